@@ -7,6 +7,7 @@
 #include <errno.h>
 #include <assert.h>
 #include <time.h>
+#include <usdr_time.h>
 
 struct ring_buffer* ring_buffer_create(unsigned items, unsigned isize)
 {
@@ -55,27 +56,7 @@ char* ring_buffer_at(struct ring_buffer* rb, unsigned idx)
 
 static int ring_buffer_stdwait(sem_t* sem, int usecs)
 {
-    int res;
-    if (usecs == -1) {
-        res = sem_wait(sem);
-    } else if (usecs == 0) {
-        res = sem_trywait(sem);
-    } else {
-        struct timespec t;
-        res = clock_gettime(CLOCK_REALTIME, &t);
-        if (res)
-            return res;
-
-        t.tv_nsec += (usecs % 1000000) * 1000;
-        t.tv_sec += (usecs / 1000000);
-        if (t.tv_nsec > 1000000000) {
-            t.tv_nsec -= 1000000000;
-            t.tv_sec++;
-        }
-
-        res = sem_timedwait(sem, &t);
-    }
-    return res;
+    return usdr_sem_wait_ns(sem, (usecs < 0) ? -1 : (int64_t)usecs * 1000);
 }
 
 unsigned ring_buffer_pwait(struct ring_buffer* rb, int usecs)
@@ -83,7 +64,7 @@ unsigned ring_buffer_pwait(struct ring_buffer* rb, int usecs)
     int res;
     do {
         res = ring_buffer_stdwait(&rb->producer, usecs);
-    } while (res == -1 && errno == EINTR);
+    } while (res == -EINTR);
     if (res == 0)
         return rb->pidx++;
 
@@ -101,7 +82,7 @@ unsigned ring_buffer_cwait(struct ring_buffer* rb, int usecs)
     int res;
     do {
         res = ring_buffer_stdwait(&rb->consumer, usecs);
-    } while (res == -1 && errno == EINTR);
+    } while (res == -EINTR);
     if (res == 0)
         return rb->cidx++;
 
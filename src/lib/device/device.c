@@ -12,8 +12,22 @@
 #include <fnmatch.h>
 
 static int _usdr_device_vfs_get_by_path(device_t *base, const char* fullpath, pusdr_vfs_obj_t *obj);
+
+static int _usdr_device_bringup_get(vfs_object_t* obj, uint64_t* ovalue)
+{
+    pdevice_t dev = (pdevice_t)obj->object;
+    const char* report = device_profile_report(&dev->profile);
+    if (report == NULL)
+        return -ENOMEM;
+
+    *ovalue = (uintptr_t)report;
+    return 0;
+}
+
 int usdr_device_base_create(pdevice_t dev, lldev_t lldev)
 {
+    int res;
+
     dev->dev = lldev;
     dev->initialize = NULL;
     dev->destroy = NULL;
@@ -22,11 +36,18 @@ int usdr_device_base_create(pdevice_t dev, lldev_t lldev)
     dev->timer_op = NULL;
     dev->vfs_get_single_object = &_usdr_device_vfs_get_by_path;
     dev->vfs_filter = &usdr_device_vfs_filter;
-    return vfs_folder_init(&dev->rootfs, "", dev);
+    device_profile_init(&dev->profile);
+
+    res = vfs_folder_init(&dev->rootfs, "", dev);
+    if (res)
+        return res;
+
+    return vfs_add_obj_i64(&dev->rootfs, "/dm/debug/bringup", dev, 0, NULL, &_usdr_device_bringup_get);
 }
 
 int usdr_device_base_destroy(pdevice_t dev)
 {
+    device_profile_free(&dev->profile);
     vfs_folder_destroy(&dev->rootfs);
     return 0;
 }
@@ -78,6 +99,7 @@ int usdr_device_register_limesdr();
 int usdr_device_register_m2_d09_4_ad45_2();
 int usdr_device_register_m2_dsdr();
 int usdr_device_register_pe_sync();
+int usdr_device_register_synth();
 
 int usdr_device_init()
 {
@@ -90,6 +112,9 @@ int usdr_device_init()
     usdr_device_register_m2_d09_4_ad45_2();
     usdr_device_register_m2_dsdr();
     usdr_device_register_pe_sync();
+#if !defined(__EMSCRIPTEN__) && !defined(WVLT_WEBUSB_BUILD)
+    usdr_device_register_synth();
+#endif
 
     // Dynamic Device initialization
     return 0;
@@ -111,6 +136,13 @@ int usdr_device_create(lldev_t dev, device_id_t devid)
     return -ENOENT;
 }
 
+int usdr_device_initialize(pdevice_t udev, unsigned pcount, const char** devparam, const char** devval)
+{
+    int span = device_span_begin(&udev->profile, "initialize");
+    int res = udev->initialize(udev, pcount, devparam, devval);
+    return device_span_end(&udev->profile, span, res);
+}
+
 int usdr_device_destroy(pdevice_t udev)
 {
    udev->destroy(udev);
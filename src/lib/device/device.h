@@ -8,6 +8,7 @@
 #include <usdr_lowlevel.h>
 
 #include "device_vfs.h"
+#include "device_profile.h"
 
 /** @file Generic device functions */
 struct device_id {
@@ -37,6 +38,7 @@ struct device {
     lldev_t dev;              ///< Underlying lowlevel device
 
     vfs_object_t rootfs;      ///< All
+    device_profile_t profile; ///< Bring-up step timings, `/dm/debug/bringup`
 
     int (*initialize)(device_t *udev, unsigned pcount, const char** devparam, const char** devval);
     void (*destroy)(device_t *udev);
@@ -74,6 +76,7 @@ int usdr_device_base_destroy(pdevice_t dev);
 
 
 int usdr_device_create(lldev_t dev, device_id_t devid);
+int usdr_device_initialize(pdevice_t udev, unsigned pcount, const char** devparam, const char** devval);
 int usdr_device_destroy(pdevice_t udev);
 
 int usdr_device_register(device_id_t devid, const struct device_factory_ops* ops);
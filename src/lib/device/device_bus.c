@@ -119,6 +119,45 @@ int device_bus_init(pdevice_t dev, struct device_bus* pdb)
 }
 
 
+enum {
+    DRP_RB_BUSY = 0x80000000,
+
+    // Register round trip is usually enough for DRP to complete, so spin a few times first
+    DRP_POLL_SPIN = 4,
+    DRP_POLL_BACKOFF_MIN_US = 10,
+    DRP_POLL_BACKOFF_MAX_US = 1000,
+    DRP_POLL_TIMEOUT_US = 10000,
+};
+
+static int device_bus_drp_poll_rb(lldev_t dev, subdev_t subdev, unsigned reg, uint32_t* pdata)
+{
+    int res;
+    unsigned delay = DRP_POLL_BACKOFF_MIN_US;
+    unsigned elapsed = 0;
+
+    for (unsigned k = 0; ; k++) {
+        res = lowlevel_reg_rd32(dev, subdev, reg, pdata);
+        if (res)
+            return res;
+
+        if ((*pdata & DRP_RB_BUSY) == 0)
+            return 0;
+
+        if (k < DRP_POLL_SPIN)
+            continue;
+
+        if (elapsed >= DRP_POLL_TIMEOUT_US) {
+            USDR_LOG("DBUS", USDR_LOG_ERROR, "DRP[%d] readback timed out, last %08x\n", reg, *pdata);
+            return -ETIMEDOUT;
+        }
+
+        usleep(delay);
+        elapsed += delay;
+        if (delay < DRP_POLL_BACKOFF_MAX_US)
+            delay *= 2;
+    }
+}
+
 int device_bus_drp_generic_op(lldev_t dev, subdev_t subdev, const device_bus_t* db,
                               lsopaddr_t ls_op_addr,
                               size_t meminsz, void* pin,
@@ -145,9 +184,14 @@ int device_bus_drp_generic_op(lldev_t dev, subdev_t subdev, const device_bus_t*
         return res;
 
     if (meminsz) {
-        usleep(1000);
         uint32_t data;
-        res = lowlevel_reg_rd32(dev, subdev, db->drp_base[bus], &data);
+        if (db->drp_core[bus] == DRP_CORE_PHY_V1) {
+            res = device_bus_drp_poll_rb(dev, subdev, db->drp_base[bus], &data);
+        } else {
+            // No completion flag, wait for the worst case
+            usleep(1000);
+            res = lowlevel_reg_rd32(dev, subdev, db->drp_base[bus], &data);
+        }
         if (res)
             return res;
 
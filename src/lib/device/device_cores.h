@@ -62,6 +62,8 @@ enum usdr_bus_cores {
     USDR_BS_QSPIA24_R0 = 6,
 
     USDR_QSPI_FLASH_24_RW = 7,
+
+    USDR_DRP_PHY_V1 = 8, // PHY_V0 with DRP busy flag in readback
 };
 
 enum usd_aux_cores {
@@ -113,5 +115,6 @@ enum usdr_gpi_cores {
 #define I2C_CORE_AUTO_LUTUPD  USDR_MAKE_COREID(USDR_CS_BUS, USDR_BS_DI2C_SIMPLE)
 #define SPI_CORE_32W          USDR_MAKE_COREID(USDR_CS_BUS, USDR_BS_SPI_SIMPLE)
 #define SPI_CORE_CFGW_CS8     USDR_MAKE_COREID(USDR_CS_BUS, USDR_BS_SPI_CFG_CS8)
+#define DRP_CORE_PHY_V1       USDR_MAKE_COREID(USDR_CS_BUS, USDR_DRP_PHY_V1)
 
 #endif
@@ -15,12 +15,14 @@
 #define M2_LM7_1_DEVICE_ID  {{ 0x12, 0xc7, 0xdc, 0x11, 0xc4, 0x05, 0x46, 0xd9, 0x83, 0x08, 0x9b, 0xc6, 0x8a, 0xcd, 0x2c, 0x6c }}
 #define M2_DSDR_DEVICE_ID  {{ 0x04, 0xe5, 0x1d, 0x5c, 0xe6, 0x22, 0x43, 0x74, 0xa4, 0x17, 0x09, 0xf3, 0x53, 0x01, 0xbc, 0xa6 }}
 #define PE_SYNC_DEVICE_ID  {{ 0x05, 0x8f, 0xa4, 0xa8, 0x75, 0x2a, 0x41, 0x15, 0x9c, 0x09, 0x23, 0x06, 0x8d, 0xc6, 0x8c, 0xdf }}
+#define SYNTH_DEVICE_ID  {{ 0x05, 0x08, 0xcf, 0xbe, 0x0d, 0x9b, 0x48, 0x96, 0xbd, 0x65, 0xc7, 0x6d, 0x45, 0x96, 0x06, 0x60 }}
 
 static const device_id_t U3_LIMESDR_DEVICE_ID_C = U3_LIMESDR_DEVICE_ID;
 static const device_id_t M2_LM6_1_DEVICE_ID_C = M2_LM6_1_DEVICE_ID;
 static const device_id_t M2_LM7_1_DEVICE_ID_C = M2_LM7_1_DEVICE_ID;
 static const device_id_t M2_DSDR_DEVICE_ID_C = M2_DSDR_DEVICE_ID;
 static const device_id_t PE_SYNC_DEVICE_ID_C = PE_SYNC_DEVICE_ID;
+static const device_id_t SYNTH_DEVICE_ID_C = SYNTH_DEVICE_ID;
 
 
 #endif //_DEVICE_IDS_H
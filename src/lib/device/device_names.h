@@ -31,6 +31,7 @@
 #define DN_BUCKET           "bucket"
 #define DN_GPI              "gpi"
 #define DN_GPO              "gpo"
+#define DN_LSSEQ            "lsseq"
 
 #define DNLL(x)  DNLL_PREFIX_NAME x
 #define DNLLC(x) DNLL_PREFIX_NAME x "_" DNP_COUNT
@@ -48,6 +49,10 @@
 #define DNLL_GPI_COUNT DNLLC(DN_GPI)
 #define DNLL_GPO_COUNT DNLLC(DN_GPO)
 
+// Non zero when the FPGA executes queued SPI/I2C commands back to back.
+// Opt-in, used only when advertised here or forced with `lsseq=on`
+#define DNLL_LSSEQ DNLL(DN_LSSEQ)
+
 #define DNLLFP_NAME(b, idx, name) DNLL_PREFIX_NAME b "/" idx "/" name
 #define DNLLFP_BASE(b, idx)  DNLLFP_NAME(b, idx, DNP_BASE)
 #define DNLLFP_IRQ(b, idx)   DNLLFP_NAME(b, idx, DNP_IRQ)
@@ -0,0 +1,89 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#include "device_poll.h"
+
+#include <usdr_port.h>
+#include <usdr_logging.h>
+#include <usdr_time.h>
+
+enum {
+    // A status register round trip is often enough, so spin a few times first
+    POLL_SPIN = 2,
+    POLL_BACKOFF_MIN_US = 10,
+    POLL_BACKOFF_MAX_US = 5000,
+};
+
+int device_poll_ready(const char* what, unsigned min_delay_us, unsigned timeout_us,
+                      device_poll_fn_t fn, void* param)
+{
+    unsigned delay = POLL_BACKOFF_MIN_US;
+    unsigned elapsed = 0;
+    uint64_t start;
+    int res;
+
+    if (min_delay_us) {
+        usleep(min_delay_us);
+    }
+
+    // Sleeps overshoot, so the budget is checked against the clock
+    start = usdr_time_ns();
+    for (unsigned k = 0; ; k++) {
+        res = fn(param);
+        if (res < 0)
+            return res;
+        if (res > 0) {
+            USDR_LOG("POLL", USDR_LOG_DEBUG, "%s ready after %u us\n", what,
+                     min_delay_us + (unsigned)((usdr_time_ns() - start) / 1000));
+            return 0;
+        }
+
+        if (k < POLL_SPIN)
+            continue;
+
+        elapsed = (usdr_time_ns() - start) / 1000;
+        if (elapsed >= timeout_us) {
+            USDR_LOG("POLL", USDR_LOG_WARNING, "%s isn't ready after %u us\n", what, min_delay_us + elapsed);
+            return -ETIMEDOUT;
+        }
+
+        if (delay > timeout_us - elapsed)
+            delay = timeout_us - elapsed;
+
+        usleep(delay);
+        if (delay < POLL_BACKOFF_MAX_US)
+            delay *= 2;
+    }
+}
+
+struct poll_reg32 {
+    lldev_t dev;
+    subdev_t subdev;
+    unsigned reg;
+    uint32_t mask;
+    uint32_t value;
+    uint32_t last;
+};
+
+static int device_poll_reg32_fn(void* param)
+{
+    struct poll_reg32* p = (struct poll_reg32*)param;
+    int res = lowlevel_reg_rd32(p->dev, p->subdev, p->reg, &p->last);
+    if (res)
+        return res;
+
+    return (p->last & p->mask) == p->value;
+}
+
+int device_poll_reg32(lldev_t dev, subdev_t subdev, unsigned reg,
+                      uint32_t mask, uint32_t value,
+                      unsigned min_delay_us, unsigned timeout_us,
+                      const char* what, uint32_t* plast)
+{
+    struct poll_reg32 p = { dev, subdev, reg, mask, value, 0 };
+    int res = device_poll_ready(what, min_delay_us, timeout_us, &device_poll_reg32_fn, &p);
+    if (plast) {
+        *plast = p.last;
+    }
+    return res;
+}
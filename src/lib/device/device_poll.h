@@ -0,0 +1,28 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#ifndef DEVICE_POLL_H
+#define DEVICE_POLL_H
+
+#include <stdint.h>
+#include <usdr_lowlevel.h>
+
+// Bounded readiness polls used in place of fixed bring-up sleeps.
+//
+// `min_delay_us` is the datasheet minimum before the flag may be trusted (0
+// when there's none), after that the condition is checked with exponential
+// backoff until `timeout_us` elapses. -ETIMEDOUT is returned on timeout.
+
+// Returns > 0 when ready, 0 when not yet, negative error to abort the poll
+typedef int (*device_poll_fn_t)(void* param);
+
+int device_poll_ready(const char* what, unsigned min_delay_us, unsigned timeout_us,
+                      device_poll_fn_t fn, void* param);
+
+// Waits for (reg & mask) == value, *plast gets the last readback (may be NULL)
+int device_poll_reg32(lldev_t dev, subdev_t subdev, unsigned reg,
+                      uint32_t mask, uint32_t value,
+                      unsigned min_delay_us, unsigned timeout_us,
+                      const char* what, uint32_t* plast);
+
+#endif
@@ -0,0 +1,143 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#include "device_profile.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <usdr_logging.h>
+#include <usdr_time.h>
+
+enum {
+    REPORT_LINE_MAX = 96,
+    REPORT_NAME_WIDTH = 40,
+};
+
+void device_profile_init(device_profile_t* p)
+{
+    memset(p, 0, sizeof(*p));
+}
+
+void device_profile_free(device_profile_t* p)
+{
+    free(p->report);
+    p->report = NULL;
+}
+
+// Drops the oldest top level step after the first one (device initialization),
+// so repeated tuning keeps the most recent history. Only called when no span
+// is open, handles held by the callers stay valid.
+static void device_profile_evict(device_profile_t* p)
+{
+    unsigned first = 0, next;
+
+    for (unsigned i = 1; i < p->count; i++) {
+        if (p->spans[i].depth == 0) {
+            first = i;
+            break;
+        }
+    }
+    if (first == 0)
+        return;
+
+    for (next = first + 1; next < p->count; next++) {
+        if (p->spans[next].depth == 0)
+            break;
+    }
+
+    memmove(&p->spans[first], &p->spans[next], (p->count - next) * sizeof(p->spans[0]));
+    p->count -= next - first;
+    p->dropped += next - first;
+}
+
+int device_span_begin(device_profile_t* p, const char* name)
+{
+    uint64_t now = usdr_time_ns();
+    struct device_span* s;
+
+    if (p == NULL)
+        return -1;
+
+    if (p->count == 0 && p->dropped == 0)
+        p->t0 = now;
+
+    if (p->depth == 0 && p->count + DEVICE_PROFILE_MAX_SPANS / 4 > DEVICE_PROFILE_MAX_SPANS) {
+        device_profile_evict(p);
+    }
+
+    if (p->count >= DEVICE_PROFILE_MAX_SPANS) {
+        p->dropped++;
+        p->depth++;
+        return -1;
+    }
+
+    s = &p->spans[p->count];
+    s->name = name;
+    s->start_ns = now - p->t0;
+    s->dur_ns = 0;
+    s->res = 0;
+    s->depth = p->depth++;
+    s->open = 1;
+    return p->count++;
+}
+
+int device_span_end(device_profile_t* p, int span, int res)
+{
+    struct device_span* s;
+
+    if (p == NULL)
+        return res;
+
+    if (p->depth > 0)
+        p->depth--;
+
+    if (span < 0 || (unsigned)span >= p->count)
+        return res;
+
+    s = &p->spans[span];
+    s->dur_ns = usdr_time_ns() - p->t0 - s->start_ns;
+    s->res = res;
+    s->open = 0;
+
+    USDR_LOG("PROF", USDR_LOG_DEBUG, "%s: %.3f ms, res=%d\n",
+             s->name, s->dur_ns / 1.0e6, res);
+    return res;
+}
+
+const char* device_profile_report(device_profile_t* p)
+{
+    size_t cap = (size_t)(p->count + 2) * REPORT_LINE_MAX;
+    size_t off = 0;
+    char* r = (char*)malloc(cap);
+    if (r == NULL)
+        return NULL;
+
+    off += snprintf(r + off, cap - off, "%-*s %10s %10s %5s\n",
+                    REPORT_NAME_WIDTH, "step", "start_ms", "dur_ms", "res");
+
+    for (unsigned i = 0; i < p->count; i++) {
+        const struct device_span* s = &p->spans[i];
+        unsigned indent = 2 * s->depth;
+        if (indent > REPORT_NAME_WIDTH / 2)
+            indent = REPORT_NAME_WIDTH / 2;
+
+        if (s->open) {
+            off += snprintf(r + off, cap - off, "%*s%-*.*s %10.3f %10s %5s\n",
+                            indent, "", REPORT_NAME_WIDTH - indent, REPORT_NAME_WIDTH - indent, s->name,
+                            s->start_ns / 1.0e6, "-", "-");
+        } else {
+            off += snprintf(r + off, cap - off, "%*s%-*.*s %10.3f %10.3f %5d\n",
+                            indent, "", REPORT_NAME_WIDTH - indent, REPORT_NAME_WIDTH - indent, s->name,
+                            s->start_ns / 1.0e6, s->dur_ns / 1.0e6, s->res);
+        }
+    }
+
+    if (p->dropped) {
+        snprintf(r + off, cap - off, "%u spans dropped\n", p->dropped);
+    }
+
+    free(p->report);
+    p->report = r;
+    return r;
+}
@@ -0,0 +1,49 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#ifndef DEVICE_PROFILE_H
+#define DEVICE_PROFILE_H
+
+#include <stdint.h>
+
+// Bring-up profiler, every named init / tune step is recorded as a span with
+// its start, duration and result. Spans nest, the report is available as
+// `/dm/debug/bringup`. All calls accept a NULL profile and do nothing then.
+
+enum {
+    DEVICE_PROFILE_MAX_SPANS = 96,
+};
+
+struct device_span {
+    const char* name;      // Must be a static string
+    uint64_t start_ns;     // Since the first span
+    uint64_t dur_ns;
+    int32_t res;
+    uint16_t depth;
+    uint16_t open;
+};
+
+struct device_profile {
+    uint64_t t0;
+    unsigned count;
+    unsigned depth;
+    unsigned dropped;
+    struct device_span spans[DEVICE_PROFILE_MAX_SPANS];
+
+    char* report;
+};
+typedef struct device_profile device_profile_t;
+
+void device_profile_init(device_profile_t* p);
+void device_profile_free(device_profile_t* p);
+
+// Returns the span handle for device_span_end(), negative when the table is full
+int device_span_begin(device_profile_t* p, const char* name);
+
+// Returns `res` so the call can wrap the step result
+int device_span_end(device_profile_t* p, int span, int res);
+
+// Text report, valid until the next call or device_profile_free()
+const char* device_profile_report(device_profile_t* p);
+
+#endif
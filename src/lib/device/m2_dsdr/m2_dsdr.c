@@ -15,6 +15,7 @@
 #include "../device_names.h"
 #include "../device_cores.h"
 #include "../device_ids.h"
+#include "../device_poll.h"
 #include "../dev_param.h"
 
 #include "../ipblks/streams/sfe_rx_4.h"
@@ -66,6 +67,30 @@ enum {
     SRF4_FIFOBSZ = 0x10000, // 64kB
 };
 
+// Minimum delays where there's no ready flag to read back
+enum dsdr_min_delays {
+    DSDR_DLY_LMK_POR_US = 40000,      // LMK05318 power on reset / EEPROM load
+    DSDR_DLY_LMK_CFG_US = 1000,       // LMK05318 output dividers update
+    DSDR_DLY_CLK_METER_US = 500000,   // FPGA clock meter gate time
+    DSDR_DLY_AFE_VIOSYS_US = 10000,   // AFE VIOSYS before the PMIC is accessed
+    DSDR_DLY_AFE_1V2_US = 25000,      // 1.2V rail ramp before 1.8V enable (Hiper)
+    DSDR_DLY_AFE_PWR_US = 100000,     // AFE79xx power up to reset
+    DSDR_DLY_AFE_RST_US = 100000,     // AFE79xx reset to first SPI access
+    DSDR_DLY_JESD_RST_US = 10000,     // JESD link reset release
+    DSDR_DLY_DSP_RST_US = 1000,       // DSP chain reset pulse
+    DSDR_DLY_PWR_OFF_US = 100,        // Power down sequencing step
+};
+
+// Readiness polls
+enum dsdr_poll_timeouts {
+    DSDR_LMK_PG_TIMEOUT_US = 100000,
+    DSDR_TPS_TIMEOUT_US = 200000,
+    DSDR_LMK_CREATE_TIMEOUT_US = 1000000,
+    DSDR_LMK_LOCK_TIMEOUT_US = 2500000,
+    DSDR_AFE_PG_TIMEOUT_US = 100000,
+    DSDR_GT_PLL_TIMEOUT_US = 1000000,
+};
+
 enum i2c_bus1 {
     I2C_ADDR_PMIC_0P9 = 0x60, //LP875484
 };
@@ -603,6 +628,13 @@ static int dev_gpi_get32(lldev_t dev, unsigned bank, unsigned* data)
     return lowlevel_reg_rd32(dev, 0, 16 + (bank / 4), data);
 }
 
+// Waits for all `mask` bits to be set
+static int dev_gpi_poll32(lldev_t dev, unsigned bank, unsigned mask, unsigned timeout_us,
+                          const char* what, unsigned* last)
+{
+    return device_poll_reg32(dev, 0, 16 + (bank / 4), mask, mask, 0, timeout_us, what, last);
+}
+
 bool dev_m2_dsdr_has_hiper(dev_m2_dsdr_t* d)
 {
     return d->type == DSDR_PCIE_HIPER_R0;
@@ -1199,19 +1231,19 @@ void usdr_device_m2_dsdr_destroy(pdevice_t udev)
     }
 
     dev_gpo_set(dev, IGPO_AFE_RST, 0x1);
-    usleep(100);
+    usleep(DSDR_DLY_PWR_OFF_US);
 
     // Safe Power OFF sequence
     dev_gpo_set(dev, IGPO_PWR_AFE, 0xf);
-    usleep(100);
+    usleep(DSDR_DLY_PWR_OFF_US);
     dev_gpo_set(dev, IGPO_PWR_AFE, 0x7);
-    usleep(100);
+    usleep(DSDR_DLY_PWR_OFF_US);
     dev_gpo_set(dev, IGPO_PWR_AFE, 0x3);
-    usleep(100);
+    usleep(DSDR_DLY_PWR_OFF_US);
     dev_gpo_set(dev, IGPO_PWR_AFE, 0x1);
-    usleep(100);
+    usleep(DSDR_DLY_PWR_OFF_US);
     dev_gpo_set(dev, IGPO_PWR_AFE, 0x0);
-    usleep(100);
+    usleep(DSDR_DLY_PWR_OFF_US);
     dev_gpo_set(dev, IGPO_PWR_LMK, 0x0);
 
     // Activity LED off
@@ -1224,8 +1256,7 @@ static int usdr_jesd204b_bringup_pre(struct dev_m2_dsdr *dd)
 {
     lldev_t dev = dd->base.dev;
     int res = 0;
-    uint32_t d;
-    bool pll_ready = false;
+    uint32_t d = 0;
 
     res = res ? res : dev_gpo_set(dev, IGPO_TIAFE_RX_SYNC_RESET, 1);
     res = res ? res : dev_gpo_set(dev, IGPO_TIAFE_TX_SYNC_RESET, 1);
@@ -1249,18 +1280,10 @@ static int usdr_jesd204b_bringup_pre(struct dev_m2_dsdr *dd)
 
     res = res ? res : dev_gpo_set(dev, IGPO_TIAFE_MASTER_RESET_N, 1);
 
-    for (unsigned k = 0; k < 100; k++) {
-        usleep(10000);
-
-        res = dev_gpi_get32(dev, IGPI_JESD_SYSREF_RAC, &d);
-        USDR_LOG("DSDR", USDR_LOG_ERROR, "STAT = %08x\n", d);
-        if (d & 0x08000000) {
-            pll_ready = true;
-            break;
-        }
-    }
-
-    if (!pll_ready) {
+    res = res ? res : dev_gpi_poll32(dev, IGPI_JESD_SYSREF_RAC, 0x08000000, DSDR_GT_PLL_TIMEOUT_US,
+                                     "GTH/GTY PLL lock", &d);
+    USDR_LOG("DSDR", USDR_LOG_ERROR, "STAT = %08x\n", d);
+    if (res == -ETIMEDOUT) {
         USDR_LOG("DSDR", USDR_LOG_ERROR, "FPGA GTH/GTY PLLs are not locked! giving up!\n");
         return -EIO;
     }
@@ -1268,7 +1291,7 @@ static int usdr_jesd204b_bringup_pre(struct dev_m2_dsdr *dd)
     // TODO wait for PLL to lock..
     res = res ? res : dev_gpo_set(dev, IGPO_TIAFE_TX_SYNC_RESET, 0);
 
-    usleep(10000);
+    usleep(DSDR_DLY_JESD_RST_US);
 
     res = res ? res :dev_gpi_get32(dev, IGPI_JESD_SYSREF_RAC, &d);
     USDR_LOG("DSDR", USDR_LOG_ERROR, "STAT = %08x\n", d);
@@ -1283,7 +1306,7 @@ static int usdr_jesd204b_bringup_post(struct dev_m2_dsdr *dd)
 
     res = res ? res : dev_gpo_set(dev, IGPO_TIAFE_RX_SYNC_RESET, 0);
 
-    usleep(10000);
+    usleep(DSDR_DLY_JESD_RST_US);
 
     res = res ? res : dev_gpi_get32(dev, IGPI_JESD_SYSREF_RAC, &d);
     USDR_LOG("DSDR", USDR_LOG_ERROR, "STAT = %08x\n", d);
@@ -1291,6 +1314,45 @@ static int usdr_jesd204b_bringup_post(struct dev_m2_dsdr *dd)
 
 }
 
+static int _dsdr_tps_init_fn(void* param)
+{
+    struct dev_m2_dsdr *d = (struct dev_m2_dsdr *)param;
+    return tps6381x_init(d->base.dev, d->subdev, I2C_TPS63811, true, true, 3450) == 0;
+}
+
+static int _dsdr_lmk_create_fn(void* param)
+{
+    struct dev_m2_dsdr *d = (struct dev_m2_dsdr *)param;
+
+    // Doesn't respond until its EEPROM is loaded
+    if (lmk05318_create(d->base.dev, d->subdev, I2C_LMK,
+                        (d->type == DSDR_PCIE_HIPER_R0) ? 2 : 1 /* TODO FIXME!!! */, &d->lmk) == 0)
+        return 1;
+
+    // Give the EEPROM load another POR delay before the next attempt
+    usleep(DSDR_DLY_LMK_POR_US);
+    return 0;
+}
+
+static int _dsdr_lmk_lock_fn(void* param)
+{
+    struct dev_m2_dsdr *d = (struct dev_m2_dsdr *)param;
+    unsigned los;
+    int res = lmk05318_get_live_lock(&d->lmk, &los);
+    if (res)
+        return res;
+
+    return (los & (LMK05318_LOS_XO | LMK05318_LOL_PLL1 | LMK05318_LOL_PLL2)) == 0;
+}
+
+static int _dsdr_afe_pmic_pg_fn(void* param)
+{
+    struct dev_m2_dsdr *d = (struct dev_m2_dsdr *)param;
+    bool pg = false;
+    int res = lp875484_is_pg(d->base.dev, d->subdev, I2C_AFE_PMIC, &pg);
+    return res ? res : pg;
+}
+
 static
 int usdr_device_m2_dsdr_initialize(pdevice_t udev, unsigned pcount, const char** devparam, const char** devval)
 {
@@ -1298,6 +1360,7 @@ int usdr_device_m2_dsdr_initialize(pdevice_t udev, unsigned pcount, const char**
     lldev_t dev = d->base.dev;
     int res = 0;
     uint32_t hwid, usr2, pg, los, devid, jesdv;
+    int span;
 
     d->subdev = 0;
     d->hw_mask_fb = 0;
@@ -1404,33 +1467,22 @@ int usdr_device_m2_dsdr_initialize(pdevice_t udev, unsigned pcount, const char**
     }
 
 
+    span = device_span_begin(&d->base.profile, "clock_power");
     res = res ? res : dev_gpo_set(dev, IGPO_PWR_LMK, 0xf);
 
-    for (unsigned j = 0; j < 10; j++) {
-        usleep(10000);
-        res = res ? res : dev_gpi_get32(dev, IGPI_PGOOD, &pg);
-        if (res || (pg & 1))
-            break;
-    }
+    // 2V05 is checked once more before the AFE is powered up
+    res = res ? res : dev_gpi_poll32(dev, IGPI_PGOOD, 1, DSDR_LMK_PG_TIMEOUT_US, "2V05 power good", &pg);
+    if (res == -ETIMEDOUT)
+        res = 0;
 
     if (d->type == DSDR_M2_R0) {
-        for (unsigned j = 0; j < 20; j++) {
-            usleep(10000);
-            res = res ? res : tps6381x_init(dev, d->subdev, I2C_TPS63811, true, true, 3450);
-            if (res == 0)
-                break;
-        }
+        res = res ? res : device_poll_ready("TPS63811", 0, DSDR_TPS_TIMEOUT_US, &_dsdr_tps_init_fn, d);
     }
-    usleep(40000);
+    device_span_end(&d->base.profile, span, res);
 
-
-    for (unsigned j = 0; j < 25; j++) {
-        usleep(40000);
-        res = res ? res : lmk05318_create(dev, d->subdev, I2C_LMK,
-                                          (d->type == DSDR_PCIE_HIPER_R0) ? 2 : 1 /* TODO FIXME!!! */, &d->lmk);
-        if (res == 0)
-            break;
-    }
+    span = device_span_begin(&d->base.profile, "lmk05318_init");
+    res = res ? res : device_poll_ready("LMK05318", DSDR_DLY_LMK_POR_US, DSDR_LMK_CREATE_TIMEOUT_US,
+                                        &_dsdr_lmk_create_fn, d);
     // Update deviders for 245/491MSPS rate
     if (d->jesdv == DSDR_JESD204C_6664_491) {
         // GT should be 245.76
@@ -1440,22 +1492,28 @@ int usdr_device_m2_dsdr_initialize(pdevice_t udev, unsigned pcount, const char**
         res = res ? res : lmk05318_set_out_div(&d->lmk, LMK_FPGA_1PPS, 4);
     }
 
-    usleep(1000);
+    // Lock is reported below, the clock meter has the final say
+    if (res == 0) {
+        int lock_res = device_poll_ready("LMK05318 APLL lock", DSDR_DLY_LMK_CFG_US, DSDR_LMK_LOCK_TIMEOUT_US,
+                                         &_dsdr_lmk_lock_fn, d);
+        if (lock_res != -ETIMEDOUT)
+            res = lock_res;
+    }
+    device_span_end(&d->base.profile, span, res);
 
     res = res ? res : lmk05318_check_lock(&d->lmk, &los);
 
-    for (int i = 0; i < 5; i++) {
+    // One gate time for the meter to catch up with the new clocks
+    if (res == 0) {
         uint32_t clk = 0;
-        res = res ? res : dev_gpi_get32(d->base.dev, 20, &clk);
+        usleep(DSDR_DLY_CLK_METER_US);
+        res = dev_gpi_get32(d->base.dev, 20, &clk);
 
         USDR_LOG("DSDR", USDR_LOG_ERROR, "Clk %d: %d\n", clk >> 28, clk & 0xfffffff);
-        usleep(0.5 * 1e6);
     }
 
-    res = res ? res : lmk05318_check_lock(&d->lmk, &los);
     // res = res ? res : lmk05318_set_out_mux(&d->lmk, LMK_FPGA_SYSREF, false, LVDS);
 
-    usleep(1000);
     res = res ? res : dev_gpi_get32(dev, IGPI_PGOOD, &pg);
 
     USDR_LOG("DSDR", USDR_LOG_ERROR, "Configuration: OK [%08x, %08x] res=%d   PG=%08x\n", usr2, hwid, res, pg);
@@ -1469,29 +1527,22 @@ int usdr_device_m2_dsdr_initialize(pdevice_t udev, unsigned pcount, const char**
     }
 
     // Initialize AFEPWR
+    span = device_span_begin(&d->base.profile, "afe_power");
     res = res ? res : dev_gpo_set(dev, IGPO_PWR_AFE, 0x1); // Enable VIOSYS, hold RESET
-    usleep(10000);
+    usleep(DSDR_DLY_AFE_VIOSYS_US);
     //res = res ? res : dev_gpo_set(dev, IGPO_PWR_AFE, 0x3); // Enable VIOSYS, hold RESET
     res = res ? res : lp875484_init(dev, d->subdev, I2C_AFE_PMIC);
     res = res ? res : lp875484_set_vout(dev, d->subdev, I2C_AFE_PMIC, 900);
     res = res ? res : dev_gpo_set(dev, IGPO_PWR_AFE, 0x3); // Enable VIOSYS, release RESET
     if (res)
-        return res;
-
-    bool afe_pg = false;
-    for (unsigned j = 0; j < 100; j++) {
-        res = lp875484_is_pg(dev, d->subdev, I2C_AFE_PMIC, &afe_pg);
-        if (res)
-            return res;
-
-        if (afe_pg)
-            break;
+        return device_span_end(&d->base.profile, span, res);
 
-        usleep(1000);
-    }
-    if (!afe_pg) {
+    res = device_poll_ready("DCDC 0.9V", 0, DSDR_AFE_PG_TIMEOUT_US, &_dsdr_afe_pmic_pg_fn, d);
+    if (res == -ETIMEDOUT) {
         USDR_LOG("DSDR", USDR_LOG_ERROR, "DCDC 0.9V isn't good, giving up!\n");
-        return -EIO;
+        return device_span_end(&d->base.profile, span, -EIO);
+    } else if (res) {
+        return device_span_end(&d->base.profile, span, res);
     }
 
     res = res ? res : dev_gpo_set(dev, IGPO_PWR_AFE, 0x7); // Enable DCDC 1.2V;
@@ -1499,44 +1550,39 @@ int usdr_device_m2_dsdr_initialize(pdevice_t udev, unsigned pcount, const char**
     // We don't have EN_1v8 routed in this rev
 
     if (d->type == DSDR_PCIE_HIPER_R0) {
-        usleep(25000);
+        usleep(DSDR_DLY_AFE_1V2_US);
         res = res ? res : dev_gpo_set(dev, IGPO_PWR_AFE, 0xf);
     }
 
     // Check PG_1v8
-    for (unsigned j = 0; j < 100; j++) {
-        res = dev_gpi_get32(dev, IGPI_PGOOD, &pgdat);
-        if (pgdat & (1 << 6))
-            break;
-
-        usleep(1000);
-    }
-    if (!(pgdat & (1 << 6))) {
+    res = res ? res : dev_gpi_poll32(dev, IGPI_PGOOD, 1 << 6, DSDR_AFE_PG_TIMEOUT_US, "DCDC 1.8V", &pgdat);
+    if (res == -ETIMEDOUT) {
         USDR_LOG("DSDR", USDR_LOG_ERROR, "DCDC 1.8V isn't good, giving up!\n");
-        return -EIO;
+        return device_span_end(&d->base.profile, span, -EIO);
     }
 
     res = res ? res : dev_gpo_set(dev, IGPO_PWR_AFE, 0x1f);
     if (res)
-        return res;
+        return device_span_end(&d->base.profile, span, res);
 
     // Test AFE chip
     USDR_LOG("DSDR", USDR_LOG_ERROR, "AFE is powered up!\n");
 
-    usleep(100000);
+    usleep(DSDR_DLY_AFE_PWR_US);
 
     res = res ? res : dev_gpo_set(dev, IGPO_AFE_RST, 0x0);
     res = res ? res : dev_gpo_set(dev, IGPO_AFE_RST, 0x1);
 
-    usleep(100000);
-
+    usleep(DSDR_DLY_AFE_RST_US);
+    device_span_end(&d->base.profile, span, res);
 
+    span = device_span_begin(&d->base.profile, "afe79xx_init");
     res = res ? res : afe79xx_create(dev, d->subdev, 0, &d->st);
     if (res == 0) {
         res = res ? res : usdr_jesd204b_bringup_pre(d);
 
         // sleep(1);
-        usleep(10000);
+        usleep(DSDR_DLY_JESD_RST_US);
 
         char afeconfig_path[1024];
         char *afecfgpath = getenv("AFECFG_PATH");
@@ -1547,6 +1593,7 @@ int usdr_device_m2_dsdr_initialize(pdevice_t udev, unsigned pcount, const char**
         res = res ? res : afe79xx_init(&d->st, afeconfig_path);
         res = res ? res : usdr_jesd204b_bringup_post(d);
     }
+    device_span_end(&d->base.profile, span, res);
 
     if (d->type == DSDR_PCIE_HIPER_R0) {
         res = res ? res : dsdr_hiper_fe_create(dev, SPI_BUS_HIPER_FE, &d->hiper);
@@ -1783,11 +1830,11 @@ int usdr_device_m2_dsdr_create_stream(device_t* dev, const char* sid, const char
         }
 
         res = (res) ? res : dev_gpo_set(d->base.dev, IGPO_DSPCHAIN_RST, 0x7);
-        usleep(1000);
+        usleep(DSDR_DLY_DSP_RST_US);
         res = (res) ? res : dev_gpo_set(d->base.dev, IGPO_DSPCHAIN_RST, 0x0);
 
         res = (res) ? res : create_sfetrx4_stream(dev, CORE_EXFERX_DMA32_R0, dformat, channels->count, &lchans, pktsyms,
-                                    flags, M2PCI_REG_WR_RXDMA_CONFIRM, VIRT_CFG_SFX_BASE, 0,
+                                    flags, parameters, M2PCI_REG_WR_RXDMA_CONFIRM, VIRT_CFG_SFX_BASE, 0,
                                     SRF4_FIFOBSZ, CSR_RFE4_BASE, &d->rx, &hwchs);
         if (res) {
             return res;
@@ -1845,11 +1892,11 @@ int usdr_device_m2_dsdr_create_stream(device_t* dev, const char* sid, const char
         }
 
         res = (res) ? res : dev_gpo_set(d->base.dev, IGPO_DSPCHAIN_TX_RST, 0x7);
-        usleep(1000);
+        usleep(DSDR_DLY_DSP_RST_US);
         res = (res) ? res : dev_gpo_set(d->base.dev, IGPO_DSPCHAIN_TX_RST, 0x0);
 
         res = (res) ? res : create_sfetrx4_stream(dev, CORE_EXFETX_DMA32_R0, dformat, channels->count, &lchans, pktsyms,
-                                                  flags | DMS_DONT_CHECK_FWID,
+                                                  flags | DMS_DONT_CHECK_FWID, parameters,
                                                   M2PCI_REG_WR_TXDMA_CFG0,
                                                   M2PCI_REG_WR_SYNC_CTRL,
                                                   M2PCI_REG_RD_TXDMA_STAT,
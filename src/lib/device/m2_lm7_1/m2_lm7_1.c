@@ -978,7 +978,8 @@ int usdr_device_m2_lm7_1_stream_initialize(lldev_t dev, subdev_t subdev, lowleve
         return -EOPNOTSUPP;
     }
 
-    res = xsdr_prepare(&d->xdev, true, true);
+    int span = device_span_begin(&d->base.profile, "stream_prepare");
+    res = device_span_end(&d->base.profile, span, xsdr_prepare(&d->xdev, true, true));
     if (res) {
         return res;
     }
@@ -1034,7 +1035,9 @@ int usdr_device_m2_lm7_1_initialize(pdevice_t udev, unsigned pcount, const char*
 
     if (d->xdev.new_rev) {
         // Init FE
+        int span = device_span_begin(&udev->profile, "fe_probe");
         res = device_fe_probe(udev, d->xdev.ssdr ? "m2b+m" : "m2a+e", fe, I2C_BUS_FRONTEND, &d->fe);
+        device_span_end(&udev->profile, span, res);
         if (res) {
             return res;
         }
@@ -1150,7 +1153,7 @@ int usdr_device_m2_lm7_1_create_stream(device_t* dev, const char* sid, const cha
         }
 
         res = create_sfetrx4_stream(dev, CORE_SFERX_DMA32_R0, dformat, channels->count, &lchans, pktsyms,
-                                    flags, M2PCI_REG_WR_RXDMA_CONFIRM, VIRT_CFG_SFX_BASE, 0,
+                                    flags, parameters, M2PCI_REG_WR_RXDMA_CONFIRM, VIRT_CFG_SFX_BASE, 0,
                                     SRF4_FIFOBSZ, CSR_RFE4_BASE, &d->rx, &hwchs);
         if (res) {
             return res;
@@ -1180,7 +1183,7 @@ int usdr_device_m2_lm7_1_create_stream(device_t* dev, const char* sid, const cha
         }
 
         res = create_sfetrx4_stream(dev, CORE_SFETX_DMA32_R0, dformat, channels->count, &lchans, pktsyms,
-                                    flags, M2PCI_REG_WR_TXDMA_CNF_L, M2PCI_REG_WR_SYNC_CTRL, M2PCI_REG_RD_TXDMA_STAT,
+                                    flags, parameters, M2PCI_REG_WR_TXDMA_CNF_L, M2PCI_REG_WR_SYNC_CTRL, M2PCI_REG_RD_TXDMA_STAT,
                                     0, 0, &d->tx, &hwchs);
         if (res) {
             return res;
@@ -1225,6 +1228,7 @@ int usdr_device_m2_lm7_1_create(lldev_t dev, device_id_t devid)
     if (res) {
         goto failed_free;
     }
+    d->xdev.prof = &d->base.profile;
 
     res = vfs_add_const_i64_vec(&d->base.rootfs,
                                 s_params_m2_lm7_1_rev000,
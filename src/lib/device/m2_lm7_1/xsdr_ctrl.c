@@ -19,6 +19,7 @@
 #include "../cal/cal_lo_iqimb.h"
 #include "../ipblks/streams/sfe_rx_4.h"
 #include "../ipblks/xlnx_mmcm.h"
+#include "../device_poll.h"
 
 #ifndef MAX
 #define MAX(x,y) (((x) > (y)) ? (x) : (y))
@@ -38,6 +39,25 @@ enum {
     XSDR_INT_REFCLK = 26000000,
 };
 
+// Minimum delays where there's no ready flag to read back
+enum xsdr_min_delays {
+    XSDR_DLY_PHY_RST_US = 100,        // LML PHY / MMCM reset pulse width
+    XSDR_DLY_MMCM_RST_US = 1000,      // MMCM held in reset before DRP reprogramming
+    XSDR_DLY_AFE_CLK_US = 10000,      // LMS7 AFE clock to the LML after power up
+    XSDR_DLY_LMS_PWR_OFF_US = 5000,   // LMS7 rails discharge / LDO switch
+    XSDR_DLY_LMS_LDO_US = 1000,       // LMS7 internal LDOs
+    XSDR_DLY_LMS_RST_US = 2500,       // LMS7 reset release to first SPI access
+    XSDR_DLY_SSDR_1V8A_US = 100000,   // Heavy load on 1.8VA (SSDR)
+    XSDR_DLY_LMS8_SPI_US = 100,       // LMS8 SPI mux switch
+    XSDR_DLY_LMS8_PWR_US = 100000,    // LMS8 LDOs / reset
+};
+
+// Readiness polls
+enum xsdr_poll_timeouts {
+    XSDR_PMIC_PG_TIMEOUT_US = 100000,
+    XSDR_MMCM_LOCK_TIMEOUT_US = 60000,
+};
+
 // 1001011 - PDAC80501MDQFT
 // 1100010 - MCP4725A1T
 enum BUSIDX_mp_lm7_1_rev000 {
@@ -108,6 +128,28 @@ static int dev_gpi_get32(lldev_t dev, unsigned bank, unsigned* data)
 static int _xsdr_init_revx(xsdr_dev_t *d, unsigned hwid);
 static int _xsdr_init_revo(xsdr_dev_t *d);
 
+struct xsdr_pmic_pg {
+    xsdr_dev_t *d;
+    lsopaddr_t ls_op_addr;
+};
+
+static int _xsdr_pmic_pg_fn(void* param)
+{
+    struct xsdr_pmic_pg* p = (struct xsdr_pmic_pg*)param;
+    bool pg = false;
+    int res = lp8758_check_pg(p->d->base.lmsstate.dev, p->d->base.lmsstate.subdev, p->ls_op_addr, 0xf, &pg);
+    return res ? res : pg;
+}
+
+// Wait for power good on all rails of a PMIC
+static int _xsdr_pmic_wait_pg(xsdr_dev_t *d, lsopaddr_t ls_op_addr, const char* name)
+{
+    struct xsdr_pmic_pg p = { d, ls_op_addr };
+    int span = device_span_begin(d->prof, name);
+    int res = device_poll_ready(name, 0, XSDR_PMIC_PG_TIMEOUT_US, &_xsdr_pmic_pg_fn, &p);
+    return device_span_end(d->prof, span, res);
+}
+
 static int _xsdr_checkpwr(xsdr_dev_t *d)
 {
     USDR_LOG("XDEV", USDR_LOG_ERROR, "checkpwr: %d\n", d->pwr_en);
@@ -170,17 +212,17 @@ int xsdr_configure_lml_mmcm(xsdr_dev_t *d)
 
     res = (res) ? res : lowlevel_reg_wr32(d->base.lmsstate.dev, d->base.lmsstate.subdev, REG_CFG_PHY_0,
                                           0x80000000 | 0x10000 | 0xF);
-    usleep(100);
+    usleep(XSDR_DLY_PHY_RST_US);
     res = (res) ? res : lowlevel_reg_wr32(d->base.lmsstate.dev, d->base.lmsstate.subdev, REG_CFG_PHY_0,
                                           0x80000000 | 0x10000 | 0xD);
-    usleep(100);
+    usleep(XSDR_DLY_PHY_RST_US);
     res = (res) ? res : lowlevel_reg_wr32(d->base.lmsstate.dev, d->base.lmsstate.subdev, REG_CFG_PHY_0,
                                           0x80000000 | 0x10000 | 0x1);
 
     if (res)
         return res;
 
-    usleep(1000);
+    usleep(XSDR_DLY_MMCM_RST_US);
     res = mmcm_init_raw(d->base.lmsstate.dev, d->base.lmsstate.subdev, 0, &cfg_raw);
     if (res)
         return res;
@@ -188,24 +230,18 @@ int xsdr_configure_lml_mmcm(xsdr_dev_t *d)
     res = (res) ? res : lowlevel_reg_wr32(d->base.lmsstate.dev, d->base.lmsstate.subdev, REG_CFG_PHY_0,
                                           0x80000000 | 0x10000 | 0x0);
 
-    usleep(10000);
     res = (res) ? res : lowlevel_reg_wr32(d->base.lmsstate.dev, d->base.lmsstate.subdev, REG_CFG_PHY_0,
                                            0x01000000);
     if (res)
         return res;
 
-    for (unsigned k = 0; k < 10; k++) {
-        // Wait for lock
-        res = lowlevel_reg_rd32(d->base.lmsstate.dev, d->base.lmsstate.subdev,
-                                REG_CFG_PHY_0, &rb);
-
-
-        USDR_LOG("XDEV", USDR_LOG_INFO, "MMCM FLAGS:%08x\n", rb);
-        if (rb & (1 << 16))
-            return 0;
+    // Wait for lock, the PHY is usable even without it so it's not fatal
+    res = device_poll_reg32(d->base.lmsstate.dev, d->base.lmsstate.subdev, REG_CFG_PHY_0,
+                            1 << 16, 1 << 16, 0, XSDR_MMCM_LOCK_TIMEOUT_US, "MMCM lock", &rb);
+    USDR_LOG("XDEV", USDR_LOG_INFO, "MMCM FLAGS:%08x\n", rb);
+    if (res && res != -ETIMEDOUT)
+        return res;
 
-        usleep(5000);
-    }
     return 0;
 
     return -ERANGE;
@@ -263,10 +299,11 @@ int xsdr_hwchans_cnt(xsdr_dev_t *d, bool rx, unsigned chans)
     return 0;
 }
 
-int xsdr_set_samplerate_ex(xsdr_dev_t *d,
-                           unsigned rxrate, unsigned txrate,
-                           unsigned adcclk, unsigned dacclk,
-                           unsigned flags)
+static
+int _xsdr_set_samplerate_ex(xsdr_dev_t *d,
+                            unsigned rxrate, unsigned txrate,
+                            unsigned adcclk, unsigned dacclk,
+                            unsigned flags)
 {
     const unsigned l1_pid = (d->hwid) & 0x7;
     const unsigned l2_pid = (d->hwid >> 4) & 0x7;
@@ -278,6 +315,7 @@ int xsdr_set_samplerate_ex(xsdr_dev_t *d,
     subdev_t subdev = d->base.lmsstate.subdev;
     unsigned sisosdrflag;
     int res;
+    int span;
 
     res = _xsdr_checkpwr(d);
     if (res)
@@ -292,7 +330,9 @@ int xsdr_set_samplerate_ex(xsdr_dev_t *d,
     unsigned m_flags = flags | ((d->siso_sdr_active_rx && d->hwchans_rx == 1) ? XSDR_LML_SISO_DDR_RX : 0)
                        | ((d->siso_sdr_active_tx && d->hwchans_tx == 1) ? XSDR_LML_SISO_DDR_TX : 0);
 
+    span = device_span_begin(d->prof, "lms7002m_samplerate");
     res = lms7002m_samplerate(&d->base, rxrate, txrate, adcclk, dacclk, m_flags, rx_port_1);
+    device_span_end(d->prof, span, res);
     if (res)
         return res;
 
@@ -307,7 +347,7 @@ int xsdr_set_samplerate_ex(xsdr_dev_t *d,
         lms7002m_afe_enable(&d->base.lmsstate, true, true, true, true); // TODO: Check if rx & tx, a & b is required!
 
         // wait for clock to stabilize
-        usleep(10000);
+        usleep(XSDR_DLY_AFE_CLK_US);
 
         d->afe_active = true;
     }
@@ -320,7 +360,7 @@ int xsdr_set_samplerate_ex(xsdr_dev_t *d,
 
     sisosdrflag = d->base.lml_mode.rxsisoddr ? 8 : 0;
     res = lowlevel_reg_wr32(dev, subdev, REG_CFG_PHY_0, 0x80000007 | sisosdrflag);
-    usleep(100);
+    usleep(XSDR_DLY_PHY_RST_US);
     res = lowlevel_reg_wr32(dev, subdev, REG_CFG_PHY_0, 0x80000000 | sisosdrflag);
 
 
@@ -329,7 +369,7 @@ int xsdr_set_samplerate_ex(xsdr_dev_t *d,
         // TODO phase search
         for (unsigned h = 0; h < 16; h++) {
             res = lowlevel_reg_wr32(dev, subdev, REG_CFG_PHY_0, 0x80000007 | sisosdrflag);
-            usleep(100);
+            usleep(XSDR_DLY_PHY_RST_US);
             res = lowlevel_reg_wr32(dev, subdev, REG_CFG_PHY_0, 0x80000000 | sisosdrflag);
 
 
@@ -355,6 +395,16 @@ int xsdr_set_samplerate_ex(xsdr_dev_t *d,
 
 }
 
+int xsdr_set_samplerate_ex(xsdr_dev_t *d,
+                           unsigned rxrate, unsigned txrate,
+                           unsigned adcclk, unsigned dacclk,
+                           unsigned flags)
+{
+    int span = device_span_begin(d->prof, "set_samplerate");
+    int res = _xsdr_set_samplerate_ex(d, rxrate, txrate, adcclk, dacclk, flags);
+    return device_span_end(d->prof, span, res);
+}
+
 
 int xsdr_clk_debug_info(xsdr_dev_t *d)
 {
@@ -718,7 +768,6 @@ int _xsdr_init_revx(xsdr_dev_t *d, unsigned hwid)
     lldev_t dev = d->base.lmsstate.dev;
     unsigned subdev = 0;
     int res;
-    bool pg = false;
 
     enum tx_switch_cfg {
         TX_SW_NORMAL = 0,
@@ -811,12 +860,8 @@ int _xsdr_init_revx(xsdr_dev_t *d, unsigned hwid)
     res = res ? res : lp8758_vout_ctrl(dev, subdev, I2C_BUS_LP8758_FPGA, 3, 1, 1); //1v8
 
     // Wait for power to settle
-    for (unsigned i = 0; !res && !pg && (i < 100); i++) {
-        usleep(1000);
-        res = res ? res : lp8758_check_pg(dev, subdev, I2C_BUS_LP8758_FPGA, 0xf, &pg);
-    }
-
-    if (!pg) {
+    res = res ? res : _xsdr_pmic_wait_pg(d, I2C_BUS_LP8758_FPGA, "pmic_fpga_pg");
+    if (res) {
         USDR_LOG("XDEV", USDR_LOG_INFO, "Couldn't set PMIC voltages!\n");
         return -EIO;
     }
@@ -830,13 +875,13 @@ int _xsdr_init_revx(xsdr_dev_t *d, unsigned hwid)
         res = res ? res : dev_gpo_set(dev, IGPO_LMS8_CTRL, 0x0);
         res = res ? res : dev_gpo_set(dev, IGPO_LDOLMS_EN, 1); // Enable LDOs
         res = res ? res : dev_gpo_set(dev, IGPO_LMS_PWR, 9);   // LMS
-        usleep(100000);
+        usleep(XSDR_DLY_LMS8_PWR_US);
 
         res = res ? res : lowlevel_spi_tr32(dev, d->base.lmsstate.subdev, 0, 0x002F0000, &chipver);
         USDR_LOG("XDEV", USDR_LOG_INFO, "LMS7002 version %08x\n", chipver);
 
         res = res ? res : dev_gpo_set(dev, IGPO_LMS8_CTRL, 0x81);
-        usleep(100000);
+        usleep(XSDR_DLY_LMS8_PWR_US);
 
         res = res ? res : lowlevel_spi_tr32(dev, d->base.lmsstate.subdev, 0, 0x800000ff, &chipver);
         res = res ? res : lowlevel_spi_tr32(dev, d->base.lmsstate.subdev, 0, 0x000f0000, &chipver);
@@ -865,9 +910,9 @@ int xsdr_trspi_lms8(xsdr_dev_t *d, uint32_t out, uint32_t* in)
         return -EINVAL;
 
     res = res ? res : dev_gpo_set(dev, IGPO_LMS8_CTRL, 0x81);
-    usleep(100);
+    usleep(XSDR_DLY_LMS8_SPI_US);
     res = res ? res : lowlevel_spi_tr32(dev, d->base.lmsstate.subdev, 0, out, in);
-    usleep(100);
+    usleep(XSDR_DLY_LMS8_SPI_US);
     res = res ? res : dev_gpo_set(dev, IGPO_LMS8_CTRL, 0x80);
 
     return res;
@@ -880,7 +925,6 @@ int _xsdr_init_revo(xsdr_dev_t *d)
     int res = 0;
     int mid_range;
     uint16_t rev;
-    bool bpg;
     uint32_t cfg;
 
     // Antenna band switch configuration
@@ -944,20 +988,12 @@ int _xsdr_init_revo(xsdr_dev_t *d)
     res = res ? res : lp8758_vout_ctrl(dev, subdev, I2C_BUS_LP8758_LMSINIT, 3, 1, 1);
 
     // wait for power good on all rails
-    for (unsigned i = 0; i < 100; i++) {
-        bpg = false;
-        res = res ? res : lp8758_check_pg(dev, subdev, I2C_BUS_LP8758_LMSINIT, 0xf, &bpg);
-        if (res)
-            return res;
-
-        if (bpg)
-            break;
-
-        usleep(1000);
-    }
-    if (!bpg) {
+    res = res ? res : _xsdr_pmic_wait_pg(d, I2C_BUS_LP8758_LMSINIT, "pmic_lms_pg");
+    if (res == -ETIMEDOUT) {
         USDR_LOG("XDEV", USDR_LOG_ERROR, "PMIC_LMS7: couldn't set LMS7 volatges, giving up!\n");
         return -EIO;
+    } else if (res) {
+        return res;
     }
 
     // Switch second I2C to gpio control
@@ -1063,9 +1099,9 @@ int _xsdr_pwren_revx(xsdr_dev_t *d, bool on)
 
     if (d->ssdr) {
         // Haevy load on 1.8VA
-        usleep(100000);
+        usleep(XSDR_DLY_SSDR_1V8A_US);
     }
-    usleep(1000);
+    usleep(XSDR_DLY_LMS_LDO_US);
     return 0;
 }
 
@@ -1075,7 +1111,8 @@ int _xsdr_pwren_revo(xsdr_dev_t *d, bool on)
     return 0;
 }
 
-int xsdr_pwren(xsdr_dev_t *d, bool on)
+static
+int _xsdr_pwren(xsdr_dev_t *d, bool on)
 {
     int res;
     lldev_t dev = d->base.lmsstate.dev;
@@ -1083,24 +1120,24 @@ int xsdr_pwren(xsdr_dev_t *d, bool on)
     res = dev_gpo_set(dev, IGPO_LMS_PWR, 0); //Disble, put into reset
     if (res)
         return res;
-    usleep(5000);
+    usleep(XSDR_DLY_LMS_PWR_OFF_US);
 
     res = (d->new_rev) ?
                 _xsdr_pwren_revx(d, on) :
                 _xsdr_pwren_revo(d, on);
     if (res)
         return res;
-    usleep(5000);
+    usleep(XSDR_DLY_LMS_PWR_OFF_US);
 
     res = dev_gpo_set(dev, IGPO_LMS_PWR, 1); //Enable LDO, put into reset
     if (res)
         return res;
-    usleep(1000);
+    usleep(XSDR_DLY_LMS_LDO_US);
 
     res = dev_gpo_set(dev, IGPO_LMS_PWR, 9); //Enable LDO, reset release
     if (res)
         return res;
-    usleep(2500);
+    usleep(XSDR_DLY_LMS_RST_US);
 
 
     res = lms7002m_create(d->base.lmsstate.dev, d->base.lmsstate.subdev, SPI_LMS7,
@@ -1112,6 +1149,12 @@ int xsdr_pwren(xsdr_dev_t *d, bool on)
     return res;
 }
 
+int xsdr_pwren(xsdr_dev_t *d, bool on)
+{
+    int span = device_span_begin(d->prof, on ? "rfic_power_on" : "rfic_power_off");
+    return device_span_end(d->prof, span, _xsdr_pwren(d, on));
+}
+
 int xsdr_usbclk(xsdr_dev_t *d, bool uclk)
 {
     // Override for testing purposes
@@ -1123,6 +1166,7 @@ int xsdr_init(xsdr_dev_t *d)
     uint32_t hwid, hwcfg_devid;
     lldev_t dev = d->base.lmsstate.dev;
     int res;
+    int span;
 
     res = dev_gpi_get32(dev, IGPI_HWID, &hwid);
     if (res)
@@ -1137,7 +1181,8 @@ int xsdr_init(xsdr_dev_t *d)
     d->siso_sdr_active_rx = false;
     d->siso_sdr_active_tx = false;
 
-    res = lms7002m_init(&d->base, dev, 0, XSDR_INT_REFCLK);
+    span = device_span_begin(d->prof, "lms7002m_init");
+    res = device_span_end(d->prof, span, lms7002m_init(&d->base, dev, 0, XSDR_INT_REFCLK));
     if (res)
         return res;
 
@@ -1156,7 +1201,9 @@ int xsdr_init(xsdr_dev_t *d)
         }
     }
 
+    span = device_span_begin(d->prof, "board_init");
     res = (d->new_rev) ? _xsdr_init_revx(d, hwcfg_devid) : _xsdr_init_revo(d);
+    device_span_end(d->prof, span, res);
     if (res)
         return res;
 
@@ -1201,6 +1248,7 @@ int xsdr_prepare(xsdr_dev_t *d, bool rxen, bool txen)
 {
     lldev_t dev = d->base.lmsstate.dev;
     int res = 0;
+    int span;
 
     if (d->base.cgen_clk == 0) {
         const unsigned default_rate = 1000000;
@@ -1229,10 +1277,12 @@ int xsdr_prepare(xsdr_dev_t *d, bool rxen, bool txen)
     d->base.tx_run[0] = txen;
     d->base.tx_run[1] = txen;
 
+    span = device_span_begin(d->prof, "rfic_streaming_up");
     res = xsdr_rfic_streaming_up(d,
                                  (rxen ? RFIC_LMS7_RX : 0) | (txen ? RFIC_LMS7_TX : 0),
                                  LMS7_CH_AB, 0,
                                  LMS7_CH_AB, 0);
+    device_span_end(d->prof, span, res);
 
     //if (txen) {
         // TODO: Add proper delay calibration
@@ -12,6 +12,7 @@
 #include "../generic_usdr/generic_regs.h"
 #include "lms7002m_ctrl.h"
 #include "../hw/lms8001/lms8001.h"
+#include "../device_profile.h"
 
 #define RFIC_CHANS 2
 
@@ -59,6 +60,8 @@ struct xsdr_dev
         bool pmic_ch145_valid;
         bool dac_old_r5;
     };
+
+    device_profile_t* prof; // Bring-up timings of the owning device
 };
 
 typedef struct xsdr_dev xsdr_dev_t;
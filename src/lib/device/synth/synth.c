@@ -0,0 +1,336 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+// Host-only device on top of the synthetic lowlevel backend, streams go
+// through the same SFE RX/TX DMA32 code as the M.2 boards
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <usdr_port.h>
+#include <usdr_lowlevel.h>
+#include <usdr_logging.h>
+
+#include "../device.h"
+#include "../device_ids.h"
+#include "../device_vfs.h"
+#include "../device_names.h"
+#include "../device_cores.h"
+
+#include "../generic_usdr/generic_regs.h"
+#include "../ipblks/streams/stream_sfetrx4_dma32.h"
+#include "../../lowlevel/synth_ll/synth_ll.h"
+
+enum {
+    SRF4_FIFOBSZ = 0x10000, // 64kB
+
+    SYNTH_STREAM_RX = 0,
+    SYNTH_STREAM_TX = 1,
+};
+
+static
+const usdr_dev_param_constant_t s_params_synth_rev000[] = {
+    { DNLL_SPI_COUNT, 0 },
+    { DNLL_I2C_COUNT, 0 },
+    { DNLL_SRX_COUNT, 1 },
+    { DNLL_STX_COUNT, 1 },
+    { DNLL_RFE_COUNT, 1 },
+    { DNLL_TFE_COUNT, 0 },
+    { DNLL_IDX_REGSP_COUNT, 1 },
+    { DNLL_IRQ_COUNT, 0 },
+
+    { "/ll/idx_regsp/0/base", M2PCI_REG_WR_BADDR },
+    { "/ll/idx_regsp/0/virt_base", VIRT_CFG_SFX_BASE },
+
+    // data stream cores
+    { "/ll/srx/0/core",    USDR_MAKE_COREID(USDR_CS_STREAM, USDR_SC_RXDMA_BRSTN) },
+    { "/ll/srx/0/base",    M2PCI_REG_WR_RXDMA_CONFIRM},
+    { "/ll/srx/0/cfg_base",VIRT_CFG_SFX_BASE },
+    { "/ll/srx/0/rfe",     (uintptr_t)"/ll/rfe/0" },
+    { "/ll/rfe/0/fifobsz", SRF4_FIFOBSZ },
+    { "/ll/rfe/0/core",    USDR_MAKE_COREID(USDR_CS_FE, USDR_FC_BRSTN) },
+    { "/ll/rfe/0/base",    CSR_RFE4_BASE },
+
+    { "/ll/stx/0/core",    USDR_MAKE_COREID(USDR_CS_STREAM, USDR_SC_TXDMA_OLD) },
+    { "/ll/stx/0/base",    M2PCI_REG_WR_TXDMA_CNF_L},
+    { "/ll/stx/0/cfg_base",VIRT_CFG_SFX_BASE + 512 },
+
+    { "/ll/sync/0/core",   USDR_MAKE_COREID(USDR_CS_SYNC, USDR_SYNC_SIMPLE) },
+    { "/ll/sync/0/base",   M2PCI_REG_WR_SYNC_CTRL},
+
+    { "/ll/sdr/0/rfic/0", (uintptr_t)"none" },
+    { "/ll/sdr/max_hw_rx_chans",  2 },
+    { "/ll/sdr/max_hw_tx_chans",  2 },
+    { "/ll/sdr/max_sw_rx_chans",  2 },
+    { "/ll/sdr/max_sw_tx_chans",  2 },
+};
+
+static int dev_synth_rate_set(pdevice_t ud, pusdr_vfs_obj_t obj, uint64_t value);
+static int dev_synth_rate_m_set(pdevice_t ud, pusdr_vfs_obj_t obj, uint64_t value);
+static int dev_synth_rf_set(pdevice_t ud, pusdr_vfs_obj_t obj, uint64_t value);
+static int dev_synth_dummy(pdevice_t ud, pusdr_vfs_obj_t obj, uint64_t value);
+static int dev_synth_zero_get(pdevice_t ud, pusdr_vfs_obj_t obj, uint64_t* ovalue);
+static int dev_synth_senstemp_get(pdevice_t ud, pusdr_vfs_obj_t obj, uint64_t* ovalue);
+static int dev_synth_refclk_frequency_set(pdevice_t ud, pusdr_vfs_obj_t obj, uint64_t value);
+static int dev_synth_refclk_frequency_get(pdevice_t ud, pusdr_vfs_obj_t obj, uint64_t* ovalue);
+
+// There's no RF, tuning is accepted so the generic clients (SoapySDR,
+// usdr_dm_create) work as usual
+static
+const usdr_dev_param_func_t s_fparams_synth_rev000[] = {
+    { "/dm/rate/master",          { dev_synth_rate_set, NULL }},
+    { "/dm/rate/rxtxadcdac",      { dev_synth_rate_m_set, NULL }},
+    { "/dm/sdr/channels",         { NULL, NULL }},
+
+    { "/dm/sdr/0/rx/freqency",    { dev_synth_rf_set, NULL }},
+    { "/dm/sdr/0/tx/freqency",    { dev_synth_rf_set, NULL }},
+    { "/dm/sdr/0/tdd/freqency",   { dev_synth_rf_set, NULL }},
+    { "/dm/sdr/0/rx/gain",        { dev_synth_rf_set, NULL }},
+    { "/dm/sdr/0/rx/gain/vga",    { dev_synth_rf_set, NULL }},
+    { "/dm/sdr/0/rx/gain/pga",    { dev_synth_rf_set, NULL }},
+    { "/dm/sdr/0/rx/gain/lna",    { dev_synth_rf_set, NULL }},
+    { "/dm/sdr/0/tx/gain",        { dev_synth_rf_set, NULL }},
+    { "/dm/sdr/0/rx/bandwidth",   { dev_synth_rf_set, NULL }},
+    { "/dm/sdr/0/tx/bandwidth",   { dev_synth_rf_set, NULL }},
+    { "/dm/sdr/0/rx/path",        { dev_synth_dummy, NULL }},
+    { "/dm/sdr/0/tx/path",        { dev_synth_dummy, NULL }},
+    { "/dm/sdr/0/calibrate",      { dev_synth_dummy, dev_synth_zero_get }},
+
+    { "/dm/sdr/refclk/path",      { dev_synth_dummy, NULL }},
+    { "/dm/sdr/refclk/frequency", { dev_synth_refclk_frequency_set, dev_synth_refclk_frequency_get }},
+    { "/dm/sync/cal/freq",        { dev_synth_dummy, NULL }},
+
+    { "/dm/sensor/temp",          { NULL, dev_synth_senstemp_get }},
+    { "/dm/debug/all",            { NULL, dev_synth_zero_get }},
+    { "/dm/debug/rxtime",         { NULL, dev_synth_zero_get }},
+};
+
+enum {
+    // 8.8 fixed point, same as the real temperature sensors report
+    SYNTH_TEMP = 25 * 256,
+};
+
+struct dev_synth {
+    device_t base;
+
+    stream_handle_t* rx;
+    stream_handle_t* tx;
+
+    uint64_t refclk;
+};
+
+int dev_synth_rate_set(pdevice_t ud, pusdr_vfs_obj_t obj, uint64_t value)
+{
+    if (value == 0 || value > UINT32_MAX)
+        return -ERANGE;
+
+    return synth_ll_set_rate(ud->dev, (unsigned)value, (unsigned)value);
+}
+
+int dev_synth_rate_m_set(pdevice_t ud, pusdr_vfs_obj_t obj, uint64_t value)
+{
+    uint32_t *rates = (uint32_t *)(uintptr_t)value;
+    uint32_t rx_rate = rates[0];
+    uint32_t tx_rate = rates[1];
+
+    if (rx_rate == 0 && tx_rate == 0)
+        return -EINVAL;
+
+    return synth_ll_set_rate(ud->dev, rx_rate ? rx_rate : tx_rate, tx_rate ? tx_rate : rx_rate);
+}
+
+int dev_synth_rf_set(pdevice_t ud, pusdr_vfs_obj_t obj, uint64_t value)
+{
+    USDR_LOG("SYNT", USDR_LOG_INFO, "%s <= %" PRIu64 "\n", obj->full_path, value);
+    return 0;
+}
+
+int dev_synth_dummy(pdevice_t ud, pusdr_vfs_obj_t obj, uint64_t value)
+{
+    return 0;
+}
+
+int dev_synth_zero_get(pdevice_t ud, pusdr_vfs_obj_t obj, uint64_t* ovalue)
+{
+    *ovalue = 0;
+    return 0;
+}
+
+int dev_synth_senstemp_get(pdevice_t ud, pusdr_vfs_obj_t obj, uint64_t* ovalue)
+{
+    *ovalue = SYNTH_TEMP;
+    return 0;
+}
+
+int dev_synth_refclk_frequency_set(pdevice_t ud, pusdr_vfs_obj_t obj, uint64_t value)
+{
+    struct dev_synth *d = (struct dev_synth *)ud;
+    d->refclk = value;
+    return 0;
+}
+
+int dev_synth_refclk_frequency_get(pdevice_t ud, pusdr_vfs_obj_t obj, uint64_t* ovalue)
+{
+    struct dev_synth *d = (struct dev_synth *)ud;
+    *ovalue = d->refclk;
+    return 0;
+}
+
+static const channel_map_info_t s_synth_chmap[] = {
+    { "a", 0 },
+    { "b", 1 },
+    { NULL, CH_NULL },
+};
+
+static
+void usdr_device_synth_destroy(pdevice_t udev)
+{
+    struct dev_synth *d = (struct dev_synth *)udev;
+
+    if (d->rx) {
+        d->rx->ops->destroy(d->rx);
+    }
+    if (d->tx) {
+        d->tx->ops->destroy(d->tx);
+    }
+
+    usdr_device_base_destroy(udev);
+}
+
+static
+int usdr_device_synth_initialize(pdevice_t udev, unsigned pcount, const char** devparam, const char** devval)
+{
+    return 0;
+}
+
+static
+int usdr_device_synth_create_stream(device_t* dev, const char* sid, const char* dformat,
+                                    const usdr_channel_info_t* channels, unsigned pktsyms,
+                                    unsigned flags, const char* parameters, stream_handle_t** out_handle)
+{
+    struct dev_synth *d = (struct dev_synth *)dev;
+    stream_handle_t** pstr;
+    stream_t llstr;
+    unsigned hwchs;
+    channel_info_t lchans;
+    usdr_dms_nfo_t nfo;
+    int res;
+
+    res = usdr_channel_info_map_default(channels, s_synth_chmap, 2, &lchans);
+    if (res) {
+        return res;
+    }
+
+    // No firmware to check
+    flags |= DMS_DONT_CHECK_FWID;
+
+    if (strstr(sid, "rx") != NULL) {
+        if (d->rx) {
+            return -EBUSY;
+        }
+
+        res = create_sfetrx4_stream(dev, CORE_SFERX_DMA32_R0, dformat, channels->count, &lchans, pktsyms,
+                                    flags, parameters, M2PCI_REG_WR_RXDMA_CONFIRM, VIRT_CFG_SFX_BASE, 0,
+                                    SRF4_FIFOBSZ, CSR_RFE4_BASE, &d->rx, &hwchs);
+        pstr = &d->rx;
+        llstr = SYNTH_STREAM_RX;
+    } else if (strstr(sid, "tx") != NULL) {
+        if (d->tx) {
+            return -EBUSY;
+        }
+
+        res = create_sfetrx4_stream(dev, CORE_SFETX_DMA32_R0, dformat, channels->count, &lchans, pktsyms,
+                                    flags, parameters, M2PCI_REG_WR_TXDMA_CNF_L, M2PCI_REG_WR_SYNC_CTRL, M2PCI_REG_RD_TXDMA_STAT,
+                                    0, 0, &d->tx, &hwchs);
+        pstr = &d->tx;
+        llstr = SYNTH_STREAM_TX;
+    } else {
+        return -EINVAL;
+    }
+    if (res) {
+        return res;
+    }
+
+    // Pace the emulated DMA by the packet size
+    res = (*pstr)->ops->stat(*pstr, &nfo);
+    res = res ? res : synth_ll_set_pktsyms(dev->dev, llstr, nfo.pktsyms);
+    if (res) {
+        (*pstr)->ops->destroy(*pstr);
+        *pstr = NULL;
+        return res;
+    }
+
+    *out_handle = *pstr;
+    return 0;
+}
+
+static
+int usdr_device_synth_unregister_stream(device_t* dev, stream_handle_t* stream)
+{
+    struct dev_synth *d = (struct dev_synth *)dev;
+    if (stream == d->tx) {
+        d->tx->ops->destroy(d->tx);
+        d->tx = NULL;
+    } else if (stream == d->rx) {
+        d->rx->ops->destroy(d->rx);
+        d->rx = NULL;
+    } else {
+        return -EINVAL;
+    }
+    return 0;
+}
+
+static
+int usdr_device_synth_create(lldev_t dev, device_id_t devid)
+{
+    int res;
+    struct dev_synth *d = (struct dev_synth *)malloc(sizeof(struct dev_synth));
+    if (d == NULL)
+        return -ENOMEM;
+
+    res = usdr_device_base_create(&d->base, dev);
+    if (res) {
+        goto failed_free;
+    }
+
+    res = vfs_add_const_i64_vec(&d->base.rootfs,
+                                s_params_synth_rev000,
+                                SIZEOF_ARRAY(s_params_synth_rev000));
+    if (res)
+        goto failed_tree_creation;
+
+    res = usdr_vfs_obj_param_init_array(&d->base,
+                                        s_fparams_synth_rev000,
+                                        SIZEOF_ARRAY(s_fparams_synth_rev000));
+    if (res)
+        goto failed_tree_creation;
+
+    d->base.initialize = &usdr_device_synth_initialize;
+    d->base.destroy = &usdr_device_synth_destroy;
+    d->base.create_stream = &usdr_device_synth_create_stream;
+    d->base.unregister_stream = &usdr_device_synth_unregister_stream;
+    d->base.timer_op = &sfetrx4_stream_sync;
+    d->rx = NULL;
+    d->tx = NULL;
+    d->refclk = 0;
+
+    dev->pdev = &d->base;
+    return 0;
+
+failed_tree_creation:
+    usdr_device_base_destroy(&d->base);
+failed_free:
+    free(d);
+    return res;
+}
+
+static const
+struct device_factory_ops s_ops = {
+    usdr_device_synth_create,
+};
+
+int usdr_device_register_synth()
+{
+    return usdr_device_register(SYNTH_DEVICE_ID_C, &s_ops);
+}
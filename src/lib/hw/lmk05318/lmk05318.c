@@ -205,6 +205,20 @@ int lmk05318_set_out_mux(lmk05318_state_t* d, unsigned port, bool pll1, unsigned
     return lmk05318_reg_wr_n(d, regs, SIZEOF_ARRAY(regs));
 }
 
+int lmk05318_get_live_lock(lmk05318_state_t* d, unsigned* los_msk)
+{
+    uint8_t live;
+    int res = lmk05318_reg_rd(d, INT_LIVE0, &live);
+    if (res)
+        return res;
+
+    *los_msk = ((live & LOS_XO_MSK) ? LMK05318_LOS_XO : 0) |
+               ((live & LOL_PLL1_MSK) ? LMK05318_LOL_PLL1 : 0) |
+               ((live & LOL_PLL2_MSK) ? LMK05318_LOL_PLL2 : 0) |
+               ((live & LOS_FDET_XO_MSK) ? LMK05318_LOS_FDET_XO : 0);
+    return 0;
+}
+
 int lmk05318_check_lock(lmk05318_state_t* d, unsigned* los_msk)
 {
     uint8_t los[3];
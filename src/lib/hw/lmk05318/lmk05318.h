@@ -48,6 +48,9 @@ enum lock_msk {
 
 int lmk05318_check_lock(lmk05318_state_t* d, unsigned* los_msk);
 
+// Live APLL / XO status, no logging so it can be polled
+int lmk05318_get_live_lock(lmk05318_state_t* d, unsigned* los_msk);
+
 int lmk05318_reg_wr(lmk05318_state_t* d, uint16_t reg, uint8_t out);
 int lmk05318_reg_rd(lmk05318_state_t* d, uint16_t reg, uint8_t* val);
 
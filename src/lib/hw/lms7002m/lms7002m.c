@@ -46,12 +46,11 @@ struct pll_cfg {
 
 static int lms7002m_spi_post(lms7002m_state_t* obj, uint32_t* regs, unsigned count)
 {
-    int res;
-    for (unsigned i = 0; i < count; i++) {
-        res = lowlevel_spi_tr32(obj->dev, obj->subdev, obj->lsaddr, regs[i], NULL);
-        if (res)
-            return res;
+    int res = lowlevel_spi_post32(obj->dev, obj->subdev, obj->lsaddr, regs, count);
+    if (res)
+        return res;
 
+    for (unsigned i = 0; i < count; i++) {
         USDR_LOG("7002", USDR_LOG_NOTE, "%d/%d reg wr [mac:%d] %08x\n", i, count,
                  GET_LMS7002M_LML_0X0020_MAC(obj->reg_amac),
                  regs[i]);
@@ -41,12 +41,11 @@ enum {
 
 static int lms8001_spi_post(lms8001_state_t* obj, uint32_t* regs, unsigned count)
 {
-    int res;
-    for (unsigned i = 0; i < count; i++) {
-        res = lowlevel_spi_tr32(obj->dev, obj->subdev, obj->lsaddr, regs[i], NULL);
-        if (res)
-            return res;
+    int res = lowlevel_spi_post32(obj->dev, obj->subdev, obj->lsaddr, regs, count);
+    if (res)
+        return res;
 
+    for (unsigned i = 0; i < count; i++) {
         USDR_LOG("8001", USDR_LOG_NOTE, "[%d/%d] reg wr %08x\n", i, count, regs[i]);
     }
 
@@ -7,8 +7,8 @@
 #include <string.h>
 #include <assert.h>
 
-// Check data sanity before being written
-#define DEBUG_CHECK_RAM
+// Check data sanity in local memory before being written
+//#define DEBUG_CHECK_RAM
 
 enum jedec_cmds {
     ESPI_CMD_QCFR_0 = 0x0B,
@@ -38,9 +38,24 @@ enum espi_core_regs {
 
 #define LOCAL_BLK_LEN 128
 #define LOCAL_MEM_TOP 0
-#define WATCHDOG_LIMIT 300000
 #define RDSR_BUSY_BIT (1)
 
+#define SUBSECTOR_MSK 0x0fff // 4KiB
+#define SECTOR_MSK    0xffff // 64KiB
+
+// WIP polling starts at `interval_us` and doubles up to `max_interval_us`
+struct espi_wip_poll {
+    unsigned interval_us;
+    unsigned max_interval_us;
+    unsigned timeout_us;
+};
+
+// Intervals are derived from typical MT25Q/MX25 timings, timeouts are above max values
+static const struct espi_wip_poll s_wip_page_program = { 20,     200,    5000 };
+static const struct espi_wip_poll s_wip_subsector    = { 1000,   10000,  1000000 };
+static const struct espi_wip_poll s_wip_sector       = { 5000,   20000,  3000000 };
+static const struct espi_wip_poll s_wip_bulk         = { 100000, 500000, 600000000 };
+
 
 static int _espi_flash_wait_done(lldev_t dev, subdev_t subdev, unsigned cfg_base)
 {
@@ -213,37 +228,41 @@ static int _espi_flash_sector_erase(lldev_t dev, subdev_t subdev, unsigned cfg_b
 }
 
 
-static int _espi_flash_wait_ready(lldev_t dev, subdev_t subdev, unsigned cfg_base)
+static int _espi_flash_wait_ready(lldev_t dev, subdev_t subdev, unsigned cfg_base,
+                                  const struct espi_wip_poll* wp)
 {
-	int res;
-	uint8_t status;
-	unsigned limit = 0;
+    int res;
+    uint8_t status;
+    unsigned interval = wp->interval_us;
+    unsigned elapsed = 0;
 
-	do {
+    for (;;) {
         res = _espi_flash_cmd_rdsr(dev, subdev, cfg_base, &status);
-		if (res)
-			return res;
+        if (res)
+            return res;
 
-		if ((status & RDSR_BUSY_BIT) != RDSR_BUSY_BIT)
-			break;
+        if ((status & RDSR_BUSY_BIT) != RDSR_BUSY_BIT)
+            return 0;
 
-		usleep(1);
-		limit++;
-	} while (limit < WATCHDOG_LIMIT);
+        if (elapsed >= wp->timeout_us) {
+            USDR_LOG("FLSH", USDR_LOG_ERROR, "Flash is busy for more than %u us, status %02x\n",
+                     elapsed, status);
+            return -ETIMEDOUT;
+        }
 
-	if (limit == WATCHDOG_LIMIT)
-		return -ETIMEDOUT;
-	return 0;
+        usleep(interval);
+        elapsed += interval;
+        interval = (interval * 2 > wp->max_interval_us) ? wp->max_interval_us : interval * 2;
+    }
 }
 
 
 static int _espi_flash_erase(lldev_t dev, subdev_t subdev, unsigned cfg_base, uint32_t addr, uint32_t size)
 {
-    const unsigned subsector_msk = 0x0fff; // 4KiB
-    const unsigned sector_msk    = 0xffff; // 64KiB
+    const struct espi_wip_poll* wp;
 	int res;
 
-    if (size <= subsector_msk)
+    if (size <= SUBSECTOR_MSK)
 		return -EINVAL;
 
 	do {
@@ -258,7 +277,8 @@ static int _espi_flash_erase(lldev_t dev, subdev_t subdev, unsigned cfg_base, ui
 				return res;
 
 			size = 0;
-        } else if (((addr & sector_msk) == 0) && (size > sector_msk)) {
+            wp = &s_wip_bulk;
+        } else if (((addr & SECTOR_MSK) == 0) && (size > SECTOR_MSK)) {
             res = _espi_flash_cmd_wren(dev, subdev, cfg_base);
 			if (res)
 				return res;
@@ -269,11 +289,10 @@ static int _espi_flash_erase(lldev_t dev, subdev_t subdev, unsigned cfg_base, ui
 			if (res)
 				return res;
 
-            addr += sector_msk + 1;
-            size -= sector_msk + 1;
-
-            usleep(10000);
-        } else if (((addr & subsector_msk) == 0) && (size > subsector_msk)) {
+            addr += SECTOR_MSK + 1;
+            size -= SECTOR_MSK + 1;
+            wp = &s_wip_sector;
+        } else if (((addr & SUBSECTOR_MSK) == 0) && (size > SUBSECTOR_MSK)) {
             res = _espi_flash_cmd_wren(dev, subdev, cfg_base);
 			if (res)
 				return res;
@@ -284,16 +303,15 @@ static int _espi_flash_erase(lldev_t dev, subdev_t subdev, unsigned cfg_base, ui
 			if (res)
 				return res;
 
-            addr += subsector_msk + 1;
-            size -= subsector_msk + 1;
-
-            usleep(1000);
+            addr += SUBSECTOR_MSK + 1;
+            size -= SUBSECTOR_MSK + 1;
+            wp = &s_wip_subsector;
 		} else {
 			// Granularity less than subsector
 			return -EINVAL;
 		}
 
-        res = _espi_flash_wait_ready(dev, subdev, cfg_base);
+        res = _espi_flash_wait_ready(dev, subdev, cfg_base, wp);
 		if (res)
 			return res;
 
@@ -303,78 +321,230 @@ static int _espi_flash_erase(lldev_t dev, subdev_t subdev, unsigned cfg_base, ui
 }
 
 
+static int _espi_flash_upload(lldev_t dev, subdev_t subdev, unsigned cfg_mmap_base,
+                              const uint8_t* in, uint32_t bsz)
+{
+    uint32_t iosz = (((bsz + 3) / 4)) * 4;
+    uint32_t tmp[LOCAL_BLK_LEN / 4];
+    int res;
+
+    // Don't touch bytes past the end of the input buffer
+    if (iosz != bsz) {
+        memset(tmp, 0xff, iosz);
+        memcpy(tmp, in, bsz);
+        in = (const uint8_t*)tmp;
+    }
+
+    res = lowlevel_get_ops(dev)->ls_op(dev, subdev, USDR_LSOP_HWREG, cfg_mmap_base,
+                                       0, NULL, iosz, in);
+    if (res)
+        return res;
+#ifdef DEBUG_CHECK_RAM
+    uint32_t chk[LOCAL_BLK_LEN / 4];
+    res = lowlevel_get_ops(dev)->ls_op(dev, subdev, USDR_LSOP_HWREG, cfg_mmap_base,
+                                       iosz, chk, 0, NULL);
+    if (res)
+        return res;
+
+    res = memcmp(chk, in, iosz);
+    assert (res == 0);
+#endif
+    return 0;
+}
+
+
+// Issue page program from local memory and wait until the core has shifted the
+// data out. Local memory is free afterwards while the flash is still in WIP.
 static int _espi_flash_write(lldev_t dev, subdev_t subdev, unsigned cfg_base, uint8_t cmd, uint8_t sz,
                        uint32_t flash_addr)
 {
-    int res = _espi_flash_cmd_wren(dev, subdev, cfg_base);
-    res = (res) ? res : lowlevel_reg_wr32(dev, subdev, cfg_base + ESPI_FADDR, flash_addr);
-    res = (res) ? res : lowlevel_reg_wr32(dev, subdev, cfg_base + ESPI_CMD,
-                            MAKE_ESPI_CORE_CMD(cmd, sz, (LOCAL_MEM_TOP >> 4), 1, 2, 1));
-	if (res)
-		return res;
-	usleep(1000);
-
+    const uint32_t wren = MAKE_ESPI_CORE_CMD(ESPI_CMD_WREN, 0, 0, 0, 0, 0);
+    const uint32_t prog = MAKE_ESPI_CORE_CMD(cmd, sz, (LOCAL_MEM_TOP >> 4), 1, 2, 1);
+    lowlevel_ls_batch_op_t ops[] = {
+        { USDR_LSOP_HWREG, cfg_base + ESPI_CMD,   0, 4, NULL, &wren },
+        { USDR_LSOP_HWREG, cfg_base + ESPI_FADDR, 0, 4, NULL, &flash_addr },
+        { USDR_LSOP_HWREG, cfg_base + ESPI_CMD,   0, 4, NULL, &prog },
+    };
+
+    int res = lowlevel_ls_batch(dev, subdev, ops, SIZEOF_ARRAY(ops));
     res = (res) ? res : _espi_flash_wait_done(dev, subdev, cfg_base);
-    res = (res) ? res : _espi_flash_wait_ready(dev, subdev, cfg_base);
 	return res;
 }
 
 
-int espi_flash_erase(lldev_t dev, subdev_t subdev, unsigned cfg_base,
-                     uint32_t size, uint32_t flash_off)
+// Uploading of the next block overlaps with page program of the previous one
+static int _espi_flash_program(lldev_t dev, subdev_t subdev, unsigned cfg_base, unsigned cfg_mmap_base,
+                               const uint8_t* in, uint32_t size, uint32_t addr)
 {
-   return _espi_flash_erase(dev, subdev, cfg_base, flash_off, size);
-}
+    uint32_t bsz = (size > LOCAL_BLK_LEN) ? LOCAL_BLK_LEN : size;
+    int res = 0;
 
+    if (size == 0)
+        return 0;
 
-int espi_flash_write(lldev_t dev, subdev_t subdev, unsigned cfg_base, unsigned cfg_mmap_base,
-                     const uint8_t* in, uint32_t size, uint32_t flash_off, unsigned flags)
-{
-    int res;
-    if ((flags & ESPI_FLASH_DONT_ERASE) != ESPI_FLASH_DONT_ERASE) {
-        res = _espi_flash_erase(dev, subdev, cfg_base, flash_off, size);
+    res = _espi_flash_upload(dev, subdev, cfg_mmap_base, in, bsz);
+    if (res)
+        return res;
+
+    while (size > 0) {
+        res = _espi_flash_write(dev, subdev, cfg_base, ESPI_CMD_QCPP_0, bsz, addr);
+        USDR_LOG("FLSH", USDR_LOG_NOTE, "Flash write: addr=%u sizez=%d res=%d\n",
+                 addr, bsz, res);
         if (res)
             return res;
-    }
 
-    if ((flags & ESPI_FLASH_DONT_WRITE_HEADER) == ESPI_FLASH_DONT_WRITE_HEADER) {
-        size -= 256;
-        flash_off += 256;
-        in += 256;
+        in += bsz;
+        size -= bsz;
+        addr += bsz;
+
+        bsz = (size > LOCAL_BLK_LEN) ? LOCAL_BLK_LEN : size;
+        if (bsz > 0) {
+            res = _espi_flash_upload(dev, subdev, cfg_mmap_base, in, bsz);
+            if (res)
+                return res;
+        }
+
+        res = _espi_flash_wait_ready(dev, subdev, cfg_base, &s_wip_page_program);
+        if (res)
+            return res;
     }
 
-    uint32_t addr = flash_off;
+    return 0;
+}
+
+
+// Compare flash contents with the image, stops on the first mismatched block
+static int _espi_flash_compare(lldev_t dev, subdev_t subdev, unsigned cfg_base, unsigned cfg_mmap_base,
+                               const uint8_t* in, uint32_t size, uint32_t addr, bool* equal)
+{
+    uint32_t tmp[LOCAL_BLK_LEN / 4];
+    int res;
+
+    *equal = false;
     while (size > 0) {
         uint32_t bsz = (size > LOCAL_BLK_LEN) ? LOCAL_BLK_LEN : size;
         uint32_t iosz = (((bsz + 3) / 4)) * 4;
 
-        res = lowlevel_get_ops(dev)->ls_op(dev, subdev, USDR_LSOP_HWREG, cfg_mmap_base,
-                                           0, NULL, iosz, in);
+        res = _espi_flash_read_to_local(dev, subdev, cfg_base, ESPI_CMD_QCFR_0, bsz, addr);
+        res = (res) ? res : lowlevel_get_ops(dev)->ls_op(dev, subdev, USDR_LSOP_HWREG, cfg_mmap_base,
+                                                         iosz, tmp, 0, NULL);
         if (res)
             return res;
-#ifdef DEBUG_CHECK_RAM
-        uint32_t tmp[64];
-        res = lowlevel_get_ops(dev)->ls_op(dev, subdev, USDR_LSOP_HWREG, cfg_mmap_base,
-                                           iosz, tmp, 0, NULL);
+
+        if (memcmp(tmp, in, bsz))
+            return 0;
+
+        in += bsz;
+        size -= bsz;
+        addr += bsz;
+    }
+
+    *equal = true;
+    return 0;
+}
+
+
+// Rewrite single erase unit, first `uhdr` bytes are left blank
+static int _espi_flash_update_unit(lldev_t dev, subdev_t subdev, unsigned cfg_base, unsigned cfg_mmap_base,
+                                   const uint8_t* in, uint32_t usz, uint32_t addr, uint32_t uhdr, bool erase)
+{
+    int res;
+    if (erase) {
+        res = _espi_flash_erase(dev, subdev, cfg_base, addr, usz);
         if (res)
             return res;
+    }
 
-        res = memcmp(tmp, in, iosz);
-        assert (res == 0);
-#endif
-
-        res = _espi_flash_write(dev, subdev, cfg_base, ESPI_CMD_QCPP_0, bsz, addr);
-        USDR_LOG("FLSH", USDR_LOG_NOTE, "Flash write: addr=%u sizez=%d res=%d\n",
-                    addr, bsz, res);
-		if (res)
-			return res;
+    return _espi_flash_program(dev, subdev, cfg_base, cfg_mmap_base,
+                               in + uhdr, usz - uhdr, addr + uhdr);
+}
 
-		in += bsz;
-		size -= bsz;
-		addr += bsz;
-	}
 
-	return res;
+int espi_flash_erase(lldev_t dev, subdev_t subdev, unsigned cfg_base,
+                     uint32_t size, uint32_t flash_off)
+{
+   return _espi_flash_erase(dev, subdev, cfg_base, flash_off, size);
 }
 
 
+int espi_flash_write(lldev_t dev, subdev_t subdev, unsigned cfg_base, unsigned cfg_mmap_base,
+                     const uint8_t* in, uint32_t size, uint32_t flash_off, unsigned flags)
+{
+    bool erase = (flags & ESPI_FLASH_DONT_ERASE) != ESPI_FLASH_DONT_ERASE;
+    bool skip = (flags & ESPI_FLASH_SKIP_EQUAL) == ESPI_FLASH_SKIP_EQUAL;
+    uint32_t hdr = ((flags & ESPI_FLASH_DONT_WRITE_HEADER) == ESPI_FLASH_DONT_WRITE_HEADER) ? 256 : 0;
+    unsigned skipped = 0, total = 0;
+    uint32_t hdr_usz = 0;
+    int res;
+
+    if (hdr > size)
+        return -EINVAL;
+
+    if (erase && !skip) {
+        res = _espi_flash_erase(dev, subdev, cfg_base, flash_off, size);
+        if (res)
+            return res;
+
+        return _espi_flash_program(dev, subdev, cfg_base, cfg_mmap_base,
+                                   in + hdr, size - hdr, flash_off + hdr);
+    }
+
+    if (erase && (((flash_off | size) & SUBSECTOR_MSK) != 0))
+        return -EINVAL;
+
+    // Process by erase units, matching units are left as is
+    uint32_t off = 0;
+    while (off < size) {
+        uint32_t addr = flash_off + off;
+        uint32_t usz = SUBSECTOR_MSK + 1 - (addr & SUBSECTOR_MSK);
+        if (((addr & SECTOR_MSK) == 0) && (size - off > SECTOR_MSK))
+            usz = SECTOR_MSK + 1;
+        if (usz > size - off)
+            usz = size - off;
+
+        uint32_t uhdr = (off < hdr) ? hdr - off : 0;
+        if (uhdr > usz)
+            uhdr = usz;
+
+        total++;
+        if (skip) {
+            bool equal;
+            res = _espi_flash_compare(dev, subdev, cfg_base, cfg_mmap_base, in + off, usz, addr, &equal);
+            if (res)
+                return res;
+
+            if (equal) {
+                USDR_LOG("FLSH", USDR_LOG_INFO, "Flash unit %08x/%u is up to date\n", addr, usz);
+                // Header unit is invalidated later if anything else has to be updated
+                if (uhdr && erase)
+                    hdr_usz = usz;
+
+                skipped++;
+                off += usz;
+                continue;
+            }
+        }
+
+        // Image must not look valid while its body is being rewritten
+        if (hdr_usz) {
+            USDR_LOG("FLSH", USDR_LOG_INFO, "Invalidating header at %08x\n", flash_off);
+            res = _espi_flash_update_unit(dev, subdev, cfg_base, cfg_mmap_base,
+                                          in, hdr_usz, flash_off, hdr, erase);
+            if (res)
+                return res;
+
+            skipped--;
+            hdr_usz = 0;
+        }
+
+        res = _espi_flash_update_unit(dev, subdev, cfg_base, cfg_mmap_base,
+                                      in + off, usz, addr, uhdr, erase);
+        if (res)
+            return res;
+
+        off += usz;
+    }
+
+    USDR_LOG("FLSH", USDR_LOG_INFO, "Flash write: %u of %u units were up to date\n", skipped, total);
+    return 0;
+}
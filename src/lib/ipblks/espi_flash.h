@@ -10,6 +10,8 @@
 enum espi_write_flags {
     ESPI_FLASH_DONT_WRITE_HEADER = 1,
     ESPI_FLASH_DONT_ERASE = 2,
+    // Read back every erase unit first and leave it untouched if it already matches
+    ESPI_FLASH_SKIP_EQUAL = 4,
 };
 
 int espi_flash_get_id(lldev_t dev, subdev_t subdev, unsigned cfg_base,
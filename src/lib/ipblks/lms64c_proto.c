@@ -137,14 +137,14 @@ int lms64c_parse_packet(uint8_t cmd, const proto_lms64c_t* in, unsigned in_cnt,
     unsigned mod = _lms64c_get_modifier_rep(cmd);
 
     for (i = 0, off = 0; (i < in_cnt) && (remaining != 0); i++) {
-        unsigned bsz = (remaining > LMS64C_DATA_LENGTH) ? LMS64C_DATA_LENGTH : remaining;
+        unsigned maxdata = (mod == MOD_INT32_16) ? LMS64C_DATA_LENGTH / 2 : LMS64C_DATA_LENGTH;
+        unsigned bsz = (remaining > maxdata) ? maxdata : remaining;
 
         if (mod == MOD_INT32_16) {
-            // TODO: Endianess
-            const uint16_t* d = (const uint16_t*)in[i].data;
+            // Reply is { addr, value } big endian pairs, only values are extracted
             for (unsigned j = 0; j < bsz; j += 2) {
-                data[off + j + 0] = d[j + 1] >> 8;
-                data[off + j + 1] = d[j + 1] & 0xFF;
+                data[off + j + 0] = in[i].data[2 * j + 3];
+                data[off + j + 1] = in[i].data[2 * j + 2];
             }
         } else {
             memcpy(&data[off], in[i].data, bsz);
@@ -0,0 +1,195 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#include "dma_trace.h"
+#include "stream_telemetry.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+
+#include <usdr_logging.h>
+
+enum {
+    DMT_IO_BUFFER = 4 * 1024 * 1024,
+    DMT_MAX_OOB = 64,
+};
+
+struct dma_trace {
+    FILE* f;
+    char* iobuf;
+    bool write;
+    bool failed;
+    uint64_t t0;
+    uint64_t records;
+
+    // Reader
+    long data_start;
+    uint8_t oob[DMT_MAX_OOB];
+    void* data;
+    unsigned data_cap;
+};
+
+static int dma_trace_alloc(const char* path, bool write, dma_trace_t** out)
+{
+    dma_trace_t* t = (dma_trace_t*)calloc(1, sizeof(dma_trace_t));
+    if (t == NULL)
+        return -ENOMEM;
+
+    t->f = fopen(path, write ? "wb" : "rb");
+    if (t->f == NULL) {
+        int err = -errno;
+        USDR_LOG("DTRC", USDR_LOG_ERROR, "Unable to open trace `%s`: %d\n", path, err);
+        free(t);
+        return err;
+    }
+
+    t->iobuf = (char*)malloc(DMT_IO_BUFFER);
+    if (t->iobuf) {
+        setvbuf(t->f, t->iobuf, _IOFBF, DMT_IO_BUFFER);
+    }
+    t->write = write;
+    *out = t;
+    return 0;
+}
+
+int dma_trace_create(const char* path, const dma_trace_hdr_t* hdr, dma_trace_t** out)
+{
+    dma_trace_hdr_t h = *hdr;
+    dma_trace_t* t = NULL;
+    int res;
+
+    res = dma_trace_alloc(path, true, &t);
+    if (res)
+        return res;
+
+    memcpy(h.magic, DMA_TRACE_MAGIC, sizeof(h.magic));
+    h.version = DMA_TRACE_VERSION;
+    h.format[sizeof(h.format) - 1] = 0;
+
+    if (fwrite(&h, sizeof(h), 1, t->f) != 1) {
+        dma_trace_close(t);
+        return -EIO;
+    }
+
+    USDR_LOG("DTRC", USDR_LOG_INFO, "Recording %s DMA trace to `%s`\n",
+             h.dir == DMT_DIR_RX ? "RX" : "TX", path);
+    *out = t;
+    return 0;
+}
+
+void dma_trace_write(dma_trace_t* t, unsigned type, int res,
+                     const void* oob, unsigned oob_size,
+                     const void* data, unsigned data_len)
+{
+    uint64_t now = stream_telemetry_now();
+    dma_trace_rec_t rec;
+
+    if (t->failed)
+        return;
+
+    if (t->records == 0)
+        t->t0 = now;
+
+    if (oob == NULL || oob_size > DMT_MAX_OOB)
+        oob_size = 0;
+    if (data == NULL)
+        data_len = 0;
+
+    rec.type = type;
+    rec.oob_size = oob_size;
+    rec.res = res;
+    rec.data_len = data_len;
+    rec.reserved = 0;
+    rec.t_ns = now - t->t0;
+
+    // Tracing must not break streaming, a full disk just stops the recording
+    if (fwrite(&rec, sizeof(rec), 1, t->f) != 1 ||
+        (oob_size && fwrite(oob, oob_size, 1, t->f) != 1) ||
+        (data_len && fwrite(data, data_len, 1, t->f) != 1)) {
+        USDR_LOG("DTRC", USDR_LOG_ERROR, "Unable to write DMA trace, stopping the recording after %lld records\n",
+                 (long long)t->records);
+        t->failed = true;
+        return;
+    }
+
+    t->records++;
+}
+
+int dma_trace_open(const char* path, dma_trace_hdr_t* hdr, dma_trace_t** out)
+{
+    dma_trace_t* t = NULL;
+    int res;
+
+    res = dma_trace_alloc(path, false, &t);
+    if (res)
+        return res;
+
+    if (fread(hdr, sizeof(*hdr), 1, t->f) != 1 ||
+        memcmp(hdr->magic, DMA_TRACE_MAGIC, sizeof(hdr->magic)) != 0) {
+        USDR_LOG("DTRC", USDR_LOG_ERROR, "`%s` isn't a DMA trace\n", path);
+        dma_trace_close(t);
+        return -EINVAL;
+    }
+    if (hdr->version != DMA_TRACE_VERSION) {
+        USDR_LOG("DTRC", USDR_LOG_ERROR, "`%s`: unsupported DMA trace version %d\n", path, hdr->version);
+        dma_trace_close(t);
+        return -EINVAL;
+    }
+
+    hdr->format[sizeof(hdr->format) - 1] = 0;
+    t->data_start = ftell(t->f);
+    *out = t;
+    return 0;
+}
+
+int dma_trace_read(dma_trace_t* t, dma_trace_rec_t* rec, const void** oob, const void** data)
+{
+    if (fread(rec, sizeof(*rec), 1, t->f) != 1)
+        return feof(t->f) ? -ENODATA : -EIO;
+
+    if (rec->oob_size > DMT_MAX_OOB)
+        return -EINVAL;
+
+    if (rec->oob_size && fread(t->oob, rec->oob_size, 1, t->f) != 1)
+        return -EIO;
+
+    if (rec->data_len > t->data_cap) {
+        void* nd = realloc(t->data, rec->data_len);
+        if (nd == NULL)
+            return -ENOMEM;
+
+        t->data = nd;
+        t->data_cap = rec->data_len;
+    }
+    if (rec->data_len && fread(t->data, rec->data_len, 1, t->f) != 1)
+        return -EIO;
+
+    *oob = t->oob;
+    *data = t->data;
+    t->records++;
+    return 0;
+}
+
+int dma_trace_rewind(dma_trace_t* t)
+{
+    t->records = 0;
+    return fseek(t->f, t->data_start, SEEK_SET) ? -errno : 0;
+}
+
+void dma_trace_close(dma_trace_t* t)
+{
+    if (t == NULL)
+        return;
+
+    if (t->write) {
+        USDR_LOG("DTRC", USDR_LOG_INFO, "DMA trace closed, %lld records\n", (long long)t->records);
+    }
+
+    fclose(t->f);
+    free(t->iobuf);
+    free(t->data);
+    free(t);
+}
@@ -0,0 +1,75 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#ifndef DMA_TRACE_H
+#define DMA_TRACE_H
+
+#include <stdint.h>
+
+// Raw DMA traffic of a stream as seen at the lowlevel boundary, written by
+// the stream on `trace_<file>` and fed back by the synthetic backend.
+//
+// File layout (host endianness): dma_trace_hdr, then records each made of
+// dma_trace_rec, oob_size bytes of OOB and data_len bytes of data.
+//
+//   DMT_RX_BUF     recv_dma_wait(): OOB and the filled buffer, res is the
+//                  return value, a failed wait has no OOB / data
+//   DMT_TX_GET     send_dma_get(): TX core statistics in the OOB
+//   DMT_TX_COMMIT  send_dma_commit(): {timestamp, lgbursts, wire_len} OOB
+//                  and the wire data
+
+#define DMA_TRACE_MAGIC   "USDRDMAT"
+#define DMA_TRACE_VERSION 1
+
+enum dma_trace_rec_type {
+    DMT_RX_BUF = 1,
+    DMT_TX_GET = 2,
+    DMT_TX_COMMIT = 3,
+};
+
+enum dma_trace_dir {
+    DMT_DIR_RX = 0,
+    DMT_DIR_TX = 1,
+};
+
+struct dma_trace_hdr {
+    char magic[8];
+    uint32_t version;
+    uint32_t dir;
+    uint32_t core_id;
+    uint32_t channels;
+    uint32_t pkt_symbs;
+    uint32_t pkt_bytes;
+    uint32_t wire_bps;
+    uint32_t burst_count;
+    char format[32];       // Stream format as requested, truncated
+};
+typedef struct dma_trace_hdr dma_trace_hdr_t;
+
+struct dma_trace_rec {
+    uint16_t type;
+    uint16_t oob_size;
+    int32_t res;
+    uint32_t data_len;
+    uint32_t reserved;
+    uint64_t t_ns;         // Since the first record
+};
+typedef struct dma_trace_rec dma_trace_rec_t;
+
+struct dma_trace;
+typedef struct dma_trace dma_trace_t;
+
+// Writer, records are buffered and flushed on close
+int dma_trace_create(const char* path, const dma_trace_hdr_t* hdr, dma_trace_t** out);
+void dma_trace_write(dma_trace_t* t, unsigned type, int res,
+                     const void* oob, unsigned oob_size,
+                     const void* data, unsigned data_len);
+
+// Reader, *oob / *data stay valid until the next read
+int dma_trace_open(const char* path, dma_trace_hdr_t* hdr, dma_trace_t** out);
+int dma_trace_read(dma_trace_t* t, dma_trace_rec_t* rec, const void** oob, const void** data);
+int dma_trace_rewind(dma_trace_t* t);
+
+void dma_trace_close(dma_trace_t* t);
+
+#endif
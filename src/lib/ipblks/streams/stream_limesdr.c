@@ -51,6 +51,7 @@ struct stream_limesdr {
     unsigned block_samples; // Number samples in one process block (4K)
     unsigned tx_sampl_c;
     int fd;
+    bool dev_mem;
 
     // Stats
     uint64_t blk_time_prev;
@@ -359,6 +360,9 @@ int _limestr_stream_get(stream_handle_t* str, const char* name, int64_t* out_val
     if (strcmp(name, "fd") == 0) {
         *out_val = stream->fd;
         return 0;
+    } else if (strcmp(name, "devmem") == 0) {
+        *out_val = stream->dev_mem;
+        return 0;
     }
     return -EINVAL;
 }
@@ -513,6 +517,7 @@ int create_limesdr_stream(device_t* device,
     sparams.flags = ((need_fd) ? LLSF_NEED_FDPOLL : 0);
     sparams.channels = 0;
     sparams.bits_per_sym = 0;
+    sparams.out_flags = 0;
 
     res = dops->stream_initialize(device->dev, 0, &sparams, &sid);
     if (res)
@@ -551,6 +556,7 @@ int create_limesdr_stream(device_t* device,
     strdev->outst.wire_bidx = 0;
 
     strdev->fd = sparams.underlying_fd;
+    strdev->dev_mem = (sparams.out_flags & LLSOF_DEV_MEM) ? true : false;
 
     *outu = &strdev->base;
     return 0;
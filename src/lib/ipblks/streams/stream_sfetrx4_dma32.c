@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: MIT
 
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
@@ -13,9 +14,13 @@
 #include "sfe_rx_4.h"
 #include "dma_tx_32.h"
 #include "sfe_tx_4.h"
+#include "stream_telemetry.h"
+#include "dma_trace.h"
 
 #include "../../xdsp/conv.h"
+#include "../../xdsp/iqcorr.h"
 #include "../../device/device_vfs.h"
+#include "../../common/parse_params.h"
 
 #include "../xlnx_bitstream.h"
 
@@ -73,7 +78,9 @@ struct stream_sfetrx_dma32 {
     uint32_t burst_mask;
 
     stream_stats_t stats;
+    stream_telemetry_t tm;
     int fd;
+    bool dev_mem;        // Lowlevel transfer buffers are zero-copy
     unsigned burst_count;
     unsigned burst_align_bytes; // Burst align to this byte boundary
 
@@ -86,6 +93,12 @@ struct stream_sfetrx_dma32 {
     } storage;
 
     extxcfg_cache_t cstx4;
+
+    // Host side DC/IQ correction, one state per logical channel (RX only)
+    iqcorr_state_t* iqcorr;
+    unsigned iqcorr_samples;
+
+    dma_trace_t* trace;
 };
 typedef struct stream_sfetrx_dma32 stream_sfetrx_dma32_t;
 
@@ -124,27 +137,68 @@ int _sfetrx4_destroy(stream_handle_t* str)
     res = dops->stream_deinitialize(dev, 0, stream->ll_streamo);
 
     // Cleanup device state
+    dma_trace_close(stream->trace);
+    free(stream->iqcorr);
     free(stream);
     return res;
 }
 
+// Splits the received buffer into its bursts; a DMA buffer lost before this
+// one is a gap in front of the first burst, bursts missing in the frontend
+// mask are flagged as partial
+static unsigned _sfetrx4_fill_bursts(const stream_sfetrx_dma32_t* stream,
+                                     uint32_t mask, unsigned pkt_lost,
+                                     struct usdr_dms_burst_nfo* bursts,
+                                     unsigned max_bursts)
+{
+    unsigned count = (stream->burst_count < max_bursts) ? stream->burst_count : max_bursts;
+    unsigned bsyms;
+
+    if (stream->burst_count == 0)
+        return 0;
+
+    bsyms = stream->pkt_symbs / stream->burst_count;
+
+    for (unsigned i = 0; i < count; i++) {
+        unsigned bit = 32 - stream->burst_count + i;
+        struct usdr_dms_burst_nfo* b = &bursts[i];
+
+        b->time = stream->r_ts + (uint64_t)i * bsyms;
+        b->offset = i * bsyms;
+        b->samples = bsyms;
+        b->lost = (i == 0) ? pkt_lost * stream->pkt_symbs : 0;
+        b->flags = (b->lost) ? USDR_DMS_BURST_GAP : 0;
+        if (stream->burst_mask && !(mask & (1u << bit))) {
+            b->flags |= USDR_DMS_BURST_PARTIAL;
+        }
+    }
+    return count;
+}
+
 static
-int _sfetrx4_stream_recv(stream_handle_t* str,
-                         char** stream_buffs,
-                         unsigned timeout,
-                         struct usdr_dms_recv_nfo* nfo)
+int _sfetrx4_stream_recv_bursts(stream_handle_t* str,
+                                char** stream_buffs,
+                                unsigned timeout,
+                                struct usdr_dms_recv_nfo* nfo,
+                                struct usdr_dms_burst_nfo* bursts,
+                                unsigned max_bursts,
+                                unsigned* nbursts)
 {
     int res;
     struct lowlevel_ops* ops;
     stream_sfetrx_dma32_t* stream = (stream_sfetrx_dma32_t*)str;
     lldev_t dev = stream->base.dev->dev;
 
+    if (nbursts)
+        *nbursts = 0;
     if (stream->type != USDR_ZCPY_RX)
         return -ENOTSUP;
 
     uint64_t oob_data[2];
     unsigned oob_size = sizeof(oob_data);
     char* dma_buf;
+    uint64_t t_start = stream_telemetry_now(), t_dma, t_conv;
+    unsigned pkt_lost = 0;
 
     if (stream->rcnt == 0) {
         // TODO: Issue rx ready, should be put inside
@@ -158,11 +212,23 @@ int _sfetrx4_stream_recv(stream_handle_t* str,
     res = ops->recv_dma_wait(dev, 0,
                              stream->ll_streamo,
                              (void**)&dma_buf, &oob_data, &oob_size, timeout);
-    if (res < 0)
+    t_dma = stream_telemetry_now();
+    if (stream->trace) {
+        dma_trace_write(stream->trace, DMT_RX_BUF, res, (res < 0) ? NULL : oob_data, oob_size,
+                        (res < 0) ? NULL : dma_buf, stream->pkt_bytes);
+    }
+    if (res < 0) {
+        stream_telemetry_begin(&stream->tm);
+        STM_ADD(&stream->tm, calls, 1);
+        STM_ADD(&stream->tm, dma_wait_ns, t_dma - t_start);
+        if (res == -ETIMEDOUT)
+            STM_ADD(&stream->tm, timeouts, 1);
+        stream_telemetry_end(&stream->tm);
         return res;
+    }
 
     if (oob_data[0] & 0xffffff) {
-        unsigned pkt_lost = oob_data[0] & 0xffffff;
+        pkt_lost = oob_data[0] & 0xffffff;
         USDR_LOG("UDMS", USDR_LOG_INFO, "Recv %016" PRIx64 ".%016" PRIx64 " EXTRA:%d buf=%p seq=%16" PRIu64 "\n", oob_data[0], oob_data[1], res, dma_buf,
                  stream->rcnt);
 
@@ -183,6 +249,13 @@ int _sfetrx4_stream_recv(stream_handle_t* str,
 
     // Data transformation
     stream->tf_data((const void**)&dma_buf, stream->pkt_bytes, (void**)stream_buffs, stream->host_bytes);
+    if (stream->iqcorr) {
+        // In place while the converted data is still hot in cache
+        for (unsigned ch = 0; ch < stream->channels; ch++) {
+            iqcorr_process(&stream->iqcorr[ch], stream_buffs[ch], stream_buffs[ch], stream->iqcorr_samples);
+        }
+    }
+    t_conv = stream_telemetry_now();
     stream->rcnt++;
 
     if (nfo) {
@@ -191,18 +264,45 @@ int _sfetrx4_stream_recv(stream_handle_t* str,
         nfo->totlost = stream->stats.fe_drop;
         nfo->extra = (oob_size >= 16) ? oob_data[1] : 0;
     }
+    if (bursts && nbursts) {
+        *nbursts = _sfetrx4_fill_bursts(stream, oob_data[0] >> 32, pkt_lost, bursts, max_bursts);
+    }
 
     stream->r_ts += stream->pkt_symbs;
 
     // Release DMA buffer
     res = ops->recv_dma_release(dev, 0,
                                 stream->ll_streamo, dma_buf);
+
+    stream_telemetry_begin(&stream->tm);
+    STM_ADD(&stream->tm, calls, 1);
+    STM_ADD(&stream->tm, packets, 1);
+    STM_ADD(&stream->tm, wire_bytes, stream->pkt_bytes);
+    STM_ADD(&stream->tm, symbols, stream->pkt_symbs);
+    STM_ADD(&stream->tm, dma_wait_ns, t_dma - t_start);
+    STM_ADD(&stream->tm, conv_ns, t_conv - t_dma);
+    if (pkt_lost) {
+        STM_ADD(&stream->tm, overruns, pkt_lost);
+        STM_SET(&stream->tm, last_overrun_ns, t_dma);
+    }
+    stream_telemetry_hist_add(&stream->tm.d.call_latency, stream_telemetry_now() - t_start);
+    stream_telemetry_end(&stream->tm);
+
     if (res)
         return res;
 
     return 0;
 }
 
+static
+int _sfetrx4_stream_recv(stream_handle_t* str,
+                         char** stream_buffs,
+                         unsigned timeout,
+                         struct usdr_dms_recv_nfo* nfo)
+{
+    return _sfetrx4_stream_recv_bursts(str, stream_buffs, timeout, nfo, NULL, 0, NULL);
+}
+
 static int _extx_burstup(unsigned total_samples, unsigned brst_samples_max, unsigned* plgbrst)
 {
     unsigned lgbursts = 0;
@@ -300,26 +400,25 @@ void parse_txcore_stat(uint32_t stat[4], txcore_statistics_t* s)
 
 
 static
-int _sfetrx4_stream_send(stream_handle_t* str,
-                         const char **stream_buffs,
-                         unsigned samples,
-                         dm_time_t timestamp,
-                         unsigned timeout,
-                         usdr_dms_send_stat_t* ostat)
+int _sfetrx4_stream_send_pkt(stream_sfetrx_dma32_t* stream,
+                             const char **stream_buffs,
+                             unsigned samples,
+                             dm_time_t timestamp,
+                             unsigned timeout,
+                             usdr_dms_send_stat_t* ostat)
 {
     int res;
     struct lowlevel_ops* ops;
     void* buffer;
     uint32_t stat[4];
     unsigned stat_sz = sizeof(stat);
-    stream_sfetrx_dma32_t* stream = (stream_sfetrx_dma32_t*)str;
     lldev_t dev = stream->base.dev->dev;
     unsigned lgbursts = 0;
     unsigned brst_align = stream->burst_align_bytes - 1;
     unsigned brst_samples = stream->pkt_symbs / stream->burst_count;
-
-    if (stream->type != USDR_ZCPY_TX)
-        return -ENOTSUP;
+    uint64_t t_start, t_dma, t_conv;
+    uint64_t fe_drop = stream->stats.fe_drop, dma_drop = stream->stats.dma_drop;
+    unsigned fifo_used = 0;
 
     if (stream->storage.srx4.cfg_fecore_id == CORE_EXFETX_DMA32_R0) {
         res = _extx_burstup(samples, brst_samples, &lgbursts);
@@ -338,7 +437,7 @@ int _sfetrx4_stream_send(stream_handle_t* str,
         do {
             unsigned ns = (samples < brst_samples) ? samples : brst_samples;
 
-            res = _sfetrx4_stream_send(str, nstreams, ns, timestamp, timeout, ostat);
+            res = _sfetrx4_stream_send_pkt(stream, nstreams, ns, timestamp, timeout, ostat);
             if (res)
                 return res;
 
@@ -355,8 +454,17 @@ int _sfetrx4_stream_send(stream_handle_t* str,
     }
 
     ops = lowlevel_get_ops(dev);
+    t_start = stream_telemetry_now();
     res = ops->send_dma_get(dev, 0, stream->ll_streamo, &buffer, stat, &stat_sz, timeout);
+    t_dma = stream_telemetry_now();
+    if (stream->trace) {
+        dma_trace_write(stream->trace, DMT_TX_GET, res, (res < 0) ? NULL : stat, stat_sz, NULL, 0);
+    }
     if (res < 0) {
+        stream_telemetry_begin(&stream->tm);
+        STM_ADD(&stream->tm, dma_wait_ns, t_dma - t_start);
+        stream_telemetry_end(&stream->tm);
+
         if (res == -ETIMEDOUT) {
             txcore_statistics_t st;
             uint32_t stat[4] = { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff };
@@ -401,6 +509,7 @@ int _sfetrx4_stream_send(stream_handle_t* str,
 
         //unsigned burst_lost = (stream->stats.fe_drop - pfe) + (stream->stats.dma_drop - pda);
         stream->stats.pktok ++;
+        fifo_used = st.fifo_used;
 
         USDR_LOG("UDMS", USDR_LOG_DEBUG, "Send stat %d -- %08x.%08x.%08x.%08x -- HOST:%d WIRE:%d\n"
                                         "    Buff (Pstd/Reqd/Cpld/Aired) %2d/%2d/%2d/%2d  DropFE:%"PRId64" DropDMA:%"PRId64" TAGS:%d FIFO:%d\n",
@@ -441,6 +550,28 @@ int _sfetrx4_stream_send(stream_handle_t* str,
         wire_len = wire_bytes * bursts;
         stream->tf_data((const void**)stream_buffs, host_bytes * bursts, &buffer, wire_len);
     }
+    t_conv = stream_telemetry_now();
+
+    stream_telemetry_begin(&stream->tm);
+    STM_ADD(&stream->tm, packets, 1);
+    STM_ADD(&stream->tm, wire_bytes, wire_bytes * bursts);
+    STM_ADD(&stream->tm, symbols, samples * bursts);
+    STM_ADD(&stream->tm, dma_wait_ns, t_dma - t_start);
+    STM_ADD(&stream->tm, conv_ns, t_conv - t_dma);
+    if (stat_sz > 0) {
+        STM_SET(&stream->tm, occupancy, fifo_used);
+        if (fifo_used > stream->tm.d.occupancy_max)
+            STM_SET(&stream->tm, occupancy_max, fifo_used);
+    }
+    if (stream->stats.fe_drop != fe_drop) {
+        STM_ADD(&stream->tm, underruns, stream->stats.fe_drop - fe_drop);
+        STM_SET(&stream->tm, last_underrun_ns, t_dma);
+    }
+    if (stream->stats.dma_drop != dma_drop) {
+        STM_ADD(&stream->tm, late, stream->stats.dma_drop - dma_drop);
+        STM_SET(&stream->tm, last_late_ns, t_dma);
+    }
+    stream_telemetry_end(&stream->tm);
 
     USDR_LOG("UDMS", USDR_LOG_DEBUG, "Send %lld [TS:%lld LG:%d BRST:%d]\n",
              (long long)stream->rcnt, (long long)timestamp, lgbursts, (unsigned)wire_len);
@@ -448,6 +579,10 @@ int _sfetrx4_stream_send(stream_handle_t* str,
     stream->rcnt++;
 
     uint64_t oob[3] = { timestamp, lgbursts, wire_len };
+    if (stream->trace) {
+        dma_trace_write(stream->trace, DMT_TX_COMMIT, 0, oob, sizeof(oob), buffer, wire_len);
+    }
+
     res = ops->send_dma_commit(dev, 0,
                                stream->ll_streamo, buffer, wire_bytes,
                                &oob, sizeof(oob));
@@ -457,6 +592,33 @@ int _sfetrx4_stream_send(stream_handle_t* str,
     return 0;
 }
 
+static
+int _sfetrx4_stream_send(stream_handle_t* str,
+                         const char **stream_buffs,
+                         unsigned samples,
+                         dm_time_t timestamp,
+                         unsigned timeout,
+                         usdr_dms_send_stat_t* ostat)
+{
+    stream_sfetrx_dma32_t* stream = (stream_sfetrx_dma32_t*)str;
+    uint64_t t_start;
+    int res;
+
+    if (stream->type != USDR_ZCPY_TX)
+        return -ENOTSUP;
+
+    t_start = stream_telemetry_now();
+    res = _sfetrx4_stream_send_pkt(stream, stream_buffs, samples, timestamp, timeout, ostat);
+
+    stream_telemetry_begin(&stream->tm);
+    STM_ADD(&stream->tm, calls, 1);
+    if (res == -ETIMEDOUT)
+        STM_ADD(&stream->tm, timeouts, 1);
+    stream_telemetry_hist_add(&stream->tm.d.call_latency, stream_telemetry_now() - t_start);
+    stream_telemetry_end(&stream->tm);
+    return res;
+}
+
 
 static int _sfetrx4_op(stream_handle_t* str,
                        unsigned command,
@@ -510,7 +672,15 @@ int _sfetrx4_option_get(stream_handle_t* str, const char* name, int64_t* out_val
     if (strcmp(name, "fd") == 0) {
         *out_val = stream->fd;
         return 0;
+    } else if (strcmp(name, "devmem") == 0) {
+        *out_val = stream->dev_mem;
+        return 0;
     }
+
+    // Transport specific options
+    lowlevel_ops_t* dops = lowlevel_get_ops(stream->base.dev->dev);
+    if (dops->stream_option_get)
+        return dops->stream_option_get(stream->base.dev->dev, 0, stream->ll_streamo, name, out_val);
     return -EINVAL;
 }
 
@@ -573,9 +743,21 @@ int _sfetrx4_option_set(stream_handle_t* str, const char* name, int64_t in_val)
 
         return exfe_tx4_mute(&stream->storage.srx4, in_val);
     }
+
+    // Transport specific options
+    lowlevel_ops_t* dops = lowlevel_get_ops(stream->base.dev->dev);
+    if (dops->stream_option_set)
+        return dops->stream_option_set(stream->base.dev->dev, 0, stream->ll_streamo, name, in_val);
     return -EINVAL;
 }
 
+static
+int _sfetrx4_telemetry(stream_handle_t* str, usdr_dms_telemetry_t* out)
+{
+    stream_sfetrx_dma32_t* stream = (stream_sfetrx_dma32_t*)str;
+    return stream_telemetry_snapshot(&stream->tm, out);
+}
+
 static
 int _sfetrx4_stat(stream_handle_t* str, usdr_dms_nfo_t* nfo)
 {
@@ -608,6 +790,8 @@ static const struct stream_ops s_sfetr4_dma32_ops = {
     .stat = &_sfetrx4_stat,
     .option_get = &_sfetrx4_option_get,
     .option_set = &_sfetrx4_option_set,
+    .telemetry = &_sfetrx4_telemetry,
+    .recv_bursts = &_sfetrx4_stream_recv_bursts,
 };
 
 
@@ -663,6 +847,163 @@ int parse_sfetrx4(const char* dformat, const channel_info_t *channels, unsigned
     return 0;
 }
 
+// RX stream parameters (':' separated):
+//   iqcorr_<on|dc|iq|off>  host side DC offset / IQ imbalance correction
+//   iqtau_<samples>        estimator time constant
+//   devmem_<on|off>        zero-copy transfer buffers when lowlevel supports them (default on)
+//   usblat_<us>            adaptive USB transfer depth within the latency bound (default fixed depth)
+//   trace_<file>           record DMA buffers and OOB into a trace file, see dma_trace.h
+static int _sfetrx4_parse_rx_params(const char* parameters, const char* host_fmt,
+                                    unsigned* iqc_flags, unsigned* iqc_fmt, unsigned* iqc_tau,
+                                    unsigned* llsf_flags, unsigned* usb_lat,
+                                    char* trace_path, size_t trace_path_sz)
+{
+    enum { P_IQCORR, P_IQTAU, P_DEVMEM, P_USBLAT, P_TRACE };
+    static const char* ppars[] = {
+        "iqcorr_",
+        "iqtau_",
+        "devmem_",
+        "usblat_",
+        "trace_",
+        NULL,
+    };
+    struct param_data pd[SIZEOF_ARRAY(ppars)];
+    memset(pd, 0, sizeof(pd));
+
+    *iqc_flags = 0;
+    *iqc_tau = 0;
+    *llsf_flags = 0;
+    *usb_lat = 0;
+    *trace_path = 0;
+
+    if (parameters == NULL)
+        return 0;
+
+    const char* fault = NULL;
+    parse_params(parameters, ':', ppars, pd, &fault);
+    if (fault) {
+        USDR_LOG("DSTR", USDR_LOG_WARNING, "Ignoring unrecognized stream option: `%s`\n", fault);
+    }
+
+    if (pd[P_IQCORR].item_len) {
+        int on = is_param_on(&pd[P_IQCORR]);
+        if (on >= 0) {
+            *iqc_flags = (on) ? IQCORR_DC | IQCORR_IQ : 0;
+        } else if (pd[P_IQCORR].item_len == 2 && strncmp(pd[P_IQCORR].item, "dc", 2) == 0) {
+            *iqc_flags = IQCORR_DC;
+        } else if (pd[P_IQCORR].item_len == 2 && strncmp(pd[P_IQCORR].item, "iq", 2) == 0) {
+            *iqc_flags = IQCORR_IQ;
+        } else {
+            USDR_LOG("DSTR", USDR_LOG_ERROR, "Unknown iqcorr mode `%.*s`, valid are on, off, dc, iq\n",
+                     (int)pd[P_IQCORR].item_len, pd[P_IQCORR].item);
+            return -EINVAL;
+        }
+    }
+
+    if (pd[P_IQTAU].item_len) {
+        long tau;
+        if (get_param_long(&pd[P_IQTAU], &tau) || tau <= 0) {
+            USDR_LOG("DSTR", USDR_LOG_ERROR, "Incorrect iqtau value `%.*s`\n",
+                     (int)pd[P_IQTAU].item_len, pd[P_IQTAU].item);
+            return -EINVAL;
+        }
+        *iqc_tau = tau;
+    }
+
+    if (pd[P_DEVMEM].item_len) {
+        int on = is_param_on(&pd[P_DEVMEM]);
+        if (on < 0) {
+            USDR_LOG("DSTR", USDR_LOG_ERROR, "Incorrect devmem value `%.*s`, valid are on, off\n",
+                     (int)pd[P_DEVMEM].item_len, pd[P_DEVMEM].item);
+            return -EINVAL;
+        }
+        *llsf_flags = (on) ? 0 : LLSF_HOST_MEM;
+    }
+
+    if (pd[P_USBLAT].item_len) {
+        long lat;
+        if (get_param_long(&pd[P_USBLAT], &lat) || lat < 0 || lat > UINT32_MAX) {
+            USDR_LOG("DSTR", USDR_LOG_ERROR, "Incorrect usblat value `%.*s`\n",
+                     (int)pd[P_USBLAT].item_len, pd[P_USBLAT].item);
+            return -EINVAL;
+        }
+        *usb_lat = lat;
+    }
+
+    if (pd[P_TRACE].item_len) {
+        if (pd[P_TRACE].item_len >= trace_path_sz)
+            return -ENAMETOOLONG;
+
+        memcpy(trace_path, pd[P_TRACE].item, pd[P_TRACE].item_len);
+        trace_path[pd[P_TRACE].item_len] = 0;
+    }
+
+    if (*iqc_flags == 0)
+        return 0;
+
+    if (strcasecmp(host_fmt, "ci16") == 0) {
+        *iqc_fmt = IQCORR_CI16;
+    } else if (strcasecmp(host_fmt, "cf32") == 0) {
+        *iqc_fmt = IQCORR_CF32;
+    } else {
+        USDR_LOG("DSTR", USDR_LOG_ERROR, "Host side IQ correction is only available for ci16 and cf32, requested '%s'\n",
+                 host_fmt);
+        return -EINVAL;
+    }
+    return 0;
+}
+
+// TX stream parameters (':' separated):
+//   trace_<file>           record DMA buffers, OOB and TX statistics into a trace file
+static int _sfetrx4_parse_tx_params(const char* parameters, char* trace_path, size_t trace_path_sz)
+{
+    enum { P_TRACE };
+    static const char* ppars[] = {
+        "trace_",
+        NULL,
+    };
+    struct param_data pd[SIZEOF_ARRAY(ppars)];
+    memset(pd, 0, sizeof(pd));
+
+    *trace_path = 0;
+    if (parameters == NULL)
+        return 0;
+
+    const char* fault = NULL;
+    parse_params(parameters, ':', ppars, pd, &fault);
+    if (fault) {
+        USDR_LOG("DSTR", USDR_LOG_WARNING, "Ignoring unrecognized stream option: `%s`\n", fault);
+    }
+
+    if (pd[P_TRACE].item_len) {
+        if (pd[P_TRACE].item_len >= trace_path_sz)
+            return -ENAMETOOLONG;
+
+        memcpy(trace_path, pd[P_TRACE].item, pd[P_TRACE].item_len);
+        trace_path[pd[P_TRACE].item_len] = 0;
+    }
+    return 0;
+}
+
+static int _sfetrx4_trace_start(stream_sfetrx_dma32_t* strdev, const char* path,
+                                struct parsed_data_format pfmt)
+{
+    dma_trace_hdr_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+
+    hdr.dir = (strdev->type == USDR_ZCPY_RX) ? DMT_DIR_RX : DMT_DIR_TX;
+    hdr.core_id = strdev->storage.srx4.cfg_fecore_id;
+    hdr.channels = strdev->channels;
+    hdr.pkt_symbs = strdev->pkt_symbs;
+    hdr.pkt_bytes = strdev->pkt_bytes;
+    hdr.wire_bps = strdev->wire_bps;
+    hdr.burst_count = strdev->burst_count;
+    snprintf(hdr.format, sizeof(hdr.format), "%s%s%s", pfmt.host_fmt,
+             pfmt.wire_fmt ? "@" : "", pfmt.wire_fmt ? pfmt.wire_fmt : "");
+
+    return dma_trace_create(path, &hdr, &strdev->trace);
+}
+
 static int initialize_stream_rx_32(device_t* device,
                                    unsigned chcount,
                                    channel_info_t *channels,
@@ -671,12 +1012,21 @@ static int initialize_stream_rx_32(device_t* device,
                                    unsigned sx_base,
                                    unsigned sx_cfg_base,
                                    struct parsed_data_format pfmt,
+                                   const char* parameters,
+                                   unsigned ll_streamno,
                                    stream_sfetrx_dma32_t** outu,
                                    bool need_fd,
                                    bool data_lane_bifurcation)
 {
     int res;
     stream_sfetrx_dma32_t* strdev;
+    unsigned iqc_flags = 0, iqc_fmt = IQCORR_CI16, iqc_tau = 0, llsf_flags, usb_lat;
+    char trace_path[256];
+
+    res = _sfetrx4_parse_rx_params(parameters, pfmt.host_fmt, &iqc_flags, &iqc_fmt, &iqc_tau, &llsf_flags, &usb_lat,
+                                   trace_path, sizeof(trace_path));
+    if (res)
+        return res;
 
     res = dma_rx32_reset(device->dev, 0, sx_base);
     if (res)
@@ -697,6 +1047,11 @@ static int initialize_stream_rx_32(device_t* device,
         sc.sfmt++;
     }
 
+    if (iqc_flags && logicchs != chcount) {
+        USDR_LOG("DSTR", USDR_LOG_ERROR, "Host side IQ correction isn't supported for interleaved channels\n");
+        return -EINVAL;
+    }
+
     res = sfe_rx4_check_format(&sc);
     if (res) {
         if (pfmt.wire_fmt != NULL) {
@@ -768,15 +1123,16 @@ static int initialize_stream_rx_32(device_t* device,
     stream_t sid;
     lowlevel_ops_t* dops = lowlevel_get_ops(device->dev);
 
-    sparams.streamno = 0;
+    sparams.streamno = ll_streamno;
     sparams.flags = 0;
     sparams.block_size = fc.bpb * fc.burstspblk;
     sparams.buffer_count = 32;
-    sparams.flags = (need_fd) ? LLSF_NEED_FDPOLL : 0;
+    sparams.flags = ((need_fd) ? LLSF_NEED_FDPOLL : 0) | llsf_flags;
     sparams.channels = 0;
     sparams.bits_per_sym = 0;
 
     sparams.underlying_fd = -1;
+    sparams.out_flags = 0;
     sparams.dma_core_id = fecfg->cfg_fecore_id;
     sparams.param = NULL;
     sparams.soft_tx_commit = NULL;
@@ -785,6 +1141,13 @@ static int initialize_stream_rx_32(device_t* device,
     if (res)
         return res;
 
+    if (usb_lat) {
+        res = (dops->stream_option_set) ? dops->stream_option_set(device->dev, 0, sid, "usblat", usb_lat) : -ENOTSUP;
+        if (res) {
+            USDR_LOG("DSTR", USDR_LOG_WARNING, "Adaptive transfer depth isn't supported by the transport, ignoring usblat\n");
+        }
+    }
+
     strdev = (stream_sfetrx_dma32_t*)malloc(sizeof(stream_sfetrx_dma32_t));
     //usdr_dmo_init(&strdev->obj_stream, &s_dms_ops);
     //strdev->parent = device;
@@ -817,8 +1180,10 @@ static int initialize_stream_rx_32(device_t* device,
     strdev->stats.pktok = 0;
     strdev->stats.fe_drop = 0;
     strdev->stats.dma_drop = 0;
+    stream_telemetry_init(&strdev->tm);
 
     strdev->fd = sparams.underlying_fd;
+    strdev->dev_mem = (sparams.out_flags & LLSOF_DEV_MEM) ? true : false;
 
     strdev->burst_mask = ((((uint64_t)1U) << fc.burstspblk) - 1) << (32 - fc.burstspblk);
     strdev->burst_count = fc.burstspblk;
@@ -828,6 +1193,38 @@ static int initialize_stream_rx_32(device_t* device,
     strdev->fe_complex = bfmt.complex;
     strdev->storage.srx4 = *fecfg;
 
+    strdev->iqcorr = NULL;
+    strdev->iqcorr_samples = 0;
+    strdev->trace = NULL;
+    if (iqc_flags) {
+        unsigned ssz = (iqc_fmt == IQCORR_CI16) ? 2 * sizeof(int16_t) : 2 * sizeof(float);
+
+        strdev->iqcorr = (iqcorr_state_t*)malloc(sizeof(iqcorr_state_t) * logicchs);
+        if (strdev->iqcorr == NULL) {
+            dops->stream_deinitialize(device->dev, 0, sid);
+            free(strdev);
+            return -ENOMEM;
+        }
+
+        strdev->iqcorr_samples = strdev->host_bytes / logicchs / ssz;
+        for (unsigned ch = 0; ch < logicchs; ch++) {
+            iqcorr_init(&strdev->iqcorr[ch], iqc_fmt, iqc_flags, iqc_tau);
+        }
+
+        USDR_LOG("DSTR", USDR_LOG_INFO, "RX: Host side correction%s%s enabled for %d channels\n",
+                 (iqc_flags & IQCORR_DC) ? " DC" : "", (iqc_flags & IQCORR_IQ) ? " IQ" : "", logicchs);
+    }
+
+    if (*trace_path) {
+        res = _sfetrx4_trace_start(strdev, trace_path, pfmt);
+        if (res) {
+            dops->stream_deinitialize(device->dev, 0, sid);
+            free(strdev->iqcorr);
+            free(strdev);
+            return res;
+        }
+    }
+
     USDR_LOG("DSTR", USDR_LOG_INFO, "RX: Samples=%d Bps=%d WireBytes=%d HostBytes=%d Bursts=%d\n",
              strdev->pkt_symbs, strdev->wire_bps, strdev->pkt_bytes, strdev->host_bytes, strdev->burst_count);
 
@@ -874,6 +1271,8 @@ static int initialize_stream_tx_32(device_t* device,
                                    unsigned sx_sync,
                                    unsigned sx_base_rb,
                                    struct parsed_data_format pfmt,
+                                   const char* parameters,
+                                   unsigned ll_streamno,
                                    stream_sfetrx_dma32_t** outu,
                                    bool need_fd,
                                    bool data_lane_bifurcation,
@@ -881,10 +1280,15 @@ static int initialize_stream_tx_32(device_t* device,
 {
     int res;
     stream_sfetrx_dma32_t* strdev;
+    char trace_path[256];
 
     struct stream_config sc;
     unsigned logicchs = chcount;
 
+    res = _sfetrx4_parse_tx_params(parameters, trace_path, sizeof(trace_path));
+    if (res)
+        return res;
+
     sc.burstspblk = 0;
     sc.chcnt = chcount;
     sc.channels = *channels;
@@ -1013,7 +1417,11 @@ static int initialize_stream_tx_32(device_t* device,
     if (!strdev)
         return -ENOMEM;
 
-    sparams.streamno = 1;
+    strdev->iqcorr = NULL;
+    strdev->iqcorr_samples = 0;
+    strdev->trace = NULL;
+
+    sparams.streamno = ll_streamno;
     sparams.flags = 1;
     sparams.block_size = pktsyms * hardware_channels * bits_per_single_sym / 8;
     sparams.buffer_count = 32;
@@ -1024,6 +1432,7 @@ static int initialize_stream_tx_32(device_t* device,
     sparams.dma_core_id = fecfg->cfg_fecore_id;
     sparams.param = strdev;
     sparams.soft_tx_commit = (fecfg->cfg_fecore_id == CORE_SFETX_DMA32_R0) ? &stream_soft_tx_commit : &stream_soft_extx_commit;
+    sparams.out_flags = 0;
 
     sparams.out_max_bursts = 1;
     if (sparams.block_size > max_mtu) {
@@ -1096,8 +1505,10 @@ static int initialize_stream_tx_32(device_t* device,
     strdev->stats.pktok = 0;
     strdev->stats.fe_drop = 0;
     strdev->stats.dma_drop = 0;
+    stream_telemetry_init(&strdev->tm);
 
     strdev->fd = sparams.underlying_fd;
+    strdev->dev_mem = (sparams.out_flags & LLSOF_DEV_MEM) ? true : false;
 
     strdev->burst_mask = 0;
     strdev->burst_count = sparams.out_max_bursts;
@@ -1110,6 +1521,14 @@ static int initialize_stream_tx_32(device_t* device,
     strdev->storage.srx4 = *fecfg;
     extxcfg_cache_init(&strdev->cstx4);
 
+    if (*trace_path) {
+        res = _sfetrx4_trace_start(strdev, trace_path, pfmt);
+        if (res) {
+            dops->stream_deinitialize(device->dev, 0, sid);
+            goto fail_dealloc;
+        }
+    }
+
     USDR_LOG("DSTR", USDR_LOG_INFO, "TX: Samples=%d Bps=%d WireBytes=%d HostBytes=%d Bursts=%d\n",
              strdev->pkt_symbs, strdev->wire_bps, strdev->pkt_bytes, strdev->host_bytes, strdev->burst_count);
     *outu = strdev;
@@ -1128,6 +1547,7 @@ int create_sfetrx4_stream(device_t* device,
                           channel_info_t *channels,
                           unsigned pktsyms,
                           unsigned flags,
+                          const char* parameters,
                           unsigned sx_base,
                           unsigned sx_cfg_base,
                           unsigned sx_base_rb,
@@ -1135,6 +1555,28 @@ int create_sfetrx4_stream(device_t* device,
                           unsigned fe_base,
                           stream_handle_t** outu,
                           unsigned *hw_chans_cnt)
+{
+    return create_sfetrx4_stream_ex(device, core_id, dformat, chcount, channels, pktsyms, flags,
+                                    parameters, 0, sx_base, sx_cfg_base, sx_base_rb, fe_fifobsz,
+                                    fe_base, outu, hw_chans_cnt);
+}
+
+int create_sfetrx4_stream_ex(device_t* device,
+                             unsigned core_id,
+                             const char* dformat,
+                             unsigned chcount,
+                             channel_info_t *channels,
+                             unsigned pktsyms,
+                             unsigned flags,
+                             const char* parameters,
+                             unsigned dma_pair,
+                             unsigned sx_base,
+                             unsigned sx_cfg_base,
+                             unsigned sx_base_rb,
+                             unsigned fe_fifobsz,
+                             unsigned fe_base,
+                             stream_handle_t** outu,
+                             unsigned *hw_chans_cnt)
 {
     bool need_fd = (flags & DMS_FLAG_NEED_FD) == DMS_FLAG_NEED_FD;
     bool bifurcation = (flags & DMS_FLAG_BIFURCATION) == DMS_FLAG_BIFURCATION;
@@ -1164,7 +1606,8 @@ int create_sfetrx4_stream(device_t* device,
         fecfg.cfg_dma_align_bytes = fecfg.cfg_word_bytes;
 
         res = initialize_stream_rx_32(device, chcount, channels, pktsyms,
-                                      &fecfg, sx_base, sx_cfg_base, pfmt,
+                                      &fecfg, sx_base, sx_cfg_base, pfmt, parameters,
+                                      2 * dma_pair,
                                       (stream_sfetrx_dma32_t** )outu,
                                       need_fd, bifurcation);
         break;
@@ -1176,7 +1619,8 @@ int create_sfetrx4_stream(device_t* device,
         fecfg.cfg_dma_align_bytes = fecfg.cfg_word_bytes;
 
         res = initialize_stream_tx_32(device, chcount, channels, pktsyms,
-                                       &fecfg, sx_base, sx_cfg_base, sx_base_rb, pfmt,
+                                       &fecfg, sx_base, sx_cfg_base, sx_base_rb, pfmt, parameters,
+                                       2 * dma_pair + 1,
                                        (stream_sfetrx_dma32_t** )outu,
                                        need_fd, bifurcation, dontcheck);
         break;
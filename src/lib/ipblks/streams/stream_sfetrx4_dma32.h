@@ -45,6 +45,7 @@ int create_sfetrx4_stream(device_t* device,
                           channel_info_t *channels,
                           unsigned pktsyms,
                           unsigned flags,
+                          const char* parameters,
                           unsigned sx_base,
                           unsigned sx_cfg_base,
                           unsigned int sx_base_rb,
@@ -53,6 +54,25 @@ int create_sfetrx4_stream(device_t* device,
                           stream_handle_t** outu,
                           unsigned *hw_chans_cnt);
 
+// Same as above for the dma_pair-th RX/TX DMA engine pair, the lowlevel
+// stream number is 2 * dma_pair for RX and 2 * dma_pair + 1 for TX
+int create_sfetrx4_stream_ex(device_t* device,
+                             unsigned core_id,
+                             const char* dformat,
+                             unsigned int chcount,
+                             channel_info_t *channels,
+                             unsigned pktsyms,
+                             unsigned flags,
+                             const char* parameters,
+                             unsigned dma_pair,
+                             unsigned sx_base,
+                             unsigned sx_cfg_base,
+                             unsigned int sx_base_rb,
+                             unsigned fe_fifobsz,
+                             unsigned fe_base,
+                             stream_handle_t** outu,
+                             unsigned *hw_chans_cnt);
+
 // Syncronize streams
 int sfetrx4_stream_sync(device_t* device,
                         stream_handle_t** pstream, unsigned scount,
@@ -0,0 +1,99 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#include "stream_telemetry.h"
+
+#include <string.h>
+#include <sched.h>
+
+enum {
+    HIST_UNIT_SHIFT = 6,    // 64ns
+    HIST_SUB_BITS = 2,      // 4 buckets per octave
+    HIST_SUB = 1 << HIST_SUB_BITS,
+};
+
+void stream_telemetry_init(stream_telemetry_t* t)
+{
+    memset(t, 0, sizeof(*t));
+}
+
+unsigned stream_telemetry_bucket(uint64_t ns)
+{
+    uint64_t u = ns >> HIST_UNIT_SHIFT;
+    unsigned e, idx;
+
+    if (u < HIST_SUB)
+        return u;
+
+    e = 63 - __builtin_clzll(u);
+    idx = (e - HIST_SUB_BITS + 1) * HIST_SUB + ((u >> (e - HIST_SUB_BITS)) & (HIST_SUB - 1));
+    return (idx < USDR_DMS_HIST_BUCKETS) ? idx : USDR_DMS_HIST_BUCKETS - 1;
+}
+
+uint64_t stream_telemetry_bucket_top(unsigned idx)
+{
+    unsigned e, sub;
+
+    if (idx < HIST_SUB)
+        return (uint64_t)(idx + 1) << HIST_UNIT_SHIFT;
+    if (idx >= USDR_DMS_HIST_BUCKETS - 1)
+        return UINT64_MAX;
+
+    e = idx / HIST_SUB + HIST_SUB_BITS - 1;
+    sub = idx % HIST_SUB;
+    return (uint64_t)(HIST_SUB + sub + 1) << (e - HIST_SUB_BITS + HIST_UNIT_SHIFT);
+}
+
+int stream_telemetry_snapshot(const stream_telemetry_t* t, usdr_dms_telemetry_t* out)
+{
+    const uint64_t* src = (const uint64_t*)&t->d;
+    uint64_t* dst = (uint64_t*)out;
+    unsigned words = sizeof(*out) / sizeof(uint64_t);
+    uint32_t s1, s2;
+
+    for (unsigned retry = 0;; retry++) {
+        s1 = __atomic_load_n(&t->seq, __ATOMIC_ACQUIRE);
+        if (s1 & 1) {
+            if (retry > 16)
+                sched_yield();
+            continue;
+        }
+
+        for (unsigned i = 0; i < words; i++) {
+            dst[i] = __atomic_load_n(&src[i], __ATOMIC_RELAXED);
+        }
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        s2 = __atomic_load_n(&t->seq, __ATOMIC_RELAXED);
+        if (s1 == s2)
+            break;
+        if (retry > 16)
+            sched_yield();
+    }
+
+    out->snap_ns = stream_telemetry_now();
+    return 0;
+}
+
+uint64_t stream_telemetry_percentile(const struct usdr_dms_histogram* h, double pct)
+{
+    uint64_t target, acc = 0;
+
+    if (h->count == 0)
+        return 0;
+
+    target = (uint64_t)(h->count * pct / 100.0 + 0.5);
+    if (target == 0)
+        target = 1;
+    if (target > h->count)
+        target = h->count;
+
+    for (unsigned i = 0; i < USDR_DMS_HIST_BUCKETS; i++) {
+        acc += h->buckets[i];
+        if (acc >= target) {
+            uint64_t top = stream_telemetry_bucket_top(i);
+            return (top < h->max_ns) ? top : h->max_ns;
+        }
+    }
+    return h->max_ns;
+}
@@ -0,0 +1,61 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#ifndef STREAM_TELEMETRY_H
+#define STREAM_TELEMETRY_H
+
+#include <stdint.h>
+#include <usdr_time.h>
+
+#include "../../models/dm_stream.h"
+
+// Stream counters with a single writer (the thread doing recv / send) and any
+// number of readers. The writer updates fields in place between
+// stream_telemetry_begin() / stream_telemetry_end(), readers retry the copy
+// when the sequence has changed underneath, so the stream never blocks.
+struct stream_telemetry {
+    uint32_t seq;
+    usdr_dms_telemetry_t d;
+};
+typedef struct stream_telemetry stream_telemetry_t;
+
+void stream_telemetry_init(stream_telemetry_t* t);
+
+int stream_telemetry_snapshot(const stream_telemetry_t* t, usdr_dms_telemetry_t* out);
+
+unsigned stream_telemetry_bucket(uint64_t ns);
+uint64_t stream_telemetry_bucket_top(unsigned idx);
+uint64_t stream_telemetry_percentile(const struct usdr_dms_histogram* h, double pct);
+
+// Cycle counter based, a couple of these are taken on every recv / send
+static inline uint64_t stream_telemetry_now(void)
+{
+    return usdr_time_fast_ns();
+}
+
+static inline void stream_telemetry_begin(stream_telemetry_t* t)
+{
+    __atomic_store_n(&t->seq, t->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void stream_telemetry_end(stream_telemetry_t* t)
+{
+    __atomic_store_n(&t->seq, t->seq + 1, __ATOMIC_RELEASE);
+}
+
+// Only valid inside begin / end
+#define STM_SET(t, field, v)  __atomic_store_n(&(t)->d.field, (v), __ATOMIC_RELAXED)
+#define STM_ADD(t, field, v)  STM_SET(t, field, (t)->d.field + (v))
+
+static inline void stream_telemetry_hist_add(struct usdr_dms_histogram* h, uint64_t ns)
+{
+    unsigned idx = stream_telemetry_bucket(ns);
+    __atomic_store_n(&h->count, h->count + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&h->sum_ns, h->sum_ns + ns, __ATOMIC_RELAXED);
+    __atomic_store_n(&h->buckets[idx], h->buckets[idx] + 1, __ATOMIC_RELAXED);
+    if (ns > h->max_ns)
+        __atomic_store_n(&h->max_ns, ns, __ATOMIC_RELAXED);
+}
+
+#endif
@@ -33,6 +33,18 @@ struct stream_ops {
     // Custom stream options
     int (*option_get)(stream_handle_t*, const char* name, int64_t* out_val);
     int (*option_set)(stream_handle_t*, const char* name, int64_t in_val);
+
+    // Optional, NULL if the stream doesn't keep telemetry
+    int (*telemetry)(stream_handle_t*, usdr_dms_telemetry_t* out);
+
+    // Optional, recv() with per burst metadata
+    int (*recv_bursts)(stream_handle_t* stream,
+                       char **stream_buffs,
+                       unsigned timeout_ms,
+                       struct usdr_dms_recv_nfo* nfo,
+                       struct usdr_dms_burst_nfo* bursts,
+                       unsigned max_bursts,
+                       unsigned* nbursts);
 };
 typedef struct stream_ops stream_ops_t;
 
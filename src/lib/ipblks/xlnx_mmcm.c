@@ -36,34 +36,17 @@ enum {
     DIG_DLY_MAX = 63,
 };
 
-int mmcm_init_raw_clkout(lldev_t dev, subdev_t subdev,
-                         unsigned drp_port, uint8_t clkout_reg,
-                         const struct mmcm_port_config_raw *pcfg)
-{
-    int res;
-    uint16_t clk1_reg_old, clk2_reg_old;
-    uint16_t clk1_reg_out, clk2_reg_out;
+// Register list for a complete MMCM programming
+enum {
+    MMCM_RMW_MAX = 2 * MAX_MMCM_PORTS + 1 + 3 + 2,
+};
 
+static int mmcm_fill_clkout(lowlevel_drp_rmw_t* regs, uint8_t clkout_reg,
+                            const struct mmcm_port_config_raw *pcfg)
+{
     if (pcfg->period_h > DIG_DIV_MAX || pcfg->period_l > DIG_DIV_MAX || pcfg->delay > DIG_DLY_MAX)
         return -EINVAL;
 
-    res = lowlevel_drp_rd16(dev, subdev, drp_port, clkout_reg, &clk1_reg_old);
-    if (res)
-        return res;
-
-    clk1_reg_out = ((pcfg->phase & 7) << 13) |
-            (clk1_reg_old & (1 << 12)) |
-            ((pcfg->period_h & 0x3f) << 6) |
-            (pcfg->period_l & 0x3f);
-
-    res = lowlevel_drp_wr16(dev, subdev, drp_port, clkout_reg, clk1_reg_out);
-    if (res)
-        return res;
-
-    res = lowlevel_drp_rd16(dev, subdev, drp_port, clkout_reg + 1, &clk2_reg_old);
-    if (res)
-        return res;
-
     // Chooses the edge that the High Time counter transitions on
     //
     // As an example, if a 50/50 duty cycle is desired with a divide value of 3, the Edge bit would be
@@ -71,141 +54,99 @@ int mmcm_init_raw_clkout(lldev_t dev, subdev_t subdev,
     // With the edge bit set, the net count for the High and Low times would be 1.5 clock cycles each.
     unsigned ht_edge = (pcfg->period_l - pcfg->period_h) == 1 ? 1 : 0;
 
-    clk2_reg_out = (clk2_reg_old & 0xfc00) | (ht_edge << 7)  | (pcfg->delay & 0x3f);
+    regs[0].regaddr = clkout_reg;
+    regs[0].mask = 0xefff;
+    regs[0].value = ((pcfg->phase & 7) << 13) |
+            ((pcfg->period_h & 0x3f) << 6) |
+            (pcfg->period_l & 0x3f);
 
-    res = lowlevel_drp_wr16(dev, subdev, drp_port, clkout_reg + 1, clk2_reg_out);
-    if (res)
-        return res;
+    regs[1].regaddr = clkout_reg + 1;
+    regs[1].mask = 0x03ff;
+    regs[1].value = (ht_edge << 7)  | (pcfg->delay & 0x3f);
+    return 2;
+}
+
+static void mmcm_log_clkout(const lowlevel_drp_rmw_t* regs)
+{
+    uint16_t clk1_reg_old = regs[0].rb;
+    uint16_t clk2_reg_old = regs[1].rb;
 
     USDR_LOG("MMCM", USDR_LOG_ERROR, " CLKREG %02x OLD: PHASE=%d HIGH=%d LOW=%d | MX=%d EDGE=%d NO_CNT=%d DELAY=%d\n",
-               clkout_reg,
+               regs[0].regaddr,
                (clk1_reg_old >> 13) & 0x7, (clk1_reg_old >> 6) & 0x3f, clk1_reg_old & 0x3f,
                (clk2_reg_old >> 8) & 0x3, (clk2_reg_old >> 7) & 1, (clk2_reg_old >> 6) & 1,
                (clk2_reg_old & 0x3f));
-    return 0;
 }
 
-
-int mmcm_init_raw_div(lldev_t dev, subdev_t subdev,
-                      unsigned drp_port, int div)
+static int mmcm_fill_div(lowlevel_drp_rmw_t* regs, int div)
 {
-    int res;
-    uint16_t tmp, out;
-
-    res = lowlevel_drp_rd16(dev, subdev, drp_port, DIVCLK_DivReg, &tmp);
-    if (res)
-        return res;
-
-    out = (tmp & 0xC000) |
-            ((div % 2) << 13) |
+    regs[0].regaddr = DIVCLK_DivReg;
+    regs[0].mask = 0x3fff;
+    regs[0].value = ((div % 2) << 13) |
             ((div <= 1) ? (1 << 12) : 0) |
             (((div / 2) & 0x3f) << 6) |
             (((div + 1) / 2) & 0x3f);
-
-    res = lowlevel_drp_wr16(dev, subdev, drp_port, DIVCLK_DivReg, out);
-    if (res)
-        return res;
-    return 0;
+    return 1;
 }
 
 // Lock1,2,3
-int mmcm_init_raw_lock(lldev_t dev, subdev_t subdev, unsigned drpport, int div)
+static int mmcm_fill_lock(lowlevel_drp_rmw_t* regs, int div)
 {
-    uint16_t tmp, out;
-    int res = 0;
-
-    // Lock1
-    res = res ? res : lowlevel_drp_rd16(dev, subdev, drpport, LockReg1, &tmp);
-    out = (tmp & 0xfc00) | ((mmcm_rom[div] >> 20) & 0x3ff);
-    res = res ? res : lowlevel_drp_wr16(dev, subdev, drpport, LockReg1, out);
-
-    // Lock2
-    res = res ? res : lowlevel_drp_rd16(dev, subdev, drpport, LockReg2, &tmp);
-    out = (tmp & 0x8000) | (((mmcm_rom[div] >> 30) & 0x1f) << 10) | (mmcm_rom[div] & 0x3ff);
-    res = res ? res : lowlevel_drp_wr16(dev, subdev, drpport, LockReg2, out);
-
-    // Lock3
-    res = res ? res : lowlevel_drp_rd16(dev, subdev, drpport, LockReg3, &tmp);
-    out = (tmp & 0x8000) | (((mmcm_rom[div] >> 35) & 0x1f) << 10) | ((mmcm_rom[div] >> 10) & 0x3ff);
-    res = res ? res : lowlevel_drp_wr16(dev, subdev, drpport, LockReg3, out);
-
-    return res;
+    regs[0].regaddr = LockReg1;
+    regs[0].mask = 0x03ff;
+    regs[0].value = ((mmcm_rom[div] >> 20) & 0x3ff);
+
+    regs[1].regaddr = LockReg2;
+    regs[1].mask = 0x7fff;
+    regs[1].value = (((mmcm_rom[div] >> 30) & 0x1f) << 10) | (mmcm_rom[div] & 0x3ff);
+
+    regs[2].regaddr = LockReg3;
+    regs[2].mask = 0x7fff;
+    regs[2].value = (((mmcm_rom[div] >> 35) & 0x1f) << 10) | ((mmcm_rom[div] >> 10) & 0x3ff);
+    return 3;
 }
 
 // Filt1,2
-int mmcm_init_raw_filt(lldev_t dev, subdev_t subdev, unsigned drpport, int div, int h)
+static int mmcm_fill_filt(lowlevel_drp_rmw_t* regs, int div, int h)
 {
-    uint16_t tmp, out;
-    int res;
-
     unsigned tblval = (h) ? (mmcm_rom[div] >> 50) : ((mmcm_rom[div] >> 40) & 0x3ff);
-    // Lock1
-    res = lowlevel_drp_rd16(dev, subdev, drpport, FiltReg1, &tmp);
-    if (res)
-        return res;
 
-    out = (((tblval >> 9) & 0x1) << 15) |
-            (tmp & 0x6000) |
+    regs[0].regaddr = FiltReg1;
+    regs[0].mask = 0x9900;
+    regs[0].value = (((tblval >> 9) & 0x1) << 15) |
             (((tblval >> 7) & 0x3) << 11) |
-            (tmp & 0x0600) |
-            (((tblval >> 6) & 0x1) << 8) |
-            (tmp & 0x00ff);
-
-    res = lowlevel_drp_wr16(dev, subdev, drpport, FiltReg1, out);
-    if (res)
-        return res;
+            (((tblval >> 6) & 0x1) << 8);
 
-    // Lock2
-    res = lowlevel_drp_rd16(dev, subdev, drpport, FiltReg2, &tmp);
-    if (res)
-        return res;
-
-    out = (((tblval >> 5) & 0x1) << 15) |
-            (tmp & 0x6000) |
+    regs[1].regaddr = FiltReg2;
+    regs[1].mask = 0x9990;
+    regs[1].value = (((tblval >> 5) & 0x1) << 15) |
             (((tblval >> 3) & 0x3) << 11) |
-            (tmp & 0x0600) |
             (((tblval >> 1) & 0x3) << 7) |
-            (tmp & 0x0060) |
-            ((tblval & 0x1) << 4) |
-            (tmp & 0x000f);
-
-    res = lowlevel_drp_wr16(dev, subdev, drpport, FiltReg2, out);
-    if (res)
-        return res;
-
-    return 0;
+            ((tblval & 0x1) << 4);
+    return 2;
 }
 
 int mmcm_set_phdigdelay_raw(lldev_t dev, subdev_t subdev,
                             unsigned drp_port, unsigned port, unsigned phdelay)
 {
-    uint16_t reg_old, reg_out, clkout_reg = CLKOUT5_ClkReg1 + 2 * port;
-    int res = 0;
-
-    // VCO phase
-    res = res ? res : lowlevel_drp_rd16(dev, subdev, drp_port, clkout_reg + 0, &reg_old);
-    reg_out = ((phdelay & 7) << 13) | (reg_old & 0x1fff);
-    res = res ? res : lowlevel_drp_wr16(dev, subdev, drp_port, clkout_reg + 0, reg_out);
-
-    // Digital counter delay
-    res = res ? res : lowlevel_drp_rd16(dev, subdev, drp_port, clkout_reg + 1, &reg_old);
-    reg_out = (reg_old & 0xffc0) | ((phdelay >> 3) & 0x3f);
-    res = res ? res : lowlevel_drp_wr16(dev, subdev, drp_port, clkout_reg + 1, reg_out);
-
-    return res;
+    uint16_t clkout_reg = CLKOUT5_ClkReg1 + 2 * port;
+    lowlevel_drp_rmw_t regs[2] = {
+        // VCO phase
+        { clkout_reg + 0, 0xe000, (phdelay & 7) << 13, 0 },
+        // Digital counter delay
+        { clkout_reg + 1, 0x003f, (phdelay >> 3) & 0x3f, 0 },
+    };
+
+    return lowlevel_drp_rmw16(dev, subdev, drp_port, regs, SIZEOF_ARRAY(regs));
 }
 
 
 int mmcm_set_digdelay_raw(lldev_t dev, subdev_t subdev,
                           unsigned drp_port, unsigned port, unsigned delay)
 {
-    uint16_t reg_old, reg_out, clkout_reg = CLKOUT5_ClkReg1 + 2 * port + 1;
-    int res = 0;
+    lowlevel_drp_rmw_t reg = { CLKOUT5_ClkReg1 + 2 * port + 1, 0x003f, delay & 0x3f, 0 };
 
-    res = res ? res : lowlevel_drp_rd16(dev, subdev, drp_port, clkout_reg, &reg_old);
-    reg_out = (reg_old & 0xffc0) | (delay & 0x3f);
-    res = res ? res : lowlevel_drp_wr16(dev, subdev, drp_port, clkout_reg, reg_out);
-    return res;
+    return lowlevel_drp_rmw16(dev, subdev, drp_port, &reg, 1);
 }
 
 int mmcm_init_raw(lldev_t dev, subdev_t subdev,
@@ -214,36 +155,38 @@ int mmcm_init_raw(lldev_t dev, subdev_t subdev,
 {
     int res;
     unsigned clkfbdiv = cfg->ports[CLKOUT_PORT_FB].period_h + cfg->ports[CLKOUT_PORT_FB].period_l;
-
-    res = lowlevel_drp_wr16(dev, subdev, drp_port, PowerRegV7, 0xffff);
-    if (res) {
-        USDR_LOG("MMCM", USDR_LOG_ERROR, " unable to turn it on\n");
-        return res;
-    }
+    lowlevel_drp_rmw_t regs[MMCM_RMW_MAX];
+    unsigned cnt = 0;
 
     for (unsigned i = 0; i < MAX_MMCM_PORTS; i++) {
-        res = mmcm_init_raw_clkout(dev, subdev, drp_port, CLKOUT5_ClkReg1 + 2 * i,
-                                   &cfg->ports[i]);
-        if (res)
+        res = mmcm_fill_clkout(&regs[cnt], CLKOUT5_ClkReg1 + 2 * i, &cfg->ports[i]);
+        if (res < 0)
             return res;
+
+        cnt += res;
     }
 
     // Input divide
-    res = mmcm_init_raw_div(dev, subdev, drp_port, 1);
-    if (res)
-        return res;
+    cnt += mmcm_fill_div(&regs[cnt], 1);
 
     // Lock
-    res = mmcm_init_raw_lock(dev, subdev, drp_port, clkfbdiv);
-    if (res)
-        return res;
+    cnt += mmcm_fill_lock(&regs[cnt], clkfbdiv);
 
     // Filter
-    res = mmcm_init_raw_filt(dev, subdev, drp_port, clkfbdiv, 1);
+    cnt += mmcm_fill_filt(&regs[cnt], clkfbdiv, 1);
+
+    res = lowlevel_drp_wr16(dev, subdev, drp_port, PowerRegV7, 0xffff);
+    if (res) {
+        USDR_LOG("MMCM", USDR_LOG_ERROR, " unable to turn it on\n");
+        return res;
+    }
+
+    res = lowlevel_drp_rmw16(dev, subdev, drp_port, regs, cnt);
     if (res)
         return res;
 
+    for (unsigned i = 0; i < MAX_MMCM_PORTS; i++) {
+        mmcm_log_clkout(&regs[2 * i]);
+    }
     return 0;
 }
-
-
@@ -8,6 +8,7 @@
 #include <pthread.h>
 #include <signal.h>
 #include <assert.h>
+#include <usdr_time.h>
 
 #ifdef __linux
 #include <sys/eventfd.h>
@@ -80,6 +81,92 @@ unsigned find_usb_match(libusb_device **usbdev, size_t devices,
     return k;
 }
 
+static void _libusb_thread_cfg_parse(const char* name, const char* val, libusb_thread_cfg_t* cfg)
+{
+    int cpu, prio;
+    int cnt = sscanf(val, "%d/%d", &cpu, &prio);
+    if (cnt < 1) {
+        USDR_LOG("USBX", USDR_LOG_WARNING, "Incorrect `%s` thread configuration `%s`, expected <cpu>[/<prio>]\n",
+                 name, val);
+        return;
+    }
+
+    cfg->enabled = true;
+    cfg->cpu = cpu;
+    if (cnt > 1)
+        cfg->prio = prio;
+}
+
+static void _libusb_thread_cfg_init(unsigned pcount, const char** devparam,
+                                    const char** devval, libusb_generic_dev_t* odev)
+{
+    // Control path is served before stream completions on a shared core
+    odev->io_cfg.enabled = true;
+    odev->io_cfg.cpu = -1;
+    odev->io_cfg.prio = 2;
+    odev->rx_cfg.enabled = false;
+    odev->rx_cfg.cpu = -1;
+    odev->rx_cfg.prio = 1;
+    odev->tx_cfg = odev->rx_cfg;
+
+    for (unsigned k = 0; k < pcount; k++) {
+        if (strcmp(devparam[k], "usbio") == 0) {
+            _libusb_thread_cfg_parse(devparam[k], devval[k], &odev->io_cfg);
+            odev->io_cfg.enabled = true;
+        } else if (strcmp(devparam[k], "usbrx") == 0) {
+            _libusb_thread_cfg_parse(devparam[k], devval[k], &odev->rx_cfg);
+        } else if (strcmp(devparam[k], "usbtx") == 0) {
+            _libusb_thread_cfg_parse(devparam[k], devval[k], &odev->tx_cfg);
+        }
+    }
+}
+
+static void _libusb_thread_apply(pthread_t th, const char* name, const libusb_thread_cfg_t* cfg)
+{
+#if defined(__linux) || defined(__APPLE__)
+    int res;
+
+#if defined(__linux)
+    pthread_setname_np(th, name);
+
+    if (cfg->cpu >= 0) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(cfg->cpu, &cpuset);
+
+        res = pthread_setaffinity_np(th, sizeof(cpuset), &cpuset);
+        if (res) {
+            USDR_LOG("USBX", USDR_LOG_WARNING, "%s: Unable to set CPU affinity to %d: error %d\n",
+                     name, cfg->cpu, res);
+        }
+    }
+#else
+    // Only the calling thread can be named, no CPU affinity API
+    if (pthread_equal(th, pthread_self()))
+        pthread_setname_np(name);
+#endif
+
+    if (cfg->prio > 0) {
+        struct sched_param shed;
+        shed.sched_priority = cfg->prio;
+
+        res = pthread_setschedparam(th, SCHED_FIFO, &shed);
+        if (res) {
+            USDR_LOG("USBX", USDR_LOG_WARNING, "%s: Unable to set realtime priority: error %d\n", name, res);
+        }
+    }
+#endif
+}
+
+static void _libusb_thread_block_signals(void)
+{
+#if defined(__linux) || defined(__APPLE__)
+    sigset_t set;
+    sigfillset(&set);
+    pthread_sigmask(SIG_SETMASK, &set, NULL);
+#endif
+}
+
 static
 int usb_filtering_params_parse(unsigned pcount, const char** devparam,
                                const char** devval, struct usb_filtering_params* pp)
@@ -291,6 +378,7 @@ int libusb_generic_plugin_create(unsigned pcount, const char** devparam,
     strncpy(odev->devid_str, usdr_device_id_to_str(odev->devid), sizeof(odev->devid_str) - 1);
 
     odev->stop = false;
+    _libusb_thread_cfg_init(pcount, devparam, devval, odev);
 
     return 0;
 
@@ -307,22 +395,8 @@ void* libusb_generic_io_thread(void *arg)
     libusb_generic_dev_t* dev = (libusb_generic_dev_t*)arg;
     int res = 0;
 
-#if defined(__linux) || defined(__APPLE__)
-    sigset_t set;
-
-    pthread_setname_np(pthread_self(), "usb_io");
-
-    sigfillset(&set);
-    pthread_sigmask(SIG_SETMASK, &set, NULL);
-
-    struct sched_param shed;
-    shed.sched_priority = 2;
-
-    res = pthread_setschedparam(pthread_self(), SCHED_FIFO, &shed);
-    if (res) {
-        USDR_LOG("USBX", USDR_LOG_WARNING, "IO thread: Unable to set realtime priority: error %d", res);
-    }
-#endif
+    _libusb_thread_block_signals();
+    _libusb_thread_apply(pthread_self(), "usb_io", &dev->io_cfg);
 
     USDR_LOG("USBX", USDR_LOG_INFO, "IO thread started");
 
@@ -359,9 +433,63 @@ int libusb_generic_stop_thread(libusb_generic_dev_t *dev)
 }
 
 
+static void _buffers_mem_free(struct buffers* rb)
+{
+    if (rb->rqueuebuf_ptr == NULL)
+        return;
+
+#if defined(LIBUSB_API_VERSION) && (LIBUSB_API_VERSION >= 0x01000105)
+    if (rb->dev_mem) {
+        libusb_dev_mem_free(rb->dh, rb->rqueuebuf_ptr, rb->rqueuebuf_sz);
+    } else
+#endif
+    {
+        free(rb->rqueuebuf_ptr);
+    }
+
+    rb->rqueuebuf_ptr = NULL;
+    rb->rqueuebuf_sz = 0;
+    rb->dev_mem = false;
+}
+
+// Zero-copy buffers are mmaped from usbfs, so the kernel doesn't bounce every
+// URB through its own memory. Not available on older kernels / non Linux or
+// when usbfs_memory_mb is exhausted, fall back to the regular heap then.
+static int _buffers_mem_alloc(struct buffers* rb, size_t sz)
+{
+    int res;
+
+#if defined(LIBUSB_API_VERSION) && (LIBUSB_API_VERSION >= 0x01000105)
+    if (rb->dh) {
+        rb->rqueuebuf_ptr = libusb_dev_mem_alloc(rb->dh, sz);
+        if (rb->rqueuebuf_ptr) {
+            rb->rqueuebuf_sz = sz;
+            rb->dev_mem = true;
+            return 0;
+        }
+
+        USDR_LOG("USBX", USDR_LOG_INFO, "Zero-copy allocation of %u bytes isn't available, using host memory\n",
+                 (unsigned)sz);
+    }
+#endif
+
+    res = posix_memalign((void**)&rb->rqueuebuf_ptr, 4096, sz);
+    if (res != 0) {
+        rb->rqueuebuf_ptr = NULL;
+        return -res;
+    }
+
+    rb->rqueuebuf_sz = sz;
+    rb->dev_mem = false;
+    return 0;
+}
+
 int buffers_init(struct buffers* rb, unsigned max, unsigned zerosemval, bool has_event)
 {
     rb->rqueuebuf_ptr = NULL;
+    rb->rqueuebuf_sz = 0;
+    rb->dh = NULL;
+    rb->dev_mem = false;
 
     rb->allocsz = 0;
     rb->allocsz_rounded = 0;
@@ -378,6 +506,10 @@ int buffers_init(struct buffers* rb, unsigned max, unsigned zerosemval, bool has
         return -errno;
     }
 
+    usdr_cond_init_monotonic(&rb->cb_done);
+    pthread_mutex_init(&rb->cb_lock, NULL);
+    rb->cb_active = 0;
+
     if (has_event) {
         rb->fd_event = fdevent_create(zerosemval);
         if (rb->fd_event < 0) {
@@ -392,17 +524,21 @@ int buffers_init(struct buffers* rb, unsigned max, unsigned zerosemval, bool has
     rb->auto_restart = false;
     rb->stop = false;
     rb->transfers_count = 0;
+    rb->transfers_inflight = 0;
+    rb->transfers_depth = 0;
+    rb->transfers_idle_cnt = 0;
+    rb->depth_adaptive = false;
+    rb->overflows = 0;
+    rb->worker_on = false;
 
     rb->on_buffer_param = NULL;
     rb->on_buffer = NULL;
     return 0;
 }
 
-void buffers_deinit(struct buffers* rb)
+static void _buffers_cancel_all(struct buffers* rb)
 {
     int res;
-
-    rb->stop = true;
     for (unsigned i = 0; i < rb->transfers_count; i++) {
         res = libusb_to_errno(libusb_cancel_transfer(rb->transfers[i]));
         if (res && res != -ENXIO) {
@@ -410,18 +546,66 @@ void buffers_deinit(struct buffers* rb)
                      i, rb->transfers_count, res);
         }
     }
+}
+
+static bool _buffers_busy(struct buffers* rb)
+{
+    return __atomic_load_n(&rb->transfers_inflight, __ATOMIC_SEQ_CST) != 0 || rb->cb_active != 0;
+}
+
+// Cancels all transfers and waits for their callbacks. Cancellation is
+// repeated every slice in case a callback racing with stop resubmitted.
+static int _buffers_cancel_wait(struct buffers* rb, unsigned timeout_ms)
+{
+    const unsigned slice_ms = 10;
+    unsigned waited = 0;
+    struct timespec ts;
+    int res = 0;
+
+    __atomic_store_n(&rb->stop, true, __ATOMIC_SEQ_CST);
+    if (!_buffers_busy(rb))
+        return 0;
+
+    _buffers_cancel_all(rb);
+
+    pthread_mutex_lock(&rb->cb_lock);
+    while (_buffers_busy(rb)) {
+        usdr_time_deadline(&ts, slice_ms * 1000000ull);
+        if (pthread_cond_timedwait(&rb->cb_done, &rb->cb_lock, &ts) != ETIMEDOUT)
+            continue;
+
+        waited += slice_ms;
+        if (waited >= timeout_ms) {
+            res = -ETIMEDOUT;
+            break;
+        }
+
+        pthread_mutex_unlock(&rb->cb_lock);
+        _buffers_cancel_all(rb);
+        pthread_mutex_lock(&rb->cb_lock);
+    }
+    pthread_mutex_unlock(&rb->cb_lock);
+    return res;
+}
 
-    // TODO Add synchronization to get all outstanging endpoints
-    usleep(10000);
+void buffers_deinit(struct buffers* rb)
+{
+    int res = _buffers_cancel_wait(rb, 1000);
+    if (res) {
+        // IO thread isn't running or the device is gone, nothing to wait for anymore
+        USDR_LOG("USBX", USDR_LOG_WARNING, "%d transfers are still in flight on teardown\n",
+                 __atomic_load_n(&rb->transfers_inflight, __ATOMIC_SEQ_CST));
+    }
 
+    pthread_cond_destroy(&rb->cb_done);
+    pthread_mutex_destroy(&rb->cb_lock);
     sem_destroy(&rb->buf_ready);
-    free(rb->rqueuebuf_ptr);
+    _buffers_mem_free(rb);
     free(rb->bd);
     if (rb->fd_event >= 0)
         fdevent_destroy(rb->fd_event);
     rb->fd_event = -101;
 
-    rb->rqueuebuf_ptr = NULL;
     rb->bd = NULL;
 }
 
@@ -430,7 +614,7 @@ int buffers_realloc(struct buffers* rb, unsigned allocsz)
     int res;
     unsigned i;
 
-    free(rb->rqueuebuf_ptr);
+    _buffers_mem_free(rb);
     free(rb->bd);
     rb->allocsz = allocsz;
 
@@ -439,10 +623,12 @@ int buffers_realloc(struct buffers* rb, unsigned allocsz)
 
     rb->bd = (struct buffer_discriptor *)malloc(sizeof(struct buffer_discriptor) * (rb->buf_max + 1));
 
-    res = posix_memalign((void**)&rb->rqueuebuf_ptr, 4096,
-                         rb->allocsz_rounded * (rb->buf_max + 1));
-    if (res != 0)
-        return -res;
+    if (rb->bd == NULL)
+        return -ENOMEM;
+
+    res = _buffers_mem_alloc(rb, (size_t)rb->allocsz_rounded * (rb->buf_max + 1));
+    if (res)
+        return res;
 
     for (i = 0; i <= rb->buf_max; i++) {
         rb->bd[i].b = rb;
@@ -450,8 +636,8 @@ int buffers_realloc(struct buffers* rb, unsigned allocsz)
         rb->bd[i].buffer_sz = 0;
     }
 
-    USDR_LOG("USBX", USDR_LOG_ERROR, "RX buffer configured to %d bytes for %d original\n",
-             rb->allocsz_rounded, allocsz);
+    USDR_LOG("USBX", USDR_LOG_ERROR, "RX buffer configured to %d bytes for %d original, %s memory\n",
+             rb->allocsz_rounded, allocsz, rb->dev_mem ? "zero-copy usbfs" : "host");
 
     rb->bufno_prod = 0;
     rb->bufno_cons = 0;
@@ -541,8 +727,10 @@ int buffers_usb_transfer_post(struct buffers *prxb, unsigned buffer_idx, unsigne
     prxb->transfers[transfer_idx]->length = length; //prxb->allocsz_rounded;
     prxb->transfers[transfer_idx]->user_data = &prxb->bd[buffer_idx];
 
+    __atomic_fetch_add(&prxb->transfers_inflight, 1, __ATOMIC_SEQ_CST);
     res = libusb_to_errno(libusb_submit_transfer(prxb->transfers[transfer_idx]));
     if (res) {
+        __atomic_fetch_sub(&prxb->transfers_inflight, 1, __ATOMIC_SEQ_CST);
         USDR_LOG("USBX", USDR_LOG_ERROR, "FAILED to post %s_STRM[%d] buf %d error %d\n",
                  (prxb->transfers[transfer_idx]->endpoint & LIBUSB_ENDPOINT_IN) ? "IN" : "OUT",
                  transfer_idx, buffer_idx, res);
@@ -554,11 +742,48 @@ int buffers_usb_transfer_post(struct buffers *prxb, unsigned buffer_idx, unsigne
     return res;
 }
 
-void LIBUSB_CALL libusb_transfer_buffers_cb(struct libusb_transfer *transfer)
+static void _buffers_usb_depth_update(struct buffers *rxb)
 {
-    struct buffer_discriptor *rxbd = (struct buffer_discriptor *)transfer->user_data;
-    struct buffers *rxb = rxbd->b;
+    unsigned ovf = rxb->overflows;
+
+    rxb->overflows = 0;
+
+    unsigned prev = rxb->transfers_depth;
+    unsigned depth = usb_depth_ctrl_update(&rxb->depth_ctrl, usdr_time_ns() / 1000, ovf);
+    rxb->transfers_depth = depth;
+    if (depth != prev) {
+        USDR_LOG("USBX", USDR_LOG_INFO, "IN_STRM depth %d -> %d, period %d us\n",
+                 prev, depth, rxb->depth_ctrl.period_us);
+    }
+}
+
+// Resubmit completed transfer and bring in-flight count to the desired depth
+static void _buffers_usb_depth_resubmit(struct buffers *rxb, unsigned idx)
+{
+    unsigned depth = rxb->transfers_depth;
     int res;
+
+    rxb->transfers_idle[rxb->transfers_idle_cnt++] = idx;
+    while (rxb->transfers_idle_cnt > 0 &&
+           __atomic_load_n(&rxb->transfers_inflight, __ATOMIC_SEQ_CST) < depth) {
+        idx = rxb->transfers_idle[--rxb->transfers_idle_cnt];
+        res = buffers_usb_transfer_post(rxb,
+                                        _buffers_prod_get_nolock(rxb),
+                                        rxb->allocsz_rounded,
+                                        idx);
+        if (res) {
+            USDR_LOG("USBX", USDR_LOG_ERROR, "IN_STRM[%d] transfer resumbit failed, error %d!\n",
+                     idx, res);
+            rxb->transfers_idle_cnt++;
+            break;
+        }
+    }
+}
+
+static void _buffers_transfer_complete(struct libusb_transfer *transfer,
+                                       struct buffer_discriptor *rxbd)
+{
+    struct buffers *rxb = rxbd->b;
     int idx;
     uint8_t *mptr;
     const char* tr_type = (transfer->endpoint & LIBUSB_ENDPOINT_IN) ? "IN" : "OUT";
@@ -571,8 +796,7 @@ void LIBUSB_CALL libusb_transfer_buffers_cb(struct libusb_transfer *transfer)
     USDR_LOG("USBX", USDR_LOG_DEBUG, "%s_STRM[%d] transfer %d => %d / %d\n", tr_type,
              idx, transfer->status, transfer->actual_length, transfer->length);
 
-    if (rxb->stop) {
-        // TODO: Syncronize EPs
+    if (__atomic_load_n(&rxb->stop, __ATOMIC_SEQ_CST)) {
         return;
     }
 
@@ -603,24 +827,117 @@ void LIBUSB_CALL libusb_transfer_buffers_cb(struct libusb_transfer *transfer)
         buffers_ready_post(rxb);
     }
 
+    if (__atomic_load_n(&rxb->depth_adaptive, __ATOMIC_ACQUIRE)) {
+        _buffers_usb_depth_update(rxb);
+    }
+
     // Resubmit
 restart:
     if (rxb->auto_restart && (transfer->endpoint & LIBUSB_ENDPOINT_IN)) {
-        res = buffers_usb_transfer_post(rxb,
-                                        _buffers_prod_get_nolock(rxb),
-                                        rxb->allocsz_rounded,
-                                        idx);
-        if (res) {
-            USDR_LOG("USBX", USDR_LOG_ERROR, "IN_STRM[%d] transfer resumbit failed, error %d!\n",
-                     idx, res);
+        _buffers_usb_depth_resubmit(rxb, idx);
+    }
+}
+
+void LIBUSB_CALL libusb_transfer_buffers_cb(struct libusb_transfer *transfer)
+{
+    struct buffer_discriptor *rxbd = (struct buffer_discriptor *)transfer->user_data;
+    struct buffers *rxb = rxbd->b;
+
+    __atomic_fetch_add(&rxb->cb_active, 1, __ATOMIC_SEQ_CST);
+    __atomic_fetch_sub(&rxb->transfers_inflight, 1, __ATOMIC_SEQ_CST);
+
+    if (rxb->worker_on) {
+        // Each transfer is queued at most once, the ring can't overflow
+        pthread_mutex_lock(&rxb->cb_lock);
+        rxb->worker_q[rxb->worker_q_wr++ % BUFFERS_MAX_TRANS] = transfer;
+        if (rxb->worker_waiting)
+            pthread_cond_signal(&rxb->worker_cond);
+    } else {
+        _buffers_transfer_complete(transfer, rxbd);
+        pthread_mutex_lock(&rxb->cb_lock);
+    }
+
+    // Nothing in rxb is touched after teardown is woken up
+    rxb->cb_active--;
+    pthread_cond_broadcast(&rxb->cb_done);
+    pthread_mutex_unlock(&rxb->cb_lock);
+}
+
+static void* _buffers_worker_thread(void* arg)
+{
+    struct buffers *rxb = (struct buffers *)arg;
+    struct libusb_transfer *transfer;
+
+    _libusb_thread_block_signals();
+
+    pthread_mutex_lock(&rxb->cb_lock);
+    for (;;) {
+        while (rxb->worker_q_rd == rxb->worker_q_wr && !rxb->worker_stop) {
+            rxb->worker_waiting = true;
+            pthread_cond_wait(&rxb->worker_cond, &rxb->cb_lock);
+            rxb->worker_waiting = false;
         }
+        if (rxb->worker_stop)
+            break;
+
+        transfer = rxb->worker_q[rxb->worker_q_rd++ % BUFFERS_MAX_TRANS];
+        pthread_mutex_unlock(&rxb->cb_lock);
+
+        // Buffer number isn't tied to the transfer slot, the descriptor is
+        // taken from the transfer the same way the callback does
+        _buffers_transfer_complete(transfer, (struct buffer_discriptor *)transfer->user_data);
+
+        pthread_mutex_lock(&rxb->cb_lock);
     }
+    pthread_mutex_unlock(&rxb->cb_lock);
+    return NULL;
+}
+
+static int _buffers_worker_start(struct buffers *rxb, unsigned endpoint, const libusb_thread_cfg_t* cfg)
+{
+    int res;
+
+    rxb->worker_stop = false;
+    rxb->worker_waiting = false;
+    rxb->worker_q_rd = 0;
+    rxb->worker_q_wr = 0;
+    pthread_cond_init(&rxb->worker_cond, NULL);
+
+    res = pthread_create(&rxb->worker, NULL, _buffers_worker_thread, rxb);
+    if (res) {
+        pthread_cond_destroy(&rxb->worker_cond);
+        return -res;
+    }
+
+    char name[16];
+    snprintf(name, sizeof(name), "usb_ep%02x", endpoint);
+    _libusb_thread_apply(rxb->worker, name, cfg);
+
+    rxb->worker_on = true;
+    return 0;
+}
+
+// The worker may resubmit while running, so it's stopped before transfers
+// are cancelled
+static void _buffers_worker_stop(struct buffers *rxb)
+{
+    if (!rxb->worker_on)
+        return;
+
+    __atomic_store_n(&rxb->stop, true, __ATOMIC_SEQ_CST);
+
+    pthread_mutex_lock(&rxb->cb_lock);
+    rxb->worker_stop = true;
+    pthread_cond_signal(&rxb->worker_cond);
+    pthread_mutex_unlock(&rxb->cb_lock);
+
+    pthread_join(rxb->worker, NULL);
 }
 
 
 int buffers_usb_init(libusb_generic_dev_t* gdev, struct buffers *prxb,
                      unsigned max_reqs, unsigned max_buffs, unsigned max_blocksize,
-                     unsigned endpoint, bool eventfd_ntfy)
+                     unsigned endpoint, bool eventfd_ntfy, bool host_mem)
 {
     bool usb_in = (endpoint & LIBUSB_ENDPOINT_IN) ? true : false;
     int res = 0;
@@ -629,6 +946,9 @@ int buffers_usb_init(libusb_generic_dev_t* gdev, struct buffers *prxb,
     }
 
     res = res ? res : buffers_init(prxb, max_buffs, usb_in ? 0 : max_buffs, eventfd_ntfy);
+    if (res == 0 && !host_mem) {
+        prxb->dh = gdev->dh;
+    }
     res = res ? res : buffers_realloc(prxb, max_blocksize);
     res = res ? res : libusb_generic_prepare_transfer(gdev, NULL, endpoint,
                                                       LIBUSB_TRANSFER_TYPE_BULK,
@@ -645,15 +965,31 @@ int buffers_usb_init(libusb_generic_dev_t* gdev, struct buffers *prxb,
         prxb->transfers[j]->user_data = &prxb->bd[j];
     }
     prxb->transfers_count = max_reqs;
+    prxb->transfers_depth = max_reqs;
+
+    const libusb_thread_cfg_t* wcfg = usb_in ? &gdev->rx_cfg : &gdev->tx_cfg;
+    if (wcfg->enabled) {
+        res = _buffers_worker_start(prxb, endpoint, wcfg);
+        if (res) {
+            USDR_LOG("USBX", USDR_LOG_WARNING, "Unable to start completion thread for endpoint %02x, error %d; "
+                     "completions are handled in the IO thread\n", endpoint, res);
+        }
+    }
 
-    USDR_LOG("USBX", USDR_LOG_INFO, "%s_STRM endpoint %02x configured: %d requests, %d x %d buffers\n",
-             usb_in ? "IN" : "OUT", endpoint, max_reqs, max_buffs, prxb->allocsz_rounded);
+    USDR_LOG("USBX", USDR_LOG_INFO, "%s_STRM endpoint %02x configured: %d requests, %d x %d %s buffers\n",
+             usb_in ? "IN" : "OUT", endpoint, max_reqs, max_buffs, prxb->allocsz_rounded,
+             prxb->dev_mem ? "zero-copy" : "host");
     return 0;
 }
 
 int buffers_usb_free(struct buffers *prxb)
 {
+    _buffers_worker_stop(prxb);
     buffers_deinit(prxb);
+    if (prxb->worker_on) {
+        pthread_cond_destroy(&prxb->worker_cond);
+        prxb->worker_on = false;
+    }
 
     for (unsigned j = 0; j < prxb->transfers_count; j++) {
         libusb_free_transfer(prxb->transfers[j]);
@@ -661,8 +997,7 @@ int buffers_usb_free(struct buffers *prxb)
         prxb->transfers[j] = NULL;
     }
 
-    free(prxb->rqueuebuf_ptr);
-    prxb->rqueuebuf_ptr = NULL;
+    _buffers_mem_free(prxb);
 
     free(prxb->bd);
     prxb->bd = NULL;
@@ -671,37 +1006,59 @@ int buffers_usb_free(struct buffers *prxb)
     return 0;
 }
 
-// Helpers
-
-int sem_wait_ex(sem_t *s, int64_t timeout_ns)
+int buffers_usb_start(struct buffers *prxb, unsigned count)
 {
     int res;
-    if (timeout_ns > 0) {
-        struct timespec ts;
-        unsigned secs = timeout_ns / (1000 * 1000 * 1000);
+    if (count > prxb->transfers_count)
+        count = prxb->transfers_count;
+
+    // Idle transfers are popped from the end
+    prxb->transfers_depth = count;
+    prxb->transfers_idle_cnt = 0;
+    for (unsigned t = prxb->transfers_count; t > count; t--) {
+        prxb->transfers_idle[prxb->transfers_idle_cnt++] = t - 1;
+    }
 
-        res = clock_gettime(CLOCK_REALTIME, &ts);
+    for (unsigned t = 0; t < count; t++) {
+        res = buffers_usb_transfer_post(prxb,
+                                        _buffers_prod_get_nolock(prxb),
+                                        prxb->allocsz_rounded,
+                                        t);
         if (res)
-            return -EFAULT;
-
-        ts.tv_sec += secs;
-        timeout_ns -= (int64_t)1000 * 1000 * 1000 * secs;
+            return res;
+    }
+    return 0;
+}
 
-        ts.tv_nsec += timeout_ns * 1000;
-        while (ts.tv_nsec > 1000 * 1000 * 1000) {
-            ts.tv_nsec -= 1000 * 1000 * 1000;
-            ts.tv_sec++;
-        }
+int buffers_usb_depth_set_latency(struct buffers *prxb, unsigned min_depth, unsigned latency_us)
+{
+    if (!prxb->auto_restart)
+        return -ENOTSUP;
 
-        res = sem_timedwait(s, &ts);
-    } else if (timeout_ns < 0) {
-        res = sem_wait(s);
-    } else {
-        res = sem_trywait(s);
+    if (latency_us == 0) {
+        __atomic_store_n(&prxb->depth_adaptive, false, __ATOMIC_RELEASE);
+        return 0;
     }
-    if (res) {
-        // sem_* function on error returns -1, get proper error
-        res = -errno;
+
+    if (__atomic_load_n(&prxb->depth_adaptive, __ATOMIC_ACQUIRE)) {
+        usb_depth_ctrl_set_latency(&prxb->depth_ctrl, latency_us);
+        return 0;
     }
-    return res;
+
+    usb_depth_ctrl_init(&prxb->depth_ctrl, min_depth, prxb->transfers_count,
+                        prxb->transfers_depth, latency_us);
+    __atomic_store_n(&prxb->depth_adaptive, true, __ATOMIC_RELEASE);
+    return 0;
+}
+
+unsigned buffers_usb_depth_get(struct buffers *prxb)
+{
+    return __atomic_load_n(&prxb->transfers_depth, __ATOMIC_RELAXED);
+}
+
+// Helpers
+
+int sem_wait_ex(sem_t *s, int64_t timeout_ns)
+{
+    return usdr_sem_wait_ns(s, timeout_ns);
 }
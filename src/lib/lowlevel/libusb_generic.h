@@ -9,12 +9,14 @@
 #include <libusb-1.0/libusb.h>
 #include <string.h>
 #include <semaphore.h>
+#include <pthread.h>
 #include <time.h>
 
 #include <usdr_logging.h>
 
 #include "../device/device.h"
 #include "libusb_vidpid_map.h"
+#include "usb_depth_ctrl.h"
 
 static int libusb_to_errno(int libusberr)
 {
@@ -83,6 +85,17 @@ struct usb_filtering_params
 };
 typedef struct usb_filtering_params usb_filtering_params_t;
 
+// Thread placement from usbio=, usbrx= and usbtx= device parameters, each
+// given as <cpu>[/<prio>]. usbio is the libusb event thread serving the
+// control path; usbrx/usbtx move stream completion handling to a dedicated
+// thread per stream.
+struct libusb_thread_cfg {
+    bool enabled;
+    int cpu;     // -1 - no affinity
+    int prio;    // SCHED_FIFO priority, 0 - regular scheduling
+};
+typedef struct libusb_thread_cfg libusb_thread_cfg_t;
+
 struct libusb_generic_dev {
     libusb_context* ctx;
     libusb_device_handle* dh;
@@ -95,6 +108,10 @@ struct libusb_generic_dev {
 
     pthread_t io_thread;
     bool stop;
+
+    libusb_thread_cfg_t io_cfg;
+    libusb_thread_cfg_t rx_cfg;
+    libusb_thread_cfg_t tx_cfg;
 };
 typedef struct libusb_generic_dev libusb_generic_dev_t;
 
@@ -166,6 +183,10 @@ struct buffers
     sem_t buf_ready;
 
     uint8_t* rqueuebuf_ptr; // cache aligned pointer to rx_queuebuf
+    size_t rqueuebuf_sz;
+
+    libusb_device_handle* dh; // try to allocate transfer buffers in usbfs if set
+    bool dev_mem;             // rqueuebuf_ptr is allocated by libusb_dev_mem_alloc()
 
     unsigned allocsz;
     unsigned allocsz_rounded; // rounded up buffer to the maximum USB Transfer size
@@ -185,6 +206,33 @@ struct buffers
     //
     struct libusb_transfer *transfers[BUFFERS_MAX_TRANS];
     unsigned transfers_count;
+    unsigned transfers_inflight;
+    unsigned transfers_depth;   // Desired number of in-flight auto_restart transfers
+
+    // Teardown waits until all submitted transfers called back and no
+    // callback is running
+    unsigned cb_active;
+    pthread_mutex_t cb_lock;
+    pthread_cond_t cb_done;
+
+    // Adaptive number of in-flight transfers for auto_restart IN streams,
+    // updated from the completion thread only
+    bool depth_adaptive;
+    usb_depth_ctrl_t depth_ctrl;
+    unsigned transfers_idle[BUFFERS_MAX_TRANS];
+    unsigned transfers_idle_cnt;
+    unsigned overflows;     // Device side overflows, reported by on_buffer()
+
+    // Completion worker, when started the libusb callback only queues
+    // completed transfers and all processing above happens there
+    bool worker_on;
+    bool worker_stop;
+    bool worker_waiting;
+    pthread_t worker;
+    pthread_cond_t worker_cond;
+    struct libusb_transfer* worker_q[BUFFERS_MAX_TRANS];
+    unsigned worker_q_rd;
+    unsigned worker_q_wr;
 
     void* on_buffer_param;
     void (*on_buffer)(void* param, struct buffer_discriptor * bd);
@@ -218,10 +266,18 @@ int buffers_usb_transfer_post(struct buffers *prxb, unsigned buffer_idx, unsigne
 void LIBUSB_CALL libusb_transfer_buffers_cb(struct libusb_transfer *transfer);
 
 // TODO: on auto resubmit mode max_buffs must be more than max_reqs
+// host_mem disables zero-copy usbfs buffers, check prxb->dev_mem for the actual mode
 int buffers_usb_init(libusb_generic_dev_t* gdev, struct buffers *prxb,
                      unsigned max_reqs, unsigned max_buffs, unsigned max_blocksize,
-                     unsigned endpoint, bool eventfd_ntfy);
+                     unsigned endpoint, bool eventfd_ntfy, bool host_mem);
 
 int buffers_usb_free(struct buffers *prxb);
 
+// Post first `count` prepared IN transfers, the rest are kept for depth adaptation
+int buffers_usb_start(struct buffers *prxb, unsigned count);
+
+// latency_us == 0 freezes the current depth
+int buffers_usb_depth_set_latency(struct buffers *prxb, unsigned min_depth, unsigned latency_us);
+unsigned buffers_usb_depth_get(struct buffers *prxb);
+
 #endif
@@ -0,0 +1,270 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "lowlevel_async.h"
+#include "../ipblks/spiext.h"
+
+#include <usdr_logging.h>
+#include <usdr_time.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+// await_id = generation << 8 | slot, stale ids are rejected
+#define AWAIT_ID_SLOT(x)   ((x) & 0xff)
+#define AWAIT_ID_GEN(x)    ((x) >> 8)
+#define AWAIT_ID_MAKE(s, g) ((((g) & 0x7fffff) << 8) | (s))
+
+enum async_slot_state {
+    SLOT_FREE,
+    SLOT_QUEUED,
+    SLOT_DONE,
+};
+
+struct async_slot {
+    unsigned state;
+    unsigned gen;
+    int result;
+    subdev_t subdev;
+    lowlevel_ls_batch_op_t op;
+};
+
+struct async_lane {
+    lowlevel_async_t* as;
+    pthread_t thread;
+    bool started;
+
+    // FIFO of slot indexes
+    unsigned q[LOWLEVEL_ASYNC_MAX_REQS];
+    unsigned q_rd;
+    unsigned q_wr;
+    pthread_cond_t q_cond;
+};
+
+struct lowlevel_async {
+    lldev_t dev;
+    unsigned lanes;
+    bool stop;
+    int fd_event;
+
+    pthread_mutex_t lock;
+    pthread_cond_t done_cond;
+
+    struct async_slot slots[LOWLEVEL_ASYNC_MAX_REQS];
+    struct async_lane lane[LOWLEVEL_ASYNC_LANES];
+};
+
+static unsigned _async_lane_get(const lowlevel_async_t* as, const lowlevel_ls_batch_op_t* op)
+{
+    unsigned bus;
+    switch (op->ls_op) {
+    case USDR_LSOP_SPI: bus = SPIEXT_LSOP_GET_BUS(op->ls_op_addr); break;
+    case USDR_LSOP_I2C_DEV: bus = LSOP_I2C_INSTANCE(op->ls_op_addr) + 1; break;
+    default: bus = 0;
+    }
+    return bus % as->lanes;
+}
+
+static void* _async_lane_thread(void* param)
+{
+    struct async_lane* l = (struct async_lane*)param;
+    lowlevel_async_t* as = l->as;
+    uint64_t one = 1;
+
+    pthread_mutex_lock(&as->lock);
+    for (;;) {
+        while (l->q_rd == l->q_wr && !as->stop) {
+            pthread_cond_wait(&l->q_cond, &as->lock);
+        }
+        if (l->q_rd == l->q_wr)
+            break;
+
+        struct async_slot* s = &as->slots[l->q[l->q_rd % LOWLEVEL_ASYNC_MAX_REQS]];
+        pthread_mutex_unlock(&as->lock);
+
+        int res = lowlevel_get_ops(as->dev)->ls_op(as->dev, s->subdev, s->op.ls_op, s->op.ls_op_addr,
+                                                   s->op.meminsz, s->op.pin, s->op.memoutsz, s->op.pout);
+
+        pthread_mutex_lock(&as->lock);
+        l->q_rd++;
+        s->result = res;
+        s->state = SLOT_DONE;
+        pthread_cond_broadcast(&as->done_cond);
+
+        if (write(as->fd_event, &one, sizeof(one)) != sizeof(one)) {
+            USDR_LOG("LLAS", USDR_LOG_ERROR, "Unable to signal completion, error %d\n", errno);
+        }
+    }
+    pthread_mutex_unlock(&as->lock);
+    return NULL;
+}
+
+int lowlevel_async_create(lldev_t dev, unsigned lanes, lowlevel_async_t** pas)
+{
+    if (lanes == 0 || lanes > LOWLEVEL_ASYNC_LANES)
+        return -EINVAL;
+
+    lowlevel_async_t* as = (lowlevel_async_t*)malloc(sizeof(lowlevel_async_t));
+    if (as == NULL)
+        return -ENOMEM;
+
+    memset(as, 0, sizeof(*as));
+    as->dev = dev;
+    as->lanes = lanes;
+    as->fd_event = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (as->fd_event < 0) {
+        int err = -errno;
+        USDR_LOG("LLAS", USDR_LOG_ERROR, "Unable to create eventfd! err=%d\n", err);
+        free(as);
+        return err;
+    }
+
+    pthread_mutex_init(&as->lock, NULL);
+    usdr_cond_init_monotonic(&as->done_cond);
+    for (unsigned i = 0; i < LOWLEVEL_ASYNC_LANES; i++) {
+        as->lane[i].as = as;
+        pthread_cond_init(&as->lane[i].q_cond, NULL);
+    }
+
+    *pas = as;
+    return 0;
+}
+
+void lowlevel_async_destroy(lowlevel_async_t* as)
+{
+    if (as == NULL)
+        return;
+
+    pthread_mutex_lock(&as->lock);
+    as->stop = true;
+    for (unsigned i = 0; i < as->lanes; i++) {
+        pthread_cond_signal(&as->lane[i].q_cond);
+    }
+    pthread_mutex_unlock(&as->lock);
+
+    for (unsigned i = 0; i < as->lanes; i++) {
+        if (as->lane[i].started)
+            pthread_join(as->lane[i].thread, NULL);
+        pthread_cond_destroy(&as->lane[i].q_cond);
+    }
+
+    pthread_cond_destroy(&as->done_cond);
+    pthread_mutex_destroy(&as->lock);
+    close(as->fd_event);
+    free(as);
+}
+
+// Called under the lock
+static int _async_submit(lowlevel_async_t* as, subdev_t subdev, const lowlevel_ls_batch_op_t* op)
+{
+    struct async_lane* l = &as->lane[_async_lane_get(as, op)];
+    unsigned idx;
+    int res;
+
+    if (as->stop)
+        return -EPIPE;
+
+    for (idx = 0; idx < LOWLEVEL_ASYNC_MAX_REQS; idx++) {
+        if (as->slots[idx].state == SLOT_FREE)
+            break;
+    }
+    if (idx == LOWLEVEL_ASYNC_MAX_REQS)
+        return -EBUSY;
+
+    if (!l->started) {
+        res = pthread_create(&l->thread, NULL, _async_lane_thread, l);
+        if (res) {
+            USDR_LOG("LLAS", USDR_LOG_ERROR, "Unable to start lane thread, error %d\n", res);
+            return -res;
+        }
+        l->started = true;
+    }
+
+    struct async_slot* s = &as->slots[idx];
+    s->state = SLOT_QUEUED;
+    s->gen++;
+    s->result = 0;
+    s->subdev = subdev;
+    s->op = *op;
+
+    l->q[l->q_wr % LOWLEVEL_ASYNC_MAX_REQS] = idx;
+    l->q_wr++;
+    pthread_cond_signal(&l->q_cond);
+
+    return AWAIT_ID_MAKE(idx, s->gen);
+}
+
+// Called under the lock
+static int _async_wait(lowlevel_async_t* as, unsigned await_id, unsigned op, unsigned timeout)
+{
+    unsigned idx = AWAIT_ID_SLOT(await_id);
+    struct async_slot* s;
+    struct timespec ts;
+    int res;
+
+    if (idx >= LOWLEVEL_ASYNC_MAX_REQS)
+        return -EINVAL;
+
+    s = &as->slots[idx];
+    if (s->state == SLOT_FREE || AWAIT_ID_MAKE(idx, s->gen) != await_id)
+        return -ENOENT;
+
+    if (s->state != SLOT_DONE) {
+        if (op == LLAWAIT_POLL || timeout == 0)
+            return -EAGAIN;
+
+        if (timeout != LLAWAIT_INFINITE) {
+            usdr_time_deadline(&ts, timeout * 1000000ull);
+        }
+
+        while (s->state != SLOT_DONE) {
+            res = (timeout == LLAWAIT_INFINITE) ? pthread_cond_wait(&as->done_cond, &as->lock) :
+                                                  pthread_cond_timedwait(&as->done_cond, &as->lock, &ts);
+            if (res == ETIMEDOUT)
+                return -ETIMEDOUT;
+        }
+    }
+
+    res = s->result;
+    s->state = SLOT_FREE;
+    return res;
+}
+
+int lowlevel_async_await(lowlevel_async_t* as, subdev_t subdev, unsigned await_id,
+                         unsigned op, void** await_inout_aux_data, unsigned timeout)
+{
+    int res;
+
+    switch (op) {
+    case LLAWAIT_SUBMIT:
+        if (await_inout_aux_data == NULL || *await_inout_aux_data == NULL)
+            return -EINVAL;
+
+        pthread_mutex_lock(&as->lock);
+        res = _async_submit(as, subdev, (const lowlevel_ls_batch_op_t*)*await_inout_aux_data);
+        pthread_mutex_unlock(&as->lock);
+        return res;
+
+    case LLAWAIT_WAIT:
+    case LLAWAIT_POLL:
+        pthread_mutex_lock(&as->lock);
+        res = _async_wait(as, await_id, op, timeout);
+        pthread_mutex_unlock(&as->lock);
+        return res;
+
+    case LLAWAIT_GET_FD:
+        if (await_inout_aux_data == NULL || *await_inout_aux_data == NULL)
+            return -EINVAL;
+
+        *(int*)*await_inout_aux_data = as->fd_event;
+        return 0;
+    }
+
+    return -EINVAL;
+}
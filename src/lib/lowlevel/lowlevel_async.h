@@ -0,0 +1,32 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#ifndef LOWLEVEL_ASYNC_H
+#define LOWLEVEL_ASYNC_H
+
+#include "usdr_lowlevel.h"
+
+// Generic async ls_op executor for backends implementing await() on top of
+// blocking ls_op. Transactions are queued to per-bus lanes, so ops to
+// different SPI/I2C buses are in flight simultaneously while ops to the same
+// bus keep submission order.
+enum {
+    LOWLEVEL_ASYNC_MAX_REQS = 64,
+    LOWLEVEL_ASYNC_LANES = 4,
+};
+
+struct lowlevel_async;
+typedef struct lowlevel_async lowlevel_async_t;
+
+// Lane threads are started on the first submission, use a single lane when
+// the backend can't run ls_op from several threads at once
+int lowlevel_async_create(lldev_t dev, unsigned lanes, lowlevel_async_t** pas);
+
+// Waits for all outstanding requests
+void lowlevel_async_destroy(lowlevel_async_t* as);
+
+// await() implementation, see enum lowlevel_await_ops
+int lowlevel_async_await(lowlevel_async_t* as, subdev_t subdev, unsigned await_id,
+                         unsigned op, void** await_inout_aux_data, unsigned timeout);
+
+#endif
@@ -23,6 +23,7 @@
 #include "../device/device_vfs.h"
 
 #include "pcie_uram_driver_if.h"
+#include "../lowlevel_async.h"
 
 #include "../ipblks/si2c.h"
 #include "../ipblks/spiext.h"
@@ -71,6 +72,9 @@ struct pcie_uram_dev
     device_bus_t db;
 
     struct stream_cache_data scache[DBMAX_SRX + DBMAX_STX];
+
+    // Async ls_op, every SPI/I2C bus is served by the driver independently
+    lowlevel_async_t* async;
 };
 typedef struct pcie_uram_dev pcie_uram_dev_t;
 
@@ -485,6 +489,7 @@ int pcie_uram_stream_initialize(lldev_t dev, subdev_t subdev,
     //d->bit_per_all_sym[pdsc.sno] = params->bits_per_sym;
     params->underlying_fd = d->fd;
     params->out_mtu_size = pdsc.dma_buf_sz;
+    params->out_flags = (pdsc.type == STREAM_MMAPED) ? LLSOF_DEV_MEM : 0;
     USDR_LOG("PCIE", USDR_LOG_INFO, "Configured stream%d: %d X %d (vma_off=%08lx vma_len=%08lx)\n",
              pdsc.sno, pdsc.dma_buf_sz, pdsc.dma_bufs, pdsc.out_vma_off, pdsc.out_vma_length);
     return 0;
@@ -681,7 +686,11 @@ int pcie_uram_send_dma_commit(lldev_t dev, subdev_t subdev, stream_t channel, vo
 static
 int pcie_uram_await(lldev_t dev, subdev_t subdev, unsigned await_id, unsigned op, void** await_inout_aux_data, unsigned timeout)
 {
-    return -ENOTSUP;
+    struct pcie_uram_dev* d = (struct pcie_uram_dev*)dev;
+    if (d->async == NULL)
+        return -ENOTSUP;
+
+    return lowlevel_async_await(d->async, subdev, await_id, op, await_inout_aux_data, timeout);
 }
 
 static
@@ -712,6 +721,9 @@ int pcie_uram_destroy(lldev_t dev)
         dev->pdev->destroy(dev->pdev);
     }
 
+    lowlevel_async_destroy(d->async);
+    d->async = NULL;
+
     //
     if (d->mmaped_io) {
         munmap(d->mmaped_io, 4096);
@@ -1058,8 +1070,15 @@ int pcie_uram_plugin_create(unsigned pcount, const char** devparam, const char**
         }
     }
 
+    err = lowlevel_async_create(&dev->ll, LOWLEVEL_ASYNC_LANES, &dev->async);
+    if (err) {
+        USDR_LOG("PCIE", USDR_LOG_WARNING, "Async operations aren't available, error %d\n", err);
+        dev->async = NULL;
+        err = 0;
+    }
+
     // Device initialization
-    err = err ? err : dev->ll.pdev->initialize(dev->ll.pdev, pcount, devparam, devval);
+    err = err ? err : usdr_device_initialize(dev->ll.pdev, pcount, devparam, devval);
     if (err) {
         USDR_LOG("PCIE", USDR_LOG_ERROR,
                  "Unable to initialize device, error %d\n", err);
@@ -1070,6 +1089,7 @@ int pcie_uram_plugin_create(unsigned pcount, const char** devparam, const char**
     return 0;
 
 clear_map:
+    lowlevel_async_destroy(dev->async);
     if (dev->mmaped_io) {
         munmap(dev->mmaped_io, iospacesz);
     }
@@ -0,0 +1,924 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#include "synth_ll.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+
+#include <usdr_logging.h>
+#include <usdr_time.h>
+
+#include "../device/device.h"
+#include "../device/device_ids.h"
+#include "../device/generic_usdr/generic_regs.h"
+#include "../ipblks/streams/dma_trace.h"
+
+// Emulated cores:
+//  RX -- DMA ring filled by the device at the sample rate. When the host
+//        doesn't keep up the ring gets full and the following packets are
+//        lost, the count is reported in the OOB of the next filled buffer
+//        the same way the PCIe driver does.
+//  TX -- ring played out at the sample rate. A gap in the data counts as a
+//        frontend drop (underrun), a burst with a timestamp behind the
+//        playout position is dropped by DMA (late). Statistics are reported
+//        in the PCIe TX core format.
+// The device clock starts with the first transfer of the stream.
+//
+// Replay -- instead of the emulation RX buffers with their OOB and TX
+// statistics come from a trace recorded by the stream with `trace_<file>`,
+// at the recorded pace or as fast as the host goes.
+
+enum {
+    SYNTH_MAX_STREAMS = 2,
+    SYNTH_MAX_BUFS = 64,
+    SYNTH_DEF_BLOCK = 65536,
+
+    SYNTH_REGS = 64,
+    SYNTH_VIRT_REGS = 1024,
+
+    // dma_rx_32 configuration registers in the indexed space of stream 0
+    SYNTH_RXCFG_BBURSTSZ = VIRT_CFG_SFX_BASE + 64,
+
+    SYNTH_TONE_PERIOD = 64,
+};
+
+struct synth_stream {
+    pthread_mutex_t lock;
+    bool rx;
+    unsigned bufcnt;
+    unsigned bufsz;
+    unsigned pktsyms;      // Samples in a full buffer, 0 -- unknown
+    unsigned bits_per_sym; // TX only
+    uint8_t* mem;
+
+    uint64_t t0;           // Device clock start, CLOCK_MONOTONIC ns; 0 -- not started
+
+    // RX ring: wr -- filled by the device, hand -- given to the host, rd -- released
+    uint64_t wr;
+    uint64_t hand;
+    uint64_t rd;
+    uint64_t periods;      // Packet periods accounted since t0
+    uint64_t pending_lost; // Lost packets to report with the next filled buffer
+    uint32_t lost[SYNTH_MAX_BUFS];
+    uint64_t ts[SYNTH_MAX_BUFS];
+
+    // TX ring: seq -- committed, aired -- played out
+    uint64_t seq;
+    uint64_t aired;
+    uint64_t q_end;        // Device time when the queued data runs out, samples
+    uint64_t slot_end[SYNTH_MAX_BUFS];
+    uint32_t drop_fe;
+    uint32_t drop_dma;
+    uint32_t bursts_sent;
+
+    void* param;
+    soft_tx_commit_fn_t soft_tx_fn;
+
+    // Replay
+    dma_trace_t* replay;
+    dma_trace_rec_t rec;   // Next record, valid when rec_pending
+    const void* rec_oob;
+    const void* rec_data;
+    bool rec_pending;
+    uint64_t replay_base;  // Added to the record time, grows with every loop
+    uint64_t replay_last;
+};
+
+struct synth_dev {
+    struct lowlevel_dev ll;
+    char name[32];
+    device_id_t devid;
+
+    bool pace;
+    unsigned ovf_every;
+    unsigned udr_every;
+    unsigned rate[2];      // RX, TX
+
+    bool replay_max;
+    bool replay_loop;
+    dma_trace_t* replay[SYNTH_MAX_STREAMS];
+
+    pthread_mutex_t reg_lock;
+    uint32_t regs[SYNTH_REGS];
+    uint32_t vregs[SYNTH_VIRT_REGS];
+
+    struct synth_stream str[SYNTH_MAX_STREAMS];
+};
+typedef struct synth_dev synth_dev_t;
+
+
+static void synth_sleep_until(uint64_t ns)
+{
+    struct timespec ts = { .tv_sec = ns / 1000000000u, .tv_nsec = ns % 1000000000u };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+}
+
+static unsigned synth_rate(synth_dev_t* d, struct synth_stream* s)
+{
+    return (d->pace) ? __atomic_load_n(&d->rate[s->rx ? 0 : 1], __ATOMIC_RELAXED) : 0;
+}
+
+static uint64_t synth_ns_to_samples(uint64_t ns, unsigned rate)
+{
+    return (uint64_t)((double)ns * rate / 1e9);
+}
+
+static uint64_t synth_samples_to_ns(uint64_t samples, unsigned rate)
+{
+    return (uint64_t)ceil((double)samples * 1e9 / rate);
+}
+
+static struct synth_stream* synth_get_stream(synth_dev_t* d, stream_t channel, bool rx)
+{
+    if (channel >= SYNTH_MAX_STREAMS)
+        return NULL;
+
+    struct synth_stream* s = &d->str[channel];
+    return (s->mem != NULL && s->rx == rx) ? s : NULL;
+}
+
+static int synth_generic_get(lldev_t dev, int generic_op, const char** pout)
+{
+    synth_dev_t* d = (synth_dev_t*)dev;
+
+    switch (generic_op) {
+    case LLGO_DEVICE_NAME: *pout = d->name; return 0;
+    case LLGO_DEVICE_UUID: *pout = (const char*)d->devid.d; return 0;
+    }
+
+    return -EINVAL;
+}
+
+static void synth_tx_advance(struct synth_stream* s, uint64_t now_s)
+{
+    while (s->aired < s->seq && s->slot_end[s->aired % s->bufcnt] <= now_s) {
+        s->aired++;
+    }
+}
+
+static unsigned synth_tx_buf_samples(struct synth_stream* s, unsigned sz)
+{
+    if (s->bits_per_sym)
+        return (uint64_t)sz * 8 / s->bits_per_sym;
+
+    return (uint64_t)sz * s->pktsyms / s->bufsz;
+}
+
+static void synth_tx_stat(synth_dev_t* d, struct synth_stream* s, uint32_t stat[4])
+{
+    unsigned rate = synth_rate(d, s);
+    uint64_t now_s = (rate && s->t0) ? synth_ns_to_samples(usdr_time_ns() - s->t0, rate) : 0;
+    uint64_t ring_samples = synth_tx_buf_samples(s, s->bufsz) * s->bufcnt;
+    unsigned fifo_used = 0;
+
+    if (rate) {
+        synth_tx_advance(s, now_s);
+        if (s->q_end > now_s && ring_samples) {
+            fifo_used = 255 * (s->q_end - now_s) / ring_samples;
+            if (fifo_used > 255)
+                fifo_used = 255;
+        }
+    }
+
+    stat[0] = ((s->seq & 0x3f) << 24) | ((s->aired & 0x3f) << 16) | 1;
+    stat[1] = (fifo_used << 16) | ((s->drop_fe & 0xff) << 8) | (s->drop_dma & 0xff);
+    stat[2] = (uint32_t)now_s;
+    stat[3] = (s->bursts_sent & 0xffff) << 16;
+}
+
+static int synth_ls_op(lldev_t dev, subdev_t subdev,
+                       unsigned ls_op, lsopaddr_t ls_op_addr,
+                       size_t meminsz, void* pin,
+                       size_t memoutsz, const void* pout)
+{
+    synth_dev_t* d = (synth_dev_t*)dev;
+
+    switch (ls_op) {
+    case USDR_LSOP_HWREG: {
+        uint32_t* ina = (uint32_t*)pin;
+        const uint32_t* outa = (const uint32_t*)pout;
+        uint32_t* file;
+        unsigned base, count;
+
+        if ((meminsz % 4) || (memoutsz % 4))
+            return -EINVAL;
+
+        if (ls_op_addr >= VIRT_CFG_SFX_BASE) {
+            file = d->vregs;
+            base = ls_op_addr - VIRT_CFG_SFX_BASE;
+            count = SYNTH_VIRT_REGS;
+        } else {
+            file = d->regs;
+            base = ls_op_addr;
+            count = SYNTH_REGS;
+        }
+
+        pthread_mutex_lock(&d->reg_lock);
+        for (unsigned i = 0; i < memoutsz / 4; i++) {
+            if (base + i < count)
+                file[base + i] = outa[i];
+        }
+        pthread_mutex_unlock(&d->reg_lock);
+
+        if (meminsz == 0)
+            return 0;
+
+        // Only indexed registers and TX statistics read back, the rest is write-only
+        if (file == d->regs && ls_op_addr >= M2PCI_REG_RD_TXDMA_STAT &&
+            ls_op_addr + meminsz / 4 <= M2PCI_REG_RD_TXDMA_STAT + 4) {
+            uint32_t stat[4] = { 0, 0, 0, 0 };
+            struct synth_stream* s = synth_get_stream(d, 1, false);
+            if (s) {
+                pthread_mutex_lock(&s->lock);
+                synth_tx_stat(d, s, stat);
+                pthread_mutex_unlock(&s->lock);
+            }
+            memcpy(ina, &stat[ls_op_addr - M2PCI_REG_RD_TXDMA_STAT], meminsz);
+            return 0;
+        }
+
+        pthread_mutex_lock(&d->reg_lock);
+        for (unsigned i = 0; i < meminsz / 4; i++) {
+            ina[i] = (file == d->vregs && base + i < count) ? file[base + i] : 0;
+        }
+        pthread_mutex_unlock(&d->reg_lock);
+        return 0;
+    }
+    case USDR_LSOP_SPI:
+    case USDR_LSOP_I2C_DEV:
+    case USDR_LSOP_DRP:
+    case USDR_LSOP_GPI:
+    case USDR_LSOP_GPO:
+        // No peripherals behind, reads as zeroes
+        if (meminsz)
+            memset(pin, 0, meminsz);
+        return 0;
+    }
+
+    return -EOPNOTSUPP;
+}
+
+static void synth_fill_tone(struct synth_stream* s)
+{
+    int16_t* iq = (int16_t*)s->mem;
+    size_t samples = (size_t)s->bufcnt * s->bufsz / (2 * sizeof(int16_t));
+
+    for (size_t i = 0; i < samples; i++) {
+        double ph = 2 * M_PI * (i % SYNTH_TONE_PERIOD) / SYNTH_TONE_PERIOD;
+        iq[2 * i + 0] = (int16_t)(16000 * cos(ph));
+        iq[2 * i + 1] = (int16_t)(16000 * sin(ph));
+    }
+}
+
+static int synth_stream_initialize(lldev_t dev, subdev_t subdev,
+                                   lowlevel_stream_params_t* params,
+                                   stream_t* channel)
+{
+    synth_dev_t* d = (synth_dev_t*)dev;
+    unsigned sno = params->streamno;
+    unsigned bufcnt = params->buffer_count;
+    unsigned bufsz = params->block_size ? params->block_size : SYNTH_DEF_BLOCK;
+    struct synth_stream* s;
+
+    if (sno >= SYNTH_MAX_STREAMS)
+        return -EINVAL;
+
+    s = &d->str[sno];
+    if (s->mem)
+        return -EBUSY;
+
+    if (bufcnt < 2 || bufcnt > SYNTH_MAX_BUFS || (bufcnt & (bufcnt - 1))) {
+        if (params->flags & LLSF_EXACT_VALUES)
+            return -EINVAL;
+
+        bufcnt = 32;
+    }
+
+    s->mem = (uint8_t*)aligned_alloc(64, ((size_t)bufcnt * bufsz + 63) & ~(size_t)63);
+    if (!s->mem)
+        return -ENOMEM;
+
+    s->rx = (sno % 2) == 0;
+    s->bufcnt = bufcnt;
+    s->bufsz = bufsz;
+    s->pktsyms = 0;
+    s->bits_per_sym = s->rx ? 0 : params->bits_per_sym;
+    s->t0 = 0;
+    s->wr = s->hand = s->rd = 0;
+    s->periods = 0;
+    s->pending_lost = 0;
+    s->seq = s->aired = 0;
+    s->q_end = 0;
+    s->drop_fe = s->drop_dma = s->bursts_sent = 0;
+    s->param = params->param;
+    s->soft_tx_fn = params->soft_tx_commit;
+    s->replay = d->replay[sno];
+    s->rec_pending = false;
+    s->replay_base = 0;
+    s->replay_last = 0;
+    if (s->replay) {
+        dma_trace_rewind(s->replay);
+    }
+
+    if (s->rx) {
+        synth_fill_tone(s);
+    } else {
+        memset(s->mem, 0, (size_t)bufcnt * bufsz);
+    }
+
+    *channel = sno;
+    params->underlying_fd = -1;
+    params->out_mtu_size = bufsz;
+    params->out_flags = (params->flags & LLSF_HOST_MEM) ? 0 : LLSOF_DEV_MEM;
+
+    USDR_LOG("SYNT", USDR_LOG_INFO, "Configured %s stream%d: %d X %d\n",
+             s->rx ? "RX" : "TX", sno, bufsz, bufcnt);
+    return 0;
+}
+
+static int synth_stream_deinitialize(lldev_t dev, subdev_t subdev, stream_t channel)
+{
+    synth_dev_t* d = (synth_dev_t*)dev;
+    struct synth_stream* s;
+
+    if (channel >= SYNTH_MAX_STREAMS)
+        return -EINVAL;
+
+    s = &d->str[channel];
+    if (!s->mem)
+        return -EINVAL;
+
+    pthread_mutex_lock(&s->lock);
+    free(s->mem);
+    s->mem = NULL;
+    pthread_mutex_unlock(&s->lock);
+    return 0;
+}
+
+// Device side of the RX ring up to the current time
+static void synth_rx_advance(synth_dev_t* d, struct synth_stream* s, uint64_t now, unsigned rate)
+{
+    uint64_t elapsed;
+
+    if (rate == 0) {
+        // Unpaced, a new packet is there whenever the host asks for it
+        elapsed = s->periods + ((s->wr == s->hand) ? 1 : 0);
+    } else {
+        elapsed = synth_ns_to_samples(now - s->t0, rate) / s->pktsyms;
+    }
+
+    while (s->periods < elapsed) {
+        unsigned idx = s->wr % s->bufcnt;
+
+        if (s->wr - s->rd == s->bufcnt) {
+            // Ring is full, everything up to now is lost
+            s->pending_lost += elapsed - s->periods;
+            s->periods = elapsed;
+            break;
+        }
+
+        if (d->ovf_every && (s->periods + 1) % d->ovf_every == 0) {
+            s->pending_lost++;
+        } else {
+            s->lost[idx] = (s->pending_lost > 0xffffff) ? 0xffffff : s->pending_lost;
+            s->ts[idx] = s->periods * (s->pktsyms ? s->pktsyms : 1);
+            s->pending_lost = 0;
+            s->wr++;
+        }
+        s->periods++;
+    }
+}
+
+// Next record of the type, waits for its time unless replaying at full speed
+static int synth_replay_next(synth_dev_t* d, struct synth_stream* s, unsigned type, unsigned timeout)
+{
+    uint64_t now = usdr_time_ns();
+    uint64_t deadline = now + (uint64_t)timeout * 1000000u;
+    int res;
+
+    if (s->t0 == 0)
+        s->t0 = now;
+
+    while (!s->rec_pending) {
+        res = dma_trace_read(s->replay, &s->rec, &s->rec_oob, &s->rec_data);
+        if (res == -ENODATA && d->replay_loop) {
+            s->replay_base += s->replay_last;
+            res = dma_trace_rewind(s->replay);
+            if (res == 0)
+                continue;
+        }
+        if (res)
+            return res;
+
+        s->replay_last = s->rec.t_ns;
+        s->rec_pending = (s->rec.type == type);
+    }
+
+    if (!d->replay_max) {
+        uint64_t at = s->t0 + s->replay_base + s->rec.t_ns;
+        if (at > deadline) {
+            synth_sleep_until(deadline);
+            return -ETIMEDOUT;
+        }
+        synth_sleep_until(at);
+    }
+
+    s->rec_pending = false;
+    return 0;
+}
+
+static int synth_replay_rx(synth_dev_t* d, struct synth_stream* s, void** buffer,
+                           void* oob_ptr, unsigned *oob_size, unsigned timeout)
+{
+    unsigned idx = s->hand % s->bufcnt;
+    int res;
+
+    if (s->hand - s->rd == s->bufcnt)
+        return -EBUSY;
+
+    res = synth_replay_next(d, s, DMT_RX_BUF, timeout);
+    if (res)
+        return res;
+
+    if (s->rec.res < 0)
+        return s->rec.res;
+
+    if (s->rec.data_len > s->bufsz) {
+        USDR_LOG("SYNT", USDR_LOG_ERROR, "Trace buffer is %d bytes, the stream is configured with %d, replay the trace with the recorded stream parameters\n",
+                 s->rec.data_len, s->bufsz);
+        return -EMSGSIZE;
+    }
+
+    memcpy(s->mem + (size_t)idx * s->bufsz, s->rec_data, s->rec.data_len);
+    *buffer = s->mem + (size_t)idx * s->bufsz;
+    if (oob_ptr && oob_size) {
+        unsigned sz = (s->rec.oob_size < *oob_size) ? s->rec.oob_size : *oob_size;
+        memcpy(oob_ptr, s->rec_oob, sz);
+        *oob_size = sz;
+    }
+
+    s->hand++;
+    s->wr = s->hand;
+    return s->rec.res;
+}
+
+static int synth_replay_tx(synth_dev_t* d, struct synth_stream* s, void** buffer,
+                           void* oob_ptr, unsigned *oob_size, unsigned timeout)
+{
+    int res = synth_replay_next(d, s, DMT_TX_GET, timeout);
+    if (res)
+        return res;
+
+    if (s->rec.res < 0)
+        return s->rec.res;
+
+    *buffer = s->mem + (size_t)(s->seq % s->bufcnt) * s->bufsz;
+    if (oob_ptr && oob_size) {
+        unsigned sz = (s->rec.oob_size < *oob_size) ? s->rec.oob_size : *oob_size;
+        memcpy(oob_ptr, s->rec_oob, sz);
+        *oob_size = sz;
+    }
+    return s->rec.res;
+}
+
+static int synth_recv_dma_wait(lldev_t dev, subdev_t subdev, stream_t channel, void** buffer,
+                               void* oob_ptr, unsigned *oob_size, unsigned timeout)
+{
+    synth_dev_t* d = (synth_dev_t*)dev;
+    struct synth_stream* s = synth_get_stream(d, channel, true);
+    uint64_t now, deadline;
+    unsigned rate;
+    int res;
+
+    if (!s)
+        return -EINVAL;
+
+    pthread_mutex_lock(&s->lock);
+    if (s->replay) {
+        res = synth_replay_rx(d, s, buffer, oob_ptr, oob_size, timeout);
+        pthread_mutex_unlock(&s->lock);
+        return res;
+    }
+
+    now = usdr_time_ns();
+    deadline = now + (uint64_t)timeout * 1000000u;
+    if (s->t0 == 0)
+        s->t0 = now;
+
+    for (;;) {
+        rate = (s->pktsyms) ? synth_rate(d, s) : 0;
+        synth_rx_advance(d, s, now, rate);
+        if (s->wr != s->hand)
+            break;
+
+        if (rate == 0) {
+            // Unpaced device never waits, the host holds every buffer
+            pthread_mutex_unlock(&s->lock);
+            return -EBUSY;
+        }
+
+        uint64_t next = s->t0 + synth_samples_to_ns((s->periods + 1) * s->pktsyms, rate);
+        if (next > deadline) {
+            pthread_mutex_unlock(&s->lock);
+            synth_sleep_until(deadline);
+            return -ETIMEDOUT;
+        }
+
+        pthread_mutex_unlock(&s->lock);
+        synth_sleep_until(next);
+        pthread_mutex_lock(&s->lock);
+        now = usdr_time_ns();
+    }
+
+    unsigned idx = s->hand % s->bufcnt;
+    *buffer = s->mem + (size_t)idx * s->bufsz;
+    if (oob_ptr && oob_size && *oob_size >= 2 * sizeof(uint64_t)) {
+        uint64_t* oob64 = (uint64_t*)oob_ptr;
+        uint32_t bursts = d->vregs[SYNTH_RXCFG_BBURSTSZ - VIRT_CFG_SFX_BASE] + 1;
+        uint64_t mask = (bursts >= 32) ? 0xffffffffu : (((1u << bursts) - 1) << (32 - bursts));
+
+        oob64[0] = (mask << 32) | s->lost[idx];
+        oob64[1] = s->ts[idx];
+        *oob_size = 2 * sizeof(uint64_t);
+    }
+
+    s->hand++;
+    res = s->wr - s->hand;
+    pthread_mutex_unlock(&s->lock);
+    return res;
+}
+
+static int synth_recv_dma_release(lldev_t dev, subdev_t subdev, stream_t channel, void* buffer)
+{
+    synth_dev_t* d = (synth_dev_t*)dev;
+    struct synth_stream* s = synth_get_stream(d, channel, true);
+    if (!s)
+        return -EINVAL;
+
+    pthread_mutex_lock(&s->lock);
+    if (s->rd != s->hand)
+        s->rd++;
+    pthread_mutex_unlock(&s->lock);
+    return 0;
+}
+
+static int synth_send_dma_get(lldev_t dev, subdev_t subdev, stream_t channel, void** buffer,
+                              void* oob_ptr, unsigned *oob_size, unsigned timeout)
+{
+    synth_dev_t* d = (synth_dev_t*)dev;
+    struct synth_stream* s = synth_get_stream(d, channel, false);
+    uint64_t deadline;
+    unsigned rate;
+    int res;
+
+    if (!s)
+        return -EINVAL;
+
+    pthread_mutex_lock(&s->lock);
+    if (s->replay) {
+        res = synth_replay_tx(d, s, buffer, oob_ptr, oob_size, timeout);
+        pthread_mutex_unlock(&s->lock);
+        return res;
+    }
+
+    deadline = usdr_time_ns() + (uint64_t)timeout * 1000000u;
+
+    for (;;) {
+        rate = synth_rate(d, s);
+        if (rate == 0 || s->t0 == 0) {
+            s->aired = s->seq;
+            break;
+        }
+
+        synth_tx_advance(s, synth_ns_to_samples(usdr_time_ns() - s->t0, rate));
+        if (s->seq - s->aired < s->bufcnt)
+            break;
+
+        uint64_t next = s->t0 + synth_samples_to_ns(s->slot_end[s->aired % s->bufcnt], rate);
+        if (next > deadline) {
+            pthread_mutex_unlock(&s->lock);
+            synth_sleep_until(deadline);
+            return -ETIMEDOUT;
+        }
+
+        pthread_mutex_unlock(&s->lock);
+        synth_sleep_until(next);
+        pthread_mutex_lock(&s->lock);
+    }
+
+    *buffer = s->mem + (size_t)(s->seq % s->bufcnt) * s->bufsz;
+    if (oob_ptr && oob_size && *oob_size >= 4 * sizeof(uint32_t)) {
+        synth_tx_stat(d, s, (uint32_t*)oob_ptr);
+        *oob_size = 4 * sizeof(uint32_t);
+    }
+
+    res = s->bufcnt - (s->seq - s->aired) - 1;
+    pthread_mutex_unlock(&s->lock);
+    return res;
+}
+
+static int synth_send_dma_commit(lldev_t dev, subdev_t subdev, stream_t channel, void* buffer,
+                                 unsigned sz, const void* oob_ptr, unsigned oob_size)
+{
+    synth_dev_t* d = (synth_dev_t*)dev;
+    struct synth_stream* s = synth_get_stream(d, channel, false);
+    const uint64_t* oob = (const uint64_t*)oob_ptr;
+    int64_t ts = (oob && oob_size >= sizeof(uint64_t)) ? (int64_t)oob[0] : -1;
+    unsigned rate;
+    int res;
+
+    if (!s)
+        return -EINVAL;
+
+    if (s->bufsz < sz) {
+        USDR_LOG("SYNT", USDR_LOG_CRITICAL_WARNING, "Stream was configured with %d DMA buffer but tried to write %d!\n",
+                 s->bufsz, sz);
+        return -EINVAL;
+    }
+
+    // Same register traffic as the real core
+    if (s->soft_tx_fn) {
+        res = s->soft_tx_fn(s->param, sz, oob_ptr, oob_size);
+        if (res)
+            return res;
+    }
+
+    pthread_mutex_lock(&s->lock);
+    uint64_t now = usdr_time_ns();
+    unsigned idx = s->seq % s->bufcnt;
+
+    if (s->t0 == 0)
+        s->t0 = now;
+
+    rate = synth_rate(d, s);
+    s->slot_end[idx] = 0;
+
+    if (s->replay) {
+        // Statistics come from the trace
+    } else if (d->udr_every && (s->seq + 1) % d->udr_every == 0) {
+        s->drop_fe++;
+    } else if (rate) {
+        uint64_t now_s = synth_ns_to_samples(now - s->t0, rate);
+
+        if (s->q_end < now_s) {
+            if (s->seq != 0)
+                s->drop_fe++;
+            s->q_end = now_s;
+        }
+
+        if (ts >= 0 && ts != INT64_MAX && (uint64_t)ts < s->q_end) {
+            s->drop_dma++;
+        } else {
+            if (ts >= 0 && ts != INT64_MAX)
+                s->q_end = ts;
+
+            s->q_end += synth_tx_buf_samples(s, sz);
+            s->slot_end[idx] = s->q_end;
+            s->bursts_sent++;
+        }
+    } else {
+        s->bursts_sent++;
+    }
+
+    s->seq++;
+    pthread_mutex_unlock(&s->lock);
+    return 0;
+}
+
+static int synth_recv_buf(lldev_t dev, subdev_t subdev, stream_t channel, void** buffer, unsigned *expected_sz, void* oob_ptr, unsigned *oob_size, unsigned timeout)
+{
+    return -ENOTSUP;
+}
+
+static int synth_send_buf(lldev_t dev, subdev_t subdev, stream_t channel, void* buffer, unsigned sz, const void* oob_ptr, unsigned oob_size, unsigned timeout)
+{
+    return -ENOTSUP;
+}
+
+static int synth_await(lldev_t dev, subdev_t subdev, unsigned await_id, unsigned op, void** await_inout_aux_data, unsigned timeout)
+{
+    return -ENOTSUP;
+}
+
+static int synth_destroy(lldev_t dev)
+{
+    synth_dev_t* d = (synth_dev_t*)dev;
+
+    if (dev->pdev) {
+        dev->pdev->destroy(dev->pdev);
+    }
+
+    for (unsigned sno = 0; sno < SYNTH_MAX_STREAMS; sno++) {
+        free(d->str[sno].mem);
+        pthread_mutex_destroy(&d->str[sno].lock);
+        dma_trace_close(d->replay[sno]);
+    }
+    pthread_mutex_destroy(&d->reg_lock);
+
+    USDR_LOG("SYNT", USDR_LOG_INFO, "Device %s destroyed!\n", d->name);
+    free(d);
+    return 0;
+}
+
+int synth_ll_set_rate(lldev_t dev, unsigned rx_rate, unsigned tx_rate)
+{
+    synth_dev_t* d = (synth_dev_t*)dev;
+    __atomic_store_n(&d->rate[0], rx_rate, __ATOMIC_RELAXED);
+    __atomic_store_n(&d->rate[1], tx_rate, __ATOMIC_RELAXED);
+    return 0;
+}
+
+int synth_ll_set_pktsyms(lldev_t dev, stream_t channel, unsigned pktsyms)
+{
+    synth_dev_t* d = (synth_dev_t*)dev;
+    if (channel >= SYNTH_MAX_STREAMS || !d->str[channel].mem)
+        return -EINVAL;
+
+    pthread_mutex_lock(&d->str[channel].lock);
+    d->str[channel].pktsyms = pktsyms;
+    pthread_mutex_unlock(&d->str[channel].lock);
+    return 0;
+}
+
+// Device operations
+static
+struct lowlevel_ops s_synth_ops = {
+    synth_generic_get,
+    synth_ls_op,
+    synth_stream_initialize,
+    synth_stream_deinitialize,
+    synth_recv_dma_wait,
+    synth_recv_dma_release,
+    synth_send_dma_get,
+    synth_send_dma_commit,
+    synth_recv_buf,
+    synth_send_buf,
+    synth_await,
+    synth_destroy,
+};
+
+// Factory functions
+static
+const char* synth_plugin_info_str(unsigned iparam) {
+    switch (iparam) {
+    case LLPI_NAME_STR: return "synth";
+    case LLPI_DESCRIPTION_STR: return "Synthetic streaming device";
+    }
+    return NULL;
+}
+
+// Never picked up implicitly unless USDR_SYNTH is set
+static int synth_filtering_params_parse(unsigned pcount, const char** filterparams,
+                                        const char** filtervals)
+{
+    bool bus = false;
+
+    for (unsigned k = 0; k < pcount; k++) {
+        const char* val = filtervals[k];
+        if (strcmp(filterparams[k], "bus") == 0) {
+            if (val == NULL || strncmp(val, "synth", 5) != 0)
+                return -ENODEV;
+
+            bus = true;
+        } else if (strcmp(filterparams[k], "dev") == 0 || strcmp(filterparams[k], "device") == 0) {
+            if (val == NULL || strcmp(val, "synth0") != 0)
+                return -ENODEV;
+        }
+    }
+
+    if (!bus && getenv("USDR_SYNTH") == NULL)
+        return -ENODEV;
+
+    return 0;
+}
+
+static
+int synth_plugin_discovery(unsigned pcount, const char** filterparams, const char** filtervals, unsigned maxbuf, char* outarray)
+{
+    int res = synth_filtering_params_parse(pcount, filterparams, filtervals);
+    if (res)
+        return res;
+
+    int l = snprintf(outarray, maxbuf, "bus=synth,device=synth0\n");
+    if (l < 0 || (unsigned)l >= maxbuf) {
+        if (maxbuf)
+            outarray[0] = 0;
+        return -ENOMEM;
+    }
+
+    return 1;
+}
+
+static
+int synth_plugin_create(unsigned pcount, const char** devparam, const char** devval, lldev_t* odev,
+                        unsigned vidpid, void* webops, uintptr_t param)
+{
+    const device_id_t did = SYNTH_DEVICE_ID_C;
+    synth_dev_t* dev;
+    int err = synth_filtering_params_parse(pcount, devparam, devval);
+    if (err)
+        return err;
+
+    dev = (synth_dev_t*)calloc(1, sizeof(synth_dev_t));
+    if (dev == NULL)
+        return -ENOMEM;
+
+    dev->ll.ops = &s_synth_ops;
+    dev->devid = did;
+    dev->pace = true;
+    strncpy(dev->name, "synth0", sizeof(dev->name) - 1);
+    pthread_mutex_init(&dev->reg_lock, NULL);
+    for (unsigned sno = 0; sno < SYNTH_MAX_STREAMS; sno++) {
+        pthread_mutex_init(&dev->str[sno].lock, NULL);
+    }
+
+    for (unsigned k = 0; k < pcount; k++) {
+        if (devval[k] == NULL)
+            continue;
+
+        if (strcmp(devparam[k], "synthpace") == 0) {
+            dev->pace = atoi(devval[k]) != 0;
+        } else if (strcmp(devparam[k], "synthovf") == 0) {
+            dev->ovf_every = atoi(devval[k]);
+        } else if (strcmp(devparam[k], "synthudr") == 0) {
+            dev->udr_every = atoi(devval[k]);
+        } else if (strcmp(devparam[k], "replayspeed") == 0) {
+            dev->replay_max = strcmp(devval[k], "max") == 0;
+        } else if (strcmp(devparam[k], "replayloop") == 0) {
+            dev->replay_loop = atoi(devval[k]) != 0;
+        } else if (strcmp(devparam[k], "replayrx") == 0 || strcmp(devparam[k], "replaytx") == 0) {
+            unsigned sno = (devparam[k][6] == 'r') ? 0 : 1;
+            dma_trace_hdr_t hdr;
+
+            dma_trace_close(dev->replay[sno]);
+            dev->replay[sno] = NULL;
+
+            err = dma_trace_open(devval[k], &hdr, &dev->replay[sno]);
+            if (err)
+                goto remove_dev;
+
+            if (hdr.dir != ((sno == 0) ? DMT_DIR_RX : DMT_DIR_TX)) {
+                USDR_LOG("SYNT", USDR_LOG_ERROR, "`%s` is a %s trace\n", devval[k], hdr.dir == DMT_DIR_RX ? "RX" : "TX");
+                err = -EINVAL;
+                goto remove_dev;
+            }
+
+            USDR_LOG("SYNT", USDR_LOG_INFO, "Replaying %s trace `%s`: format %s, %d channels, %d samples, %d bytes in %d bursts\n",
+                     (sno == 0) ? "RX" : "TX", devval[k], hdr.format, hdr.channels, hdr.pkt_symbs, hdr.pkt_bytes, hdr.burst_count);
+        }
+    }
+    if (dev->ovf_every == 1 || dev->udr_every == 1) {
+        USDR_LOG("SYNT", USDR_LOG_ERROR, "Can't drop every single packet!\n");
+        err = -EINVAL;
+        goto remove_dev;
+    }
+
+    USDR_LOG("SYNT", USDR_LOG_INFO, "Synthetic device: pacing %s, overrun every %d, underrun every %d\n",
+             dev->pace ? "on" : "off", dev->ovf_every, dev->udr_every);
+
+    err = usdr_device_create(&dev->ll, did);
+    if (err) {
+        USDR_LOG("SYNT", USDR_LOG_ERROR, "Unable to find device spec for uuid %s!\n",
+                 usdr_device_id_to_str(did));
+        goto remove_dev;
+    }
+
+    err = usdr_device_initialize(dev->ll.pdev, pcount, devparam, devval);
+    if (err) {
+        USDR_LOG("SYNT", USDR_LOG_ERROR, "Unable to initialize device, error %d\n", err);
+        dev->ll.pdev->destroy(dev->ll.pdev);
+        goto remove_dev;
+    }
+
+    *odev = &dev->ll;
+    return 0;
+
+remove_dev:
+    for (unsigned sno = 0; sno < SYNTH_MAX_STREAMS; sno++) {
+        pthread_mutex_destroy(&dev->str[sno].lock);
+        dma_trace_close(dev->replay[sno]);
+    }
+    pthread_mutex_destroy(&dev->reg_lock);
+    free(dev);
+    return err;
+}
+
+// Factory operations
+static const
+struct lowlevel_plugin s_synth_plugin = {
+    synth_plugin_info_str,
+    synth_plugin_discovery,
+    synth_plugin_create,
+};
+
+
+const struct lowlevel_plugin *synth_register()
+{
+    return &s_synth_plugin;
+}
@@ -0,0 +1,27 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#ifndef SYNTH_LL_H
+#define SYNTH_LL_H
+
+#include "../usdr_lowlevel.h"
+
+// Synthetic lowlevel backend, emulates the generic uSDR register map and
+// the PCIe RX/TX DMA rings without any hardware. Created with `bus=synth`,
+// extra connection parameters:
+//   synthpace=0  -- don't pace the streams by the sample rate, run at full speed
+//   synthovf=N   -- drop every N-th RX packet in the device (overrun)
+//   synthudr=N   -- drop every N-th TX burst in the frontend (underrun)
+//   replayrx=F   -- RX buffers and OOB from trace F instead of the emulation
+//   replaytx=F   -- TX statistics from trace F
+//   replayspeed=recorded|max -- replay pace, recorded by default
+//   replayloop=1 -- start over at the end of the trace, otherwise -ENODATA
+// Unfiltered discovery lists the device only when USDR_SYNTH is set.
+
+// Sample rates used to pace the streams, 0 -- as fast as the host goes
+int synth_ll_set_rate(lldev_t dev, unsigned rx_rate, unsigned tx_rate);
+
+// Samples in a full DMA buffer, the real core derives it from the FE configuration
+int synth_ll_set_pktsyms(lldev_t dev, stream_t channel, unsigned pktsyms);
+
+#endif
@@ -0,0 +1,117 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#include "usb_depth_ctrl.h"
+
+void usb_depth_ctrl_init(usb_depth_ctrl_t* c, unsigned min_depth, unsigned max_depth,
+                         unsigned depth, unsigned latency_us)
+{
+    if (min_depth == 0)
+        min_depth = 1;
+    if (max_depth < min_depth)
+        max_depth = min_depth;
+    if (depth < min_depth)
+        depth = min_depth;
+    if (depth > max_depth)
+        depth = max_depth;
+
+    c->min_depth = min_depth;
+    c->max_depth = max_depth;
+    c->depth = depth;
+    c->latency_us = latency_us;
+
+    c->period_us = 0;
+    c->grows = 0;
+    c->shrinks = 0;
+
+    c->last_ts = 0;
+    c->win_start_ts = 0;
+    c->win_cnt = 0;
+    c->win_max_gap = 0;
+    c->win_overflows = 0;
+    c->calm_windows = 0;
+}
+
+void usb_depth_ctrl_set_latency(usb_depth_ctrl_t* c, unsigned latency_us)
+{
+    c->latency_us = latency_us;
+}
+
+static unsigned _usb_depth_ctrl_limit(const usb_depth_ctrl_t* c, unsigned period)
+{
+    unsigned lat_depth;
+    if (c->latency_us == 0)
+        return c->max_depth;
+
+    lat_depth = c->latency_us / period;
+    if (lat_depth < c->min_depth)
+        return c->min_depth;
+    if (lat_depth > c->max_depth)
+        return c->max_depth;
+    return lat_depth;
+}
+
+unsigned usb_depth_ctrl_update(usb_depth_ctrl_t* c, uint64_t ts_us, unsigned overflows)
+{
+    uint64_t gap;
+    uint64_t period;
+    uint64_t buffered, buffered_less;
+    unsigned depth, limit;
+    bool stress;
+
+    c->win_overflows += overflows;
+    if (c->last_ts == 0) {
+        c->last_ts = ts_us;
+        c->win_start_ts = ts_us;
+        return c->depth;
+    }
+
+    gap = ts_us - c->last_ts;
+    c->last_ts = ts_us;
+    if (gap > c->win_max_gap)
+        c->win_max_gap = (gap > UINT32_MAX) ? UINT32_MAX : (unsigned)gap;
+    if (++c->win_cnt < USB_DEPTH_CTRL_WINDOW)
+        return c->depth;
+
+    // Lost blocks took their slots in the device stream too
+    period = (ts_us - c->win_start_ts) / (c->win_cnt + c->win_overflows);
+    if (period == 0)
+        period = 1;
+    c->period_us = (period > UINT32_MAX) ? UINT32_MAX : (unsigned)period;
+
+    // Time the device keeps streaming into queued transfers while the host is late
+    depth = c->depth;
+    buffered = (depth - 1) * period;
+    buffered_less = (depth > 2) ? (depth - 2) * period : 0;
+
+    stress = (c->win_overflows != 0) || (4 * (uint64_t)c->win_max_gap >= 3 * buffered);
+    if (stress) {
+        depth += (depth / 2) ? depth / 2 : 1;
+        c->calm_windows = 0;
+    } else if (2 * (uint64_t)c->win_max_gap < buffered_less) {
+        if (++c->calm_windows >= USB_DEPTH_CTRL_CALM_WINDOWS) {
+            depth--;
+            c->calm_windows = 0;
+        }
+    } else {
+        c->calm_windows = 0;
+    }
+
+    limit = _usb_depth_ctrl_limit(c, c->period_us);
+    if (depth > limit)
+        depth = limit;
+    if (depth < c->min_depth)
+        depth = c->min_depth;
+
+    if (depth > c->depth)
+        c->grows++;
+    else if (depth < c->depth)
+        c->shrinks++;
+    c->depth = depth;
+
+    c->win_start_ts = ts_us;
+    c->win_cnt = 0;
+    c->win_max_gap = 0;
+    c->win_overflows = 0;
+    return depth;
+}
@@ -0,0 +1,51 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#ifndef USB_DEPTH_CTRL_H
+#define USB_DEPTH_CTRL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Adaptive number of in-flight stream transfers. Fed with every completion
+// timestamp and device overflow counter; the depth grows when completions
+// are late compared to the buffering in flight or the device overflows, and
+// shrinks back after a calm period. Data buffered in flight never exceeds
+// latency_us unless it's below min_depth transfers.
+enum {
+    USB_DEPTH_CTRL_WINDOW = 32,       // completions per decision
+    USB_DEPTH_CTRL_CALM_WINDOWS = 8,  // calm windows in a row before shrinking
+};
+
+struct usb_depth_ctrl {
+    unsigned min_depth;
+    unsigned max_depth;
+    unsigned depth;
+    unsigned latency_us;   // 0 - no latency bound
+
+    unsigned period_us;    // average completion period of the last window
+    unsigned grows;
+    unsigned shrinks;
+
+    // Current window
+    uint64_t last_ts;
+    uint64_t win_start_ts;
+    unsigned win_cnt;
+    unsigned win_max_gap;
+    unsigned win_overflows;
+    unsigned calm_windows;
+};
+typedef struct usb_depth_ctrl usb_depth_ctrl_t;
+
+void usb_depth_ctrl_init(usb_depth_ctrl_t* c, unsigned min_depth, unsigned max_depth,
+                         unsigned depth, unsigned latency_us);
+
+// Takes effect on the next window
+void usb_depth_ctrl_set_latency(usb_depth_ctrl_t* c, unsigned latency_us);
+
+// ts_us is a monotonic completion timestamp, overflows is the number of
+// data blocks (or bursts, if that's all the device reports) lost since the
+// previous completion. Returns the desired depth.
+unsigned usb_depth_ctrl_update(usb_depth_ctrl_t* c, uint64_t ts_us, unsigned overflows);
+
+#endif
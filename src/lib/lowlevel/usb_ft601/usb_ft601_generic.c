@@ -62,12 +62,14 @@ int usbft601_ctrl_transfer(lldev_t lld, uint8_t cmd, const uint8_t* data_in, uns
         goto failed;
     }
 
-    // Return status of transfer
-    switch (gen->data_ctrl_in[0].status) {
-    case STATUS_COMPLETED_CMD: res = 0; break;
-    case STATUS_UNKNOWN_CMD: res = -ENOENT; break;
-    case STATUS_BUSY_CMD: res = -EBUSY; break;
-    default: res = -EFAULT; break;
+    // Return status of transfer, every packet of a burst is acknowledged separately
+    for (int i = 0; i < cnt && res == 0; i++) {
+        switch (gen->data_ctrl_in[i].status) {
+        case STATUS_COMPLETED_CMD: res = 0; break;
+        case STATUS_UNKNOWN_CMD: res = -ENOENT; break;
+        case STATUS_BUSY_CMD: res = -EBUSY; break;
+        default: res = -EFAULT; break;
+        }
     }
 
 failed:
@@ -114,7 +116,7 @@ int usbft601_uram_ls_op(lldev_t dev, subdev_t subdev,
         break;
 
     case USDR_LSOP_SPI:
-        // TODO split to RD / WR packets
+        // Mixed RD / WR sequences are split by usbft601_uram_ls_batch()
         if (pin == NULL || meminsz == 0 || ((*(const uint32_t*)pout) & 0x80000000) != 0) {
             res = usbft601_ctrl_transfer(dev, CMD_LMS7002_WR, (const uint8_t* )pout, memoutsz, (uint8_t* )pin, meminsz, timeout_ms);
         } else {
@@ -141,6 +143,117 @@ int usbft601_uram_ls_op(lldev_t dev, subdev_t subdev,
     return res;
 }
 
+enum ft601_batch_kind {
+    FT601_BATCH_NONE,
+    FT601_BATCH_SPI_WR,
+    FT601_BATCH_SPI_RD,
+    FT601_BATCH_REG_WR,
+    FT601_BATCH_REG_RD,
+};
+
+static unsigned usbft601_batch_kind(const lowlevel_ls_batch_op_t* op)
+{
+    switch (op->ls_op) {
+    case USDR_LSOP_SPI:
+        if (op->memoutsz != 4)
+            break;
+        if (op->pin == NULL || op->meminsz == 0)
+            return FT601_BATCH_SPI_WR;
+        if ((op->meminsz == 4) && ((*(const uint32_t*)op->pout) & 0x80000000) == 0)
+            return FT601_BATCH_SPI_RD;
+        break;
+    case USDR_LSOP_HWREG:
+        if (op->memoutsz == 2 && (op->pin == NULL || op->meminsz == 0))
+            return FT601_BATCH_REG_WR;
+        if (op->meminsz == 2 && (op->pout == NULL || op->memoutsz == 0))
+            return FT601_BATCH_REG_RD;
+        break;
+    }
+    return FT601_BATCH_NONE;
+}
+
+// Execute run of the same kind transactions as one LMS64C command
+static int usbft601_batch_flush(lldev_t dev, unsigned kind, lowlevel_ls_batch_op_t* ops, unsigned count)
+{
+    int res;
+    unsigned timeout_ms = 3000;
+    uint16_t tmpbuf_out[2 * MAX_CTRL_BATCH] = { 0 };
+    uint16_t tmpbuf_in[MAX_CTRL_BATCH];
+
+    switch (kind) {
+    case FT601_BATCH_SPI_WR:
+        for (unsigned i = 0; i < count; i++) {
+            memcpy(&tmpbuf_out[2 * i], ops[i].pout, 4);
+        }
+        return usbft601_ctrl_transfer(dev, CMD_LMS7002_WR, (const uint8_t* )tmpbuf_out, 4 * count, NULL, 0, timeout_ms);
+
+    case FT601_BATCH_REG_WR:
+        for (unsigned i = 0; i < count; i++) {
+            tmpbuf_out[2 * i + 1] = ops[i].ls_op_addr;
+            tmpbuf_out[2 * i + 0] = *(const uint16_t*)ops[i].pout;
+        }
+        return usbft601_ctrl_transfer(dev, CMD_BRDSPI_WR, (const uint8_t* )tmpbuf_out, 4 * count, NULL, 0, timeout_ms);
+
+    case FT601_BATCH_SPI_RD:
+    case FT601_BATCH_REG_RD:
+        for (unsigned i = 0; i < count; i++) {
+            tmpbuf_out[i] = (kind == FT601_BATCH_SPI_RD) ? (*(const uint32_t*)ops[i].pout) >> 16 : ops[i].ls_op_addr;
+        }
+        res = usbft601_ctrl_transfer(dev, (kind == FT601_BATCH_SPI_RD) ? CMD_LMS7002_RD : CMD_BRDSPI_RD,
+                                     (const uint8_t* )tmpbuf_out, 2 * count, (uint8_t* )tmpbuf_in, 2 * count, timeout_ms);
+        if (res)
+            return res;
+
+        for (unsigned i = 0; i < count; i++) {
+            if (kind == FT601_BATCH_SPI_RD) {
+                *(uint32_t*)ops[i].pin = tmpbuf_in[i];
+            } else {
+                *(uint16_t*)ops[i].pin = tmpbuf_in[i];
+            }
+        }
+        return 0;
+    }
+
+    return -EINVAL;
+}
+
+int usbft601_uram_ls_batch(lldev_t dev, subdev_t subdev,
+                           lowlevel_ls_batch_op_t* ops, unsigned count)
+{
+    int res;
+
+    for (unsigned i = 0; i < count; ) {
+        unsigned kind = usbft601_batch_kind(&ops[i]);
+        unsigned j;
+
+        if (kind == FT601_BATCH_NONE) {
+            res = usbft601_uram_ls_op(dev, subdev, ops[i].ls_op, ops[i].ls_op_addr,
+                                      ops[i].meminsz, ops[i].pin, ops[i].memoutsz, ops[i].pout);
+            if (res)
+                return res;
+
+            i++;
+            continue;
+        }
+
+        for (j = i + 1; j < count && j - i < MAX_CTRL_BATCH; j++) {
+            if (usbft601_batch_kind(&ops[j]) != kind)
+                break;
+        }
+
+        USDR_LOG(USBG_LOG_TAG, USDR_LOG_DEBUG, "%s: Coalesced %d transactions of type %d\n",
+                 lowlevel_get_devname(dev), j - i, kind);
+
+        res = usbft601_batch_flush(dev, kind, &ops[i], j - i);
+        if (res)
+            return res;
+
+        i = j;
+    }
+
+    return 0;
+}
+
 int usbft601_uram_get_info(lldev_t lld, ft601_device_info_t* info)
 {
     uint8_t tmpdata[32];
@@ -216,7 +329,7 @@ int usbft601_uram_generic_create_and_init(lldev_t lld, unsigned pcount, const ch
 
     // Register operations are now available
 
-    res = lld->pdev->initialize(lld->pdev, pcount, devparam, devval);
+    res = usdr_device_initialize(lld->pdev, pcount, devparam, devval);
     if (res) {
         USDR_LOG(USBG_LOG_TAG, USDR_LOG_ERROR,
                  "Unable to initialize device, error %d\n", res);
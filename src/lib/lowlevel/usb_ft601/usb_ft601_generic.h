@@ -40,6 +40,10 @@ enum {
     MAX_OUT_STRM_REQS = 16,
 
     MAX_CTRL_BURST = 64,
+
+    // Max register transactions coalesced into a single LMS64C command. Callers
+    // going through lowlevel_spi_post32() hand over LOWLEVEL_LS_BATCH_MAX at once
+    MAX_CTRL_BATCH = MAX_CTRL_BURST * LMS64C_DATA_LENGTH / 4,
 };
 
 enum {
@@ -145,6 +149,9 @@ int usbft601_uram_ls_op(lldev_t dev, subdev_t subdev,
                         size_t meminsz, void* pin,
                         size_t memoutsz, const void* pout);
 
+int usbft601_uram_ls_batch(lldev_t dev, subdev_t subdev,
+                           lowlevel_ls_batch_op_t* ops, unsigned count);
+
 int usbft601_uram_get_info(lldev_t dev, ft601_device_info_t* info);
 
 int usbft601_uram_generic_create_and_init(lldev_t lld, unsigned pcount, const char** devparam,
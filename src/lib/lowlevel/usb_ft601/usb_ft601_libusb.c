@@ -134,6 +134,7 @@ int usbft601_uram_ctrl_in_pkt(lldev_t lld, unsigned pkt_szb, unsigned timeout_ms
 
     transfer->length = pkt_szb;
     transfer->buffer = (uint8_t*)d->ft601_generic.data_ctrl_in;
+    d->len_ctrl_in_rb = 0;
 
     res = libusb_to_errno(libusb_submit_transfer(transfer));
     if (res) {
@@ -159,7 +160,7 @@ static void usbft601_sem_ctrl_out_post(lldev_t lld)
 void LIBUSB_CALL libusb_transfer_ctrl_rb(struct libusb_transfer *transfer)
 {
     usbft601_dev_t* dev = (usbft601_dev_t*)transfer->user_data;
-    dev->len_ctrl_in_rb = transfer->actual_length;
+    dev->len_ctrl_in_rb += transfer->actual_length;
     const proto_lms64c_t* d = &dev->ft601_generic.data_ctrl_in[0];
 
     USDR_LOG("USBX", USDR_LOG_DEBUG, "     RB transfer %d / %d <= { %02x %02x %02x %02x  %02x %02x %02x %02x | %02x %02x %02x %02x  %02x %02x %02x %02x  ... }\n",
@@ -175,6 +176,18 @@ void LIBUSB_CALL libusb_transfer_ctrl_rb(struct libusb_transfer *transfer)
         return;
     }
 
+    // Replies to a burst may come packet by packet, wait for the rest of them
+    if (transfer->actual_length > 0 && transfer->actual_length < transfer->length) {
+        transfer->buffer += transfer->actual_length;
+        transfer->length -= transfer->actual_length;
+
+        int res = libusb_submit_transfer(transfer);
+        if (res == 0)
+            return;
+
+        USDR_LOG("USBX", USDR_LOG_ERROR, "FAILED to repost RB transfer %d\n", res);
+    }
+
     sem_post(&dev->tr_ctrl_rb);
 }
 
@@ -186,6 +199,7 @@ int usbft601_uram_stream_initialize(lldev_t dev, subdev_t subdev,
     usbft601_dev_t* d = (usbft601_dev_t*)dev;
     struct buffers *prxb = (params->streamno == DEV_RX_STREAM_NO) ? &d->rx_strms[0] : &d->tx_strms[0];
     bool eventtype = (params->flags & LLSF_NEED_FDPOLL) == LLSF_NEED_FDPOLL;
+    bool host_mem = (params->flags & LLSF_HOST_MEM) == LLSF_HOST_MEM;
     int res = 0;
     unsigned buffers_cnt = params->buffer_count;
     if (buffers_cnt > MAX_OUT_STRM_REQS)
@@ -198,7 +212,7 @@ int usbft601_uram_stream_initialize(lldev_t dev, subdev_t subdev,
     res = res ? res : buffers_usb_init(&d->gdev, prxb, buffers_cnt, (params->streamno == DEV_RX_STREAM_NO) ? 2 * buffers_cnt : buffers_cnt,
                            params->block_size,
                            data_endpoint,
-                           eventtype);
+                           eventtype, host_mem);
     if (res)
         return res;
 
@@ -216,6 +230,7 @@ int usbft601_uram_stream_initialize(lldev_t dev, subdev_t subdev,
     }
 
     params->underlying_fd = (eventtype) ? prxb->fd_event : -1;
+    params->out_flags = (prxb->dev_mem) ? LLSOF_DEV_MEM : 0;
     *channel = params->streamno;
     return 0;
 }
@@ -410,6 +425,7 @@ struct lowlevel_ops s_usbft601_uram_ops = {
     usbft601_uram_send_buf,
     usbft601_uram_await,
     usbft601_uram_destroy,
+    usbft601_uram_ls_batch,
 };
 
 static
@@ -161,7 +161,8 @@ static
         NULL,                       //recv_buf,
         NULL,                       //send_buf,
         NULL,                       //await,
-        &webusb_ll_destroy
+        &webusb_ll_destroy,
+        &usbft601_uram_ls_batch,
 };
 
 static
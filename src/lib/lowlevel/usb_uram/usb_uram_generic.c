@@ -5,6 +5,7 @@
 #include <string.h>
 #include <stdio.h>
 #include "../../device/generic_usdr/generic_regs.h"
+#include "../../common/parse_params.h"
 
 usb_uram_generic_t* get_uram_generic(lldev_t dev);
 
@@ -144,6 +145,24 @@ int usb_uram_reg_op(lldev_t dev, unsigned ls_op_addr,
     return 0;
 }
 
+static void usb_uram_i2c_unpack(uint32_t data, size_t meminsz, void* pin)
+{
+    uint8_t* di = (uint8_t*)pin;
+
+    if (meminsz == 1) {
+        di[0] = data;
+    } else if (meminsz == 2) {
+        di[0] = data;
+        di[1] = data >> 8;
+    } else if (meminsz == 3) {
+        di[0] = data;
+        di[1] = data >> 8;
+        di[2] = data >> 16;
+    } else {
+        *(uint32_t*)pin = data;
+    }
+}
+
 int usb_uram_ls_op(lldev_t dev, subdev_t subdev,
                    unsigned ls_op, lsopaddr_t ls_op_addr,
                    size_t meminsz, void* pin,
@@ -194,7 +213,6 @@ int usb_uram_ls_op(lldev_t dev, subdev_t subdev,
     case USDR_LSOP_I2C_DEV: {
         uint32_t i2ccmd[2], data = 0;
         const uint8_t* dd = (const uint8_t*)pout;
-        uint8_t* di = (uint8_t*)pin;
         uint8_t instance_no = LSOP_I2C_INSTANCE(ls_op_addr);
         uint8_t bus_no = LSOP_I2C_BUSNO(ls_op_addr);
         uint8_t i2caddr = LSOP_I2C_ADDR(ls_op_addr);
@@ -227,18 +245,7 @@ int usb_uram_ls_op(lldev_t dev, subdev_t subdev,
             if (res)
                 return res;
 
-            if (meminsz == 1) {
-                di[0] = data;
-            } else if (meminsz == 2) {
-                di[0] = data;
-                di[1] = data >> 8;
-            } else if (meminsz == 3) {
-                di[0] = data;
-                di[1] = data >> 8;
-                di[2] = data >> 16;
-            } else {
-                *(uint32_t*)pin = data;
-            }
+            usb_uram_i2c_unpack(data, meminsz, pin);
         }
         return 0;
     }
@@ -255,6 +262,164 @@ int usb_uram_ls_op(lldev_t dev, subdev_t subdev,
     return -EOPNOTSUPP;
 }
 
+static inline uint32_t usb_uram_seq_wr_hdr(unsigned addr, unsigned dwcnt)
+{
+    return (((dwcnt - 1) & 0x3f) << 16) | (addr & 0xffff);
+}
+
+// Encode SPI/I2C transaction into the same register writes usb_uram_ls_op() does,
+// -EOPNOTSUPP is returned for operations which can't be queued
+int usb_uram_seq_encode(usb_uram_generic_t* gen, const lowlevel_ls_batch_op_t* op,
+                        uint32_t* cmds, unsigned* pdwcnt, bool* pwait)
+{
+    int res;
+    device_bus_t* pdb = &gen->db;
+
+    switch (op->ls_op) {
+    case USDR_LSOP_SPI: {
+        unsigned bus = SPIEXT_LSOP_GET_BUS(op->ls_op_addr);
+        if (bus >= pdb->spi_count)
+            return -EINVAL;
+
+        if (pdb->spi_core[bus] == SPI_CORE_32W) {
+            if (((op->meminsz != 4) && (op->meminsz != 0)) || (op->memoutsz != 4))
+                return -EINVAL;
+
+            cmds[0] = usb_uram_seq_wr_hdr(pdb->spi_base[bus], 1);
+            cmds[1] = *(const uint32_t*)op->pout;
+            *pdwcnt = 2;
+        } else if (pdb->spi_core[bus] == SPI_CORE_CFGW_CS8) {
+            cmds[0] = usb_uram_seq_wr_hdr(pdb->spi_base[bus] - 1, 2);
+            cmds[1] = SPIEXT_LSOP_GET_CFG(op->ls_op_addr);
+            cmds[2] = spiext_make_data_reg(op->memoutsz, op->pout);
+            *pdwcnt = 3;
+        } else {
+            return -EINVAL;
+        }
+
+        *pwait = true;
+        return 0;
+    }
+    case USDR_LSOP_I2C_DEV: {
+        uint8_t instance_no = LSOP_I2C_INSTANCE(op->ls_op_addr);
+        uint8_t bus_no = LSOP_I2C_BUSNO(op->ls_op_addr);
+        uint8_t i2caddr = LSOP_I2C_ADDR(op->ls_op_addr);
+        struct i2c_cache* pi2cc = &gen->i2cc[4 * instance_no];
+        unsigned lidx;
+
+        if (instance_no >= pdb->i2c_count)
+            return -EINVAL;
+        if (pdb->i2c_core[instance_no] != I2C_CORE_AUTO_LUTUPD)
+            return -EINVAL;
+        if (bus_no > 1)
+            return -EINVAL;
+
+        lidx = si2c_update_lut_idx(pi2cc, i2caddr, bus_no);
+        cmds[0] = usb_uram_seq_wr_hdr(pdb->i2c_base[instance_no] - 1, 2);
+        cmds[1] = si2c_get_lut(pi2cc);
+        res = si2c_make_ctrl_reg(lidx, (const uint8_t*)op->pout, op->memoutsz, op->meminsz, &cmds[2]);
+        if (res)
+            return res;
+
+        *pdwcnt = 3;
+        *pwait = (op->meminsz > 0);
+        return 0;
+    }
+    }
+
+    return -EOPNOTSUPP;
+}
+
+// Post queued commands at once and collect completions in the issue order
+static int usb_uram_seq_flush(lldev_t dev, lowlevel_ls_batch_op_t* ops,
+                              const uint32_t* cmds, unsigned dwcnt,
+                              const unsigned* waits, unsigned wcnt)
+{
+    int res;
+    usb_uram_generic_t* gen = get_uram_generic(dev);
+
+    if (dwcnt == 0)
+        return 0;
+
+    res = gen->io_ops.io_write_seq_fn(dev, cmds, dwcnt, USB_IO_TIMEOUT);
+
+    USDR_LOG(USBG_LOG_TAG, USDR_LOG_DEBUG, "%s: Queued %d DW with %d completions (%d)\n",
+             lowlevel_get_devname(dev), dwcnt, wcnt, res);
+    if (res)
+        return res;
+
+    for (unsigned k = 0; k < wcnt; k++) {
+        lowlevel_ls_batch_op_t* op = &ops[waits[k]];
+
+        if (op->ls_op == USDR_LSOP_SPI) {
+            res = usb_uram_read_wait(dev, USDR_LSOP_SPI, SPIEXT_LSOP_GET_BUS(op->ls_op_addr),
+                                     op->meminsz, op->pin);
+        } else {
+            uint32_t data = 0;
+            res = usb_uram_read_wait(dev, USDR_LSOP_I2C_DEV, LSOP_I2C_INSTANCE(op->ls_op_addr),
+                                     op->meminsz, &data);
+            if (res == 0)
+                usb_uram_i2c_unpack(data, op->meminsz, op->pin);
+        }
+        if (res)
+            return res;
+    }
+
+    return 0;
+}
+
+int usb_uram_ls_batch(lldev_t dev, subdev_t subdev,
+                      lowlevel_ls_batch_op_t* ops, unsigned count)
+{
+    int res;
+    usb_uram_generic_t* gen = get_uram_generic(dev);
+    bool seq = gen->lsseq && gen->io_ops.io_write_seq_fn;
+    uint32_t cmds[USB_URAM_SEQ_MAX_DW];
+    unsigned waits[USB_URAM_SEQ_MAX_DW / 2];
+    unsigned dwcnt = 0, wcnt = 0;
+
+    for (unsigned i = 0; i < count; i++) {
+        lowlevel_ls_batch_op_t* op = &ops[i];
+        uint32_t ecmds[3];
+        unsigned edwcnt = 0;
+        bool wait = false;
+
+        res = (seq) ? usb_uram_seq_encode(gen, op, ecmds, &edwcnt, &wait) : -EOPNOTSUPP;
+        if (res == -EOPNOTSUPP) {
+            // Keep the order, drain the queue and execute it in the usual way
+            res = usb_uram_seq_flush(dev, ops, cmds, dwcnt, waits, wcnt);
+            if (res)
+                return res;
+
+            dwcnt = wcnt = 0;
+            res = usb_uram_ls_op(dev, subdev, op->ls_op, op->ls_op_addr,
+                                 op->meminsz, op->pin, op->memoutsz, op->pout);
+            if (res)
+                return res;
+
+            continue;
+        } else if (res) {
+            return res;
+        }
+
+        if (dwcnt + edwcnt > USB_URAM_SEQ_MAX_DW) {
+            res = usb_uram_seq_flush(dev, ops, cmds, dwcnt, waits, wcnt);
+            if (res)
+                return res;
+
+            dwcnt = wcnt = 0;
+        }
+
+        memcpy(&cmds[dwcnt], ecmds, edwcnt * sizeof(uint32_t));
+        dwcnt += edwcnt;
+        if (wait) {
+            waits[wcnt++] = i;
+        }
+    }
+
+    return usb_uram_seq_flush(dev, ops, cmds, dwcnt, waits, wcnt);
+}
+
 int usb_uram_read_wait(lldev_t dev, unsigned lsop, lsopaddr_t ls_op_addr, size_t meminsz, void* pin)
 {
     int res;
@@ -345,6 +510,26 @@ int usb_uram_generic_create_and_init(lldev_t dev, unsigned pcount, const char**
         }
     }
 
+    // Optional FPGA sequencer for queued SPI/I2C transactions. It's opt-in:
+    // no released gateware advertises DNLL_LSSEQ yet, so it's off unless the
+    // device does or `lsseq=on` / `lsseq=1` is given in the device string.
+    gen->lsseq = (usdr_device_vfs_obj_val_get_u64(dev->pdev, DNLL_LSSEQ, &tmp) == 0) && (tmp != 0);
+    for (unsigned k = 0; k < pcount; k++) {
+        if (strcmp(devparam[k], DN_LSSEQ) == 0) {
+            struct param_data pd = { devval[k], strlen(devval[k]) };
+            int on = is_param_on(&pd);
+            if (on < 0) {
+                USDR_LOG(USBG_LOG_TAG, USDR_LOG_WARNING, "%s: Unrecognized %s=%s, expected on/off\n",
+                         devname, DN_LSSEQ, devval[k]);
+            } else {
+                gen->lsseq = on;
+            }
+        }
+    }
+    if (gen->lsseq) {
+        USDR_LOG(USBG_LOG_TAG, USDR_LOG_INFO, "%s: Queued SPI/I2C transactions are enabled\n", devname);
+    }
+
     // TODO move hwid to 0
     // IGPI / HWID
     uint32_t hwid;
@@ -405,7 +590,7 @@ int usb_uram_generic_create_and_init(lldev_t dev, unsigned pcount, const char**
     }
 
     // Device initialization
-    res = dev->pdev->initialize(dev->pdev, pcount, devparam, devval);
+    res = usdr_device_initialize(dev->pdev, pcount, devparam, devval);
     if (res) {
         USDR_LOG(USBG_LOG_TAG, USDR_LOG_ERROR,
                  "Unable to initialize device, error %d\n", res);
@@ -13,11 +13,17 @@
 
 
 
+// Stream 2*n is RX and 2*n+1 is TX on the n-th DMA endpoint pair
 enum {
     DEV_RX_STREAM_NO = 0,
     DEV_TX_STREAM_NO = 1,
+
+    DEV_MAX_STREAM_PAIRS = 4,
 };
 
+#define DEV_STREAM_IS_RX(sno)  (((sno) & 1) == 0)
+#define DEV_STREAM_PAIR(sno)   ((sno) >> 1)
+
 enum {
     TXSTRM_META_SZ = 16,
 
@@ -31,17 +37,26 @@ enum {
     TO_IRQ_POLL = 250,
 };
 
+enum {
+    // Max size of queued SPI/I2C commands posted at once
+    USB_URAM_SEQ_MAX_DW = 256 / 4,
+};
+
 #define USB_IO_TIMEOUT 20000
 
 typedef int (*io_read_fn_t)(lldev_t d, unsigned addr, uint32_t *data, unsigned dwcnt, UNUSED int timeout);
 typedef int (*io_write_fn_t)(lldev_t d, unsigned addr, const uint32_t* data, unsigned dwcnt, UNUSED int timeout);
 typedef int (*io_read_bus_fn_t)(lldev_t dev, unsigned interrupt_number, unsigned reg, size_t meminsz, void* pin);
+typedef int (*io_write_seq_fn_t)(lldev_t d, const uint32_t* cmds, unsigned dwcnt, UNUSED int timeout);
 
 struct usb_uram_io_ops
 {
     io_read_fn_t io_read_fn;
     io_write_fn_t io_write_fn;
     io_read_bus_fn_t io_read_bus_fn;
+
+    // Post already encoded write commands in one transfer, NULL if not supported
+    io_write_seq_fn_t io_write_seq_fn;
 };
 typedef struct usb_uram_io_ops usb_uram_io_ops_t;
 
@@ -54,6 +69,7 @@ struct usb_uram_generic
     struct i2c_cache i2cc[4 * DBMAX_I2C_BUSES];
 
     uint32_t ntfy_seqnum_exp;
+    bool lsseq;     // Queue SPI/I2C batches to the FPGA sequencer, opt-in
 
     usb_uram_io_ops_t io_ops;
 };
@@ -71,6 +87,11 @@ int usb_uram_ls_op(lldev_t dev, subdev_t subdev,
                    size_t meminsz, void* pin, size_t memoutsz,
                    const void* pout);
 
+int usb_uram_ls_batch(lldev_t dev, subdev_t subdev,
+                      lowlevel_ls_batch_op_t* ops, unsigned count);
+int usb_uram_seq_encode(usb_uram_generic_t* gen, const lowlevel_ls_batch_op_t* op,
+                        uint32_t* cmds, unsigned* pdwcnt, bool* pwait);
+
 int usb_uram_read_wait(lldev_t dev, unsigned lsop, lsopaddr_t ls_op_addr, size_t meminsz, void* pin);
 int usb_uram_generic_create_and_init(lldev_t dev, unsigned pcount, const char** devparam,
                                      const char** devval, device_id_t* pdevid);
@@ -70,9 +70,15 @@ enum {
     // Numbers of REGOUTs piplined
     MAX_REGOUT_REQS = 1,
 
+    // Notifications queued per event, enough for a full REGOUT of SPI transactions
+    NTFY_QUEUE_SZ = 32,
+
     // Streams
     IN_STRM_SIZE     = 512,
     MAX_IN_STRM_REQS = 8,
+    // Bounds for adaptive in-flight RX transfers
+    MIN_IN_STRM_ADAPTIVE_REQS = 2,
+    MAX_IN_STRM_ADAPTIVE_REQS = 16,
     MAX_OUT_STRM_REQS = 32,
 
     RX_PKT_TRAILER_EX = 16,
@@ -91,6 +97,31 @@ struct stream_params {
     unsigned bits_per_all_chs;
 };
 
+// Every stream owns its transfer pool and completion callback, streams on
+// different endpoints don't share any state
+struct usb_rx_stream {
+    struct buffers b;
+    bool active;
+
+    unsigned app_drops;
+    unsigned rx_buffer_missed;
+    uint64_t seq;
+};
+
+struct usb_tx_stream {
+    struct buffers b;
+    bool active;
+
+    struct stream_params params;
+    uint64_t seq;
+
+    // Core statistics register, refreshed every tx_stat_rate buffers; -1 if
+    // the core doesn't expose it
+    int stat_reg;
+    uint32_t stat_prev[4];
+    uint32_t stat_cnt;
+};
+
 struct usb_dev
 {
     struct lowlevel_dev lld;
@@ -100,7 +131,13 @@ struct usb_dev
     usb_uram_generic_t uram_generic;
 
     sem_t interrupts[MAX_INTERRUPTS];
-    uint32_t rbvalue[MAX_INTERRUPTS];
+    uint32_t rbvalue[MAX_INTERRUPTS][NTFY_QUEUE_SZ];
+    unsigned rbvalue_widx[MAX_INTERRUPTS];
+    unsigned rbvalue_ridx[MAX_INTERRUPTS];
+    bool ntfy_posted;
+    // Set when a read-back timed out, its notification may still arrive and
+    // would be taken as the reply to the next transaction
+    bool rbvalue_resync;
 
     bool stop;
     sem_t tr_regout_a;
@@ -121,17 +158,10 @@ struct usb_dev
     uint64_t stream_info[STREAM_MAX_SLOTS];
     unsigned stream_info_widx;
 
-    struct buffers rx_strms[1];
-    struct buffers tx_strms[1];
-    struct stream_params tx_strms_params[1];
-
-    unsigned app_drops[1];
-    unsigned rx_buffer_missed[1];
+    struct usb_rx_stream rx_strms[DEV_MAX_STREAM_PAIRS];
+    struct usb_tx_stream tx_strms[DEV_MAX_STREAM_PAIRS];
 
     uint32_t rb_valid_idx;
-
-    uint32_t tx_stat_prev[4];
-    uint32_t tx_stat_cnt;
     uint32_t tx_stat_rate;
 };
 typedef struct usb_dev usb_dev_t;
@@ -190,7 +220,6 @@ int usb_async_start(usb_dev_t* dev)
     }
 
     dev->rb_valid_idx = 0;
-    dev->tx_stat_cnt = 0;
     dev->tx_stat_rate = 64; // TX stat update rate
     return libusb_generic_create_thread(&dev->gdev);
 
@@ -198,7 +227,17 @@ failed_prepare:
     return res;
 }
 
-static int usb_post_regout(usb_dev_t* dev, uint32_t *regoutbuffer, unsigned count_dw, int timeout)
+// Drops queued notifications nobody waits for anymore
+static void usb_rbvalue_flush(usb_dev_t* dev)
+{
+    for (unsigned i = 0; i < MAX_INTERRUPTS; i++) {
+        while (sem_trywait(&dev->interrupts[i]) == 0) {
+            dev->rbvalue_ridx[i]++;
+        }
+    }
+}
+
+static int usb_post_regout(usb_dev_t* dev, const uint32_t *regoutbuffer, unsigned count_dw, int timeout)
 {
     int res;
     unsigned i;
@@ -236,6 +275,12 @@ static int usb_post_regout(usb_dev_t* dev, uint32_t *regoutbuffer, unsigned coun
              dev->gdev.name, count_dw, tot_wrs, tot_rbs, tot_reqlen_dw,
              s_dump_buffer(regoutbuffer, count_dw * 4));
 
+    // Late replies to a timed out read-back are dropped before anything new
+    // is issued, so they can't be matched to later transactions
+    if (__atomic_exchange_n(&dev->rbvalue_resync, false, __ATOMIC_SEQ_CST)) {
+        usb_rbvalue_flush(dev);
+    }
+
     res = sem_wait(&dev->tr_regout_a);
     if (res) {
         res = -errno;
@@ -326,6 +371,8 @@ void LIBUSB_CALL libusb_transfer_ntfy(struct libusb_transfer *transfer)
     USDR_LOG("USBX", USDR_LOG_DEBUG, "NTFY transfer %d / %d\n",
              transfer->status, transfer->actual_length);
 
+    __atomic_store_n(&dev->ntfy_posted, false, __ATOMIC_SEQ_CST);
+
     if (dev->stop)
         return;
 
@@ -360,7 +407,8 @@ void LIBUSB_CALL libusb_transfer_ntfy(struct libusb_transfer *transfer)
         if (blen == 0 && ((i + 1) < packet_len / 4)) {
             USDR_LOG("USBX", USDR_LOG_NOTE, "Got notification seq %04x event %d => %08x\n",
                      seqnum, event, buff[i + 1]);
-            dev->rbvalue[event] = buff[++i];
+            unsigned widx = dev->rbvalue_widx[event]++;
+            dev->rbvalue[event][widx & (NTFY_QUEUE_SZ - 1)] = buff[++i];
             sem_post(&dev->interrupts[event]);
         } else if ((i + 1 + blen) < packet_len / 4) {
             i += blen + 1;
@@ -397,6 +445,12 @@ static int usb_async_regwrite32(lldev_t d, unsigned addr, const uint32_t* data,
     return usb_post_regout(dev, odata, sizedw + 1, timeout);
 }
 
+static int usb_async_regwrite_seq(lldev_t d, const uint32_t* cmds, unsigned dwcnt, int timeout)
+{
+    usb_dev_t* dev = (usb_dev_t*)d;
+    return usb_post_regout(dev, cmds, dwcnt, timeout);
+}
+
 static int usb_async_regread32(lldev_t d, unsigned addr, uint32_t* data, unsigned sizedw, int timeout)
 {
     usb_dev_t* dev = (usb_dev_t*)d;
@@ -443,7 +497,7 @@ int usb_uram_generic_get(lldev_t dev, int generic_op, const char** pout)
 
 static int usb_uram_wait_msi(usb_dev_t* dev, unsigned i, int timeout_ms)
 {
-    return sem_wait_ex(&dev->interrupts[i], timeout_ms * 1000);
+    return sem_wait_ex(&dev->interrupts[i], (int64_t)timeout_ms * 1000 * 1000);
 }
 
 static int usb_read_bus(lldev_t dev, unsigned interrupt_number, UNUSED unsigned reg, size_t meminsz, void* pin)
@@ -451,16 +505,27 @@ static int usb_read_bus(lldev_t dev, unsigned interrupt_number, UNUSED unsigned
     int res;
     usb_dev_t* d = (usb_dev_t*)dev;
 
-    res = libusb_to_errno(libusb_submit_transfer(d->transfer_ntfy[0]));
-    if (res)
-        return res;
+    // Notification may be still pending from the previous queued transaction
+    if (!__atomic_exchange_n(&d->ntfy_posted, true, __ATOMIC_SEQ_CST)) {
+        res = libusb_to_errno(libusb_submit_transfer(d->transfer_ntfy[0]));
+        if (res) {
+            __atomic_store_n(&d->ntfy_posted, false, __ATOMIC_SEQ_CST);
+            return res;
+        }
+    }
 
     res = usb_uram_wait_msi(d, interrupt_number, 1000);
-    if (res)
+    if (res) {
+        USDR_LOG("USBX", USDR_LOG_ERROR, "%s: No notification on event %d, error %d; resyncing\n",
+                 d->gdev.name, interrupt_number, res);
+        usb_rbvalue_flush(d);
+        __atomic_store_n(&d->rbvalue_resync, true, __ATOMIC_SEQ_CST);
         return res;
+    }
 
+    unsigned ridx = d->rbvalue_ridx[interrupt_number]++;
     if (meminsz != 0) {
-        *(uint32_t*)pin = d->rbvalue[interrupt_number];
+        *(uint32_t*)pin = d->rbvalue[interrupt_number][ridx & (NTFY_QUEUE_SZ - 1)];
 #if 0
         res = usb_uram_reg_in(dev, reg, (uint32_t*)pin);
         if (res)
@@ -485,60 +550,117 @@ uint32_t *_get_trailer_bursts(struct buffer_discriptor *bd, uint32_t *bursts, ui
 static
 void _usb_uram_stream_on_buffer(void* param, struct buffer_discriptor *rxbd)
 {
-    usb_dev_t* d = (usb_dev_t*)param;
+    struct usb_rx_stream* rs = (struct usb_rx_stream*)param;
     struct buffers *rxb = rxbd->b;
     uint32_t bursts, skipped;
     uint32_t* tr = _get_trailer_bursts(rxbd, &bursts, &skipped);
 
+    // Bursts lost by the device before this buffer, no transfer was posted in time
+    rxb->overflows += skipped & 0xffffff;
+
     if (rxbd->bno < rxb->buf_max) {
-        unsigned buffers_discarded = d->rx_buffer_missed[0];
-        tr[0] += d->rx_buffer_missed[0];
-        d->rx_buffer_missed[0] = 0;
+        unsigned buffers_discarded = rs->rx_buffer_missed;
+        tr[0] += rs->rx_buffer_missed;
+        rs->rx_buffer_missed = 0;
         buffers_ready_post(rxb);
 
         if (buffers_discarded > 0) {
             USDR_LOG("USBX", USDR_LOG_WARNING, "%d buffers were discarded due to slow processing in the application\n", buffers_discarded);
         }
     } else {
-        d->app_drops[0]++;
-        d->rx_buffer_missed[0] += 1 + (skipped & 0xffffff);
+        rs->app_drops++;
+        rs->rx_buffer_missed += 1 + (skipped & 0xffffff);
     }
 }
 
+static
+struct usb_rx_stream* _usb_uram_rx_stream(usb_dev_t* d, stream_t channel)
+{
+    if (!DEV_STREAM_IS_RX(channel) || DEV_STREAM_PAIR(channel) >= DEV_MAX_STREAM_PAIRS)
+        return NULL;
+
+    struct usb_rx_stream* rs = &d->rx_strms[DEV_STREAM_PAIR(channel)];
+    return rs->active ? rs : NULL;
+}
+
+static
+struct usb_tx_stream* _usb_uram_tx_stream(usb_dev_t* d, stream_t channel)
+{
+    if (DEV_STREAM_IS_RX(channel) || DEV_STREAM_PAIR(channel) >= DEV_MAX_STREAM_PAIRS)
+        return NULL;
+
+    struct usb_tx_stream* ts = &d->tx_strms[DEV_STREAM_PAIR(channel)];
+    return ts->active ? ts : NULL;
+}
+
+// Only the default pair is guaranteed, extra pairs depend on the gateware
+static
+int _usb_uram_check_endpoint(usb_dev_t* d, unsigned endpoint)
+{
+    int res = libusb_get_max_packet_size(libusb_get_device(d->gdev.dh), endpoint);
+    if (res < 0) {
+        USDR_LOG("USBX", USDR_LOG_ERROR, "Stream endpoint %02x isn't available on this device, error %d\n",
+                 endpoint, res);
+        return -ENODEV;
+    }
+    return 0;
+}
+
 static
 int _usb_uram_init_rxstream(usb_dev_t* d,
                             lowlevel_stream_params_t* params,
                             stream_t* channel)
 {
     int res;
-    struct buffers *prxb = &d->rx_strms[0];
+    unsigned pair = DEV_STREAM_PAIR(params->streamno);
+    unsigned endpoint = EP_IN_DEFSTREAM + pair;
+    struct usb_rx_stream *rs = &d->rx_strms[pair];
+    struct buffers *prxb = &rs->b;
     unsigned transfers = MAX_IN_STRM_REQS > params->buffer_count ? params->buffer_count : MAX_IN_STRM_REQS;
+    unsigned transfers_max = params->buffer_count / 2;
     bool eventtype = (params->flags & LLSF_NEED_FDPOLL) == LLSF_NEED_FDPOLL;
+    bool host_mem = (params->flags & LLSF_HOST_MEM) == LLSF_HOST_MEM;
     unsigned trailer_sz = RX_PKT_TRAILER_EX;
 
-    res = buffers_usb_init(&d->gdev, prxb, transfers, params->buffer_count,
-                           params->block_size + trailer_sz, EP_IN_DEFSTREAM, eventtype);
+    // Extra transfers are kept idle until the adaptive depth asks for them
+    if (transfers_max > MAX_IN_STRM_ADAPTIVE_REQS)
+        transfers_max = MAX_IN_STRM_ADAPTIVE_REQS;
+    if (transfers_max < transfers)
+        transfers_max = transfers;
+
+    if (rs->active)
+        return -EBUSY;
+
+    res = (pair == 0) ? 0 : _usb_uram_check_endpoint(d, endpoint);
+    if (res)
+        return res;
+
+    res = buffers_usb_init(&d->gdev, prxb, transfers_max, params->buffer_count,
+                           params->block_size + trailer_sz, endpoint, eventtype, host_mem);
+    if (res)
+        return res;
 
     prxb->auto_restart = true;
-    d->rx_buffer_missed[0] = 0;
-    d->app_drops[0] = 0;
+    rs->rx_buffer_missed = 0;
+    rs->app_drops = 0;
+    rs->seq = 0;
     prxb->on_buffer = &_usb_uram_stream_on_buffer;
-    prxb->on_buffer_param = d;
+    prxb->on_buffer_param = rs;
+    rs->active = true;
 
-    for (unsigned t = 0; t < transfers; t++) {
-        res = buffers_usb_transfer_post(prxb,
-                                        _buffers_prod_get_nolock(prxb),
-                                        prxb->allocsz_rounded,
-                                        t);
-        if (res)
-            return res;
+    res = buffers_usb_start(prxb, transfers);
+    if (res) {
+        rs->active = false;
+        buffers_usb_free(prxb);
+        return res;
     }
 
     params->underlying_fd = (eventtype) ? prxb->fd_event : -1;
     params->out_mtu_size = params->block_size;
-    USDR_LOG("USBX", USDR_LOG_ERROR, "Stream RX prepared sz = %d, URBs = %d, evfd = %d!\n",
-             prxb->allocsz_rounded, transfers, eventtype);
-    *channel = DEV_RX_STREAM_NO;
+    params->out_flags = (prxb->dev_mem) ? LLSOF_DEV_MEM : 0;
+    USDR_LOG("USBX", USDR_LOG_ERROR, "Stream RX%d prepared sz = %d, URBs = %d, evfd = %d, zero-copy = %d!\n",
+             pair, prxb->allocsz_rounded, transfers, eventtype, prxb->dev_mem);
+    *channel = params->streamno;
 
     return 0;
 }
@@ -549,10 +671,14 @@ int _usb_uram_init_txstream(usb_dev_t* d,
                             stream_t* channel)
 {
     int res;
-    struct buffers *prxb = &d->tx_strms[0];
-    struct stream_params *sp = &d->tx_strms_params[0];
+    unsigned pair = DEV_STREAM_PAIR(params->streamno);
+    unsigned endpoint = EP_OUT_DEFSTREAM + pair;
+    struct usb_tx_stream *ts = &d->tx_strms[pair];
+    struct buffers *prxb = &ts->b;
+    struct stream_params *sp = &ts->params;
 
     bool eventtype = (params->flags & LLSF_NEED_FDPOLL) == LLSF_NEED_FDPOLL;
+    bool host_mem = (params->flags & LLSF_HOST_MEM) == LLSF_HOST_MEM;
     unsigned buffers_cnt = params->buffer_count;
     if (buffers_cnt > MAX_OUT_STRM_REQS)
         buffers_cnt = MAX_OUT_STRM_REQS;
@@ -572,18 +698,31 @@ int _usb_uram_init_txstream(usb_dev_t* d,
         params->block_size = MAX_TX_BUFFER_SZ;
     }
 
+    if (ts->active)
+        return -EBUSY;
+
+    res = (pair == 0) ? 0 : _usb_uram_check_endpoint(d, endpoint);
+    if (res)
+        return res;
+
     res = buffers_usb_init(&d->gdev, prxb, buffers_cnt, buffers_cnt,
-                           params->block_size + TX_PKT_HEADER, EP_OUT_DEFSTREAM, eventtype);
+                           params->block_size + TX_PKT_HEADER, endpoint, eventtype, host_mem);
     if (res)
         return res;
 
     params->underlying_fd = (eventtype) ? prxb->fd_event : -1;
     params->out_mtu_size = params->block_size;
-    USDR_LOG("USBX", USDR_LOG_ERROR, "Stream TX prepared sz = %d, URBs = %d, evfd = %d!\n",
-             prxb->allocsz_rounded, buffers_cnt, eventtype);
-    *channel = DEV_TX_STREAM_NO;
+    params->out_flags = (prxb->dev_mem) ? LLSOF_DEV_MEM : 0;
+    USDR_LOG("USBX", USDR_LOG_ERROR, "Stream TX%d prepared sz = %d, URBs = %d, evfd = %d, zero-copy = %d!\n",
+             pair, prxb->allocsz_rounded, buffers_cnt, eventtype, prxb->dev_mem);
+    *channel = params->streamno;
     sp->channels = params->channels;
     sp->bits_per_all_chs = params->bits_per_sym;
+    ts->seq = 0;
+    ts->stat_reg = (pair == 0) ? 28 : -1;
+    ts->stat_cnt = 0;
+    memset(ts->stat_prev, 0, sizeof(ts->stat_prev));
+    ts->active = true;
     return 0;
 }
 
@@ -594,23 +733,26 @@ int usb_uram_stream_initialize(lldev_t dev, subdev_t subdev,
 {
     usb_dev_t* d = (usb_dev_t*)dev;
 
-    // Only RX for now
-    if (params->streamno == DEV_RX_STREAM_NO)
-        return _usb_uram_init_rxstream(d, params, channel);
-    else if (params->streamno == DEV_TX_STREAM_NO)
-        return _usb_uram_init_txstream(d, params, channel);
+    if (DEV_STREAM_PAIR(params->streamno) >= DEV_MAX_STREAM_PAIRS)
+        return -EINVAL;
 
-    return -EINVAL;
+    return DEV_STREAM_IS_RX(params->streamno) ? _usb_uram_init_rxstream(d, params, channel) :
+                                                _usb_uram_init_txstream(d, params, channel);
 }
 
 static
 int usb_uram_stream_deinitialize(lldev_t dev, subdev_t subdev, stream_t channel)
 {
     usb_dev_t* d = (usb_dev_t*)dev;
-    if (channel == DEV_RX_STREAM_NO) {
-        buffers_usb_free(&d->rx_strms[0]);
-    } else if (channel == DEV_TX_STREAM_NO) {
-        buffers_usb_free(&d->tx_strms[0]);
+    struct usb_rx_stream* rs = _usb_uram_rx_stream(d, channel);
+    struct usb_tx_stream* ts = _usb_uram_tx_stream(d, channel);
+
+    if (rs) {
+        buffers_usb_free(&rs->b);
+        rs->active = false;
+    } else if (ts) {
+        buffers_usb_free(&ts->b);
+        ts->active = false;
     } else {
         return -EINVAL;
     }
@@ -622,12 +764,12 @@ int usb_uram_recv_dma_wait(lldev_t dev, subdev_t subdev, stream_t channel, void*
                             void* oob_ptr, unsigned *oob_size, unsigned timeout)
 {
     usb_dev_t* d = (usb_dev_t*)dev;
+    struct usb_rx_stream* rs = _usb_uram_rx_stream(d, channel);
     int res;
-    if (channel != DEV_RX_STREAM_NO)
+    if (rs == NULL)
         return -EINVAL;
 
-    static uint64_t cnt = 0;
-    struct buffers *rxb = &d->rx_strms[0];
+    struct buffers *rxb = &rs->b;
 
     res = buffers_ready_wait(rxb, timeout * 1000);
     if (res) {
@@ -659,7 +801,7 @@ int usb_uram_recv_dma_wait(lldev_t dev, subdev_t subdev, stream_t channel, void*
     USDR_LOG("USBX",
              (rxb->allocsz == bd->buffer_sz) ? USDR_LOG_DEBUG : USDR_LOG_ERROR,
              "Buffer %d / %08x %08x  TO=%d SEQ=%16ld\n",
-             buffer_sz, bursts, skipped, timeout, cnt);
+             buffer_sz, bursts, skipped, timeout, rs->seq);
 
     if (oob_size && *oob_size >= 8) {
         // memset(oob_ptr, 0, *oob_size);
@@ -678,7 +820,7 @@ int usb_uram_recv_dma_wait(lldev_t dev, subdev_t subdev, stream_t channel, void*
     }
 
     *buffer = tr_buffer;
-    cnt++;
+    rs->seq++;
     return 0;
 }
 
@@ -686,11 +828,11 @@ static
 int usb_uram_recv_dma_release(lldev_t dev, subdev_t subdev, stream_t channel, void* buffer)
 {
     usb_dev_t* d = (usb_dev_t*)dev;
-    if (channel != DEV_RX_STREAM_NO)
+    struct usb_rx_stream* rs = _usb_uram_rx_stream(d, channel);
+    if (rs == NULL)
         return -EINVAL;
 
-    struct buffers *prxb = &d->rx_strms[0];
-    buffers_available_post(prxb);
+    buffers_available_post(&rs->b);
 
     return 0;
 }
@@ -699,12 +841,12 @@ static
 int usb_uram_send_dma_get(lldev_t dev, subdev_t subdev, stream_t channel, void** buffer, void* oob_ptr, unsigned *oob_size, unsigned timeout)
 {
     usb_dev_t* d = (usb_dev_t*)dev;
+    struct usb_tx_stream* ts = _usb_uram_tx_stream(d, channel);
     int res;
-    if (channel != DEV_TX_STREAM_NO)
+    if (ts == NULL)
         return -EINVAL;
 
-    static uint64_t cnt = 0;
-    struct buffers *rxb = &d->tx_strms[0];
+    struct buffers *rxb = &ts->b;
     res = buffers_ready_wait(rxb, timeout * 1000);
     if (res)
         return res;
@@ -712,28 +854,30 @@ int usb_uram_send_dma_get(lldev_t dev, subdev_t subdev, stream_t channel, void**
     unsigned bno = buffers_produce(rxb);
     *buffer = buffers_get_ptr(rxb, bno) + TXSTRM_META_SZ;
 
-    USDR_LOG("USBX", USDR_LOG_DEBUG, "TX Alloc BNO=%d %ld\n", bno, cnt);
+    USDR_LOG("USBX", USDR_LOG_DEBUG, "TX%d Alloc BNO=%d %ld\n", DEV_STREAM_PAIR(channel), bno, ts->seq);
 
     // Trottle statistics to relax extra load
-    if (oob_size) {
+    if (oob_size && ts->stat_reg < 0) {
+        *oob_size = 0;
+    } else if (oob_size) {
         unsigned sz = *oob_size;
         if (sz > 16)
             sz = 16;
 
-        unsigned pcnt = d->tx_stat_cnt++;
+        unsigned pcnt = ts->stat_cnt++;
         if ((pcnt % d->tx_stat_rate) == 0) {
-            res = lowlevel_reg_rdndw(dev, subdev, 28, d->tx_stat_prev, sz / 4);
+            res = lowlevel_reg_rdndw(dev, subdev, ts->stat_reg, ts->stat_prev, sz / 4);
             if (res) {
                 USDR_LOG("USBX", USDR_LOG_ERROR, "TX GET unable to obtain stat! error=%d\n", res);
                 return res;
             }
         }
 
-        memcpy(oob_ptr, d->tx_stat_prev, sz);
+        memcpy(oob_ptr, ts->stat_prev, sz);
         *oob_size = (sz / 4) * 4;
     }
 
-    cnt++;
+    ts->seq++;
     return 0;
 }
 
@@ -741,9 +885,10 @@ static
 int usb_uram_send_dma_commit(lldev_t dev, subdev_t subdev, stream_t channel, void* buffer, unsigned sz, const void* oob_ptr, unsigned oob_size)
 {
     usb_dev_t* d = (usb_dev_t*)dev;
+    struct usb_tx_stream* ts = _usb_uram_tx_stream(d, channel);
     int res;
     int64_t timestamp = -1;
-    if (channel != DEV_TX_STREAM_NO) {
+    if (ts == NULL) {
         USDR_LOG("USBX", USDR_LOG_ERROR,"USB TX Commit incorrect stream number\n");
         return -EINVAL;
     }
@@ -753,7 +898,7 @@ int usb_uram_send_dma_commit(lldev_t dev, subdev_t subdev, stream_t channel, voi
         return -EINVAL;
     }
 
-    struct buffers *rxb = &d->tx_strms[0];
+    struct buffers *rxb = &ts->b;
     if (sz > rxb->allocsz) {
         USDR_LOG("USBX", USDR_LOG_ERROR,"USB TX burst size is too big\n");
         return -EINVAL;
@@ -767,7 +912,7 @@ int usb_uram_send_dma_commit(lldev_t dev, subdev_t subdev, stream_t channel, voi
         return -EINVAL;
     }
 
-    uint64_t rsamples = sz * 8 / d->tx_strms_params[0].bits_per_all_chs;
+    uint64_t rsamples = sz * 8 / ts->params.bits_per_all_chs;
     unsigned samples = rsamples - 1;
 
     uint32_t* header = (uint32_t*)bx;
@@ -813,7 +958,7 @@ int usb_uram_destroy(lldev_t dev)
     usb_dev_t* d = (usb_dev_t*)dev;
 
     // Deinit streams
-    for (unsigned sno = 0; sno < 1 + 1; sno++) {
+    for (unsigned sno = 0; sno < 2 * DEV_MAX_STREAM_PAIRS; sno++) {
         usb_uram_stream_deinitialize(dev, 0, sno);
     }
 
@@ -840,6 +985,47 @@ int usb_uram_destroy(lldev_t dev)
     return 0;
 }
 
+// Stream options
+//   usblat   - latency bound for adaptive RX transfer depth in us, 0 freezes current depth
+//   usbdepth - number of RX transfers kept in flight
+static
+int usb_uram_stream_option_get(lldev_t dev, UNUSED subdev_t subdev, stream_t channel,
+                               const char* name, int64_t* out_val)
+{
+    usb_dev_t* d = (usb_dev_t*)dev;
+    struct usb_rx_stream* rs = _usb_uram_rx_stream(d, channel);
+    if (rs == NULL)
+        return -EINVAL;
+
+    struct buffers *rxb = &rs->b;
+    if (strcmp(name, "usbdepth") == 0) {
+        *out_val = buffers_usb_depth_get(rxb);
+        return 0;
+    } else if (strcmp(name, "usblat") == 0) {
+        *out_val = rxb->depth_adaptive ? rxb->depth_ctrl.latency_us : 0;
+        return 0;
+    }
+    return -EINVAL;
+}
+
+static
+int usb_uram_stream_option_set(lldev_t dev, UNUSED subdev_t subdev, stream_t channel,
+                               const char* name, int64_t in_val)
+{
+    usb_dev_t* d = (usb_dev_t*)dev;
+    struct usb_rx_stream* rs = _usb_uram_rx_stream(d, channel);
+    if (rs == NULL)
+        return -EINVAL;
+
+    if (strcmp(name, "usblat") == 0) {
+        if (in_val < 0 || in_val > UINT32_MAX)
+            return -EINVAL;
+
+        return buffers_usb_depth_set_latency(&rs->b, MIN_IN_STRM_ADAPTIVE_REQS, in_val);
+    }
+    return -EINVAL;
+}
+
 // Device operations
 const static
 struct lowlevel_ops s_usb_uram_ops = {
@@ -855,6 +1041,9 @@ struct lowlevel_ops s_usb_uram_ops = {
     usb_uram_send_buf,
     usb_uram_await,
     usb_uram_destroy,
+    usb_uram_ls_batch,
+    usb_uram_stream_option_get,
+    usb_uram_stream_option_set,
 };
 
 // Factory functions
@@ -885,7 +1074,8 @@ const static
 usb_uram_io_ops_t s_io_ops = {
     usb_async_regread32,
     usb_async_regwrite32,
-    usb_read_bus
+    usb_read_bus,
+    usb_async_regwrite_seq,
 };
 
 static
@@ -902,8 +1092,10 @@ int usb_uram_plugin_create(unsigned pcount, const char** devparam,
     }
 
     memset(dev, 0, sizeof(usb_dev_t));
-    dev->rx_strms[0].fd_event = -101;
-    dev->tx_strms[0].fd_event = -101;
+    for (unsigned i = 0; i < DEV_MAX_STREAM_PAIRS; i++) {
+        dev->rx_strms[i].b.fd_event = -101;
+        dev->tx_strms[i].b.fd_event = -101;
+    }
     dev->lld.ops = &dev->ops;
     dev->ops = s_usb_uram_ops;
 
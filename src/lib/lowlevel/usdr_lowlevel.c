@@ -33,6 +33,75 @@ const uint8_t* lowlevel_get_uuid(lldev_t dev)
     return (const uint8_t*)name;
 }
 
+int lowlevel_drp_rmw16(lldev_t dev, subdev_t subdev, unsigned port,
+                       lowlevel_drp_rmw_t* regs, unsigned count)
+{
+    lowlevel_ls_batch_op_t ops[LOWLEVEL_LS_BATCH_MAX];
+    uint16_t wr[LOWLEVEL_LS_BATCH_MAX];
+    int res;
+
+    for (unsigned off = 0; off < count; ) {
+        unsigned cnt = (count - off > LOWLEVEL_LS_BATCH_MAX) ? LOWLEVEL_LS_BATCH_MAX : count - off;
+
+        for (unsigned i = 0; i < cnt; i++) {
+            lowlevel_drp_rmw_t* r = &regs[off + i];
+
+            r->rb = 0;
+            if (r->mask != 0xffff) {
+                res = lowlevel_drp_rd16(dev, subdev, port, r->regaddr, &r->rb);
+                if (res)
+                    return res;
+            }
+
+            wr[i] = (r->rb & ~r->mask) | (r->value & r->mask);
+            ops[i].ls_op = USDR_LSOP_DRP;
+            ops[i].ls_op_addr = (port << 16) | r->regaddr;
+            ops[i].meminsz = 0;
+            ops[i].memoutsz = 2;
+            ops[i].pin = NULL;
+            ops[i].pout = &wr[i];
+        }
+
+        res = lowlevel_ls_batch(dev, subdev, ops, cnt);
+        if (res)
+            return res;
+
+        off += cnt;
+    }
+
+    return 0;
+}
+
+int lowlevel_ls_op_parallel(lldev_t dev, subdev_t subdev,
+                            lowlevel_ls_batch_op_t* ops, unsigned count, unsigned timeout_ms)
+{
+    unsigned ids[LOWLEVEL_LS_BATCH_MAX];
+    int res = 0, wres;
+
+    for (unsigned off = 0; off < count; ) {
+        unsigned cnt = (count - off > LOWLEVEL_LS_BATCH_MAX) ? LOWLEVEL_LS_BATCH_MAX : count - off;
+        unsigned submitted;
+
+        for (submitted = 0; submitted < cnt; submitted++) {
+            res = lowlevel_ls_op_submit(dev, subdev, &ops[off + submitted], &ids[submitted]);
+            if (res)
+                break;
+        }
+
+        // Reap everything in flight even on error, buffers belong to the caller
+        for (unsigned i = 0; i < submitted; i++) {
+            wres = lowlevel_await(dev, subdev, ids[i], timeout_ms);
+            if (wres && !res)
+                res = wres;
+        }
+        if (res)
+            return res;
+
+        off += cnt;
+    }
+
+    return 0;
+}
 
 int lowlevel_info(UNUSED const char* driver,
                   UNUSED unsigned iparam,
@@ -48,6 +117,7 @@ static const struct lowlevel_plugin* plugins[8];
 const struct lowlevel_plugin* pcie_uram_register();
 const struct lowlevel_plugin* verilator_wrap_register();
 const struct lowlevel_plugin* usbft601_uram_register();
+const struct lowlevel_plugin* synth_register();
 
 static
 unsigned lowlevel_initialize_plugins()
@@ -67,6 +137,11 @@ unsigned lowlevel_initialize_plugins()
     plugins[s_driver_count++] = verilator_wrap_register();
 #endif
 
+    // Last, only picked up when asked for explicitly
+#if !defined(__EMSCRIPTEN__) && !defined(WVLT_WEBUSB_BUILD)
+    plugins[s_driver_count++] = synth_register();
+#endif
+
     return s_driver_count;
 }
 
@@ -53,6 +53,21 @@ typedef unsigned stream_t;
 
 typedef struct device device_t;
 
+// Single low speed transaction in a batch, same meaning as ls_op() arguments
+struct lowlevel_ls_batch_op {
+    unsigned ls_op;
+    lsopaddr_t ls_op_addr;
+    unsigned meminsz;
+    unsigned memoutsz;
+    void* pin;
+    const void* pout;
+};
+typedef struct lowlevel_ls_batch_op lowlevel_ls_batch_op_t;
+
+enum {
+    LOWLEVEL_LS_BATCH_MAX = 32,
+};
+
 enum lowlevel_generic_ops {
     LLGO_DEVICE_NAME,
     LLGO_DEVICE_UUID,
@@ -62,6 +77,11 @@ enum lowlevel_generic_ops {
 enum llstream_flags {
     LLSF_EXACT_VALUES = 1, //Fail if requested values can't be satisfied; otherwise use closest
     LLSF_NEED_FDPOLL = 2,
+    LLSF_HOST_MEM = 4, //Don't use driver provided (zero-copy) transfer buffers
+};
+
+enum llstream_out_flags {
+    LLSOF_DEV_MEM = 1, //Transfer buffers are mapped from the driver, no kernel bounce copy
 };
 
 typedef int (*soft_tx_commit_fn_t)(void *param, unsigned sz, const void* oob_ptr, unsigned oob_size);
@@ -84,6 +104,7 @@ struct lowlevel_stream_params {
 
     size_t out_mtu_size;     ///< Maximum transfer size for single transfer (burst)
     unsigned out_max_bursts; ///< Maximum number of bursts in a transaction
+    unsigned out_flags;      ///< See llstream_out_flags
 
     unsigned dma_core_id;
     void* param;
@@ -91,6 +112,17 @@ struct lowlevel_stream_params {
 };
 typedef struct lowlevel_stream_params lowlevel_stream_params_t;
 
+// await() operations
+enum lowlevel_await_ops {
+    LLAWAIT_SUBMIT = 0, // *aux is lowlevel_ls_batch_op_t*, returns await_id or error; buffers must be valid until completion
+    LLAWAIT_WAIT = 1,   // Wait up to timeout ms for await_id, returns ls_op result and releases await_id
+    LLAWAIT_POLL = 2,   // Same as LLAWAIT_WAIT but returns -EAGAIN immediately if not completed yet
+    LLAWAIT_GET_FD = 3, // *aux is int*, the fd becomes readable on every completion; read() it to rearm
+};
+
+#define LLAWAIT_INFINITE ((unsigned)-1)
+#define LLAWAIT_ID_DONE  ((unsigned)-1) // Operation was completed synchronously on submission
+
 struct lowlevel_ops {
     int (*generic_get)(lldev_t dev, int generic_op, const char** pout);
 
@@ -115,10 +147,17 @@ struct lowlevel_ops {
     int (*recv_buf)(lldev_t dev, subdev_t subdev, stream_t channel, void** buffer, unsigned *expected_sz, void* oob_ptr, unsigned *oob_size, unsigned timeout);
     int (*send_buf)(lldev_t dev, subdev_t subdev, stream_t channel, void* buffer, unsigned sz, const void* oob_ptr, unsigned oob_size, unsigned timeout);
 
-    // TODO Async operations
+    // Async operations, see enum lowlevel_await_ops
     int (*await)(lldev_t dev, subdev_t subdev, unsigned await_id, unsigned op, void** await_inout_aux_data, unsigned timeout);
 
     int (*destroy)(lldev_t dev);
+
+    // Optional, execute ops back to back with a single completion. When NULL ls_op is used for each op
+    int (*ls_batch)(lldev_t dev, subdev_t subdev, lowlevel_ls_batch_op_t* ops, unsigned count);
+
+    // Optional, backend specific stream tuning. Returns -EINVAL for unknown options
+    int (*stream_option_get)(lldev_t dev, subdev_t subdev, stream_t channel, const char* name, int64_t* out_val);
+    int (*stream_option_set)(lldev_t dev, subdev_t subdev, stream_t channel, const char* name, int64_t in_val);
 };
 typedef struct lowlevel_ops lowlevel_ops_t;
 
@@ -176,6 +215,81 @@ static inline int lowlevel_spi_tr32(lldev_t dev, subdev_t subdev,
                                         (tin) ? 4 : 0, tin, 4, &tout);
 }
 
+static inline int lowlevel_ls_batch(lldev_t dev, subdev_t subdev,
+                                    lowlevel_ls_batch_op_t* ops, unsigned count) {
+    lowlevel_ops_t* llops = lowlevel_get_ops(dev);
+    if (llops->ls_batch)
+        return llops->ls_batch(dev, subdev, ops, count);
+
+    for (unsigned i = 0; i < count; i++) {
+        int res = llops->ls_op(dev, subdev, ops[i].ls_op, ops[i].ls_op_addr,
+                               ops[i].meminsz, ops[i].pin, ops[i].memoutsz, ops[i].pout);
+        if (res)
+            return res;
+    }
+    return 0;
+}
+
+// Submit ls_op without waiting for it. When the backend has no async support
+// the op is executed in place and LLAWAIT_ID_DONE is returned.
+static inline int lowlevel_ls_op_submit(lldev_t dev, subdev_t subdev,
+                                        lowlevel_ls_batch_op_t* op, unsigned* await_id) {
+    lowlevel_ops_t* llops = lowlevel_get_ops(dev);
+    void* aux = op;
+    int res = (llops->await) ? llops->await(dev, subdev, 0, LLAWAIT_SUBMIT, &aux, 0) : -ENOTSUP;
+    if (res == -ENOTSUP || res == -EOPNOTSUPP) {
+        res = llops->ls_op(dev, subdev, op->ls_op, op->ls_op_addr,
+                           op->meminsz, op->pin, op->memoutsz, op->pout);
+        if (res)
+            return res;
+
+        *await_id = LLAWAIT_ID_DONE;
+        return 0;
+    }
+    if (res < 0)
+        return res;
+
+    *await_id = res;
+    return 0;
+}
+
+static inline int lowlevel_await(lldev_t dev, subdev_t subdev,
+                                 unsigned await_id, unsigned timeout_ms) {
+    if (await_id == LLAWAIT_ID_DONE)
+        return 0;
+
+    return lowlevel_get_ops(dev)->await(dev, subdev, await_id, LLAWAIT_WAIT, NULL, timeout_ms);
+}
+
+// Run independent ops concurrently (e.g. to chips on different buses) and wait for all of them;
+// backends without await() (USB) execute them in place one by one
+int lowlevel_ls_op_parallel(lldev_t dev, subdev_t subdev,
+                            lowlevel_ls_batch_op_t* ops, unsigned count, unsigned timeout_ms);
+
+// Post register list to the SPI bus, up to LOWLEVEL_LS_BATCH_MAX words are queued at once
+static inline int lowlevel_spi_post32(lldev_t dev, subdev_t subdev,
+                                      lsopaddr_t ls_op_addr, const uint32_t* regs, unsigned count) {
+    lowlevel_ls_batch_op_t ops[LOWLEVEL_LS_BATCH_MAX];
+    for (unsigned off = 0; off < count; ) {
+        unsigned cnt = (count - off > LOWLEVEL_LS_BATCH_MAX) ? LOWLEVEL_LS_BATCH_MAX : count - off;
+        for (unsigned i = 0; i < cnt; i++) {
+            ops[i].ls_op = USDR_LSOP_SPI;
+            ops[i].ls_op_addr = ls_op_addr;
+            ops[i].meminsz = 0;
+            ops[i].memoutsz = 4;
+            ops[i].pin = NULL;
+            ops[i].pout = &regs[off + i];
+        }
+
+        int res = lowlevel_ls_batch(dev, subdev, ops, cnt);
+        if (res)
+            return res;
+
+        off += cnt;
+    }
+    return 0;
+}
+
 static inline int lowlevel_drp_wr16(lldev_t dev, subdev_t subdev, unsigned port,
                                     uint16_t regaddr, uint16_t out) {
     return lowlevel_get_ops(dev)->ls_op(dev, subdev, USDR_LSOP_DRP, (port << 16) | regaddr,
@@ -188,6 +302,20 @@ static inline int lowlevel_drp_rd16(lldev_t dev, subdev_t subdev, unsigned port,
                                         2, pout, 0, NULL);
 }
 
+// Read-modify-write of DRP registers, bits outside of mask are preserved.
+struct lowlevel_drp_rmw {
+    uint16_t regaddr;
+    uint16_t mask;      ///< Bits to update, 0xffff to write without reading
+    uint16_t value;
+    uint16_t rb;        ///< Register value before update (when read)
+};
+typedef struct lowlevel_drp_rmw lowlevel_drp_rmw_t;
+
+// Registers are read first and then written in one batch, so every register
+// should appear in the list once
+int lowlevel_drp_rmw16(lldev_t dev, subdev_t subdev, unsigned port,
+                       lowlevel_drp_rmw_t* regs, unsigned count);
+
 static inline int lowlevel_gpo_wr8(lldev_t dev, subdev_t subdev, unsigned addr, uint8_t out) {
     return lowlevel_get_ops(dev)->ls_op(dev, subdev, USDR_LSOP_GPO, addr, 0, NULL, 1, &out);
 }
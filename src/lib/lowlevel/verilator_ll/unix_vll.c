@@ -7,6 +7,10 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
 
 
 static
@@ -37,6 +41,10 @@ int _vll_chan_create_int(struct vll_chan* vc, const char* dev, bool server)
     }
 
     vc->fd = s;
+    vc->server = server;
+    if (server) {
+        vc->ring = NULL;
+    }
     return 0;
 }
 
@@ -52,9 +60,16 @@ int vll_chan_connect(struct vll_chan* vc, const char* dev)
     return _vll_chan_create_int(vc, dev, false);
 }
 
+static int vll_ring_send(struct vll_chan* vc, const uint8_t* data, unsigned size);
+static int vll_ring_recv(struct vll_chan* vc, uint8_t* data, unsigned max_size);
+static bool vll_ring_active(struct vll_chan* vc);
+
 int vll_chan_send_sync(struct vll_chan* vc, const uint8_t* data, unsigned size)
 {
     int res;
+    if (vll_ring_active(vc))
+        return vll_ring_send(vc, data, size);
+
     res = send(vc->fd, data, size, MSG_NOSIGNAL); //MSG_DONTWAIT
     return res;
 }
@@ -62,12 +77,16 @@ int vll_chan_send_sync(struct vll_chan* vc, const uint8_t* data, unsigned size)
 int vll_chan_recv_sync(struct vll_chan* vc, uint8_t* data, unsigned max_size)
 {
     int res;
+    if (vll_ring_active(vc))
+        return vll_ring_recv(vc, data, max_size);
+
     res = recv(vc->fd, data, max_size, 0);
     return res;
 }
 
 int vll_chan_close(struct vll_chan* vc)
 {
+    vll_ring_detach(vc);
     close(vc->fd);
     return 0;
 }
@@ -129,3 +148,294 @@ int vll_mem_close(struct vll_mem* mm)
     return 0;
 }
 
+
+
+enum {
+    VLL_RING_MAGIC = 0x564c4c52, // VLLR
+    VLL_RING_VERSION = 1,
+
+    VLL_RING_DATA_SZ = 0x10000,
+    VLL_RING_MSK = VLL_RING_DATA_SZ - 1,
+
+    // Spin before going to sleep, the peer usually answers within a few
+    // simulator cycles. Useless on a single CPU, the peer can't run meanwhile
+    VLL_RING_SPIN = 2000,
+    // Sleep slice to check peer liveness
+    VLL_RING_WAIT_NS = 100 * 1000 * 1000,
+};
+
+enum vll_ring_state {
+    VLL_RS_NONE = 0,
+    VLL_RS_LISTEN = 1,
+    VLL_RS_ATTACHING = 2,
+    VLL_RS_ATTACHED = 3,
+};
+
+enum vll_ring_dirs {
+    VLL_DIR_TO_SERVER = 0,
+    VLL_DIR_TO_CLIENT = 1,
+};
+
+#define VLL_CACHELINE 64
+
+// Single producer / single consumer byte ring, indexes are free running.
+// `*_seq` are futex words, `*_wait` are set by the side going to sleep so the
+// other side makes the wake syscall only when it's needed.
+struct vll_ring_dir {
+    uint32_t head;
+    uint8_t _pad0[VLL_CACHELINE - 4];
+    uint32_t tail;
+    uint8_t _pad1[VLL_CACHELINE - 4];
+    uint32_t data_seq;
+    uint32_t data_wait;
+    uint8_t _pad2[VLL_CACHELINE - 8];
+    uint32_t space_seq;
+    uint32_t space_wait;
+    uint8_t _pad3[VLL_CACHELINE - 8];
+
+    uint8_t data[VLL_RING_DATA_SZ];
+};
+
+struct vll_ring_shm {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t state;
+    int32_t server_pid;
+    int32_t client_pid;
+    uint8_t _pad[VLL_CACHELINE - 20];
+
+    struct vll_ring_dir dir[2];
+};
+
+_Static_assert(sizeof(struct vll_ring_shm) <= VLL_RING_REGION_SIZE, "ring doesn't fit its region");
+
+static long vll_futex(uint32_t* uaddr, int op, uint32_t val, const struct timespec* ts)
+{
+    // Not FUTEX_PRIVATE, the word lives in memory shared between processes
+    return syscall(SYS_futex, uaddr, op, val, ts, NULL, 0);
+}
+
+static void vll_ring_ring(uint32_t* seq, uint32_t* wait)
+{
+    if (__atomic_load_n(wait, __ATOMIC_SEQ_CST)) {
+        __atomic_fetch_add(seq, 1, __ATOMIC_SEQ_CST);
+        vll_futex(seq, FUTEX_WAKE, 1, NULL);
+    }
+}
+
+static bool vll_ring_active(struct vll_chan* vc)
+{
+    return vc->ring != NULL &&
+           __atomic_load_n(&vc->ring->state, __ATOMIC_ACQUIRE) == VLL_RS_ATTACHED;
+}
+
+static bool vll_ring_peer_alive(struct vll_chan* vc)
+{
+    struct vll_ring_shm* r = vc->ring;
+    pid_t peer = vc->server ? r->client_pid : r->server_pid;
+
+    return !(kill(peer, 0) != 0 && errno == ESRCH);
+}
+
+// Waits until `*idx` moves from `old`; returns 0, -EPIPE when the peer is gone
+static int vll_ring_wait(struct vll_chan* vc, uint32_t* idx, uint32_t old,
+                         uint32_t* seq, uint32_t* wait)
+{
+    const struct timespec ts = { 0, VLL_RING_WAIT_NS };
+    static int spin = -1;
+
+    if (spin < 0) {
+        spin = (sysconf(_SC_NPROCESSORS_ONLN) > 1) ? VLL_RING_SPIN : 0;
+    }
+
+    for (int k = 0; k < spin; k++) {
+        if (__atomic_load_n(idx, __ATOMIC_ACQUIRE) != old)
+            return 0;
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+
+    for (;;) {
+        uint32_t s = __atomic_load_n(seq, __ATOMIC_SEQ_CST);
+        __atomic_store_n(wait, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(idx, __ATOMIC_SEQ_CST) != old) {
+            __atomic_store_n(wait, 0, __ATOMIC_RELAXED);
+            return 0;
+        }
+
+        long res = vll_futex(seq, FUTEX_WAIT, s, &ts);
+        __atomic_store_n(wait, 0, __ATOMIC_RELAXED);
+
+        if (__atomic_load_n(idx, __ATOMIC_ACQUIRE) != old)
+            return 0;
+        if (!vll_ring_active(vc))
+            return -EPIPE;
+        if (res != 0 && errno == ETIMEDOUT && !vll_ring_peer_alive(vc))
+            return -EPIPE;
+    }
+}
+
+static int vll_ring_send(struct vll_chan* vc, const uint8_t* data, unsigned size)
+{
+    struct vll_ring_dir* d = &vc->ring->dir[vc->server ? VLL_DIR_TO_CLIENT : VLL_DIR_TO_SERVER];
+    uint32_t head = d->head;
+    uint32_t tail;
+    unsigned off, part;
+    int res;
+
+    if (size > VLL_RING_DATA_SZ)
+        return -EINVAL;
+
+    for (;;) {
+        tail = __atomic_load_n(&d->tail, __ATOMIC_ACQUIRE);
+        if (VLL_RING_DATA_SZ - (head - tail) >= size)
+            break;
+
+        res = vll_ring_wait(vc, &d->tail, tail, &d->space_seq, &d->space_wait);
+        if (res)
+            return res;
+    }
+
+    off = head & VLL_RING_MSK;
+    part = VLL_RING_DATA_SZ - off;
+    if (part >= size) {
+        memcpy(d->data + off, data, size);
+    } else {
+        memcpy(d->data + off, data, part);
+        memcpy(d->data, data + part, size - part);
+    }
+
+    // Whole packet becomes visible at once
+    __atomic_store_n(&d->head, head + size, __ATOMIC_SEQ_CST);
+    vll_ring_ring(&d->data_seq, &d->data_wait);
+    return size;
+}
+
+static int vll_ring_recv(struct vll_chan* vc, uint8_t* data, unsigned max_size)
+{
+    struct vll_ring_dir* d = &vc->ring->dir[vc->server ? VLL_DIR_TO_SERVER : VLL_DIR_TO_CLIENT];
+    uint32_t tail = d->tail;
+    uint32_t head;
+    unsigned off, part, size;
+    int res;
+
+    for (;;) {
+        head = __atomic_load_n(&d->head, __ATOMIC_ACQUIRE);
+        if (head != tail)
+            break;
+
+        res = vll_ring_wait(vc, &d->head, head, &d->data_seq, &d->data_wait);
+        if (res)
+            return res;
+    }
+
+    size = head - tail;
+    if (size > max_size)
+        size = max_size;
+
+    off = tail & VLL_RING_MSK;
+    part = VLL_RING_DATA_SZ - off;
+    if (part >= size) {
+        memcpy(data, d->data + off, size);
+    } else {
+        memcpy(data, d->data + off, part);
+        memcpy(data + part, d->data, size - part);
+    }
+
+    __atomic_store_n(&d->tail, tail + size, __ATOMIC_SEQ_CST);
+    vll_ring_ring(&d->space_seq, &d->space_wait);
+    return size;
+}
+
+unsigned vll_chan_pending(struct vll_chan* vc)
+{
+    struct vll_ring_dir* d;
+    int avail = 0;
+
+    if (!vll_ring_active(vc)) {
+        if (ioctl(vc->fd, FIONREAD, &avail))
+            return 0;
+        return avail;
+    }
+
+    d = &vc->ring->dir[vc->server ? VLL_DIR_TO_SERVER : VLL_DIR_TO_CLIENT];
+    return __atomic_load_n(&d->head, __ATOMIC_ACQUIRE) - d->tail;
+}
+
+int vll_ring_create(struct vll_chan* vc, struct vll_mem* mm, uint32_t off)
+{
+    struct vll_ring_shm* r;
+    int res = vll_mem_protect(mm, off, VLL_RING_REGION_SIZE, PROT_READ | PROT_WRITE);
+    if (res)
+        return res;
+
+    r = (struct vll_ring_shm*)((uint8_t*)mm->addr + off);
+    memset(r, 0, sizeof(*r));
+    r->magic = VLL_RING_MAGIC;
+    r->version = VLL_RING_VERSION;
+    r->server_pid = getpid();
+    __atomic_store_n(&r->state, VLL_RS_LISTEN, __ATOMIC_RELEASE);
+
+    vc->ring = r;
+    vc->server = true;
+    return 0;
+}
+
+int vll_ring_attach(struct vll_chan* vc, struct vll_mem* mm, uint32_t off)
+{
+    struct vll_ring_shm* r;
+    uint32_t state = VLL_RS_LISTEN;
+    int res = vll_mem_protect(mm, off, VLL_RING_REGION_SIZE, PROT_READ | PROT_WRITE);
+    if (res)
+        return res;
+
+    r = (struct vll_ring_shm*)((uint8_t*)mm->addr + off);
+    if (r->magic != VLL_RING_MAGIC || r->version != VLL_RING_VERSION)
+        goto no_ring;
+
+    // Left over by a simulator which is already gone
+    if (kill(r->server_pid, 0) != 0 && errno == ESRCH)
+        goto no_ring;
+
+    if (!__atomic_compare_exchange_n(&r->state, &state, VLL_RS_ATTACHING, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        res = -EBUSY;
+        goto failed;
+    }
+
+    // The server doesn't touch the rings until they are attached
+    for (unsigned i = 0; i < 2; i++) {
+        r->dir[i].head = r->dir[i].tail = 0;
+        r->dir[i].data_wait = r->dir[i].space_wait = 0;
+    }
+    r->client_pid = getpid();
+    __atomic_store_n(&r->state, VLL_RS_ATTACHED, __ATOMIC_RELEASE);
+
+    vc->ring = r;
+    vc->server = false;
+    return 0;
+
+no_ring:
+    res = -ENOENT;
+failed:
+    vll_mem_protect(mm, off, VLL_RING_REGION_SIZE, PROT_NONE);
+    return res;
+}
+
+void vll_ring_detach(struct vll_chan* vc)
+{
+    struct vll_ring_shm* r = vc->ring;
+    if (r == NULL)
+        return;
+
+    // The client gives the rings back to the server, the server retires them
+    __atomic_store_n(&r->state, vc->server ? VLL_RS_NONE : VLL_RS_LISTEN, __ATOMIC_RELEASE);
+    for (unsigned i = 0; i < 2; i++) {
+        __atomic_fetch_add(&r->dir[i].data_seq, 1, __ATOMIC_SEQ_CST);
+        vll_futex(&r->dir[i].data_seq, FUTEX_WAKE, 1, NULL);
+        __atomic_fetch_add(&r->dir[i].space_seq, 1, __ATOMIC_SEQ_CST);
+        vll_futex(&r->dir[i].space_seq, FUTEX_WAKE, 1, NULL);
+    }
+    vc->ring = NULL;
+}
@@ -22,8 +22,15 @@ extern "C" {
 #endif
 
 
+struct vll_ring_shm;
+
 struct vll_chan {
     int fd;
+
+    // Shared memory rings, when attached all the packets go there
+    // instead of the socket
+    struct vll_ring_shm* ring;
+    bool server;
 };
 
 int vll_chan_create(struct vll_chan* vc, const char* dev);
@@ -50,6 +57,23 @@ int vll_mem_protect(struct vll_mem* mm, uint32_t addr, uint32_t sz, int flags);
 
 int vll_mem_close(struct vll_mem* mm);
 
+
+// SPSC byte rings for both directions placed at `off` of the shared segment,
+// packets are published as a whole, a futex doorbell is rung only when the
+// peer sleeps. The server calls vll_ring_create() before accepting clients,
+// the client calls vll_ring_attach() before connecting the socket, otherwise
+// (ring isn't there or no server process owns it) the socket is used.
+enum {
+    VLL_RING_REGION_SIZE = 0x40000,
+};
+
+int vll_ring_create(struct vll_chan* vc, struct vll_mem* mm, uint32_t off);
+int vll_ring_attach(struct vll_chan* vc, struct vll_mem* mm, uint32_t off);
+void vll_ring_detach(struct vll_chan* vc);
+
+// Number of received bytes ready to be read without blocking
+unsigned vll_chan_pending(struct vll_chan* vc);
+
 #ifdef __cplusplus
 }
 #endif
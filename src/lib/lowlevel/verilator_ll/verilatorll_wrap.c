@@ -17,6 +17,7 @@
 #include <assert.h>
 
 #include <usdr_logging.h>
+#include <usdr_time.h>
 
 #include <string.h>
 #include <sys/un.h>
@@ -38,11 +39,24 @@ enum {
     MAX_INTERRUPTS = 32,
     TO_IRQ_POLL = 250,
 
+    // Bounds on how long MSIs wait for the channel to drain: packets read
+    // meanwhile and MSIs queued. The device confirms notifications in groups
+    // of 32, don't let it run out of the notification ring
+    NTFY_DEFER_MAX_PKTS = 16,
+    NTFY_DEFER_MAX_MSIS = 32,
+
     MAX_PACKET_SZ = 256,
 
     MMAP_SIZE = 0x100000000ul
 };
 
+enum {
+    PHYS_NTFY_BASE   = 0xfee00000,
+    PHYS_RING_BASE   = 0xfef00000,
+    PHYS_RX_DMA_ST_0 = 0x10000000,
+    PHYS_RX_DMA_OFF  = 0x01000000,
+};
+
 struct rbdata {
     uint32_t data[MAX_PACKET_SZ / 4];
 };
@@ -82,12 +96,6 @@ int vpu_init(verilator_protocol_unix_t* pvpu, const char* dev)
     if (res)
         goto mtx_failed;
 
-    res = vll_chan_connect(&pvpu->vch, dev);
-    if (res) {
-        USDR_LOG("VERI", USDR_LOG_CRITICAL_WARNING, "Connecton to verilator filed: error %d\n", res);
-        goto conn_failed;
-    }
-
     char mmapfile[256];
     snprintf(mmapfile, sizeof (mmapfile), "%s.mmap", dev);
     res = vll_mem_open(&pvpu->vchm, mmapfile, MMAP_SIZE);
@@ -96,6 +104,21 @@ int vpu_init(verilator_protocol_unix_t* pvpu, const char* dev)
         goto conn_failed;
     }
 
+    // Rings have to be attached before the simulator accepts the connection,
+    // it sends the device UUID right away
+    pvpu->vch.ring = NULL;
+    res = vll_ring_attach(&pvpu->vch, &pvpu->vchm, PHYS_RING_BASE);
+    if (res) {
+        USDR_LOG("VERI", USDR_LOG_NOTE, "Shared memory rings aren't available (%d), using socket\n", res);
+    }
+
+    res = vll_chan_connect(&pvpu->vch, dev);
+    if (res) {
+        USDR_LOG("VERI", USDR_LOG_CRITICAL_WARNING, "Connecton to verilator filed: error %d\n", res);
+        vll_ring_detach(&pvpu->vch);
+        goto conn_failed;
+    }
+
     return 0;
 
 conn_failed:
@@ -147,22 +170,112 @@ struct verilator_dev
     unsigned stat_dma_rx_wr;
 
     int delayed_ints;
+    bool ntfy_pending;
+    unsigned ntfy_deferred_pkts;
+    unsigned ntfy_deferred_msis;
 };
 
 typedef struct verilator_dev verilator_dev_t;
 
-enum {
-    PHYS_NTFY_BASE   = 0xfee00000,
-    PHYS_RX_DMA_ST_0 = 0x10000000,
-    PHYS_RX_DMA_OFF  = 0x01000000,
-};
-
 static int verilator_wrap_reg_out(verilator_dev_t* dev, unsigned reg,
                                 uint32_t outval);
 static int verilator_wrap_reg_in(verilator_dev_t* dev, unsigned reg,
                                uint32_t *pinval);
 #define NEW_EVNT_ABI
 
+// Scans the notification ring for all the events posted so far, so a burst
+// of MSIs queued in the channel is handled with a single pass
+static int verilator_process_ntfy(verilator_dev_t* dev)
+{
+    int res;
+    unsigned do_cnf = ~0u, i;
+    uint32_t* bptr = (uint32_t*)((uint8_t*)dev->proto.vchm.addr + PHYS_NTFY_BASE);
+
+    /*
+    if (rand() > RAND_MAX - RAND_MAX/200) {
+        USDR_LOG("VERI", USDR_LOG_ERROR, "Interrupt skipped!\n");
+        return 0;
+    }
+    */
+
+    // based on 128 bit notifications
+    for (i = dev->ntfy_idx; i < dev->ntfy_idx + 256; i++) {
+        uint32_t data[4];
+        unsigned event_no, flags, j;
+
+        for (j = 0; j < 4; j++)
+            data[j] = ntohl(bptr[(4 * i + j) & 0x3ff]);
+
+#ifndef NEW_EVNT_ABI
+        event_no = data[3] >> 29;
+        flags = (data[3] & (1u<<28)) ? 1 : 0;
+#else
+        flags = data[0] >> 31;
+        event_no = data[0] & 0x3f;
+#endif
+        if (flags != ((i >> 8) & 1)) {
+            break;
+        }
+        if (i % 32 == 31) {
+            do_cnf = (i << 1) & 0x3ff;
+        }
+
+        USDR_LOG("VERI", USDR_LOG_TRACE, "BUCKET %d: Event %d Flag: %d; RPTR %d; Data: %08x_%08x_%08x_%08x\n",
+                 i, event_no, flags, dev->ntfy_idx, data[3], data[2], data[1], data[0]);
+
+        {
+            unsigned irq = event_no;
+
+            if  (irq == 0) {
+#ifndef NEW_EVNT_ABI
+                dev->stat_dma_rx[4 * dev->stat_dma_rx_wr + 0] = data[2];
+                dev->stat_dma_rx[4 * dev->stat_dma_rx_wr + 1] = data[1];
+                dev->stat_dma_rx[4 * dev->stat_dma_rx_wr + 2] = data[0];
+#else
+                dev->stat_dma_rx[4 * dev->stat_dma_rx_wr + 0] = data[1];
+                dev->stat_dma_rx[4 * dev->stat_dma_rx_wr + 1] = data[2];
+                dev->stat_dma_rx[4 * dev->stat_dma_rx_wr + 2] = data[3];
+#endif
+                if (++dev->stat_dma_rx_wr == 64)
+                    dev->stat_dma_rx_wr = 0;
+            }
+
+            if (irq == 0) {
+                if (dev->ntfy_idx == 132) {
+                    dev->delayed_ints++;
+                    goto skip_interrupt;
+                }
+            }
+
+            for (;;) {
+                res = sem_post(&dev->interrupts[irq]);
+                if (res)
+                    return res;
+                if (irq != 0)
+                    break;
+                if (dev->delayed_ints == 0)
+                    break;
+
+                dev->delayed_ints--;
+            }
+            skip_interrupt:;
+        }
+
+    }
+
+    dev->ntfy_idx = i & 0x1ff;
+
+    if (do_cnf != ~0u) {
+        //Send confirmation pointer
+        verilator_wrap_reg_out(dev, 9, (0 << 16) | do_cnf);
+    }
+
+    dev->ntfy_pending = false;
+    dev->ntfy_deferred_pkts = 0;
+    dev->ntfy_deferred_msis = 0;
+    return 0;
+}
+
 int verilator_process_recv(verilator_dev_t* dev)
 {
     uint32_t buffer[64];
@@ -199,136 +312,9 @@ int verilator_process_recv(verilator_dev_t* dev)
         if (res)
             return res;
 #else
-        unsigned do_cnf = ~0u, i;
-        uint32_t* bptr = (uint32_t*)((uint8_t*)dev->proto.vchm.addr + PHYS_NTFY_BASE);
-
-        /*
-        if (rand() > RAND_MAX - RAND_MAX/200) {
-            USDR_LOG("VERI", USDR_LOG_ERROR, "Interrupt skipped!\n");
-            return 0;
-        }
-        */
-
-        // based on 128 bit notifications
-        for (i = dev->ntfy_idx; i < dev->ntfy_idx + 256; i++) {
-            uint32_t data[4];
-            unsigned event_no, flags, j;
-
-            for (j = 0; j < 4; j++)
-                data[j] = ntohl(bptr[(4 * i + j) & 0x3ff]);
-
-#ifndef NEW_EVNT_ABI
-            event_no = data[3] >> 29;
-            flags = (data[3] & (1u<<28)) ? 1 : 0;
-#else
-            flags = data[0] >> 31;
-            event_no = data[0] & 0x3f;
-#endif
-            if (flags != ((i >> 8) & 1)) {
-                break;
-            }
-            if (i % 32 == 31) {
-                do_cnf = (i << 1) & 0x3ff;
-            }
-
-            USDR_LOG("VERI", USDR_LOG_TRACE, "BUCKET %d IRQ %d: Event %d Flag: %d; RPTR %d; Data: %08x_%08x_%08x_%08x\n",
-                     i, hdr.tag, event_no, flags, dev->ntfy_idx, data[3], data[2], data[1], data[0]);
-
-            {
-                unsigned irq = event_no;
-
-                if  (irq == 0) {
-#ifndef NEW_EVNT_ABI
-                    dev->stat_dma_rx[4 * dev->stat_dma_rx_wr + 0] = data[2];
-                    dev->stat_dma_rx[4 * dev->stat_dma_rx_wr + 1] = data[1];
-                    dev->stat_dma_rx[4 * dev->stat_dma_rx_wr + 2] = data[0];
-#else
-                    dev->stat_dma_rx[4 * dev->stat_dma_rx_wr + 0] = data[1];
-                    dev->stat_dma_rx[4 * dev->stat_dma_rx_wr + 1] = data[2];
-                    dev->stat_dma_rx[4 * dev->stat_dma_rx_wr + 2] = data[3];
-#endif
-                    if (++dev->stat_dma_rx_wr == 64)
-                        dev->stat_dma_rx_wr = 0;
-                }
-
-                if (irq == 0) {
-                    if (dev->ntfy_idx == 132) {
-                        dev->delayed_ints++;
-                        goto skip_interrupt;
-                    }
-                }
-
-                for (;;) {
-                    res = sem_post(&dev->interrupts[irq]);
-                    if (res)
-                        return res;
-                    if (irq != 0)
-                        break;
-                    if (dev->delayed_ints == 0)
-                        break;
-
-                    dev->delayed_ints--;
-                }
-                skip_interrupt:;
-            }
-
-        }
-
-        dev->ntfy_idx = i & 0x1ff;
-
-        if (do_cnf != ~0u) {
-            //Send confirmation pointer
-            verilator_wrap_reg_out(dev, 9, (0 << 16) | do_cnf);
-        }
-
-#if 0
-        uint32_t* ntfy_mem = (uint32_t*)((uint8_t*)dev->proto.vchm.addr + PHYS_NTFY_BASE) + ((2 * dev->ntfy_idx) % 1024);
-        // 128 bit ntfy
-        unsigned irq = (ntfy_mem[3] & 0xff) >> 5;
-        dev->rb_event_data[irq] = ntohl(ntfy_mem[0]);
-
-        USDR_LOG("VERI", USDR_LOG_TRACE, "Interrupt %d (from %d) idx=%d [Event %08x %08x %08x %08x]\n", hdr.tag,
-                 irq, dev->ntfy_idx,
-                 ntfy_mem[0], ntfy_mem[1], ntfy_mem[2], ntfy_mem[3]);
-
-        dev->ntfy_idx += 2;
-        if (dev->ntfy_idx >= 1024)
-            dev->ntfy_idx = 0;
-
-        // Confirm each 128 events
-        if (dev->ntfy_idx % 128 == 124) {
-            verilator_wrap_reg_out(dev, 9, dev->ntfy_idx);
-        }
-
-        if  (irq == 0) {
-            dev->stat_dma_rx[4 * dev->stat_dma_rx_wr + 0] = htonl(ntfy_mem[2]);
-            dev->stat_dma_rx[4 * dev->stat_dma_rx_wr + 1] = htonl(ntfy_mem[1]);
-            dev->stat_dma_rx[4 * dev->stat_dma_rx_wr + 2] = htonl(ntfy_mem[0]);
-            if (++dev->stat_dma_rx_wr == 64)
-                dev->stat_dma_rx_wr = 0;
-        }
-
-
-        if (irq == 0) {
-            if (dev->ntfy_idx == 132) {
-                dev->delayed_ints++;
-                return 0;
-            }
-        }
-
-        for (;;) {
-            res = sem_post(&dev->interrupts[irq]);
-            if (res)
-                return res;
-            if (irq != 0)
-                break;
-            if (dev->delayed_ints == 0)
-                break;
-
-            dev->delayed_ints--;
-        }
-#endif
-
+        // Deferred until the channel is drained, see thread_verilator()
+        dev->ntfy_pending = true;
+        dev->ntfy_deferred_msis++;
 #endif
         break;
     default:
@@ -409,6 +395,19 @@ void* thread_verilator(void* obj)
             USDR_LOG("VERI", USDR_LOG_DEBUG, "Verilator monitor thread error: %d\n", res);
             return (void*)(intptr_t)res;
         }
+
+        // Batch DMA / event completions, but don't starve them under
+        // continuous traffic
+        if (dev->ntfy_pending &&
+            (++dev->ntfy_deferred_pkts >= NTFY_DEFER_MAX_PKTS ||
+             dev->ntfy_deferred_msis >= NTFY_DEFER_MAX_MSIS ||
+             vll_chan_pending(&dev->proto.vch) == 0)) {
+            res = verilator_process_ntfy(dev);
+            if (res < 0) {
+                USDR_LOG("VERI", USDR_LOG_DEBUG, "Verilator monitor thread error: %d\n", res);
+                return (void*)(intptr_t)res;
+            }
+        }
     }
 
     USDR_LOG("VERI", USDR_LOG_NOTE, "Verilator monitor thread stopped\n");
@@ -558,29 +557,7 @@ int verilator_wrap_reg_op(verilator_dev_t* d, unsigned ls_op_addr,
 
 static int verilator_wrap_wait_msi(verilator_dev_t* dev, unsigned i, int timeout_ms)
 {
-    int res;
-    struct timespec ts;
-    res = clock_gettime(CLOCK_REALTIME, &ts);
-    if (res)
-        return -EFAULT;
-
-    if (timeout_ms > 0) {
-        ts.tv_nsec += timeout_ms * 1000 * 1000;
-        while (ts.tv_nsec > 1000 * 1000 * 1000) {
-            ts.tv_nsec -= 1000 * 1000 * 1000;
-            ts.tv_sec++;
-        }
-        res = sem_timedwait(&dev->interrupts[i], &ts);
-    } else if (timeout_ms < 0) {
-        res = sem_wait(&dev->interrupts[i]);
-    } else {
-        res = sem_trywait(&dev->interrupts[i]);
-    }
-    if (res) {
-        // sem_* function on error returns -1, get proper error
-        res = -errno;
-    }
-    return res;
+    return usdr_sem_wait_ns(&dev->interrupts[i], (timeout_ms < 0) ? -1 : (int64_t)timeout_ms * 1000 * 1000);
 }
 
 static
@@ -879,7 +856,7 @@ int verilator_wrap_plugin_create(unsigned pcount, const char** devparam,
     device_id_t did;
 
 
-    dev = (verilator_dev_t*)malloc(sizeof(verilator_dev_t));
+    dev = (verilator_dev_t*)calloc(1, sizeof(verilator_dev_t));
     if (dev == NULL) {
         res = ENOMEM;
         goto init_fail;
@@ -178,8 +178,11 @@ int usdr_dmd_create_string(const char* connection_string, pdm_dev_t* odev)
             }
             bus_cnt = j;
         } else if (strcmp(par.params[k], "loglevel") == 0) {
-            int loglevel = atoi(par.value[k]);
-            usdrlog_setlevel(NULL, loglevel);
+            // Either a single level or per subsystem levels, e.g. loglevel=3:LMS7=debug
+            if (usdrlog_setlevels(par.value[k])) {
+                USDR_LOG("DSTR", USDR_LOG_WARNING, "Incorrect loglevel=`%s`\n",
+                         par.value[k] ? par.value[k] : "");
+            }
         }
     }
 
@@ -5,6 +5,7 @@
 #include "dm_dev_impl.h"
 
 #include "../ipblks/streams/streams_api.h"
+#include "../ipblks/streams/stream_telemetry.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -101,12 +102,38 @@ int usdr_dms_get_fd(pusdr_dms_t stream)
     return fd;
 }
 
+int usdr_dms_get_option(pusdr_dms_t stream, const char* name, int64_t* value)
+{
+    struct stream_handle* h = (struct stream_handle*)stream;
+    return h->ops->option_get(h, name, value);
+}
+
+int usdr_dms_set_option(pusdr_dms_t stream, const char* name, int64_t value)
+{
+    struct stream_handle* h = (struct stream_handle*)stream;
+    return h->ops->option_set(h, name, value);
+}
+
 int usdr_dms_set_ready(pusdr_dms_t stream)
 {
     struct stream_handle* h = (struct stream_handle*)stream;
     return h->ops->option_set(h, "ready", 1);
 }
 
+int usdr_dms_get_telemetry(pusdr_dms_t stream, usdr_dms_telemetry_t* t)
+{
+    struct stream_handle* h = (struct stream_handle*)stream;
+    if (h->ops->telemetry == NULL)
+        return -ENOTSUP;
+
+    return h->ops->telemetry(h, t);
+}
+
+uint64_t usdr_dms_histogram_percentile(const struct usdr_dms_histogram* h, double pct)
+{
+    return stream_telemetry_percentile(h, pct);
+}
+
 int usdr_dms_op(pusdr_dms_t stream,
                 unsigned command,
                 dm_time_t tm)
@@ -132,6 +159,41 @@ int usdr_dms_recv(pusdr_dms_t stream,
     return h->ops->recv(h, (char**)stream_buffs, timeout_ms, nfo);
 }
 
+int usdr_dms_recv_ex(pusdr_dms_t stream,
+                     void **stream_buffs,
+                     unsigned timeout_ms,
+                     usdr_dms_recv_nfo_t *nfo,
+                     usdr_dms_burst_nfo_t *bursts,
+                     unsigned max_bursts,
+                     unsigned *nbursts)
+{
+    struct stream_handle* h = (struct stream_handle*)stream;
+    usdr_dms_recv_nfo_t lnfo;
+    int res;
+
+    if (h->ops->recv_bursts) {
+        return h->ops->recv_bursts(h, (char**)stream_buffs, timeout_ms, nfo,
+                                   bursts, max_bursts, nbursts);
+    }
+
+    if (nfo == NULL)
+        nfo = &lnfo;
+
+    if (nbursts)
+        *nbursts = 0;
+    res = h->ops->recv(h, (char**)stream_buffs, timeout_ms, nfo);
+    if (res || bursts == NULL || nbursts == NULL || max_bursts == 0)
+        return res;
+
+    bursts[0].time = nfo->fsymtime;
+    bursts[0].offset = 0;
+    bursts[0].samples = nfo->totsyms;
+    bursts[0].lost = 0;
+    bursts[0].flags = 0;
+    *nbursts = 1;
+    return 0;
+}
+
 int usdr_dms_send(pusdr_dms_t stream,
                   const void **stream_buffs,
                   unsigned samples,
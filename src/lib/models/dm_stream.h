@@ -39,6 +39,45 @@ struct usdr_dms_stat {
     uint64_t spurios_op;
 };
 
+// Log-linear latency buckets: 4 linear 64ns buckets, then 4 buckets per
+// octave up to ~2.1s; the last bucket also collects everything above
+enum {
+    USDR_DMS_HIST_BUCKETS = 96,
+};
+
+struct usdr_dms_histogram {
+    uint64_t count;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+    uint64_t buckets[USDR_DMS_HIST_BUCKETS];
+};
+
+// Cumulative since the stream creation, all times are CLOCK_MONOTONIC ns
+struct usdr_dms_telemetry {
+    uint64_t snap_ns;           // time of the snapshot
+    uint64_t calls;             // recv() / send() calls
+    uint64_t packets;           // DMA buffers transferred
+    uint64_t wire_bytes;
+    uint64_t symbols;
+    uint64_t timeouts;
+
+    uint64_t dma_wait_ns;       // waiting for a filled / free DMA buffer
+    uint64_t conv_ns;           // format conversion and host side correction
+
+    uint64_t occupancy;         // TX FIFO fill on the last send, 0 -- EMPTY; 255 -- FULL
+    uint64_t occupancy_max;
+
+    uint64_t overruns;          // RX packets lost by the device
+    uint64_t underruns;         // TX bursts dropped by the frontend
+    uint64_t late;              // TX bursts dropped by DMA as late
+    uint64_t last_overrun_ns;   // 0 -- never
+    uint64_t last_underrun_ns;
+    uint64_t last_late_ns;
+
+    struct usdr_dms_histogram call_latency;
+};
+typedef struct usdr_dms_telemetry usdr_dms_telemetry_t;
+
 struct usdr_channel_info {
     unsigned count;
     unsigned flags;
@@ -72,7 +111,12 @@ int usdr_dms_create_ex(pdm_dev_t device,
                        unsigned flags,
                        pusdr_dms_t* outu);
 
-
+// parameters -- ':' separated stream options, NULL for defaults
+//   iqcorr_<on|dc|iq|off>  RX host side DC offset / IQ imbalance correction (ci16 / cf32 host formats)
+//   iqtau_<samples>        correction estimator time constant
+//   devmem_<on|off>        RX zero-copy transfer buffers when available, default on
+//   usblat_<us>            RX adaptive USB transfer depth bounded by latency, default fixed depth
+//   trace_<file>           record raw DMA buffers and metadata for offline replay (`bus=synth,replayrx=<file>`)
 int usdr_dms_create_ex2(pdm_dev_t device,
                         const char* sobj,
                         const char* dformat,
@@ -97,6 +141,21 @@ struct usdr_dms_recv_nfo {
 };
 typedef struct usdr_dms_recv_nfo usdr_dms_recv_nfo_t;
 
+enum usdr_dms_burst_flags {
+    USDR_DMS_BURST_GAP = 1,     // Samples were lost right before the burst, see `lost`
+    USDR_DMS_BURST_PARTIAL = 2, // Frontend didn't report the burst as complete
+};
+
+// Per burst metadata of a received buffer
+struct usdr_dms_burst_nfo {
+    dm_time_t time;   // Timestamp of the first sample
+    unsigned offset;  // Offset of the first sample in the channel buffers
+    unsigned samples;
+    unsigned lost;    // Samples lost right before the burst
+    unsigned flags;   // usdr_dms_burst_flags
+};
+typedef struct usdr_dms_burst_nfo usdr_dms_burst_nfo_t;
+
 struct usdr_dms_send_stat {
     dm_time_t lhwtime;
     dm_time_t opkttime;
@@ -115,6 +174,18 @@ int usdr_dms_recv(pusdr_dms_t stream,
                   unsigned timeout_ms,
                   usdr_dms_recv_nfo_t *nfo);
 
+// Same as usdr_dms_recv(), also fills up to `max_bursts` entries of the caller
+// provided `bursts` side buffer, in buffer order; `*nbursts` is the number of
+// entries filled. Streams without burst reporting fill a single entry.
+// `bursts` and `nbursts` may be NULL, then no burst metadata is reported.
+int usdr_dms_recv_ex(pusdr_dms_t stream,
+                     void **stream_buffs,
+                     unsigned timeout_ms,
+                     usdr_dms_recv_nfo_t *nfo,
+                     usdr_dms_burst_nfo_t *bursts,
+                     unsigned max_bursts,
+                     unsigned *nbursts);
+
 int usdr_dms_send(pusdr_dms_t stream,
                   const void **stream_buffs,
                   unsigned samples,
@@ -135,8 +206,23 @@ int usdr_dms_info(pusdr_dms_t stream, usdr_dms_nfo_t* nfo);
 // get fd for poll() like operation
 int usdr_dms_get_fd(pusdr_dms_t stream);
 
+// Stream specific options:
+//   fd       - (ro) same as usdr_dms_get_fd()
+//   devmem   - (ro) 1 when transfer buffers are zero-copy (driver mapped), 0 when bounced through host memory
+//   usbdepth - (ro) USB RX transfers in flight
+//   usblat   - USB RX adaptive depth latency bound in us, 0 freezes the current depth
+int usdr_dms_get_option(pusdr_dms_t stream, const char* name, int64_t* value);
+int usdr_dms_set_option(pusdr_dms_t stream, const char* name, int64_t value);
+
 int usdr_dms_set_ready(pusdr_dms_t stream);
 
+// Consistent copy of the stream counters, safe to call from any thread while
+// the stream is running. Returns -ENOTSUP if the stream doesn't keep them.
+int usdr_dms_get_telemetry(pusdr_dms_t stream, usdr_dms_telemetry_t* t);
+
+// Upper bound of the bucket holding the pct (0..100) percentile, 0 if empty
+uint64_t usdr_dms_histogram_percentile(const struct usdr_dms_histogram* h, double pct);
+
 // none   - no syncing beetween streams
 // all    - sync between all active streams
 // extall - sync between all active streams on extrenal sync event (onepps)
@@ -1,19 +1,139 @@
 // Copyright (c) 2023-2024 Wavelet Lab
 // SPDX-License-Identifier: MIT
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
 #include "usdr_logging.h"
+#include "usdr_time.h"
 #include <time.h>
 #include <stdio.h>
 #include <stdarg.h>
 #include <stdlib.h>
+#include <strings.h>
+#include <semaphore.h>
+#include <signal.h>
 
 static unsigned s_def_loglevel = USDR_LOG_ERROR;
 static bool s_colorize = false;
 
+// Slot 0 marks an unresolved call site, the last slot is shared by all
+// subsystems that didn't fit and always follows the default level
+enum {
+    SUBSYS_OVERFLOW = USDRLOG_MAX_SUBSYSTEMS - 1,
+    SUBSYS_NAME_MAX = 16,
+};
+
+struct log_subsystem {
+    char name[SUBSYS_NAME_MAX];
+    bool explicit_level;
+};
+
+unsigned usdrlog_levels[USDRLOG_MAX_SUBSYSTEMS];
+
+static struct log_subsystem s_subsys[USDRLOG_MAX_SUBSYSTEMS];
+static unsigned s_subsys_cnt = 1;
+static pthread_mutex_t s_subsys_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Lock free, names are never changed once published
+static int log_subsys_find(const char* name)
+{
+    unsigned cnt = __atomic_load_n(&s_subsys_cnt, __ATOMIC_ACQUIRE);
+    for (unsigned i = 1; i < cnt; i++) {
+        if (strncmp(s_subsys[i].name, name, SUBSYS_NAME_MAX - 1) == 0)
+            return i;
+    }
+    return -1;
+}
+
+// Called under s_subsys_lock
+static unsigned log_subsys_intern(const char* name)
+{
+    int idx = log_subsys_find(name);
+    if (idx >= 0)
+        return idx;
+
+    if (s_subsys_cnt == SUBSYS_OVERFLOW)
+        return SUBSYS_OVERFLOW;
+
+    idx = s_subsys_cnt;
+    strncpy(s_subsys[idx].name, name, SUBSYS_NAME_MAX - 1);
+    s_subsys[idx].explicit_level = false;
+    __atomic_store_n(&usdrlog_levels[idx], s_def_loglevel, __ATOMIC_RELAXED);
+    __atomic_store_n(&s_subsys_cnt, idx + 1, __ATOMIC_RELEASE);
+    return idx;
+}
+
+unsigned usdrlog_site_resolve(unsigned* site, const char* subsystem)
+{
+    unsigned sid;
+
+    pthread_mutex_lock(&s_subsys_lock);
+    sid = log_subsys_intern(subsystem ? subsystem : "");
+    pthread_mutex_unlock(&s_subsys_lock);
+
+    __atomic_store_n(site, sid, __ATOMIC_RELAXED);
+    return sid;
+}
+
+static const char* s_level_names[] = {
+    "error", "crit", "warning", "info", "note", "debug", "trace",
+};
+
+static int log_level_parse(const char* str, unsigned* level)
+{
+    char* end;
+    unsigned long v = strtoul(str, &end, 10);
+    if (end != str && *end == 0) {
+        *level = (v > USDR_LOG_TRACE) ? USDR_LOG_TRACE : (unsigned)v;
+        return 0;
+    }
+
+    for (unsigned i = 0; i < SIZEOF_ARRAY(s_level_names); i++) {
+        if (strcasecmp(str, s_level_names[i]) == 0) {
+            *level = i;
+            return 0;
+        }
+    }
+    return -EINVAL;
+}
+
+int usdrlog_setlevels(const char* spec)
+{
+    char buf[1024];
+    char *item, *saveptr, *eq;
+    unsigned level;
+    int res = 0;
+
+    if (spec == NULL)
+        return -EINVAL;
+
+    strncpy(buf, spec, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = 0;
+
+    for (item = strtok_r(buf, ",:;", &saveptr); item; item = strtok_r(NULL, ",:;", &saveptr)) {
+        eq = strchr(item, '=');
+        if (eq)
+            *eq = 0;
+
+        if (log_level_parse(eq ? eq + 1 : item, &level)) {
+            res = -EINVAL;
+            continue;
+        }
+        usdrlog_setlevel(eq ? item : NULL, level);
+    }
+    return res;
+}
+
 void __attribute__ ((constructor(101))) setup_logging(void) {
     char *envlog = getenv("USDR_LOGLEVEL");
-    if (envlog) {
-        s_def_loglevel = atoi(envlog);
+    if (envlog && usdrlog_setlevels(envlog)) {
+        fprintf(stderr, "Incorrect USDR_LOGLEVEL=`%s`\n", envlog);
+    }
+
+    char *envasync = getenv("USDR_LOG_ASYNC");
+    if (envasync && atoi(envasync)) {
+        usdrlog_set_async(true);
     }
 }
 
@@ -94,34 +214,29 @@ const struct tm* usdr_localtime(time_t now)
 
 bool usdr_check_level(unsigned loglevel, const char* subsystem)
 {
-    return loglevel <= s_def_loglevel;
+    return loglevel <= usdrlog_getlevel(subsystem);
 }
 
 #define MAX_LOG_LINE 8912
 
-void usdrlog_vout(unsigned loglevel,
-                  const char* subsystem,
-                  const char* function,
-                  const char* file,
-                  int line,
-                  const char* fmt,
-                  va_list list)
+static bool usdrlog_async_post(const struct timespec* tp, unsigned loglevel, const char* subsystem,
+                               const char* function, int line, const char* fmt, va_list list);
+
+static
+void usdrlog_format_out(const struct timespec* tp,
+                        unsigned loglevel,
+                        const char* subsystem,
+                        const char* function,
+                        int line,
+                        const char* fmt,
+                        va_list list)
 {
-    (void)file;
     char buf[MAX_LOG_LINE];
     size_t stsz;
     int sz;
 
-    if (loglevel > USDR_LOG_TRACE)
-        loglevel = USDR_LOG_TRACE;
-
-    if (!usdr_check_level(loglevel, subsystem))
-        return;
-
-    struct timespec tp;
-    clock_gettime(CLOCK_REALTIME, &tp);
-    const struct tm* stm = usdr_localtime(tp.tv_sec);
-    int nsec = (int)tp.tv_nsec;
+    const struct tm* stm = usdr_localtime(tp->tv_sec);
+    int nsec = (int)tp->tv_nsec;
 
     stsz = strftime(buf, sizeof(buf), "%H:%M:%S.", stm);
     sz = snprintf(buf + stsz - 1, sizeof(buf) - stsz, ".%06d %s",
@@ -169,15 +284,373 @@ out_truncated:
     s_log_op(0, loglevel, buf);
 }
 
+static
+void usdrlog_format_outf(const struct timespec* tp, unsigned loglevel, const char* subsystem,
+                         const char* function, int line, const char* fmt, ...)
+{
+    va_list ap;
+
+    va_start(ap, fmt);
+    usdrlog_format_out(tp, loglevel, subsystem, function, line, fmt, ap);
+    va_end(ap);
+}
+
+void usdrlog_vout(unsigned loglevel,
+                  const char* subsystem,
+                  const char* function,
+                  const char* file,
+                  int line,
+                  const char* fmt,
+                  va_list list)
+{
+    (void)file;
+    struct timespec tp;
+
+    if (loglevel > USDR_LOG_TRACE)
+        loglevel = USDR_LOG_TRACE;
+
+    if (!usdr_check_level(loglevel, subsystem))
+        return;
+
+    clock_gettime(CLOCK_REALTIME, &tp);
+    if (usdrlog_async_post(&tp, loglevel, subsystem, function, line, fmt, list))
+        return;
+
+    usdrlog_format_out(&tp, loglevel, subsystem, function, line, fmt, list);
+}
+
+#ifdef __EMSCRIPTEN__
+static bool usdrlog_async_post(const struct timespec* tp, unsigned loglevel, const char* subsystem,
+                               const char* function, int line, const char* fmt, va_list list)
+{
+    return false;
+}
+
+int usdrlog_set_async(bool enable)
+{
+    return enable ? -ENOTSUP : 0;
+}
+
+void usdrlog_flush(void)
+{
+}
+#else
+
+// Asynchronous sink. Every logging thread owns a single producer ring,
+// records are merged in the global sequence order by the drain thread.
+enum {
+    LOG_RING_SIZE = 65536,
+    LOG_REC_WRAP = 0xffffffff,
+    LOG_RING_WAKE_FILL = LOG_RING_SIZE / 4,
+    LOG_DRAIN_PERIOD_MS = 10,
+};
+
+struct log_rec {
+    uint32_t size;          // Whole record, 8 bytes aligned
+    uint32_t level;
+    uint64_t seq;
+    struct timespec ts;
+    const char* function;   // __FUNCTION__, static storage
+    int line;
+    char subsystem[8];
+    char msg[];
+};
+
+struct log_ring {
+    struct log_ring* next;
+    bool dead;              // Owner thread exited, freed when empty
+    unsigned dropped;
+    unsigned dropped_reported;
+
+    unsigned head;          // Written by the owner
+    unsigned tail;          // Written by the drain side
+    uint8_t data[LOG_RING_SIZE];
+};
+
+static struct log_ring* s_rings;
+static THREAD_SAFE struct log_ring* s_ring;
+static THREAD_SAFE bool s_ring_released;
+static pthread_key_t s_ring_key;
+static pthread_once_t s_ring_key_once = PTHREAD_ONCE_INIT;
+
+static bool s_async;
+static bool s_drain_stop;
+static bool s_drain_sleeping;
+static bool s_drain_wake_ready;
+static uint64_t s_seq;
+static pthread_t s_drain_thread;
+static pthread_mutex_t s_drain_lock = PTHREAD_MUTEX_INITIALIZER;
+static sem_t s_drain_wake;
+
+static void log_ring_release(void* p)
+{
+    struct log_ring* r = (struct log_ring*)p;
+
+    // Messages from the rest of the thread teardown go out synchronously,
+    // a new ring would never be released
+    s_ring = NULL;
+    s_ring_released = true;
+    __atomic_store_n(&r->dead, true, __ATOMIC_RELEASE);
+}
+
+static void log_ring_key_create(void)
+{
+    pthread_key_create(&s_ring_key, log_ring_release);
+}
+
+static struct log_ring* log_ring_get(void)
+{
+    struct log_ring* r = s_ring;
+    if (r)
+        return r;
+    if (s_ring_released)
+        return NULL;
+
+    r = (struct log_ring*)malloc(sizeof(struct log_ring));
+    if (r == NULL)
+        return NULL;
+
+    r->dead = false;
+    r->dropped = 0;
+    r->dropped_reported = 0;
+    r->head = 0;
+    r->tail = 0;
+
+    pthread_once(&s_ring_key_once, log_ring_key_create);
+    pthread_setspecific(s_ring_key, r);
+
+    // Only the drain side removes rings and never the list head
+    r->next = __atomic_load_n(&s_rings, __ATOMIC_ACQUIRE);
+    while (!__atomic_compare_exchange_n(&s_rings, &r->next, r, true,
+                                        __ATOMIC_RELEASE, __ATOMIC_ACQUIRE));
+    s_ring = r;
+    return r;
+}
+
+static bool usdrlog_async_post(const struct timespec* tp, unsigned loglevel, const char* subsystem,
+                               const char* function, int line, const char* fmt, va_list list)
+{
+    char msg[MAX_LOG_LINE];
+    struct log_ring* r;
+    struct log_rec* rec;
+    unsigned len, size, pos, contig, head, tail;
+    va_list ap;
+    int sz;
+
+    if (!__atomic_load_n(&s_async, __ATOMIC_ACQUIRE))
+        return false;
+
+    r = log_ring_get();
+    if (r == NULL)
+        return false;
+
+    // The caller formats `list` again if the message isn't queued
+    va_copy(ap, list);
+    sz = vsnprintf(msg, sizeof(msg), fmt, ap);
+    va_end(ap);
+    if (sz < 0)
+        return false;
+
+    len = ((unsigned)sz < sizeof(msg)) ? (unsigned)sz : sizeof(msg) - 1;
+    size = (sizeof(struct log_rec) + len + 1 + 7) & ~7u;
+
+    tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+    pos = r->head % LOG_RING_SIZE;
+    contig = LOG_RING_SIZE - pos;
+    if (contig >= size)
+        contig = 0;
+
+    if (contig + size > LOG_RING_SIZE - (r->head - tail)) {
+        __atomic_fetch_add(&r->dropped, 1, __ATOMIC_RELAXED);
+        return true;
+    }
+
+    if (contig) {
+        *(uint32_t*)&r->data[pos] = LOG_REC_WRAP;
+        pos = 0;
+    }
+
+    rec = (struct log_rec*)&r->data[pos];
+    rec->size = size;
+    rec->level = loglevel;
+    rec->seq = __atomic_fetch_add(&s_seq, 1, __ATOMIC_RELAXED);
+    rec->ts = *tp;
+    rec->function = function;
+    rec->line = line;
+    strncpy(rec->subsystem, subsystem ? subsystem : "", sizeof(rec->subsystem) - 1);
+    rec->subsystem[sizeof(rec->subsystem) - 1] = 0;
+    memcpy(rec->msg, msg, len);
+    rec->msg[len] = 0;
+
+    head = r->head + contig + size;
+    __atomic_store_n(&r->head, head, __ATOMIC_RELEASE);
+
+    // The drain thread runs periodically, it's woken up early only when the
+    // ring fills up or for errors
+    if (loglevel == USDR_LOG_ERROR ||
+        (head - tail > LOG_RING_WAKE_FILL && __atomic_exchange_n(&s_drain_sleeping, false, __ATOMIC_SEQ_CST))) {
+        sem_post(&s_drain_wake);
+    }
+    return true;
+}
+
+// Oldest record of the ring, NULL if empty. Called under s_drain_lock.
+static struct log_rec* log_ring_peek(struct log_ring* r)
+{
+    unsigned head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    unsigned pos;
+
+    if (r->tail == head)
+        return NULL;
+
+    pos = r->tail % LOG_RING_SIZE;
+    if (*(uint32_t*)&r->data[pos] == LOG_REC_WRAP) {
+        __atomic_store_n(&r->tail, r->tail + LOG_RING_SIZE - pos, __ATOMIC_RELEASE);
+        pos = 0;
+    }
+    return (struct log_rec*)&r->data[pos];
+}
+
+// Called under s_drain_lock, returns false if all rings are empty
+static bool log_drain_all(void)
+{
+    struct log_ring *r, *prev, *oldest;
+    struct log_rec *rec, *orec;
+    bool any = false;
+
+    for (;;) {
+        oldest = NULL;
+        orec = NULL;
+
+        for (prev = NULL, r = __atomic_load_n(&s_rings, __ATOMIC_ACQUIRE); r; ) {
+            unsigned dropped = __atomic_load_n(&r->dropped, __ATOMIC_RELAXED);
+            if (dropped != r->dropped_reported) {
+                struct timespec tp;
+                clock_gettime(CLOCK_REALTIME, &tp);
+                usdrlog_format_outf(&tp, USDR_LOG_WARNING, "LOGR", __FUNCTION__, __LINE__,
+                                    "%u log messages were dropped, ring is full\n",
+                                    dropped - r->dropped_reported);
+                r->dropped_reported = dropped;
+            }
+
+            rec = log_ring_peek(r);
+            if (rec == NULL && prev && __atomic_load_n(&r->dead, __ATOMIC_ACQUIRE) &&
+                r->tail == __atomic_load_n(&r->head, __ATOMIC_ACQUIRE)) {
+                prev->next = r->next;
+                free(r);
+                r = prev->next;
+                continue;
+            }
+
+            if (rec && (orec == NULL || rec->seq < orec->seq)) {
+                oldest = r;
+                orec = rec;
+            }
+            prev = r;
+            r = r->next;
+        }
+
+        if (orec == NULL)
+            return any;
+
+        usdrlog_format_outf(&orec->ts, orec->level, orec->subsystem, orec->function, orec->line,
+                            "%s", orec->msg);
+        __atomic_store_n(&oldest->tail, oldest->tail + orec->size, __ATOMIC_RELEASE);
+        any = true;
+    }
+}
+
+static void* log_drain_thread(void* arg)
+{
+    sigset_t set;
+
+    pthread_setname_np(pthread_self(), "usdr_log");
+    sigfillset(&set);
+    pthread_sigmask(SIG_SETMASK, &set, NULL);
+
+    while (!__atomic_load_n(&s_drain_stop, __ATOMIC_ACQUIRE)) {
+        pthread_mutex_lock(&s_drain_lock);
+        log_drain_all();
+        pthread_mutex_unlock(&s_drain_lock);
+
+        __atomic_store_n(&s_drain_sleeping, true, __ATOMIC_SEQ_CST);
+        usdr_sem_wait_ns(&s_drain_wake, LOG_DRAIN_PERIOD_MS * 1000000ll);
+    }
+    return NULL;
+}
+
+void usdrlog_flush(void)
+{
+    pthread_mutex_lock(&s_drain_lock);
+    log_drain_all();
+    pthread_mutex_unlock(&s_drain_lock);
+}
+
+int usdrlog_set_async(bool enable)
+{
+    int res;
+
+    if (enable == __atomic_load_n(&s_async, __ATOMIC_ACQUIRE))
+        return 0;
+
+    if (!enable) {
+        __atomic_store_n(&s_async, false, __ATOMIC_RELEASE);
+        __atomic_store_n(&s_drain_stop, true, __ATOMIC_RELEASE);
+        sem_post(&s_drain_wake);
+        pthread_join(s_drain_thread, NULL);
+
+        usdrlog_flush();
+        return 0;
+    }
+
+    if (!s_drain_wake_ready) {
+        sem_init(&s_drain_wake, 0, 0);
+        s_drain_wake_ready = true;
+    }
+
+    s_drain_stop = false;
+    res = pthread_create(&s_drain_thread, NULL, log_drain_thread, NULL);
+    if (res)
+        return -res;
+
+    __atomic_store_n(&s_async, true, __ATOMIC_RELEASE);
+    return 0;
+}
+
+void __attribute__ ((destructor(101))) shutdown_logging(void) {
+    if (__atomic_load_n(&s_async, __ATOMIC_ACQUIRE)) {
+        usdrlog_set_async(false);
+    }
+}
+#endif
+
 void usdrlog_setlevel(const char* subsystem,
                       unsigned loglevel)
 {
-    s_def_loglevel = loglevel;
+    unsigned idx;
+
+    pthread_mutex_lock(&s_subsys_lock);
+    if (subsystem == NULL) {
+        s_def_loglevel = loglevel;
+        for (idx = 1; idx < s_subsys_cnt; idx++) {
+            if (!s_subsys[idx].explicit_level)
+                __atomic_store_n(&usdrlog_levels[idx], loglevel, __ATOMIC_RELAXED);
+        }
+        __atomic_store_n(&usdrlog_levels[SUBSYS_OVERFLOW], loglevel, __ATOMIC_RELAXED);
+    } else {
+        idx = log_subsys_intern(subsystem);
+        if (idx != SUBSYS_OVERFLOW) {
+            s_subsys[idx].explicit_level = true;
+            __atomic_store_n(&usdrlog_levels[idx], loglevel, __ATOMIC_RELAXED);
+        }
+    }
+    pthread_mutex_unlock(&s_subsys_lock);
 }
 
 unsigned usdrlog_getlevel(const char* subsystem)
 {
-    return s_def_loglevel;
+    int idx = (subsystem) ? log_subsys_find(subsystem) : -1;
+    return (idx < 0) ? s_def_loglevel : __atomic_load_n(&usdrlog_levels[idx], __ATOMIC_RELAXED);
 }
 
 void usdrlog_disablecolorize(const char* subsystem)
@@ -192,5 +665,5 @@ void usdrlog_enablecolorize(const char* subsystem)
 
 void usdrlog_set_log_op( s_log_op_t op )
 {
-    s_log_op = op;
+    s_log_op = (op) ? op : &standard_log_op;
 }
@@ -21,6 +21,31 @@ enum {
     USDR_LOG_TRACE,
 };
 
+// Messages above this level are compiled out, numeric value of the level
+// above (0 - errors only, 6 - everything)
+#ifndef USDR_LOG_MAX_LEVEL
+#define USDR_LOG_MAX_LEVEL 6
+#endif
+
+// Subsystem names are interned on first use, every USDR_LOG() call site
+// caches the id so the runtime check is a single compare
+enum {
+    USDRLOG_MAX_SUBSYSTEMS = 128,
+};
+
+extern unsigned usdrlog_levels[USDRLOG_MAX_SUBSYSTEMS];
+
+unsigned usdrlog_site_resolve(unsigned* site, const char* subsystem);
+
+static inline bool usdrlog_site_enabled(unsigned* site, const char* subsystem, unsigned loglevel)
+{
+    unsigned sid = __atomic_load_n(site, __ATOMIC_RELAXED);
+    if (sid == 0)
+        sid = usdrlog_site_resolve(site, subsystem);
+
+    return loglevel <= __atomic_load_n(&usdrlog_levels[sid], __ATOMIC_RELAXED);
+}
+
 void usdrlog_out(unsigned loglevel,
                  const char* subsystem,
                  const char* function,
@@ -50,14 +75,38 @@ void usdrlog_setlevel(const char* subsystem,
  */
 unsigned usdrlog_getlevel(const char* subsystem);
 
-// TODO
-// void usdrlog_setoutfunc();
+/**
+ * @brief usdrlog_setlevels Set levels from a string like `3:LMS7=debug:STRM=1`
+ * @param spec Items separated by `,`, `:` or `;`, each is either the default
+ *        level or SUBSYSTEM=level. Levels are numbers or names (error, crit,
+ *        warning, info, note, debug, trace). Used for USDR_LOGLEVEL
+ *        environment variable and `loglevel` device parameter.
+ * @return 0 on success, -EINVAL if any item is malformed
+ */
+int usdrlog_setlevels(const char* spec);
+
+/**
+ * @brief usdrlog_set_async
+ * @param enable Format and write messages in a background thread, logging
+ *        threads only copy the message into their own ring. Also enabled by
+ *        USDR_LOG_ASYNC=1 environment variable.
+ * @return 0 on success or -errno if the thread can't be started
+ */
+int usdrlog_set_async(bool enable);
+
+/**
+ * @brief usdrlog_flush Write out all queued asynchronous messages
+ */
+void usdrlog_flush(void);
 
 // Helper macros
 
 #define USDR_LOG(system, level, ...) \
     do { \
-        usdrlog_out((level), (system), __FUNCTION__, __FILE__, __LINE__, __VA_ARGS__); \
+        static unsigned _usdrlog_site; \
+        if ((unsigned)(level) <= USDR_LOG_MAX_LEVEL && \
+            usdrlog_site_enabled(&_usdrlog_site, (system), (level))) \
+            usdrlog_out((level), (system), __FUNCTION__, __FILE__, __LINE__, __VA_ARGS__); \
     } while (0)
 
 typedef int (*s_log_op_t)(uintptr_t param, unsigned sevirity, const char* log);
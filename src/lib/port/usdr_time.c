@@ -0,0 +1,159 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "usdr_time.h"
+
+#include <errno.h>
+#include <pthread.h>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+enum {
+    // Long enough to get ~1e-5 precision out of clock_gettime() jitter
+    CAL_INTERVAL_NS = 5 * 1000 * 1000,
+    CAL_SHIFT = 32,
+};
+
+struct usdr_time_cal usdr_time_cal;
+static pthread_once_t s_cal_once = PTHREAD_ONCE_INIT;
+
+uint64_t usdr_time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static bool usdr_time_counter_invariant(void)
+{
+#if defined(__x86_64__)
+    unsigned eax, ebx, ecx, edx;
+    // Invariant TSC, doesn't stop or change rate in C / P states
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
+        return false;
+    return (edx & (1u << 8)) != 0;
+#elif defined(__aarch64__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+static uint64_t usdr_time_counter_hz(uint64_t* pt0, uint64_t* pc0)
+{
+#if defined(__x86_64__) || defined(__aarch64__)
+    uint64_t t0, t1, c0, c1;
+
+    t0 = usdr_time_ns();
+    c0 = usdr_time_cycles();
+    *pt0 = t0;
+    *pc0 = c0;
+#if defined(__aarch64__)
+    uint64_t hz;
+    __asm__ __volatile__("mrs %0, cntfrq_el0" : "=r"(hz));
+    if (hz)
+        return hz;
+#endif
+    do {
+        t1 = usdr_time_ns();
+        c1 = usdr_time_cycles();
+    } while (t1 - t0 < CAL_INTERVAL_NS);
+
+    return (uint64_t)((double)(c1 - c0) * 1.0e9 / (double)(t1 - t0) + 0.5);
+#else
+    *pt0 = *pc0 = 0;
+    return 0;
+#endif
+}
+
+static void usdr_time_do_calibrate(void)
+{
+    uint64_t t0, c0;
+    uint64_t hz = usdr_time_counter_hz(&t0, &c0);
+
+    if (hz < 1000000) {
+        // Counter is the ns clock itself
+        usdr_time_cal.mult = 1;
+        usdr_time_cal.shift = 0;
+        usdr_time_cal.counter = false;
+        hz = 1000000000u;
+    } else {
+        usdr_time_cal.mult = (uint64_t)((1000000000ull << CAL_SHIFT) / hz);
+        usdr_time_cal.shift = CAL_SHIFT;
+        usdr_time_cal.base_ns = t0;
+        usdr_time_cal.base_cycles = c0;
+        usdr_time_cal.counter = usdr_time_counter_invariant();
+    }
+
+    __atomic_store_n(&usdr_time_cal.hz, hz, __ATOMIC_RELEASE);
+}
+
+void usdr_time_calibrate(void)
+{
+    pthread_once(&s_cal_once, usdr_time_do_calibrate);
+}
+
+void usdr_time_deadline(struct timespec* ts, uint64_t ns)
+{
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    ts->tv_sec += ns / 1000000000u;
+    ts->tv_nsec += ns % 1000000000u;
+    if (ts->tv_nsec >= 1000000000) {
+        ts->tv_nsec -= 1000000000;
+        ts->tv_sec++;
+    }
+}
+
+int usdr_sem_wait_ns(sem_t* s, int64_t timeout_ns)
+{
+    int res;
+    if (timeout_ns > 0) {
+        struct timespec ts;
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 30))
+        usdr_time_deadline(&ts, timeout_ns);
+        res = sem_clockwait(s, CLOCK_MONOTONIC, &ts);
+#else
+        // No monotonic semaphore wait in this libc
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_sec += timeout_ns / 1000000000;
+        ts.tv_nsec += timeout_ns % 1000000000;
+        if (ts.tv_nsec >= 1000000000) {
+            ts.tv_nsec -= 1000000000;
+            ts.tv_sec++;
+        }
+        res = sem_timedwait(s, &ts);
+#endif
+    } else if (timeout_ns < 0) {
+        res = sem_wait(s);
+    } else {
+        res = sem_trywait(s);
+    }
+    if (res) {
+        // sem_* function on error returns -1, get proper error
+        res = -errno;
+    }
+    return res;
+}
+
+int usdr_cond_init_monotonic(pthread_cond_t* c)
+{
+    pthread_condattr_t attr;
+    int res;
+
+    res = pthread_condattr_init(&attr);
+    if (res)
+        return -res;
+
+    res = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    if (res == 0) {
+        res = pthread_cond_init(c, &attr);
+    }
+
+    pthread_condattr_destroy(&attr);
+    return -res;
+}
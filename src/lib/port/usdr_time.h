@@ -0,0 +1,92 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#ifndef USDR_TIME_H
+#define USDR_TIME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <semaphore.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// All internal time keeping is CLOCK_MONOTONIC, wall clock steps (NTP, date)
+// don't affect timeouts or measurements.
+
+// CLOCK_MONOTONIC in ns
+uint64_t usdr_time_ns(void);
+
+// Raw CPU counter: TSC on x86_64, CNTVCT on aarch64, CLOCK_MONOTONIC ns
+// elsewhere. The TSC is read even when it isn't invariant, only
+// usdr_time_fast_ns() checks for that.
+static inline uint64_t usdr_time_cycles(void)
+{
+#if defined(__x86_64__)
+    uint32_t lo, hi;
+    __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+#elif defined(__aarch64__)
+    uint64_t v;
+    __asm__ __volatile__("isb; mrs %0, cntvct_el0" : "=r"(v) :: "memory");
+    return v;
+#else
+    return usdr_time_ns();
+#endif
+}
+
+struct usdr_time_cal {
+    uint64_t hz;          // Counter frequency, 0 -- not calibrated yet
+    uint64_t base_cycles;
+    uint64_t base_ns;
+    uint64_t mult;        // ns = cycles * mult >> shift
+    uint32_t shift;
+    bool counter;         // Counter is invariant, usdr_time_fast_ns() may use it
+};
+extern struct usdr_time_cal usdr_time_cal;
+
+// Calibrates the counter against CLOCK_MONOTONIC, done once on the first use
+void usdr_time_calibrate(void);
+
+// Converts a usdr_time_cycles() delta
+static inline uint64_t usdr_time_cycles_to_ns(uint64_t cycles)
+{
+    if (__builtin_expect(__atomic_load_n(&usdr_time_cal.hz, __ATOMIC_ACQUIRE) == 0, 0))
+        usdr_time_calibrate();
+#if defined(__x86_64__) || defined(__aarch64__)
+    return (uint64_t)(((unsigned __int128)cycles * usdr_time_cal.mult) >> usdr_time_cal.shift);
+#else
+    return cycles;
+#endif
+}
+
+// CLOCK_MONOTONIC ns derived from the counter, cheap enough for per call
+// statistics. Values are comparable with usdr_time_ns().
+static inline uint64_t usdr_time_fast_ns(void)
+{
+    if (__builtin_expect(__atomic_load_n(&usdr_time_cal.hz, __ATOMIC_ACQUIRE) == 0, 0))
+        usdr_time_calibrate();
+    if (!usdr_time_cal.counter)
+        return usdr_time_ns();
+
+    return usdr_time_cal.base_ns + usdr_time_cycles_to_ns(usdr_time_cycles() - usdr_time_cal.base_cycles);
+}
+
+// Absolute CLOCK_MONOTONIC deadline `ns` from now
+void usdr_time_deadline(struct timespec* ts, uint64_t ns);
+
+// Waits on the semaphore with CLOCK_MONOTONIC timeout: `timeout_ns` < 0 --
+// forever, 0 -- try only. Returns 0 or -errno (-ETIMEDOUT, -EAGAIN, -EINTR)
+int usdr_sem_wait_ns(sem_t* s, int64_t timeout_ns);
+
+// Condition variable to be used with usdr_time_deadline()
+int usdr_cond_init_monotonic(pthread_cond_t* c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
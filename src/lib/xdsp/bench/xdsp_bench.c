@@ -0,0 +1,703 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+// xdsp micro-benchmark runner
+//
+// Every family below is probed through its *_c(cap, &sfunc) getter from the best
+// available cap down to OPT_GENERIC, each distinct variant is timed over several
+// sizes and the results are emitted as JSON or CSV for diffing between builds/hosts.
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+
+#include "conv_i16_f32_2.h"
+#include "conv_f32_i16_2.h"
+#include "conv_i12_f32_2.h"
+#include "conv_f32_i12_2.h"
+#include "conv_i12_i16_2.h"
+#include "conv_i16_i12_2.h"
+#include "conv_i16_4f32_2.h"
+#include "conv_ci16_2cf32_2.h"
+#include "conv_2cf32_ci16_2.h"
+#include "conv_ci16_2ci16_2.h"
+#include "conv_2ci16_ci16_2.h"
+#include "conv_ci12_2cf32_2.h"
+#include "conv_2cf32_ci12_2.h"
+#include "conv_ci12_2ci16_2.h"
+#include "conv_2ci16_ci12_2.h"
+#include "conv_ci16_4cf32_2.h"
+#include "conv_4cf32_ci16_2.h"
+#include "conv_ci16_4ci16_2.h"
+#include "conv_4ci16_ci16_2.h"
+#include "conv_ci12_4cf32_2.h"
+#include "conv_4cf32_ci12_2.h"
+#include "conv_ci12_4ci16_2.h"
+#include "conv_4ci16_ci12_2.h"
+#include "conv_filter.h"
+#include "sincos_functions.h"
+#include "fft_window_functions.h"
+#include "fftad_functions.h"
+#include "rtsa_functions.h"
+#include "fmquad.h"
+#include "iqcorr.h"
+
+#define BENCH_ALIGN         64
+#define BENCH_MAX_VECS      4
+#define BENCH_FLEN          32
+#define BENCH_INTERP        2
+#define BENCH_MAX_SIZES     16
+#define BENCH_FFT_MAX       65536
+#define BENCH_MAX_VARIANTS  16
+
+enum bench_kind {
+    BK_CONV,
+    BK_FILTER,
+    BK_FILTER_CF32,
+    BK_FILTER_INTERP,
+    BK_FILTER_INTERP_CF32,
+    BK_FFT_WINDOW,
+    BK_FFTAD_INIT,
+    BK_FFTAD_ADD,
+    BK_FFTAD_ADD_HWI16,
+    BK_FFTAD_NORM,
+    BK_RTSA,
+    BK_RTSA_HWI16,
+    BK_QUADFM_ENC,
+    BK_QUADFM_DEC,
+    BK_IQCORR,
+};
+
+typedef conv_function_t (*get_conv_fn_t)(generic_opts_t, const char**);
+typedef filter_function_t (*get_filter_fn_t)(generic_opts_t, const char**);
+typedef filter_cf32_function_t (*get_filter_cf32_fn_t)(generic_opts_t, const char**);
+typedef fft_window_cf32_function_t (*get_fft_window_fn_t)(generic_opts_t, const char**);
+typedef fftad_init_function_t (*get_fftad_init_fn_t)(generic_opts_t, const char**);
+typedef fftad_add_function_t (*get_fftad_add_fn_t)(generic_opts_t, const char**);
+typedef fftad_add_hwi16_function_t (*get_fftad_add_hwi16_fn_t)(generic_opts_t, const char**);
+typedef fftad_norm_function_t (*get_fftad_norm_fn_t)(generic_opts_t, const char**);
+typedef rtsa_update_function_t (*get_rtsa_fn_t)(generic_opts_t, const char**);
+typedef rtsa_update_hwi16_function_t (*get_rtsa_hwi16_fn_t)(generic_opts_t, const char**);
+typedef quadfm_encode_function_t (*get_quadfm_enc_fn_t)(generic_opts_t, const char**);
+typedef quadfm_decode_function_t (*get_quadfm_dec_fn_t)(generic_opts_t, const char**);
+typedef iqcorr_function_t (*get_iqcorr_fn_t)(generic_opts_t, const char**);
+
+struct bench_family {
+    const char* name;
+    enum bench_kind kind;
+    union {
+        get_conv_fn_t conv;
+        get_filter_fn_t filter;
+        get_filter_cf32_fn_t filter_cf32;
+        get_fft_window_fn_t fft_window;
+        get_fftad_init_fn_t fftad_init;
+        get_fftad_add_fn_t fftad_add;
+        get_fftad_add_hwi16_fn_t fftad_add_hwi16;
+        get_fftad_norm_fn_t fftad_norm;
+        get_rtsa_fn_t rtsa;
+        get_rtsa_hwi16_fn_t rtsa_hwi16;
+        get_quadfm_enc_fn_t quadfm_enc;
+        get_quadfm_dec_fn_t quadfm_dec;
+        get_iqcorr_fn_t iqcorr;
+    } get;
+    unsigned nin;
+    unsigned nout;
+    unsigned in_bits;       // per sample, all input vectors together
+    unsigned out_bits;      // per sample, all output vectors together
+    unsigned max_samples;   // 0 - no limit
+    bool in_f32;            // inputs are float vectors
+};
+typedef struct bench_family bench_family_t;
+
+#define CONV_FAMILY(nm, fn, ni, no, ib, ob, fl) \
+    { nm, BK_CONV, { .conv = fn }, ni, no, ib, ob, 0, fl }
+
+static const bench_family_t s_families[] = {
+    CONV_FAMILY("i16_f32",     conv_get_i16_f32_c,     1, 1, 16, 32, false),
+    CONV_FAMILY("f32_i16",     conv_get_f32_i16_c,     1, 1, 32, 16, true),
+    CONV_FAMILY("i12_f32",     conv_get_i12_f32_c,     1, 1, 12, 32, false),
+    CONV_FAMILY("f32_i12",     conv_get_f32_i12_c,     1, 1, 32, 12, true),
+    CONV_FAMILY("i12_i16",     conv_get_i12_i16_c,     1, 1, 12, 16, false),
+    CONV_FAMILY("i16_i12",     conv_get_i16_i12_c,     1, 1, 16, 12, false),
+    CONV_FAMILY("i16_4f32",    conv_get_i16_4f32_c,    1, 4, 16, 32, false),
+    CONV_FAMILY("ci16_2cf32",  conv_get_ci16_2cf32_c,  1, 2, 32, 64, false),
+    CONV_FAMILY("2cf32_ci16",  conv_get_2cf32_ci16_c,  2, 1, 64, 32, true),
+    CONV_FAMILY("ci16_2ci16",  conv_get_ci16_2ci16_c,  1, 2, 32, 32, false),
+    CONV_FAMILY("2ci16_ci16",  conv_get_2ci16_ci16_c,  2, 1, 32, 32, false),
+    CONV_FAMILY("ci12_2cf32",  conv_get_ci12_2cf32_c,  1, 2, 24, 64, false),
+    CONV_FAMILY("2cf32_ci12",  conv_get_2cf32_ci12_c,  2, 1, 64, 24, true),
+    CONV_FAMILY("ci12_2ci16",  conv_get_ci12_2ci16_c,  1, 2, 24, 32, false),
+    CONV_FAMILY("2ci16_ci12",  conv_get_2ci16_ci12_c,  2, 1, 32, 24, false),
+    CONV_FAMILY("ci16_4cf32",  conv_get_ci16_4cf32_c,  1, 4, 32, 64, false),
+    CONV_FAMILY("4cf32_ci16",  conv_get_4cf32_ci16_c,  4, 1, 64, 32, true),
+    CONV_FAMILY("ci16_4ci16",  conv_get_ci16_4ci16_c,  1, 4, 32, 32, false),
+    CONV_FAMILY("4ci16_ci16",  conv_get_4ci16_ci16_c,  4, 1, 32, 32, false),
+    CONV_FAMILY("ci12_4cf32",  conv_get_ci12_4cf32_c,  1, 4, 24, 64, false),
+    CONV_FAMILY("4cf32_ci12",  conv_get_4cf32_ci12_c,  4, 1, 64, 24, true),
+    CONV_FAMILY("ci12_4ci16",  conv_get_ci12_4ci16_c,  1, 4, 24, 32, false),
+    CONV_FAMILY("4ci16_ci12",  conv_get_4ci16_ci12_c,  4, 1, 32, 24, false),
+    CONV_FAMILY("sincos_i16",  get_wvlt_sincos_i16_c,  1, 2, 16, 32, false),
+
+    { "filter_i16",         BK_FILTER,      { .filter = conv_filter_c },                1, 1, 16, 16, 0, false },
+    { "filter_ci16",        BK_FILTER,      { .filter = conv_filter_interleave_c },     1, 1, 32, 32, 0, false },
+    { "filter_cf32",        BK_FILTER_CF32, { .filter_cf32 = conv_filter_cf32_c },      1, 1, 64, 64, 0, true },
+    { "filter_interp_i16",  BK_FILTER_INTERP,      { .filter = conv_filter_interpolate_c },                 1, 1, 16, 16 * BENCH_INTERP, 0, false },
+    { "filter_interp_ci16", BK_FILTER_INTERP,      { .filter = conv_filter_interpolate_interleave_c },      1, 1, 32, 32 * BENCH_INTERP, 0, false },
+    { "filter_interp_cf32", BK_FILTER_INTERP_CF32, { .filter_cf32 = conv_filter_interpolate_cf32_c },       1, 1, 64, 64 * BENCH_INTERP, 0, true },
+    { "fft_window_cf32",    BK_FFT_WINDOW,  { .fft_window = fft_window_cf32_c },        1, 1, 64, 64, BENCH_FFT_MAX, true },
+    { "fftad_init_cf32",    BK_FFTAD_INIT,  { .fftad_init = fftad_init_c },             0, 1, 0,  64, BENCH_FFT_MAX, true },
+    { "fftad_add_cf32",     BK_FFTAD_ADD,   { .fftad_add = fftad_add_c },               1, 1, 64, 64, BENCH_FFT_MAX, true },
+    { "fftad_norm_cf32",    BK_FFTAD_NORM,  { .fftad_norm = fftad_norm_c },             1, 1, 64, 32, BENCH_FFT_MAX, true },
+    { "fftad_init_hwi16",   BK_FFTAD_INIT,  { .fftad_init = fftad_init_hwi16_c },       0, 1, 0,  32, BENCH_FFT_MAX, false },
+    { "fftad_add_hwi16",    BK_FFTAD_ADD_HWI16, { .fftad_add_hwi16 = fftad_add_hwi16_c }, 1, 1, 16, 32, BENCH_FFT_MAX, false },
+    { "fftad_norm_hwi16",   BK_FFTAD_NORM,  { .fftad_norm = fftad_norm_hwi16_c },       1, 1, 32, 32, BENCH_FFT_MAX, true },
+    { "rtsa_update_cf32",   BK_RTSA,        { .rtsa = rtsa_update_c },                  1, 1, 64, 0,  BENCH_FFT_MAX, true },
+    { "rtsa_update_hwi16",  BK_RTSA_HWI16,  { .rtsa_hwi16 = rtsa_update_hwi16_c },      1, 1, 16, 0,  BENCH_FFT_MAX, false },
+    { "quadfm_encode",      BK_QUADFM_ENC,  { .quadfm_enc = quadfm_encode_c },          1, 1, 16, 32, 0, false },
+    { "quadfm_decode",      BK_QUADFM_DEC,  { .quadfm_dec = quadfm_decode_c },          1, 1, 32, 16, 0, false },
+    { "iqcorr_ci16",        BK_IQCORR,      { .iqcorr = iqcorr_ci16_c },                1, 1, 32, 32, 0, false },
+    { "iqcorr_cf32",        BK_IQCORR,      { .iqcorr = iqcorr_cf32_c },                1, 1, 64, 64, 0, true },
+};
+
+#define FAMILIES_COUNT (sizeof(s_families) / sizeof(s_families[0]))
+
+struct bench_ctx {
+    size_t vec_bytes;
+    void* in_i16[BENCH_MAX_VECS];
+    void* in_f32[BENCH_MAX_VECS];
+    void* out[BENCH_MAX_VECS];
+    float* taps_f32;
+    int16_t* taps_i16;
+    float* wnd;
+
+    fft_acc_t acc;
+    fft_rtsa_data_t rtsa;
+    rtsa_hwi16_consts_t rtsa_hwi16;
+    quadfm_decode_state_t fmstate;
+    float fmphase;
+    iqcorr_coeffs_t iqc;
+    iqcorr_moments_t iqm;
+};
+typedef struct bench_ctx bench_ctx_t;
+
+struct bench_opts {
+    unsigned sizes[BENCH_MAX_SIZES];
+    unsigned sizes_cnt;
+    unsigned min_time_ms;
+    unsigned repeats;
+    unsigned warmup;
+    int cpu;
+    const char* filter;
+    bool csv;
+    bool list_only;
+    FILE* out;
+};
+typedef struct bench_opts bench_opts_t;
+
+struct bench_variant {
+    const void* fn;
+    const char* name;
+    generic_opts_t cap;
+};
+typedef struct bench_variant bench_variant_t;
+
+struct bench_result {
+    uint64_t iters;
+    double ns_min;
+    double ns_med;
+};
+typedef struct bench_result bench_result_t;
+
+static uint64_t bench_clock_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int bench_pin_cpu(int cpu)
+{
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set);
+#else
+    (void)cpu;
+    return -1;
+#endif
+}
+
+static void bench_cpu_model(char* buf, size_t len)
+{
+    snprintf(buf, len, "unknown");
+#ifdef __linux__
+    FILE* f = fopen("/proc/cpuinfo", "r");
+    if (!f)
+        return;
+
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, "model name", 10) && strncmp(line, "Model", 5))
+            continue;
+
+        char* p = strchr(line, ':');
+        if (!p)
+            continue;
+        for (p++; *p == ' ' || *p == '\t'; p++);
+        p[strcspn(p, "\r\n\"")] = 0;
+        snprintf(buf, len, "%s", p);
+        break;
+    }
+    fclose(f);
+#endif
+}
+
+static int bench_ctx_init(bench_ctx_t* c, unsigned max_samples)
+{
+    memset(c, 0, sizeof(*c));
+    // largest sample is 8 bytes (cf32), plus tail room for filter taps
+    c->vec_bytes = (size_t)max_samples * 8 + 2 * BENCH_FLEN * 8 + BENCH_ALIGN;
+
+    // interpolating filters produce BENCH_INTERP outputs per input
+    for (unsigned i = 0; i < BENCH_MAX_VECS; i++) {
+        if (posix_memalign(&c->in_i16[i], BENCH_ALIGN, c->vec_bytes) ||
+            posix_memalign(&c->in_f32[i], BENCH_ALIGN, c->vec_bytes) ||
+            posix_memalign(&c->out[i], BENCH_ALIGN, c->vec_bytes * BENCH_INTERP))
+            return -1;
+    }
+
+    unsigned fftmax = max_samples < BENCH_FFT_MAX ? max_samples : BENCH_FFT_MAX;
+    if (posix_memalign((void**)&c->taps_f32, BENCH_ALIGN, BENCH_FLEN * 2 * BENCH_INTERP * sizeof(float)) ||
+        posix_memalign((void**)&c->taps_i16, BENCH_ALIGN, BENCH_FLEN * BENCH_INTERP * sizeof(int16_t)) ||
+        posix_memalign((void**)&c->wnd, BENCH_ALIGN, fftmax * sizeof(float)) ||
+        posix_memalign((void**)&c->acc.f_mant, BENCH_ALIGN, fftmax * sizeof(float)) ||
+        posix_memalign((void**)&c->acc.f_pwr, BENCH_ALIGN, fftmax * sizeof(int32_t)))
+        return -1;
+
+    // random but sane data, integer families interpret int16 bytes their own way (i12 etc)
+    for (unsigned i = 0; i < BENCH_MAX_VECS; i++) {
+        int16_t* pi = (int16_t*)c->in_i16[i];
+        float* pf = (float*)c->in_f32[i];
+
+        for (size_t k = 0; k < c->vec_bytes / sizeof(int16_t); k++)
+            pi[k] = (int16_t)(rand() % 32768 - 16384);
+        for (size_t k = 0; k < c->vec_bytes / sizeof(float); k++)
+            pf[k] = 2.0f * rand() / (float)RAND_MAX - 1.0f;
+    }
+
+    for (unsigned i = 0; i < BENCH_FLEN * 2 * BENCH_INTERP; i++)
+        c->taps_f32[i] = 1.0f / BENCH_FLEN;
+    for (unsigned i = 0; i < BENCH_FLEN * BENCH_INTERP; i++)
+        c->taps_i16[i] = 32767 / BENCH_FLEN;
+    for (unsigned i = 0; i < fftmax; i++)
+        c->wnd[i] = 0.5f;
+
+    c->acc.mine = 1e-7f;
+
+    fft_rtsa_settings_t* st = &c->rtsa.settings;
+    st->lower_pwr_bound = -120;
+    st->upper_pwr_bound = 0;
+    st->divs_for_dB     = 1;
+    st->charging_frame  = 256;
+    st->raise_coef      = 32;
+    st->decay_coef      = 1;
+    rtsa_calc_depth(st);
+    if (posix_memalign((void**)&c->rtsa.pwr, BENCH_ALIGN, sizeof(rtsa_pwr_t) * fftmax * st->rtsa_depth))
+        return -1;
+    memset(c->rtsa.pwr, 0, sizeof(rtsa_pwr_t) * fftmax * st->rtsa_depth);
+
+    c->fmstate.d_mp = 32767.f / (float)M_PI;
+
+    // some non trivial correction: small DC, 2% gain and 0.03 rad phase fix
+    c->iqc = (iqcorr_coeffs_t){ -1e-3f, 2e-3f, 1.02f, -0.03f, -33, 66, 16712, -492 };
+    return 0;
+}
+
+static void bench_ctx_deinit(bench_ctx_t* c)
+{
+    for (unsigned i = 0; i < BENCH_MAX_VECS; i++) {
+        free(c->in_i16[i]);
+        free(c->in_f32[i]);
+        free(c->out[i]);
+    }
+    free(c->taps_f32);
+    free(c->taps_i16);
+    free(c->wnd);
+    free(c->acc.f_mant);
+    free(c->acc.f_pwr);
+    free(c->rtsa.pwr);
+}
+
+static const void* bench_get_fn(const bench_family_t* f, generic_opts_t cap, const char** name)
+{
+    switch (f->kind) {
+    case BK_CONV:        return (const void*)f->get.conv(cap, name);
+    case BK_FILTER:      return (const void*)f->get.filter(cap, name);
+    case BK_FILTER_CF32: return (const void*)f->get.filter_cf32(cap, name);
+    case BK_FILTER_INTERP:      return (const void*)f->get.filter(cap, name);
+    case BK_FILTER_INTERP_CF32: return (const void*)f->get.filter_cf32(cap, name);
+    case BK_FFT_WINDOW:  return (const void*)f->get.fft_window(cap, name);
+    case BK_FFTAD_INIT:  return (const void*)f->get.fftad_init(cap, name);
+    case BK_FFTAD_ADD:   return (const void*)f->get.fftad_add(cap, name);
+    case BK_FFTAD_ADD_HWI16: return (const void*)f->get.fftad_add_hwi16(cap, name);
+    case BK_FFTAD_NORM:  return (const void*)f->get.fftad_norm(cap, name);
+    case BK_RTSA:        return (const void*)f->get.rtsa(cap, name);
+    case BK_RTSA_HWI16:  return (const void*)f->get.rtsa_hwi16(cap, name);
+    case BK_QUADFM_ENC:  return (const void*)f->get.quadfm_enc(cap, name);
+    case BK_QUADFM_DEC:  return (const void*)f->get.quadfm_dec(cap, name);
+    case BK_IQCORR:      return (const void*)f->get.iqcorr(cap, name);
+    }
+    return NULL;
+}
+
+static void bench_prepare(const bench_family_t* f, bench_ctx_t* c, unsigned samples)
+{
+    switch (f->kind) {
+    case BK_FFTAD_ADD:
+    case BK_FFTAD_ADD_HWI16:
+        (*fftad_init_c(OPT_GENERIC, NULL))(&c->acc, samples);
+        break;
+    case BK_FFTAD_NORM:
+        // normalize a real accumulation, not the log of zeroes
+        (*fftad_init_c(OPT_GENERIC, NULL))(&c->acc, samples);
+        (*fftad_add_c(OPT_GENERIC, NULL))(&c->acc, (wvlt_fftwf_complex*)c->in_f32[0], samples);
+        break;
+    case BK_RTSA:
+        rtsa_init(&c->rtsa, samples);
+        break;
+    case BK_RTSA_HWI16:
+        rtsa_init(&c->rtsa, samples);
+        rtsa_fill_hwi16_consts(&c->rtsa.settings, samples, 3.0103f, &c->rtsa_hwi16);
+        break;
+    default:
+        break;
+    }
+}
+
+static inline void bench_call(const bench_family_t* f, const void* fn, bench_ctx_t* c, unsigned samples)
+{
+    switch (f->kind) {
+    case BK_CONV: {
+        unsigned inbz = (unsigned)((uint64_t)samples * f->in_bits / 8);
+        unsigned outbz = (unsigned)((uint64_t)samples * f->out_bits / 8);
+        ((conv_function_t)fn)((const void**)(f->in_f32 ? c->in_f32 : c->in_i16), inbz, c->out, outbz);
+        break;
+    }
+    case BK_FILTER:
+        // values count: one int16 per real sample, I/Q pair for the interleaved one
+        ((filter_function_t)fn)((const int16_t*)c->in_i16[0], c->taps_i16, (int16_t*)c->out[0],
+                                samples * (f->in_bits / 16), 0, BENCH_FLEN);
+        break;
+    case BK_FILTER_CF32:
+        ((filter_cf32_function_t)fn)((const float*)c->in_f32[0], c->taps_f32, (float*)c->out[0],
+                                     samples * 2, 0, BENCH_FLEN);
+        break;
+    case BK_FILTER_INTERP:
+        ((filter_function_t)fn)((const int16_t*)c->in_i16[0], c->taps_i16, (int16_t*)c->out[0],
+                                samples * (f->in_bits / 16), BENCH_INTERP, BENCH_FLEN);
+        break;
+    case BK_FILTER_INTERP_CF32:
+        ((filter_cf32_function_t)fn)((const float*)c->in_f32[0], c->taps_f32, (float*)c->out[0],
+                                     samples * 2, BENCH_INTERP, BENCH_FLEN);
+        break;
+    case BK_FFT_WINDOW:
+        ((fft_window_cf32_function_t)fn)((wvlt_fftwf_complex*)c->in_f32[0], samples, c->wnd, (wvlt_fftwf_complex*)c->out[0]);
+        break;
+    case BK_FFTAD_INIT:
+        ((fftad_init_function_t)fn)(&c->acc, samples);
+        break;
+    case BK_FFTAD_ADD:
+        ((fftad_add_function_t)fn)(&c->acc, (wvlt_fftwf_complex*)c->in_f32[0], samples);
+        break;
+    case BK_FFTAD_ADD_HWI16:
+        ((fftad_add_hwi16_function_t)fn)(&c->acc, (uint16_t*)c->in_i16[0], samples);
+        break;
+    case BK_FFTAD_NORM:
+        ((fftad_norm_function_t)fn)(&c->acc, samples, 1.0f, 0.0f, (float*)c->out[0]);
+        break;
+    case BK_RTSA: {
+        fft_diap_t diap = { 0, samples };
+        ((rtsa_update_function_t)fn)((wvlt_fftwf_complex*)c->in_f32[0], samples, &c->rtsa, 3.0103f, 1e-7f, -50.f, diap);
+        break;
+    }
+    case BK_RTSA_HWI16: {
+        fft_diap_t diap = { 0, samples };
+        ((rtsa_update_hwi16_function_t)fn)((uint16_t*)c->in_i16[0], samples, &c->rtsa, 3.0103f, -50.f, diap, &c->rtsa_hwi16);
+        break;
+    }
+    case BK_QUADFM_ENC:
+        c->fmphase = ((quadfm_encode_function_t)fn)(samples, (const int16_t*)c->in_i16[0], (int16_t*)c->out[0], 1e-4f, c->fmphase);
+        break;
+    case BK_QUADFM_DEC: {
+        int32_t maxp;
+        int64_t pwr;
+        ((quadfm_decode_function_t)fn)(&c->fmstate, (const int16_t*)c->in_i16[0], samples, (int16_t*)c->out[0], &maxp, &pwr);
+        break;
+    }
+    case BK_IQCORR:
+        ((iqcorr_function_t)fn)(&c->iqc, f->in_f32 ? c->in_f32[0] : c->in_i16[0], c->out[0], samples, &c->iqm);
+        break;
+    }
+}
+
+static int cmp_double(const void* a, const void* b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static void bench_run(const bench_family_t* f, const void* fn, bench_ctx_t* c, unsigned samples,
+                      const bench_opts_t* o, bench_result_t* r)
+{
+    double ns[64];
+    unsigned repeats = o->repeats > 64 ? 64 : o->repeats;
+    uint64_t batch = 1;
+
+    bench_prepare(f, c, samples);
+
+    for (unsigned i = 0; i < o->warmup; i++)
+        bench_call(f, fn, c, samples);
+
+    // size the batch so a single timing covers about 1/8 of the time budget
+    const uint64_t batch_ns = (uint64_t)o->min_time_ms * 1000000ull / 8;
+    for (;;) {
+        uint64_t t0 = bench_clock_ns();
+        for (uint64_t i = 0; i < batch; i++)
+            bench_call(f, fn, c, samples);
+        uint64_t dt = bench_clock_ns() - t0;
+        if (dt >= batch_ns || batch >= (1ull << 30))
+            break;
+        batch = (dt < batch_ns / 64) ? batch * 16 : batch * 2;
+    }
+
+    r->iters = 0;
+    for (unsigned k = 0; k < repeats; k++) {
+        uint64_t iters = 0;
+        uint64_t t0 = bench_clock_ns();
+        uint64_t dt;
+        do {
+            for (uint64_t i = 0; i < batch; i++)
+                bench_call(f, fn, c, samples);
+            iters += batch;
+            dt = bench_clock_ns() - t0;
+        } while (dt < (uint64_t)o->min_time_ms * 1000000ull);
+
+        ns[k] = (double)dt / iters;
+        r->iters += iters;
+    }
+
+    qsort(ns, repeats, sizeof(ns[0]), cmp_double);
+    r->ns_min = ns[0];
+    r->ns_med = ns[repeats / 2];
+}
+
+static void bench_emit_header(const bench_opts_t* o, generic_opts_t maxcap)
+{
+    char capstr[32], model[128];
+    cpu_vcap_str(capstr, sizeof(capstr), maxcap);
+    bench_cpu_model(model, sizeof(model));
+
+    if (o->csv) {
+        fprintf(o->out, "# host_caps=%s cpu=\"%s\" pinned=%d min_time_ms=%u repeats=%u\n",
+                capstr, model, o->cpu, o->min_time_ms, o->repeats);
+        fprintf(o->out, "family,function,cap,samples,bytes_in,bytes_out,iters,ns_min,ns_median,msps,mbps_in,mbps_out\n");
+    } else {
+        fprintf(o->out, "{\n  \"host\": { \"caps\": \"%s\", \"cpu\": \"%s\", \"pinned\": %d, \"min_time_ms\": %u, \"repeats\": %u },\n"
+                        "  \"results\": [",
+                capstr, model, o->cpu, o->min_time_ms, o->repeats);
+    }
+}
+
+static void bench_emit(const bench_opts_t* o, const bench_family_t* f, const char* fname, generic_opts_t cap,
+                       unsigned samples, const bench_result_t* r, bool first)
+{
+    char capstr[32];
+    cpu_vcap_str(capstr, sizeof(capstr), cap);
+
+    uint64_t bin = (uint64_t)samples * f->in_bits / 8;
+    uint64_t bout = (uint64_t)samples * f->out_bits / 8;
+    double msps = samples * 1e3 / r->ns_min;
+    double mbin = bin * 1e3 / r->ns_min;
+    double mbout = bout * 1e3 / r->ns_min;
+
+    if (o->csv) {
+        fprintf(o->out, "%s,%s,%s,%u,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%.1f,%.1f,%.3f,%.3f,%.3f\n",
+                f->name, fname, capstr, samples, bin, bout, r->iters, r->ns_min, r->ns_med, msps, mbin, mbout);
+    } else {
+        fprintf(o->out, "%s\n    { \"family\": \"%s\", \"function\": \"%s\", \"cap\": \"%s\", \"samples\": %u, "
+                        "\"bytes_in\": %" PRIu64 ", \"bytes_out\": %" PRIu64 ", \"iters\": %" PRIu64 ", "
+                        "\"ns_min\": %.1f, \"ns_median\": %.1f, \"msps\": %.3f, \"mbps_in\": %.3f, \"mbps_out\": %.3f }",
+                first ? "" : ",", f->name, fname, capstr, samples, bin, bout, r->iters,
+                r->ns_min, r->ns_med, msps, mbin, mbout);
+    }
+    fflush(o->out);
+}
+
+static void bench_emit_footer(const bench_opts_t* o)
+{
+    if (!o->csv)
+        fprintf(o->out, "\n  ]\n}\n");
+}
+
+static void usage(const char* app)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -f json|csv    output format (default json)\n"
+            "  -o FILE        write results to FILE (default stdout)\n"
+            "  -s N[,N..]     sizes in samples (default 1024,16384,262144)\n"
+            "  -t MS          minimal measuring time per repeat, ms (default 50)\n"
+            "  -r N           repeats, min & median are reported (default 5)\n"
+            "  -w N           warmup calls (default 16)\n"
+            "  -c CPU         pin to CPU, -1 to disable (default 0)\n"
+            "  -F SUBSTR      run only families containing SUBSTR\n"
+            "  -l             list families and variants, do not measure\n",
+            app);
+}
+
+int main(int argc, char** argv)
+{
+    bench_opts_t o;
+    bench_ctx_t ctx;
+    int opt;
+
+    memset(&o, 0, sizeof(o));
+    o.sizes[0] = 1024;
+    o.sizes[1] = 16384;
+    o.sizes[2] = 262144;
+    o.sizes_cnt = 3;
+    o.min_time_ms = 50;
+    o.repeats = 5;
+    o.warmup = 16;
+    o.cpu = 0;
+    o.out = stdout;
+
+    while ((opt = getopt(argc, argv, "f:o:s:t:r:w:c:F:lh")) != -1) {
+        switch (opt) {
+        case 'f': o.csv = !strcmp(optarg, "csv"); break;
+        case 'o':
+            o.out = fopen(optarg, "w");
+            if (!o.out) {
+                fprintf(stderr, "Unable to open '%s'\n", optarg);
+                return 1;
+            }
+            break;
+        case 's': {
+            char* p = optarg;
+            o.sizes_cnt = 0;
+            while (*p && o.sizes_cnt < BENCH_MAX_SIZES) {
+                unsigned v = strtoul(p, &p, 0);
+                if (v)
+                    o.sizes[o.sizes_cnt++] = v;
+                if (*p == ',')
+                    p++;
+                else
+                    break;
+            }
+            break;
+        }
+        case 't': o.min_time_ms = atoi(optarg); break;
+        case 'r': o.repeats = atoi(optarg); break;
+        case 'w': o.warmup = atoi(optarg); break;
+        case 'c': o.cpu = atoi(optarg); break;
+        case 'F': o.filter = optarg; break;
+        case 'l': o.list_only = true; break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if (o.sizes_cnt == 0 || o.repeats == 0 || o.min_time_ms == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (o.cpu >= 0 && bench_pin_cpu(o.cpu)) {
+        fprintf(stderr, "Unable to pin to CPU %d, running unpinned\n", o.cpu);
+        o.cpu = -1;
+    }
+
+    const generic_opts_t maxcap = cpu_vcap_obtain(0);
+
+    unsigned max_samples = 0;
+    for (unsigned i = 0; i < o.sizes_cnt; i++) {
+        // conv kernels process samples in blocks, keep sizes aligned for them
+        o.sizes[i] = (o.sizes[i] + 63) & ~63u;
+        if (max_samples < o.sizes[i])
+            max_samples = o.sizes[i];
+    }
+
+    if (!o.list_only && bench_ctx_init(&ctx, max_samples)) {
+        fprintf(stderr, "Unable to allocate buffers for %u samples\n", max_samples);
+        return 2;
+    }
+
+    if (!o.list_only)
+        bench_emit_header(&o, maxcap);
+
+    bool first = true;
+    for (unsigned i = 0; i < FAMILIES_COUNT; i++) {
+        const bench_family_t* f = &s_families[i];
+        bench_variant_t v[BENCH_MAX_VARIANTS];
+        unsigned vcnt = 0;
+
+        if (o.filter && !strstr(f->name, o.filter))
+            continue;
+
+        // walk caps down, a variant is labeled by the lowest cap that still selects it
+        for (generic_opts_t cap = maxcap; ; cap--) {
+            const char* fname = NULL;
+            const void* fn = bench_get_fn(f, cap, &fname);
+
+            if (fn && vcnt > 0 && !strcmp(v[vcnt - 1].name, fname)) {
+                v[vcnt - 1].cap = cap;
+            } else if (fn && vcnt < BENCH_MAX_VARIANTS) {
+                v[vcnt].fn = fn;
+                v[vcnt].name = fname;
+                v[vcnt].cap = cap;
+                vcnt++;
+            }
+
+            if (cap == OPT_GENERIC)
+                break;
+        }
+
+        for (unsigned k = 0; k < vcnt; k++) {
+            if (o.list_only) {
+                char capstr[32];
+                cpu_vcap_str(capstr, sizeof(capstr), v[k].cap);
+                printf("%-20s %-40s %s\n", f->name, v[k].name, capstr);
+                continue;
+            }
+
+            for (unsigned s = 0; s < o.sizes_cnt; s++) {
+                bench_result_t r;
+                if (f->max_samples && o.sizes[s] > f->max_samples)
+                    continue;
+
+                bench_run(f, v[k].fn, &ctx, o.sizes[s], &o, &r);
+                bench_emit(&o, f, v[k].name, v[k].cap, o.sizes[s], &r, first);
+                first = false;
+            }
+        }
+    }
+
+    if (!o.list_only) {
+        bench_emit_footer(&o);
+        bench_ctx_deinit(&ctx);
+    }
+
+    if (o.out != stdout)
+        fclose(o.out);
+    return 0;
+}
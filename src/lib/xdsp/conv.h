@@ -113,6 +113,22 @@ void tr_##conv_fn (const int16_t *__restrict data, \
                    unsigned flen) \
 { conv_fn(data, conv, out, count, decim_bits, flen); }
 
+typedef void (*filter_cf32_function_t)(const float *__restrict data,
+                                       const float *__restrict conv,
+                                       float *__restrict out,
+                                       unsigned count,
+                                       unsigned decim_bits,
+                                       unsigned flen);
+
+#define DECLARE_TR_FUNC_FILTER_CF32(conv_fn) \
+void tr_##conv_fn (const float *__restrict data, \
+                   const float *__restrict conv, \
+                   float *__restrict out, \
+                   unsigned count, \
+                   unsigned decim_bits, \
+                   unsigned flen) \
+{ conv_fn(data, conv, out, count, decim_bits, flen); }
+
 
 struct fft_accumulate_data {
     float* f_mant;
@@ -237,4 +253,55 @@ void tr_##conv_fn (wvlt_fftwf_complex* __restrict in, unsigned fftsz, float* __r
                    wvlt_fftwf_complex* __restrict out) \
 { conv_fn(in, fftsz, wnd, out); }
 
+//FM quadrature modulator/demodulator
+
+struct quadfm_decode_state {
+    int16_t iq_prev[2];
+    float d_mp;
+};
+typedef struct quadfm_decode_state quadfm_decode_state_t;
+
+typedef float (*quadfm_encode_function_t)
+    (unsigned samples, const int16_t *__restrict audio, int16_t *__restrict iq, float gain, float iangle);
+
+typedef int (*quadfm_decode_function_t)
+    (quadfm_decode_state_t *__restrict state, const int16_t *__restrict piq, unsigned samples,
+     int16_t *__restrict out, int32_t *__restrict omaxp, int64_t *__restrict opwr);
+
+#define DECLARE_TR_FUNC_QUADFM_ENCODE(conv_fn) \
+float tr_##conv_fn (unsigned samples, const int16_t *__restrict audio, int16_t *__restrict iq, float gain, float iangle) \
+{ return conv_fn(samples, audio, iq, gain, iangle); }
+
+#define DECLARE_TR_FUNC_QUADFM_DECODE(conv_fn) \
+int tr_##conv_fn (quadfm_decode_state_t *__restrict state, const int16_t *__restrict piq, unsigned samples, \
+                  int16_t *__restrict out, int32_t *__restrict omaxp, int64_t *__restrict opwr) \
+{ return conv_fn(state, piq, samples, out, omaxp, opwr); }
+
+//DC offset / IQ imbalance correction
+
+// i' = i + oi;  q' = a * q + b * i + oq
+// ci16 kernels use the Q14 copies (a_q14, b_q14) and saturate the result
+struct iqcorr_coeffs {
+    float oi, oq, a, b;
+    int16_t oi_i16, oq_i16;
+    int16_t a_q14, b_q14;
+};
+typedef struct iqcorr_coeffs iqcorr_coeffs_t;
+
+// raw (uncorrected) sums accumulated by the kernels
+struct iqcorr_moments {
+    double si, sq, sii, sqq, siq;
+    uint64_t n;
+};
+typedef struct iqcorr_moments iqcorr_moments_t;
+
+typedef void (*iqcorr_function_t)
+    (const iqcorr_coeffs_t *__restrict c, const void *in, void *out, unsigned samples,
+     iqcorr_moments_t *__restrict m);
+
+#define DECLARE_TR_FUNC_IQCORR(conv_fn) \
+void tr_##conv_fn (const iqcorr_coeffs_t *__restrict c, const void *in, void *out, unsigned samples, \
+                   iqcorr_moments_t *__restrict m) \
+{ conv_fn(c, in, out, samples, m); }
+
 #endif
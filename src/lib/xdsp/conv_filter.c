@@ -1,6 +1,7 @@
 // Copyright (c) 2023-2024 Wavelet Lab
 // SPDX-License-Identifier: MIT
 
+#include <string.h>
 #include "conv_filter.h"
 #include "attribute_switch.h"
 
@@ -25,6 +26,16 @@ VWLT_ATTRIBUTE(optimize("-O3"))
 #include "templates/conv_filter_interpolate_interleave_generic.t"
 DECLARE_TR_FUNC_FILTER(conv_filter_interpolate_interleave_generic)
 
+#define TEMPLATE_FUNC_NAME conv_filter_cf32_generic
+VWLT_ATTRIBUTE(optimize("-O3"))
+#include "templates/conv_filter_cf32_generic.t"
+DECLARE_TR_FUNC_FILTER_CF32(conv_filter_cf32_generic)
+
+#define TEMPLATE_FUNC_NAME conv_filter_interpolate_cf32_generic
+VWLT_ATTRIBUTE(optimize("-O3"))
+#include "templates/conv_filter_interpolate_cf32_generic.t"
+DECLARE_TR_FUNC_FILTER_CF32(conv_filter_interpolate_cf32_generic)
+
 
 #ifdef WVLT_SSE3
 #define TEMPLATE_FUNC_NAME conv_filter_sse3
@@ -48,8 +59,54 @@ DECLARE_TR_FUNC_FILTER(conv_filter_avx2)
 VWLT_ATTRIBUTE(optimize("-O3"), target("avx2"))
 #include "templates/conv_filter_interleave_avx2.t"
 DECLARE_TR_FUNC_FILTER(conv_filter_interleave_avx2)
+
+#define TEMPLATE_FUNC_NAME conv_filter_cf32_avx2
+VWLT_ATTRIBUTE(optimize("-O3"), target("avx2,fma"))
+#include "templates/conv_filter_cf32_avx2.t"
+DECLARE_TR_FUNC_FILTER_CF32(conv_filter_cf32_avx2)
+
+#define TEMPLATE_FUNC_NAME conv_filter_interpolate_cf32_avx2
+VWLT_ATTRIBUTE(optimize("-O3"), target("avx2,fma"))
+#include "templates/conv_filter_interpolate_cf32_avx2.t"
+DECLARE_TR_FUNC_FILTER_CF32(conv_filter_interpolate_cf32_avx2)
 #endif  //WVLT_AVX2
 
+#ifdef WVLT_NEON
+#define TEMPLATE_FUNC_NAME conv_filter_neon
+VWLT_ATTRIBUTE(optimize("-O3"))
+#include "templates/conv_filter_neon.t"
+DECLARE_TR_FUNC_FILTER(conv_filter_neon)
+
+#define TEMPLATE_FUNC_NAME conv_filter_interleave_neon
+VWLT_ATTRIBUTE(optimize("-O3"))
+#include "templates/conv_filter_interleave_neon.t"
+DECLARE_TR_FUNC_FILTER(conv_filter_interleave_neon)
+#endif  //WVLT_NEON
+
+#ifdef WVLT_AVX512BW
+#define TEMPLATE_FUNC_NAME conv_filter_cf32_avx512bw
+VWLT_ATTRIBUTE(optimize("-O3"), target("avx512f,avx512bw"))
+#include "templates/conv_filter_cf32_avx512bw.t"
+DECLARE_TR_FUNC_FILTER_CF32(conv_filter_cf32_avx512bw)
+
+#define TEMPLATE_FUNC_NAME conv_filter_interpolate_cf32_avx512bw
+VWLT_ATTRIBUTE(optimize("-O3"), target("avx512f,avx512bw"))
+#include "templates/conv_filter_interpolate_cf32_avx512bw.t"
+DECLARE_TR_FUNC_FILTER_CF32(conv_filter_interpolate_cf32_avx512bw)
+#endif  //WVLT_AVX512BW
+
+#ifdef WVLT_NEON
+#define TEMPLATE_FUNC_NAME conv_filter_cf32_neon
+VWLT_ATTRIBUTE(optimize("-O3"))
+#include "templates/conv_filter_cf32_neon.t"
+DECLARE_TR_FUNC_FILTER_CF32(conv_filter_cf32_neon)
+
+#define TEMPLATE_FUNC_NAME conv_filter_interpolate_cf32_neon
+VWLT_ATTRIBUTE(optimize("-O3"))
+#include "templates/conv_filter_interpolate_cf32_neon.t"
+DECLARE_TR_FUNC_FILTER_CF32(conv_filter_interpolate_cf32_neon)
+#endif  //WVLT_NEON
+
 
 filter_function_t conv_filter_c(generic_opts_t cpu_cap, const char** sfunc)
 {
@@ -59,6 +116,7 @@ filter_function_t conv_filter_c(generic_opts_t cpu_cap, const char** sfunc)
     SELECT_GENERIC_FN(fn, fname, tr_conv_filter_generic, cpu_cap);
     SELECT_SSSE3_FN(fn, fname, tr_conv_filter_sse3, cpu_cap);
     SELECT_AVX2_FN(fn, fname, tr_conv_filter_avx2, cpu_cap);
+    SELECT_NEON_FN(fn, fname, tr_conv_filter_neon, cpu_cap);
 
     if (sfunc) *sfunc = fname;
     return fn;
@@ -72,11 +130,32 @@ filter_function_t conv_filter_interleave_c(generic_opts_t cpu_cap, const char **
     SELECT_GENERIC_FN(fn, fname, tr_conv_filter_interleave_generic, cpu_cap);
     SELECT_SSSE3_FN(fn, fname, tr_conv_filter_interleave_sse3, cpu_cap);
     SELECT_AVX2_FN(fn, fname, tr_conv_filter_interleave_avx2, cpu_cap);
+    SELECT_NEON_FN(fn, fname, tr_conv_filter_interleave_neon, cpu_cap);
 
     if (sfunc) *sfunc = fname;
     return fn;
 }
 
+void conv_filter_interleave_taps(generic_opts_t cpu_cap,
+                                 const int16_t *__restrict taps,
+                                 unsigned flen,
+                                 int16_t *__restrict out)
+{
+#ifdef WVLT_AVX2
+    if (cpu_cap >= OPT_AVX2) {
+        // AVX2 kernel multiplies taps against lane-swapped I/Q pairs, see conv_filter_interleave_avx2.t
+        const unsigned alen = (flen + 15) & ~15u;
+        for (unsigned i = 0; i < alen; i++) {
+            unsigned z = ((i & 7) << 1) | (((~i) >> 3) & 1) | (i & 0xfffffff0);
+            out[z] = (i < flen) ? taps[i] : 0;
+        }
+        return;
+    }
+#endif
+    (void)cpu_cap;
+    memcpy(out, taps, flen * sizeof(int16_t));
+}
+
 filter_function_t conv_filter_interpolate_c(generic_opts_t cpu_cap, const char **sfunc)
 {
     const char* fname;
@@ -98,3 +177,31 @@ filter_function_t conv_filter_interpolate_interleave_c(generic_opts_t cpu_cap, c
     if (sfunc) *sfunc = fname;
     return fn;
 }
+
+filter_cf32_function_t conv_filter_cf32_c(generic_opts_t cpu_cap, const char **sfunc)
+{
+    const char* fname;
+    filter_cf32_function_t fn;
+
+    SELECT_GENERIC_FN(fn, fname, tr_conv_filter_cf32_generic, cpu_cap);
+    SELECT_AVX2_FN(fn, fname, tr_conv_filter_cf32_avx2, cpu_cap);
+    SELECT_AVX512BW_FN(fn, fname, tr_conv_filter_cf32_avx512bw, cpu_cap);
+    SELECT_NEON_FN(fn, fname, tr_conv_filter_cf32_neon, cpu_cap);
+
+    if (sfunc) *sfunc = fname;
+    return fn;
+}
+
+filter_cf32_function_t conv_filter_interpolate_cf32_c(generic_opts_t cpu_cap, const char **sfunc)
+{
+    const char* fname;
+    filter_cf32_function_t fn;
+
+    SELECT_GENERIC_FN(fn, fname, tr_conv_filter_interpolate_cf32_generic, cpu_cap);
+    SELECT_AVX2_FN(fn, fname, tr_conv_filter_interpolate_cf32_avx2, cpu_cap);
+    SELECT_AVX512BW_FN(fn, fname, tr_conv_filter_interpolate_cf32_avx512bw, cpu_cap);
+    SELECT_NEON_FN(fn, fname, tr_conv_filter_interpolate_cf32_neon, cpu_cap);
+
+    if (sfunc) *sfunc = fname;
+    return fn;
+}
@@ -25,6 +25,16 @@ filter_function_t conv_filter_interleave_c(generic_opts_t cpu_cap, const char **
 filter_function_t conv_filter_interpolate_c(generic_opts_t cpu_cap, const char **sfunc);
 filter_function_t conv_filter_interpolate_interleave_c(generic_opts_t cpu_cap, const char **sfunc);
 
+/* Put taps into the order expected by conv_filter_interleave_c(cpu_cap), out should hold flen rounded up to 16 */
+void conv_filter_interleave_taps(generic_opts_t cpu_cap,
+                                 const int16_t *__restrict taps,
+                                 unsigned flen,
+                                 int16_t *__restrict out);
+
+/* Complex float (interleaved cf32) data with real float taps, no output scaling */
+filter_cf32_function_t conv_filter_cf32_c(generic_opts_t cpu_cap, const char **sfunc);
+filter_cf32_function_t conv_filter_interpolate_cf32_c(generic_opts_t cpu_cap, const char **sfunc);
+
 static inline filter_function_t conv_filter(unsigned flags)
 {
     const generic_opts_t cap = cpu_vcap_get();
@@ -40,4 +50,12 @@ static inline filter_function_t conv_filter(unsigned flags)
     }
 }
 
+static inline filter_cf32_function_t conv_filter_cf32(unsigned flags)
+{
+    const generic_opts_t cap = (flags & FDAF_NO_VECTOR) ? OPT_GENERIC : cpu_vcap_get();
+
+    return (flags & FDAF_INTERPOLATE) ?
+        conv_filter_interpolate_cf32_c(cap, NULL) : conv_filter_cf32_c(cap, NULL);
+}
+
 #endif // CONV_FILTER_H
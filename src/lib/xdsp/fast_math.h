@@ -5,6 +5,7 @@
 #define FAST_MATH_H
 
 #include <stdint.h>
+#include <math.h>
 #include "vbase.h"
 
 #define WVLT_FASTLOG2_MUL    1.1920928955078125E-7f
@@ -59,6 +60,70 @@ static inline
     return p + e;
 }
 
+/*
+ * Polynomial atan2 & sincos, max eps about 1e-5 rad
+ * WVLT_ATAN2F8/WVLT_SINCOSF8 below implement the same polynomials
+ */
+#define WVLT_PI_F       3.14159265358979f
+#define WVLT_PI_2_F     1.57079632679490f
+#define WVLT_2_PI_F     0.63661977236758f
+#define WVLT_1_2PI_F    0.15915494309190f
+#define WVLT_2PI_F      6.28318530717959f
+
+#define WVLT_ATAN_C1   -0.327622764f
+#define WVLT_ATAN_C2    0.15931422f
+#define WVLT_ATAN_C3   -0.0464964749f
+
+// Cody-Waite PI/2 split
+#define WVLT_SINCOS_DP1 1.5703125f
+#define WVLT_SINCOS_DP2 4.837512969970703125e-4f
+#define WVLT_SINCOS_DP3 7.54978995489188216e-8f
+
+#define WVLT_SIN_C1    -1.6666654611E-1f
+#define WVLT_SIN_C2     8.3321608736E-3f
+#define WVLT_SIN_C3    -1.9515295891E-4f
+#define WVLT_COS_C1     4.166664568298827E-2f
+#define WVLT_COS_C2    -1.388731625493765E-3f
+#define WVLT_COS_C3     2.443315711809948E-5f
+
+static inline
+    float wvlt_atan2f(float y, float x)
+{
+    float ax = fabsf(x), ay = fabsf(y);
+    float mx = ax > ay ? ax : ay;
+    float mn = ax > ay ? ay : ax;
+    float a = mx > 0 ? mn / mx : 0.f;
+    float s = a * a;
+    float r = ((WVLT_ATAN_C3 * s + WVLT_ATAN_C2) * s + WVLT_ATAN_C1) * s * a + a;
+
+    if (ay > ax) r = WVLT_PI_2_F - r;
+    if (x < 0)   r = WVLT_PI_F - r;
+    return copysignf(r, y);
+}
+
+static inline
+    void wvlt_sincosf(float ph, float* psin, float* pcos)
+{
+    float j = rintf(ph * WVLT_2_PI_F);
+    int q = (int)j;
+    float y = ((ph - j * WVLT_SINCOS_DP1) - j * WVLT_SINCOS_DP2) - j * WVLT_SINCOS_DP3;
+    float z = y * y;
+    float sp = y + y * z * ((WVLT_SIN_C3 * z + WVLT_SIN_C2) * z + WVLT_SIN_C1);
+    float cp = 1.0f - 0.5f * z + z * z * ((WVLT_COS_C3 * z + WVLT_COS_C2) * z + WVLT_COS_C1);
+
+    float s = (q & 1) ? cp : sp;
+    float c = (q & 1) ? sp : cp;
+    *psin = (q & 2) ? -s : s;
+    *pcos = ((q + 1) & 2) ? -c : c;
+}
+
+// wrap phase into [-PI..+PI)
+static inline
+    float wvlt_wrap_phasef(float ph)
+{
+    return ph - WVLT_2PI_F * rintf(ph * WVLT_1_2PI_F);
+}
+
 #ifdef WVLT_AVX2
 
 #define WVLT_LOG2_POLY0(x, c0) _mm256_set1_ps(c0)
@@ -101,6 +166,48 @@ static inline
     out = _mm256_add_ps(p, e); \
 }
 
+
+#define WVLT_ATAN2F8(y, x, out) \
+{ \
+    const __m256 sgn = _mm256_set1_ps(-0.0f); \
+    __m256 ax = _mm256_andnot_ps(sgn, x); \
+    __m256 ay = _mm256_andnot_ps(sgn, y); \
+    __m256 mx = _mm256_max_ps(ax, ay); \
+    __m256 mn = _mm256_min_ps(ax, ay); \
+    __m256 a = _mm256_and_ps(_mm256_div_ps(mn, mx), _mm256_cmp_ps(mx, _mm256_setzero_ps(), _CMP_GT_OQ)); \
+    __m256 s = _mm256_mul_ps(a, a); \
+    __m256 r = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(WVLT_ATAN_C3), s), _mm256_set1_ps(WVLT_ATAN_C2)); \
+    r = _mm256_add_ps(_mm256_mul_ps(r, s), _mm256_set1_ps(WVLT_ATAN_C1)); \
+    r = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(r, s), a), a); \
+  \
+    r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(WVLT_PI_2_F), r), _mm256_cmp_ps(ay, ax, _CMP_GT_OQ)); \
+    r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(WVLT_PI_F), r), _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ)); \
+    out = _mm256_or_ps(r, _mm256_and_ps(y, sgn)); \
+}
+
+#define WVLT_SINCOSF8(ph, osin, ocos) \
+{ \
+    __m256 j = _mm256_round_ps(_mm256_mul_ps(ph, _mm256_set1_ps(WVLT_2_PI_F)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); \
+    __m256i q = _mm256_cvtps_epi32(j); \
+    __m256 y = _mm256_sub_ps(ph, _mm256_mul_ps(j, _mm256_set1_ps(WVLT_SINCOS_DP1))); \
+    y = _mm256_sub_ps(y, _mm256_mul_ps(j, _mm256_set1_ps(WVLT_SINCOS_DP2))); \
+    y = _mm256_sub_ps(y, _mm256_mul_ps(j, _mm256_set1_ps(WVLT_SINCOS_DP3))); \
+    __m256 z = _mm256_mul_ps(y, y); \
+  \
+    __m256 sp = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(WVLT_SIN_C3), z), _mm256_set1_ps(WVLT_SIN_C2)); \
+    sp = _mm256_add_ps(_mm256_mul_ps(sp, z), _mm256_set1_ps(WVLT_SIN_C1)); \
+    sp = _mm256_add_ps(y, _mm256_mul_ps(_mm256_mul_ps(y, z), sp)); \
+    __m256 cp = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(WVLT_COS_C3), z), _mm256_set1_ps(WVLT_COS_C2)); \
+    cp = _mm256_add_ps(_mm256_mul_ps(cp, z), _mm256_set1_ps(WVLT_COS_C1)); \
+    cp = _mm256_add_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(_mm256_set1_ps(0.5f), z)), _mm256_mul_ps(_mm256_mul_ps(z, z), cp)); \
+  \
+    __m256 swp = _mm256_castsi256_ps(_mm256_slli_epi32(q, 31)); \
+    __m256 sneg = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(q, _mm256_set1_epi32(2)), 30)); \
+    __m256 cneg = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(q, _mm256_set1_epi32(1)), _mm256_set1_epi32(2)), 30)); \
+    osin = _mm256_xor_ps(_mm256_blendv_ps(sp, cp, swp), sneg); \
+    ocos = _mm256_xor_ps(_mm256_blendv_ps(cp, sp, swp), cneg); \
+}
+
 #endif
 
 #ifdef WVLT_NEON
@@ -146,6 +253,48 @@ static inline
         out = vaddq_f32(p, e); \
 }
 
+
+#define WVLT_ATAN2F8(y, x, out) \
+{ \
+    const uint32x4_t sgn = vdupq_n_u32(0x80000000); \
+    float32x4_t ax = vabsq_f32(x); \
+    float32x4_t ay = vabsq_f32(y); \
+    float32x4_t mx = vmaxq_f32(ax, ay); \
+    float32x4_t mn = vminq_f32(ax, ay); \
+    float32x4_t a = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(vdivq_f32(mn, mx)), vcgtq_f32(mx, vdupq_n_f32(0.f)))); \
+    float32x4_t s = vmulq_f32(a, a); \
+    float32x4_t r = vmlaq_f32(vdupq_n_f32(WVLT_ATAN_C2), vdupq_n_f32(WVLT_ATAN_C3), s); \
+    r = vmlaq_f32(vdupq_n_f32(WVLT_ATAN_C1), r, s); \
+    r = vmlaq_f32(a, vmulq_f32(r, s), a); \
+  \
+    r = vbslq_f32(vcgtq_f32(ay, ax), vsubq_f32(vdupq_n_f32(WVLT_PI_2_F), r), r); \
+    r = vbslq_f32(vcltq_f32(x, vdupq_n_f32(0.f)), vsubq_f32(vdupq_n_f32(WVLT_PI_F), r), r); \
+    out = vbslq_f32(sgn, y, r); \
+}
+
+#define WVLT_SINCOSF8(ph, osin, ocos) \
+{ \
+    float32x4_t j = vrndnq_f32(vmulq_n_f32(ph, WVLT_2_PI_F)); \
+    int32x4_t q = vcvtq_s32_f32(j); \
+    float32x4_t y = vmlsq_n_f32(ph, j, WVLT_SINCOS_DP1); \
+    y = vmlsq_n_f32(y, j, WVLT_SINCOS_DP2); \
+    y = vmlsq_n_f32(y, j, WVLT_SINCOS_DP3); \
+    float32x4_t z = vmulq_f32(y, y); \
+  \
+    float32x4_t sp = vmlaq_n_f32(vdupq_n_f32(WVLT_SIN_C2), z, WVLT_SIN_C3); \
+    sp = vmlaq_f32(vdupq_n_f32(WVLT_SIN_C1), sp, z); \
+    sp = vmlaq_f32(y, vmulq_f32(y, z), sp); \
+    float32x4_t cp = vmlaq_n_f32(vdupq_n_f32(WVLT_COS_C2), z, WVLT_COS_C3); \
+    cp = vmlaq_f32(vdupq_n_f32(WVLT_COS_C1), cp, z); \
+    cp = vmlaq_f32(vmlsq_n_f32(vdupq_n_f32(1.0f), z, 0.5f), vmulq_f32(z, z), cp); \
+  \
+    uint32x4_t swp = vtstq_s32(q, vdupq_n_s32(1)); \
+    uint32x4_t sneg = vshlq_n_u32(vreinterpretq_u32_s32(vandq_s32(q, vdupq_n_s32(2))), 30); \
+    uint32x4_t cneg = vshlq_n_u32(vreinterpretq_u32_s32(vandq_s32(vaddq_s32(q, vdupq_n_s32(1)), vdupq_n_s32(2))), 30); \
+    osin = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(swp, cp, sp)), sneg)); \
+    ocos = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(swp, sp, cp)), cneg)); \
+}
+
 #endif
 
 #define DBFS_TO_AMPLITUDE(dbfs, max_amplitude) ((max_amplitude) * pow(2, (float)(dbfs) / 6.020599913f))
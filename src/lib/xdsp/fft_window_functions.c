@@ -13,6 +13,13 @@ VWLT_ATTRIBUTE(optimize("-O3"), target("avx2"))
 DECLARE_TR_FUNC_FFT_WINDOW_CF32(fft_window_cf32_avx2)
 #endif
 
+#ifdef WVLT_NEON
+#define TEMPLATE_FUNC_NAME fft_window_cf32_neon
+VWLT_ATTRIBUTE(optimize("-O3"))
+#include "templates/fft_window_cf32_neon.t"
+DECLARE_TR_FUNC_FFT_WINDOW_CF32(fft_window_cf32_neon)
+#endif
+
 fft_window_cf32_function_t fft_window_cf32_c(generic_opts_t cpu_cap, const char** sfunc)
 {
     const char* fname;
@@ -20,6 +27,7 @@ fft_window_cf32_function_t fft_window_cf32_c(generic_opts_t cpu_cap, const char*
 
     SELECT_GENERIC_FN(fn, fname, tr_fft_window_cf32_generic, cpu_cap);
     SELECT_AVX2_FN(fn, fname, tr_fft_window_cf32_avx2, cpu_cap);
+    SELECT_NEON_FN(fn, fname, tr_fft_window_cf32_neon, cpu_cap);
 
     if (sfunc) *sfunc = fname;
     return fn;
@@ -2,14 +2,11 @@
 // SPDX-License-Identifier: MIT
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 #include "filter.h"
 
-#include <emmintrin.h>
-#include <immintrin.h>
-#include <smmintrin.h>
-
 #include "attribute_switch.h"
 #include "conv_filter.h"
 
@@ -374,11 +371,8 @@ filter_data_t* filter_data_alloc(unsigned origblksz,
 #endif
 
     // Rearrange filter taps
-    if ((flags & FDAF_INTERLEAVE) && (!(flags & FDAF_INTERPOLATE)) && (cpu_vcap_get() == OPT_AVX2)) {
-        for (unsigned i = 0; i < filer_taps; i++) {
-            unsigned z = (((~i) & 1)) | ((i & 2) << 2) | ((i & 4)) | ((i & 8) >> 2) | (i & 0xfffffff0);
-            tdata[z] = pfilter[i];
-        }
+    if ((flags & FDAF_INTERLEAVE) && (!(flags & FDAF_INTERPOLATE))) {
+        conv_filter_interleave_taps(cpu_vcap_get(), pfilter, filer_taps, tdata);
     } else if (flags & FDAF_INTERPOLATE) {
         // Reorganize to poly-phase filter array
         for (unsigned k = 0; k < decim_inter; k++) {
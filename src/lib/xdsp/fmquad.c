@@ -7,35 +7,85 @@
 #include <stdint.h>
 #include <math.h>
 #include "fmquad.h"
+#include "fast_math.h"
 #include "attribute_switch.h"
 
 
-VWLT_ATTRIBUTE(optimize("O3"))
+#define TEMPLATE_FUNC_NAME quadfm_encode_generic
+VWLT_ATTRIBUTE(optimize("-O3"))
+#include "templates/quadfm_encode_generic.t"
+DECLARE_TR_FUNC_QUADFM_ENCODE(quadfm_encode_generic)
+
+#ifdef WVLT_AVX2
+#define TEMPLATE_FUNC_NAME quadfm_encode_avx2
+VWLT_ATTRIBUTE(optimize("-O3"), target("avx2"))
+#include "templates/quadfm_encode_avx2.t"
+DECLARE_TR_FUNC_QUADFM_ENCODE(quadfm_encode_avx2)
+#endif
+
+#ifdef WVLT_NEON
+#define TEMPLATE_FUNC_NAME quadfm_encode_neon
+VWLT_ATTRIBUTE(optimize("-O3"))
+#include "templates/quadfm_encode_neon.t"
+DECLARE_TR_FUNC_QUADFM_ENCODE(quadfm_encode_neon)
+#endif
+
+quadfm_encode_function_t quadfm_encode_c(generic_opts_t cpu_cap, const char** sfunc)
+{
+    const char* fname;
+    quadfm_encode_function_t fn;
+
+    SELECT_GENERIC_FN(fn, fname, tr_quadfm_encode_generic, cpu_cap);
+    SELECT_AVX2_FN(fn, fname, tr_quadfm_encode_avx2, cpu_cap);
+    SELECT_NEON_FN(fn, fname, tr_quadfm_encode_neon, cpu_cap);
+
+    if (sfunc) *sfunc = fname;
+    return fn;
+}
+
+
+#define TEMPLATE_FUNC_NAME quadfm_decode_generic
+VWLT_ATTRIBUTE(optimize("-O3"))
+#include "templates/quadfm_decode_generic.t"
+DECLARE_TR_FUNC_QUADFM_DECODE(quadfm_decode_generic)
+
+#ifdef WVLT_AVX2
+#define TEMPLATE_FUNC_NAME quadfm_decode_avx2
+VWLT_ATTRIBUTE(optimize("-O3"), target("avx2"))
+#include "templates/quadfm_decode_avx2.t"
+DECLARE_TR_FUNC_QUADFM_DECODE(quadfm_decode_avx2)
+#endif
+
+#ifdef WVLT_NEON
+#define TEMPLATE_FUNC_NAME quadfm_decode_neon
+VWLT_ATTRIBUTE(optimize("-O3"))
+#include "templates/quadfm_decode_neon.t"
+DECLARE_TR_FUNC_QUADFM_DECODE(quadfm_decode_neon)
+#endif
+
+quadfm_decode_function_t quadfm_decode_c(generic_opts_t cpu_cap, const char** sfunc)
+{
+    const char* fname;
+    quadfm_decode_function_t fn;
+
+    SELECT_GENERIC_FN(fn, fname, tr_quadfm_decode_generic, cpu_cap);
+    SELECT_AVX2_FN(fn, fname, tr_quadfm_decode_avx2, cpu_cap);
+    SELECT_NEON_FN(fn, fname, tr_quadfm_decode_neon, cpu_cap);
+
+    if (sfunc) *sfunc = fname;
+    return fn;
+}
+
+
 float quadfm_encode(unsigned samples,
                     const int16_t* audio,
                     int16_t* iq,
                     float gain,
                     float iangle)
 {
-    unsigned i;
-    for (i = 0; i < samples; i++ ) {
-        float da = audio[i] * gain;
-        float fi, fq;
-
-        iangle += da;
-        sincosf(iangle, &fq, &fi);
-
-        int16_t vi, vq;
-        vi = (int16_t)(fi * 0.7f * 32767.0f);
-        vq = (int16_t)(fq * 0.7f * 32767.0f);
-
-        iq[2 * i + 0] = vi;
-        iq[2 * i + 1] = vq;
-    }
-    return iangle;
+    return (*quadfm_encode_c(cpu_vcap_get(), NULL))(samples, audio, iq, gain, iangle);
 }
 
-VWLT_ATTRIBUTE(optimize("O3"))
 int quadfm_decode(quadfm_decode_state_t* state,
                   const int16_t* piq,
                   unsigned samples,
@@ -43,45 +93,5 @@ int quadfm_decode(quadfm_decode_state_t* state,
                   int32_t* omaxp,
                   int64_t* opwr)
 {
-    unsigned i;
-    int64_t tpwr = 0;
-
-    int16_t iq_prev[2] = { state->iq_prev[0], state->iq_prev[1] };
-    int32_t pwr;
-    int32_t maxp = 0;
-    int16_t iq[2];
-    int32_t ld[2];
-
-    int16_t o;
-
-    for (i = 0; i < samples; i++ ) {
-        iq[0] = piq[2 * i];
-        iq[1] = piq[2 * i + 1];
-
-        // Calc PWR
-        pwr = iq[0] * iq[0] + iq[1] * iq[1];
-
-        tpwr += pwr;
-        if (maxp < pwr)
-            maxp = pwr;
-
-        // Calc differential of x(0) and x*(-1)
-        ld[0] = (int32_t)iq[0] * (int32_t)iq_prev[0] + (int32_t)iq[1] * (int32_t)iq_prev[1];
-        ld[1] = (int32_t)iq[1] * (int32_t)iq_prev[0] - (int32_t)iq[0] * (int32_t)iq_prev[1];
-
-        // decode & multiply
-        o = (int16_t)(atan2f(ld[1], ld[0]) * state->d_mp);
-
-        iq_prev[0] = iq[0];
-        iq_prev[1] = iq[1];
-        out[i] = o;
-    }
-
-    state->iq_prev[0] = iq_prev[0];
-    state->iq_prev[1] = iq_prev[1];
-
-    *omaxp = maxp;
-    *opwr = tpwr;
-    return 0;
+    return (*quadfm_decode_c(cpu_vcap_get(), NULL))(state, piq, samples, out, omaxp, opwr);
 }
-
@@ -5,13 +5,14 @@
 #define FMQUAD_H
 
 #include <stdint.h>
-
-
-typedef struct quadfm_decode_state {
-    int16_t iq_prev[2];
-    float d_mp;
-} quadfm_decode_state_t;
-
+#include "conv.h"
+
+/*
+ * SIMD variants use polynomial atan2/sincos (max error about 1e-5 rad) instead of
+ * libm, and quadfm_encode returns the phase wrapped into [-PI..+PI)
+ */
+quadfm_encode_function_t quadfm_encode_c(generic_opts_t cpu_cap, const char** sfunc);
+quadfm_decode_function_t quadfm_decode_c(generic_opts_t cpu_cap, const char** sfunc);
 
 float quadfm_encode(unsigned samples,
                     const int16_t* audio,
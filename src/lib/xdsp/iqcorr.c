@@ -0,0 +1,183 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include "iqcorr.h"
+#include "attribute_switch.h"
+
+#define IQCORR_DEFAULT_TAU  (1u << 20)
+#define IQCORR_GAIN_MAX     1.99
+#define IQCORR_GAIN_MIN     0.5
+
+
+#define TEMPLATE_FUNC_NAME iqcorr_ci16_generic
+VWLT_ATTRIBUTE(optimize("-O3"))
+#include "templates/iqcorr_ci16_generic.t"
+DECLARE_TR_FUNC_IQCORR(iqcorr_ci16_generic)
+
+#ifdef WVLT_AVX2
+#define TEMPLATE_FUNC_NAME iqcorr_ci16_avx2
+VWLT_ATTRIBUTE(optimize("-O3"), target("avx2"))
+#include "templates/iqcorr_ci16_avx2.t"
+DECLARE_TR_FUNC_IQCORR(iqcorr_ci16_avx2)
+#endif
+
+#ifdef WVLT_NEON
+#define TEMPLATE_FUNC_NAME iqcorr_ci16_neon
+VWLT_ATTRIBUTE(optimize("-O3"))
+#include "templates/iqcorr_ci16_neon.t"
+DECLARE_TR_FUNC_IQCORR(iqcorr_ci16_neon)
+#endif
+
+iqcorr_function_t iqcorr_ci16_c(generic_opts_t cpu_cap, const char** sfunc)
+{
+    const char* fname;
+    iqcorr_function_t fn;
+
+    SELECT_GENERIC_FN(fn, fname, tr_iqcorr_ci16_generic, cpu_cap);
+    SELECT_AVX2_FN(fn, fname, tr_iqcorr_ci16_avx2, cpu_cap);
+    SELECT_NEON_FN(fn, fname, tr_iqcorr_ci16_neon, cpu_cap);
+
+    if (sfunc) *sfunc = fname;
+    return fn;
+}
+
+
+#define TEMPLATE_FUNC_NAME iqcorr_cf32_generic
+VWLT_ATTRIBUTE(optimize("-O3"))
+#include "templates/iqcorr_cf32_generic.t"
+DECLARE_TR_FUNC_IQCORR(iqcorr_cf32_generic)
+
+#ifdef WVLT_AVX2
+#define TEMPLATE_FUNC_NAME iqcorr_cf32_avx2
+VWLT_ATTRIBUTE(optimize("-O3"), target("avx2"))
+#include "templates/iqcorr_cf32_avx2.t"
+DECLARE_TR_FUNC_IQCORR(iqcorr_cf32_avx2)
+#endif
+
+#ifdef WVLT_NEON
+#define TEMPLATE_FUNC_NAME iqcorr_cf32_neon
+VWLT_ATTRIBUTE(optimize("-O3"))
+#include "templates/iqcorr_cf32_neon.t"
+DECLARE_TR_FUNC_IQCORR(iqcorr_cf32_neon)
+#endif
+
+iqcorr_function_t iqcorr_cf32_c(generic_opts_t cpu_cap, const char** sfunc)
+{
+    const char* fname;
+    iqcorr_function_t fn;
+
+    SELECT_GENERIC_FN(fn, fname, tr_iqcorr_cf32_generic, cpu_cap);
+    SELECT_AVX2_FN(fn, fname, tr_iqcorr_cf32_avx2, cpu_cap);
+    SELECT_NEON_FN(fn, fname, tr_iqcorr_cf32_neon, cpu_cap);
+
+    if (sfunc) *sfunc = fname;
+    return fn;
+}
+
+
+static int16_t _iqcorr_sat16(double v)
+{
+    long r = lrint(v);
+    return (r > INT16_MAX) ? INT16_MAX : (r < -INT16_MAX) ? -INT16_MAX : (int16_t)r;
+}
+
+static void _iqcorr_set_coeffs(iqcorr_coeffs_t* c, double oi, double oq, double a, double b)
+{
+    c->oi = oi;
+    c->oq = oq;
+    c->a = a;
+    c->b = b;
+
+    c->oi_i16 = _iqcorr_sat16(oi);
+    c->oq_i16 = _iqcorr_sat16(oq);
+    c->a_q14 = _iqcorr_sat16(a * 16384);
+    c->b_q14 = _iqcorr_sat16(b * 16384);
+}
+
+int iqcorr_init(iqcorr_state_t* s, unsigned format, unsigned flags, unsigned tau_samples)
+{
+    switch (format) {
+    case IQCORR_CI16: s->func = iqcorr_ci16_c(cpu_vcap_get(), NULL); break;
+    case IQCORR_CF32: s->func = iqcorr_cf32_c(cpu_vcap_get(), NULL); break;
+    default:
+        return -EINVAL;
+    }
+
+    s->format = format;
+    s->flags = flags;
+    s->tau = (tau_samples) ? tau_samples : IQCORR_DEFAULT_TAU;
+
+    iqcorr_reset(s);
+    return 0;
+}
+
+void iqcorr_reset(iqcorr_state_t* s)
+{
+    memset(&s->acc, 0, sizeof(s->acc));
+    s->mi = s->mq = s->mii = s->mqq = s->miq = 0;
+    s->primed = false;
+
+    _iqcorr_set_coeffs(&s->coeffs, 0, 0, 1, 0);
+}
+
+void iqcorr_process(iqcorr_state_t* s, const void* in, void* out, unsigned samples)
+{
+    s->func(&s->coeffs, in, out, samples, &s->acc);
+    iqcorr_update(s);
+}
+
+void iqcorr_update(iqcorr_state_t* s)
+{
+    const iqcorr_moments_t* m = &s->acc;
+    if (m->n == 0)
+        return;
+
+    const double n = m->n;
+    const double w = (s->primed) ? -expm1(-n / s->tau) : 1.0;
+
+    s->mi  += w * (m->si  / n - s->mi);
+    s->mq  += w * (m->sq  / n - s->mq);
+    s->mii += w * (m->sii / n - s->mii);
+    s->mqq += w * (m->sqq / n - s->mqq);
+    s->miq += w * (m->siq / n - s->miq);
+    s->primed = true;
+
+    memset(&s->acc, 0, sizeof(s->acc));
+
+    double a = 1, b = 0, oi = 0, oq = 0;
+
+    if (s->flags & IQCORR_IQ) {
+        const double eps = (s->format == IQCORR_CI16) ? 1.0 : 1e-12;
+        const double vi = s->mii - s->mi * s->mi;
+        const double vq = s->mqq - s->mq * s->mq;
+        const double cv = s->miq - s->mi * s->mq;
+
+        if (vi > eps) {
+            // q'' = q - p * i is orthogonal to i, then scale it to the i power
+            const double p = cv / vi;
+            const double vo = vq - p * cv;
+
+            if (vo > eps) {
+                double g = sqrt(vi / vo);
+                double gp = g * p;
+
+                g = (g > IQCORR_GAIN_MAX) ? IQCORR_GAIN_MAX : (g < IQCORR_GAIN_MIN) ? IQCORR_GAIN_MIN : g;
+                gp = (gp > IQCORR_GAIN_MAX) ? IQCORR_GAIN_MAX : (gp < -IQCORR_GAIN_MAX) ? -IQCORR_GAIN_MAX : gp;
+
+                a = g;
+                b = -gp;
+            }
+        }
+    }
+
+    if (s->flags & IQCORR_DC) {
+        oi = -s->mi;
+        oq = -(a * s->mq + b * s->mi);
+    }
+
+    _iqcorr_set_coeffs(&s->coeffs, oi, oq, a, b);
+}
@@ -0,0 +1,57 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#ifndef IQCORR_H
+#define IQCORR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "conv.h"
+
+/*
+ * Blind DC offset and IQ imbalance correction for streams where the RFIC
+ * correction is bypassed or not available.
+ *
+ * The kernel corrects a block in place with the current coefficients and
+ * accumulates the raw moments of the same block in one pass. iqcorr_update()
+ * then smooths the moments (time constant is set in samples) and recomputes
+ * the coefficients: DC is the running mean, IQ is fixed by Gram-Schmidt
+ * orthogonalization of Q against I followed by Q gain equalization.
+ */
+enum iqcorr_flags {
+    IQCORR_DC = 1,
+    IQCORR_IQ = 2,
+};
+
+enum iqcorr_format {
+    IQCORR_CI16,
+    IQCORR_CF32,
+};
+
+struct iqcorr_state {
+    iqcorr_function_t func;
+    iqcorr_coeffs_t coeffs;
+    iqcorr_moments_t acc;
+
+    // smoothed raw moments
+    double mi, mq, mii, mqq, miq;
+    float tau;
+    unsigned flags;
+    unsigned format;
+    bool primed;
+};
+typedef struct iqcorr_state iqcorr_state_t;
+
+iqcorr_function_t iqcorr_ci16_c(generic_opts_t cpu_cap, const char** sfunc);
+iqcorr_function_t iqcorr_cf32_c(generic_opts_t cpu_cap, const char** sfunc);
+
+int iqcorr_init(iqcorr_state_t* s, unsigned format, unsigned flags, unsigned tau_samples);
+void iqcorr_reset(iqcorr_state_t* s);
+
+// Correct `samples` complex samples from `in` to `out` (may be the same buffer) and update estimates
+void iqcorr_process(iqcorr_state_t* s, const void* in, void* out, unsigned samples);
+
+// Fold accumulated moments into the estimates and recompute coefficients
+void iqcorr_update(iqcorr_state_t* s);
+
+#endif
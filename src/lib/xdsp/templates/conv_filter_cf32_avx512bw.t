@@ -0,0 +1,49 @@
+static
+void TEMPLATE_FUNC_NAME(const float *__restrict data,
+                        const float *__restrict conv,
+                        float *__restrict out,
+                        unsigned count,
+                        unsigned decim_bits,
+                        unsigned flen)
+{
+    unsigned i, n;
+    const __m512i sh0 = _mm512_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7);
+    const __m512i sh1 = _mm512_setr_epi32(8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13, 14, 14, 15, 15);
+
+    for (n = 0; n < count; n += (2 << decim_bits)) {
+        __m512 acc0 = _mm512_setzero_ps();
+        __m512 acc1 = _mm512_setzero_ps();
+
+        for (i = 0; i + 16 <= flen; i += 16) {
+            __m512 c = _mm512_loadu_ps(&conv[i]);                     // cF .. c0
+            __m512 c0 = _mm512_permutexvar_ps(sh0, c);                // c7 c7 .. c0 c0
+            __m512 c1 = _mm512_permutexvar_ps(sh1, c);                // cF cF .. c8 c8
+
+            __m512 d0 = _mm512_loadu_ps(&data[n + 2 * i + 0]);        // q7 i7 .. q0 i0
+            __m512 d1 = _mm512_loadu_ps(&data[n + 2 * i + 16]);       // qF iF .. q8 i8
+
+            acc0 = _mm512_fmadd_ps(d0, c0, acc0);
+            acc1 = _mm512_fmadd_ps(d1, c1, acc1);
+        }
+
+        __m512 acc = _mm512_add_ps(acc0, acc1);
+        __m256 acc_lo = _mm512_castps512_ps256(acc);
+        __m256 acc_hi = _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(acc), 1));
+        __m256 ps8 = _mm256_add_ps(acc_lo, acc_hi);
+        __m128 ps = _mm_add_ps(_mm256_castps256_ps128(ps8), _mm256_extractf128_ps(ps8, 1));
+        __m128 psh = _mm_add_ps(ps, _mm_movehl_ps(ps, ps));
+
+        float accr[4];
+        _mm_storeu_ps(accr, psh);
+
+        for (; i < flen; i++) {
+            accr[0] += data[n + 2 * i + 0] * conv[i];
+            accr[1] += data[n + 2 * i + 1] * conv[i];
+        }
+
+        out[(n >> decim_bits) + 0] = accr[0];
+        out[(n >> decim_bits) + 1] = accr[1];
+    }
+}
+
+#undef TEMPLATE_FUNC_NAME
@@ -0,0 +1,21 @@
+static
+void TEMPLATE_FUNC_NAME(const float *__restrict data,
+                        const float *__restrict conv,
+                        float *__restrict out,
+                        unsigned count,
+                        unsigned decim_bits,
+                        unsigned flen)
+{
+    unsigned i, n;
+    for (n = 0; n < count; n += (2 << decim_bits)) {
+        float acc[2] = {0, 0};
+        for (i = 0; i < flen; i++) {
+            acc[0] += data[n + 2 * i + 0] * conv[i];
+            acc[1] += data[n + 2 * i + 1] * conv[i];
+        }
+        out[(n >> decim_bits) + 0] = acc[0];
+        out[(n >> decim_bits) + 1] = acc[1];
+    }
+}
+
+#undef TEMPLATE_FUNC_NAME
@@ -0,0 +1,42 @@
+static
+void TEMPLATE_FUNC_NAME(const float *__restrict data,
+                        const float *__restrict conv,
+                        float *__restrict out,
+                        unsigned count,
+                        unsigned decim_bits,
+                        unsigned flen)
+{
+    unsigned i, n;
+    for (n = 0; n < count; n += (2 << decim_bits)) {
+        float32x4_t acc_i0 = vdupq_n_f32(0);
+        float32x4_t acc_q0 = vdupq_n_f32(0);
+        float32x4_t acc_i1 = vdupq_n_f32(0);
+        float32x4_t acc_q1 = vdupq_n_f32(0);
+
+        for (i = 0; i + 8 <= flen; i += 8) {
+            float32x4_t c0 = vld1q_f32(&conv[i + 0]);
+            float32x4_t c1 = vld1q_f32(&conv[i + 4]);
+
+            float32x4x2_t d0 = vld2q_f32(&data[n + 2 * i + 0]);       // i3 i2 i1 i0 . q3 q2 q1 q0
+            float32x4x2_t d1 = vld2q_f32(&data[n + 2 * i + 8]);       // i7 i6 i5 i4 . q7 q6 q5 q4
+
+            acc_i0 = vfmaq_f32(acc_i0, d0.val[0], c0);
+            acc_q0 = vfmaq_f32(acc_q0, d0.val[1], c0);
+            acc_i1 = vfmaq_f32(acc_i1, d1.val[0], c1);
+            acc_q1 = vfmaq_f32(acc_q1, d1.val[1], c1);
+        }
+
+        float acc[2] = { vaddvq_f32(vaddq_f32(acc_i0, acc_i1)),
+                         vaddvq_f32(vaddq_f32(acc_q0, acc_q1)) };
+
+        for (; i < flen; i++) {
+            acc[0] += data[n + 2 * i + 0] * conv[i];
+            acc[1] += data[n + 2 * i + 1] * conv[i];
+        }
+
+        out[(n >> decim_bits) + 0] = acc[0];
+        out[(n >> decim_bits) + 1] = acc[1];
+    }
+}
+
+#undef TEMPLATE_FUNC_NAME
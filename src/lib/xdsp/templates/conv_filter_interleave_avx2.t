@@ -36,7 +36,7 @@ void TEMPLATE_FUNC_NAME(const int16_t *__restrict data,
         __m256i pshm = _mm256_add_epi32(psh, pshi);                              //     qsN1 isN1 . qsN0 isN0
         __m256i pshl = _mm256_unpackhi_epi64(pshm, pshm);
         __m256i pshk = _mm256_add_epi32(pshl, pshm);
-        __m256i pshnorm = _mm256_srli_epi32(pshk, 13);                           //     x x . x x . x q . x i
+        __m256i pshnorm = _mm256_srli_epi32(pshk, 15);                           //     x x . x x . x q . x i
 
         out[(n >> decim_bits) + 0] = _mm256_extract_epi16(pshnorm, 0);
         out[(n >> decim_bits) + 1] = _mm256_extract_epi16(pshnorm, 2);
@@ -0,0 +1,31 @@
+static
+void TEMPLATE_FUNC_NAME(const int16_t *__restrict data,
+                        const int16_t *__restrict conv,
+                        int16_t *__restrict out,
+                        unsigned count,
+                        unsigned decim_bits,
+                        unsigned flen)
+{
+    unsigned i, n;
+    for (n = 0; n < count; n += (2 << decim_bits)) {
+        int32x4_t acc_i0 = vdupq_n_s32(0);
+        int32x4_t acc_i1 = vdupq_n_s32(0);
+        int32x4_t acc_q0 = vdupq_n_s32(0);
+        int32x4_t acc_q1 = vdupq_n_s32(0);
+
+        for (i = 0; i < flen; i += 8) {
+            int16x8_t c = vld1q_s16(&conv[i]);
+            int16x8x2_t d = vld2q_s16(&data[n + 2 * i]);   // i7 .. i0 . q7 .. q0
+
+            acc_i0 = vmlal_s16(acc_i0, vget_low_s16(d.val[0]), vget_low_s16(c));
+            acc_i1 = vmlal_high_s16(acc_i1, d.val[0], c);
+            acc_q0 = vmlal_s16(acc_q0, vget_low_s16(d.val[1]), vget_low_s16(c));
+            acc_q1 = vmlal_high_s16(acc_q1, d.val[1], c);
+        }
+
+        out[(n >> decim_bits) + 0] = vaddvq_s32(vaddq_s32(acc_i0, acc_i1)) >> 15;
+        out[(n >> decim_bits) + 1] = vaddvq_s32(vaddq_s32(acc_q0, acc_q1)) >> 15;
+    }
+}
+
+#undef TEMPLATE_FUNC_NAME
@@ -0,0 +1,49 @@
+static
+void TEMPLATE_FUNC_NAME(const float *__restrict data,
+                        const float *__restrict conv,
+                        float *__restrict out,
+                        unsigned count,
+                        unsigned interp,
+                        unsigned flen)
+{
+    unsigned i, n, z;
+    const __m256i sh0 = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+    const __m256i sh1 = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+
+    for (n = 0; n < count; n += 2) {
+        for (z = 0; z < interp; z++) {
+            const float* pconv = conv + z * flen;
+            __m256 acc0 = _mm256_setzero_ps();
+            __m256 acc1 = _mm256_setzero_ps();
+
+            for (i = 0; i + 8 <= flen; i += 8) {
+                __m256 c = _mm256_loadu_ps(&pconv[i]);
+                __m256 c0 = _mm256_permutevar8x32_ps(c, sh0);
+                __m256 c1 = _mm256_permutevar8x32_ps(c, sh1);
+
+                __m256 d0 = _mm256_loadu_ps(&data[n + 2 * i + 0]);
+                __m256 d1 = _mm256_loadu_ps(&data[n + 2 * i + 8]);
+
+                acc0 = _mm256_fmadd_ps(d0, c0, acc0);
+                acc1 = _mm256_fmadd_ps(d1, c1, acc1);
+            }
+
+            __m256 acc = _mm256_add_ps(acc0, acc1);
+            __m128 ps = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+            __m128 psh = _mm_add_ps(ps, _mm_movehl_ps(ps, ps));
+
+            float accr[4];
+            _mm_storeu_ps(accr, psh);
+
+            for (; i < flen; i++) {
+                accr[0] += data[n + 2 * i + 0] * pconv[i];
+                accr[1] += data[n + 2 * i + 1] * pconv[i];
+            }
+
+            out[interp * n + 2 * z + 0] = accr[0];
+            out[interp * n + 2 * z + 1] = accr[1];
+        }
+    }
+}
+
+#undef TEMPLATE_FUNC_NAME
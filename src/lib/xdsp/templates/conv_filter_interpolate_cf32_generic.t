@@ -0,0 +1,23 @@
+static
+void TEMPLATE_FUNC_NAME(const float *__restrict data,
+                        const float *__restrict conv,
+                        float *__restrict out,
+                        unsigned count,
+                        unsigned interp,
+                        unsigned flen)
+{
+    unsigned i, n, z;
+    for (n = 0; n < count; n += 2) {
+        for (z = 0; z < interp; z++) {
+            float acc[2] = {0, 0};
+            for (i = 0; i < flen; i++) {
+                acc[0] += data[n + 2 * i + 0] * conv[i + z * flen];
+                acc[1] += data[n + 2 * i + 1] * conv[i + z * flen];
+            }
+            out[interp * n + 2 * z + 0] = acc[0];
+            out[interp * n + 2 * z + 1] = acc[1];
+        }
+    }
+}
+
+#undef TEMPLATE_FUNC_NAME
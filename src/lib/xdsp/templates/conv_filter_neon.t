@@ -0,0 +1,26 @@
+static
+void TEMPLATE_FUNC_NAME(const int16_t *__restrict data,
+                        const int16_t *__restrict conv,
+                        int16_t *__restrict out,
+                        unsigned count,
+                        unsigned decim_bits,
+                        unsigned flen)
+{
+    unsigned i, n;
+    for (n = 0; n < count; n += (1 << decim_bits)) {
+        int32x4_t acc0 = vdupq_n_s32(0);
+        int32x4_t acc1 = vdupq_n_s32(0);
+
+        for (i = 0; i < flen; i += 8) {
+            int16x8_t c = vld1q_s16(&conv[i]);
+            int16x8_t d = vld1q_s16(&data[n + i]);
+
+            acc0 = vmlal_s16(acc0, vget_low_s16(d), vget_low_s16(c));
+            acc1 = vmlal_high_s16(acc1, d, c);
+        }
+
+        out[(n >> decim_bits)] = vaddvq_s32(vaddq_s32(acc0, acc1)) >> 15;
+    }
+}
+
+#undef TEMPLATE_FUNC_NAME
@@ -0,0 +1,23 @@
+static
+void TEMPLATE_FUNC_NAME(wvlt_fftwf_complex* __restrict in, unsigned fftsz, float* __restrict wnd,
+                        wvlt_fftwf_complex* __restrict out)
+{
+    for(unsigned i = 0; i < fftsz; i += 8)
+    {
+        float32x4x2_t e0 = vld2q_f32(&in[i + 0][0]);
+        float32x4x2_t e1 = vld2q_f32(&in[i + 4][0]);
+
+        float32x4_t w0 = vld1q_f32(&wnd[i + 0]);
+        float32x4_t w1 = vld1q_f32(&wnd[i + 4]);
+
+        e0.val[0] = vmulq_f32(e0.val[0], w0);
+        e0.val[1] = vmulq_f32(e0.val[1], w0);
+        e1.val[0] = vmulq_f32(e1.val[0], w1);
+        e1.val[1] = vmulq_f32(e1.val[1], w1);
+
+        vst2q_f32(&out[i + 0][0], e0);
+        vst2q_f32(&out[i + 4][0], e1);
+    }
+}
+
+#undef TEMPLATE_FUNC_NAME
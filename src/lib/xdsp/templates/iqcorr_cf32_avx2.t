@@ -0,0 +1,83 @@
+static
+void TEMPLATE_FUNC_NAME(const iqcorr_coeffs_t *__restrict c,
+                        const void *in,
+                        void *out,
+                        unsigned samples,
+                        iqcorr_moments_t *__restrict m)
+{
+    const float* pin = (const float*)in;
+    float* pout = (float*)out;
+
+    const float oi = c->oi;
+    const float oq = c->oq;
+    const float a = c->a;
+    const float b = c->b;
+
+    double si = 0, sq = 0, sii = 0, sqq = 0, siq = 0;
+    unsigned k = 0;
+
+    if (samples >= 4) {
+        // even lanes keep i' = i + oi, odd lanes get q' = a * q + b * i + oq
+        const __m256 va = _mm256_setr_ps(1.f, a, 1.f, a, 1.f, a, 1.f, a);
+        const __m256 vb = _mm256_setr_ps(0.f, b, 0.f, b, 0.f, b, 0.f, b);
+        const __m256 vo = _mm256_setr_ps(oi, oq, oi, oq, oi, oq, oi, oq);
+
+        while (k + 4 <= samples) {
+            // fold float partial sums into double every 1024 samples
+            unsigned blk = (samples - k) & ~3u;
+            if (blk > 1024)
+                blk = 1024;
+
+            __m256 as  = _mm256_setzero_ps();
+            __m256 ass = _mm256_setzero_ps();
+            __m256 ax  = _mm256_setzero_ps();
+
+            for (const unsigned e = k + blk; k < e; k += 4) {
+                __m256 v  = _mm256_loadu_ps(pin + 2 * k);
+                __m256 vi = _mm256_moveldup_ps(v);
+                __m256 sw = _mm256_permute_ps(v, 0xb1);
+
+                as  = _mm256_add_ps(as, v);
+                ass = _mm256_add_ps(ass, _mm256_mul_ps(v, v));
+                ax  = _mm256_add_ps(ax, _mm256_mul_ps(v, sw));
+
+                __m256 o = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(v, va), _mm256_mul_ps(vi, vb)), vo);
+                _mm256_storeu_ps(pout + 2 * k, o);
+            }
+
+            float ts[8], tss[8], tx[8];
+            _mm256_storeu_ps(ts, as);
+            _mm256_storeu_ps(tss, ass);
+            _mm256_storeu_ps(tx, ax);
+
+            si  += (double)ts[0]  + ts[2]  + ts[4]  + ts[6];
+            sq  += (double)ts[1]  + ts[3]  + ts[5]  + ts[7];
+            sii += (double)tss[0] + tss[2] + tss[4] + tss[6];
+            sqq += (double)tss[1] + tss[3] + tss[5] + tss[7];
+            siq += (double)tx[0]  + tx[2]  + tx[4]  + tx[6];
+        }
+    }
+
+    for (; k < samples; k++) {
+        const float i = pin[2 * k + 0];
+        const float q = pin[2 * k + 1];
+
+        si  += i;
+        sq  += q;
+        sii += i * i;
+        sqq += q * q;
+        siq += i * q;
+
+        pout[2 * k + 0] = i + oi;
+        pout[2 * k + 1] = a * q + b * i + oq;
+    }
+
+    m->si  += si;
+    m->sq  += sq;
+    m->sii += sii;
+    m->sqq += sqq;
+    m->siq += siq;
+    m->n   += samples;
+}
+
+#undef TEMPLATE_FUNC_NAME
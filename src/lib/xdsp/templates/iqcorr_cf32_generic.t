@@ -0,0 +1,40 @@
+static
+void TEMPLATE_FUNC_NAME(const iqcorr_coeffs_t *__restrict c,
+                        const void *in,
+                        void *out,
+                        unsigned samples,
+                        iqcorr_moments_t *__restrict m)
+{
+    const float* pin = (const float*)in;
+    float* pout = (float*)out;
+
+    const float oi = c->oi;
+    const float oq = c->oq;
+    const float a = c->a;
+    const float b = c->b;
+
+    double si = 0, sq = 0, sii = 0, sqq = 0, siq = 0;
+
+    for (unsigned k = 0; k < samples; k++) {
+        const float i = pin[2 * k + 0];
+        const float q = pin[2 * k + 1];
+
+        si  += i;
+        sq  += q;
+        sii += i * i;
+        sqq += q * q;
+        siq += i * q;
+
+        pout[2 * k + 0] = i + oi;
+        pout[2 * k + 1] = a * q + b * i + oq;
+    }
+
+    m->si  += si;
+    m->sq  += sq;
+    m->sii += sii;
+    m->sqq += sqq;
+    m->siq += siq;
+    m->n   += samples;
+}
+
+#undef TEMPLATE_FUNC_NAME
@@ -0,0 +1,80 @@
+static
+void TEMPLATE_FUNC_NAME(const iqcorr_coeffs_t *__restrict c,
+                        const void *in,
+                        void *out,
+                        unsigned samples,
+                        iqcorr_moments_t *__restrict m)
+{
+    const float* pin = (const float*)in;
+    float* pout = (float*)out;
+
+    const float oi = c->oi;
+    const float oq = c->oq;
+    const float a = c->a;
+    const float b = c->b;
+
+    double si = 0, sq = 0, sii = 0, sqq = 0, siq = 0;
+    unsigned k = 0;
+
+    if (samples >= 4) {
+        const float32x4_t voi = vdupq_n_f32(oi);
+        const float32x4_t voq = vdupq_n_f32(oq);
+
+        while (k + 4 <= samples) {
+            // fold float partial sums into double every 1024 samples
+            unsigned blk = (samples - k) & ~3u;
+            if (blk > 1024)
+                blk = 1024;
+
+            float32x4_t asi = vdupq_n_f32(0);
+            float32x4_t asq = vdupq_n_f32(0);
+            float32x4_t aii = vdupq_n_f32(0);
+            float32x4_t aqq = vdupq_n_f32(0);
+            float32x4_t aiq = vdupq_n_f32(0);
+
+            for (const unsigned e = k + blk; k < e; k += 4) {
+                float32x4x2_t v = vld2q_f32(pin + 2 * k);
+
+                asi = vaddq_f32(asi, v.val[0]);
+                asq = vaddq_f32(asq, v.val[1]);
+                aii = vaddq_f32(aii, vmulq_f32(v.val[0], v.val[0]));
+                aqq = vaddq_f32(aqq, vmulq_f32(v.val[1], v.val[1]));
+                aiq = vaddq_f32(aiq, vmulq_f32(v.val[0], v.val[1]));
+
+                float32x4x2_t o;
+                o.val[0] = vaddq_f32(v.val[0], voi);
+                o.val[1] = vaddq_f32(vaddq_f32(vmulq_n_f32(v.val[1], a), vmulq_n_f32(v.val[0], b)), voq);
+                vst2q_f32(pout + 2 * k, o);
+            }
+
+            si  += vaddvq_f32(asi);
+            sq  += vaddvq_f32(asq);
+            sii += vaddvq_f32(aii);
+            sqq += vaddvq_f32(aqq);
+            siq += vaddvq_f32(aiq);
+        }
+    }
+
+    for (; k < samples; k++) {
+        const float i = pin[2 * k + 0];
+        const float q = pin[2 * k + 1];
+
+        si  += i;
+        sq  += q;
+        sii += i * i;
+        sqq += q * q;
+        siq += i * q;
+
+        pout[2 * k + 0] = i + oi;
+        pout[2 * k + 1] = a * q + b * i + oq;
+    }
+
+    m->si  += si;
+    m->sq  += sq;
+    m->sii += sii;
+    m->sqq += sqq;
+    m->siq += siq;
+    m->n   += samples;
+}
+
+#undef TEMPLATE_FUNC_NAME
@@ -0,0 +1,112 @@
+static
+void TEMPLATE_FUNC_NAME(const iqcorr_coeffs_t *__restrict c,
+                        const void *in,
+                        void *out,
+                        unsigned samples,
+                        iqcorr_moments_t *__restrict m)
+{
+    const int16_t* pin = (const int16_t*)in;
+    int16_t* pout = (int16_t*)out;
+
+    const int32_t oi = c->oi_i16;
+    const int32_t oq = c->oq_i16;
+    const int32_t a = c->a_q14;
+    const int32_t b = c->b_q14;
+
+    int64_t si = 0, sq = 0, sii = 0, sqq = 0, siq = 0;
+    unsigned k = 0;
+
+    if (samples >= 8) {
+        const __m256i m16lo = _mm256_set1_epi32(0x0000ffff);
+        const __m256i m32lo = _mm256_set1_epi64x(0xffffffff);
+        // (b, a) multiplies (i, q) in madd
+        const __m256i vab   = _mm256_set1_epi32((int32_t)(((uint32_t)(uint16_t)a << 16) | (uint16_t)b));
+        const __m256i vrnd  = _mm256_set1_epi32(8192);
+        const __m256i voi   = _mm256_set1_epi32(oi);
+        const __m256i voq   = _mm256_set1_epi32(oq);
+        // i*q lies in (-2^30..2^30], the bias keeps it unsigned for the 64 bit fold
+        const __m256i vbias = _mm256_set1_epi32(1 << 30);
+        // packs_epi32(i', q') -> (i0' q0' i1' q1' ...) in each lane
+        const __m256i ilv   = _mm256_setr_epi8(0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15,
+                                               0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15);
+
+        __m256i aii = _mm256_setzero_si256();
+        __m256i aqq = _mm256_setzero_si256();
+        __m256i aiq = _mm256_setzero_si256();
+        uint64_t nbias = 0;
+
+        while (k + 8 <= samples) {
+            // 32 bit i/q sums are safe for 2^15 iterations
+            unsigned blk = (samples - k) & ~7u;
+            if (blk > 8 * 32768)
+                blk = 8 * 32768;
+
+            __m256i asi = _mm256_setzero_si256();
+            __m256i asq = _mm256_setzero_si256();
+
+            for (const unsigned e = k + blk; k < e; k += 8) {
+                __m256i v  = _mm256_loadu_si256((const __m256i*)(pin + 2 * k));
+                __m256i vi = _mm256_srai_epi32(_mm256_slli_epi32(v, 16), 16);
+                __m256i vq = _mm256_srai_epi32(v, 16);
+                __m256i il = _mm256_and_si256(v, m16lo);
+                __m256i ql = _mm256_andnot_si256(m16lo, v);
+                __m256i sw = _mm256_or_si256(_mm256_slli_epi32(v, 16), _mm256_srli_epi32(v, 16));
+
+                __m256i ii = _mm256_madd_epi16(il, v);
+                __m256i qq = _mm256_madd_epi16(ql, v);
+                __m256i iq = _mm256_add_epi32(_mm256_madd_epi16(il, sw), vbias);
+
+                asi = _mm256_add_epi32(asi, vi);
+                asq = _mm256_add_epi32(asq, vq);
+                aii = _mm256_add_epi64(aii, _mm256_add_epi64(_mm256_and_si256(ii, m32lo), _mm256_srli_epi64(ii, 32)));
+                aqq = _mm256_add_epi64(aqq, _mm256_add_epi64(_mm256_and_si256(qq, m32lo), _mm256_srli_epi64(qq, 32)));
+                aiq = _mm256_add_epi64(aiq, _mm256_add_epi64(_mm256_and_si256(iq, m32lo), _mm256_srli_epi64(iq, 32)));
+
+                __m256i ci = _mm256_add_epi32(vi, voi);
+                __m256i cq = _mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(v, vab), vrnd), 14), voq);
+                __m256i o  = _mm256_shuffle_epi8(_mm256_packs_epi32(ci, cq), ilv);
+
+                _mm256_storeu_si256((__m256i*)(pout + 2 * k), o);
+            }
+
+            __m256i s64 = _mm256_add_epi64(_mm256_cvtepi32_epi64(_mm256_castsi256_si128(asi)),
+                                           _mm256_cvtepi32_epi64(_mm256_extracti128_si256(asi, 1)));
+            __m256i q64 = _mm256_add_epi64(_mm256_cvtepi32_epi64(_mm256_castsi256_si128(asq)),
+                                           _mm256_cvtepi32_epi64(_mm256_extracti128_si256(asq, 1)));
+            si += _mm256_extract_epi64(s64, 0) + _mm256_extract_epi64(s64, 1) + _mm256_extract_epi64(s64, 2) + _mm256_extract_epi64(s64, 3);
+            sq += _mm256_extract_epi64(q64, 0) + _mm256_extract_epi64(q64, 1) + _mm256_extract_epi64(q64, 2) + _mm256_extract_epi64(q64, 3);
+            nbias += blk;
+        }
+
+        sii = _mm256_extract_epi64(aii, 0) + _mm256_extract_epi64(aii, 1) + _mm256_extract_epi64(aii, 2) + _mm256_extract_epi64(aii, 3);
+        sqq = _mm256_extract_epi64(aqq, 0) + _mm256_extract_epi64(aqq, 1) + _mm256_extract_epi64(aqq, 2) + _mm256_extract_epi64(aqq, 3);
+        siq = _mm256_extract_epi64(aiq, 0) + _mm256_extract_epi64(aiq, 1) + _mm256_extract_epi64(aiq, 2) + _mm256_extract_epi64(aiq, 3);
+        siq -= (int64_t)(nbias << 30);
+    }
+
+    for (; k < samples; k++) {
+        const int32_t i = pin[2 * k + 0];
+        const int32_t q = pin[2 * k + 1];
+
+        si  += i;
+        sq  += q;
+        sii += i * i;
+        sqq += q * q;
+        siq += i * q;
+
+        int32_t ci = i + oi;
+        int32_t cq = ((a * q + b * i + 8192) >> 14) + oq;
+
+        pout[2 * k + 0] = (ci > INT16_MAX) ? INT16_MAX : (ci < INT16_MIN) ? INT16_MIN : ci;
+        pout[2 * k + 1] = (cq > INT16_MAX) ? INT16_MAX : (cq < INT16_MIN) ? INT16_MIN : cq;
+    }
+
+    m->si  += si;
+    m->sq  += sq;
+    m->sii += sii;
+    m->sqq += sqq;
+    m->siq += siq;
+    m->n   += samples;
+}
+
+#undef TEMPLATE_FUNC_NAME
@@ -0,0 +1,43 @@
+static
+void TEMPLATE_FUNC_NAME(const iqcorr_coeffs_t *__restrict c,
+                        const void *in,
+                        void *out,
+                        unsigned samples,
+                        iqcorr_moments_t *__restrict m)
+{
+    const int16_t* pin = (const int16_t*)in;
+    int16_t* pout = (int16_t*)out;
+
+    const int32_t oi = c->oi_i16;
+    const int32_t oq = c->oq_i16;
+    const int32_t a = c->a_q14;
+    const int32_t b = c->b_q14;
+
+    int64_t si = 0, sq = 0, sii = 0, sqq = 0, siq = 0;
+
+    for (unsigned k = 0; k < samples; k++) {
+        const int32_t i = pin[2 * k + 0];
+        const int32_t q = pin[2 * k + 1];
+
+        si  += i;
+        sq  += q;
+        sii += i * i;
+        sqq += q * q;
+        siq += i * q;
+
+        int32_t ci = i + oi;
+        int32_t cq = ((a * q + b * i + 8192) >> 14) + oq;
+
+        pout[2 * k + 0] = (ci > INT16_MAX) ? INT16_MAX : (ci < INT16_MIN) ? INT16_MIN : ci;
+        pout[2 * k + 1] = (cq > INT16_MAX) ? INT16_MAX : (cq < INT16_MIN) ? INT16_MIN : cq;
+    }
+
+    m->si  += si;
+    m->sq  += sq;
+    m->sii += sii;
+    m->sqq += sqq;
+    m->siq += siq;
+    m->n   += samples;
+}
+
+#undef TEMPLATE_FUNC_NAME
@@ -0,0 +1,95 @@
+static
+void TEMPLATE_FUNC_NAME(const iqcorr_coeffs_t *__restrict c,
+                        const void *in,
+                        void *out,
+                        unsigned samples,
+                        iqcorr_moments_t *__restrict m)
+{
+    const int16_t* pin = (const int16_t*)in;
+    int16_t* pout = (int16_t*)out;
+
+    const int32_t oi = c->oi_i16;
+    const int32_t oq = c->oq_i16;
+    const int32_t a = c->a_q14;
+    const int32_t b = c->b_q14;
+
+    int64_t si = 0, sq = 0, sii = 0, sqq = 0, siq = 0;
+    unsigned k = 0;
+
+    if (samples >= 8) {
+        const int16x8_t voi = vdupq_n_s16(oi);
+        const int32x4_t voq = vdupq_n_s32(oq);
+
+        int64x2_t aii = vdupq_n_s64(0);
+        int64x2_t aqq = vdupq_n_s64(0);
+        int64x2_t aiq = vdupq_n_s64(0);
+
+        while (k + 8 <= samples) {
+            // 32 bit i/q sums are safe for 2^15 iterations
+            unsigned blk = (samples - k) & ~7u;
+            if (blk > 8 * 32768)
+                blk = 8 * 32768;
+
+            int32x4_t asi = vdupq_n_s32(0);
+            int32x4_t asq = vdupq_n_s32(0);
+
+            for (const unsigned e = k + blk; k < e; k += 8) {
+                int16x8x2_t v = vld2q_s16(pin + 2 * k);
+                int16x4_t il = vget_low_s16(v.val[0]);
+                int16x4_t ql = vget_low_s16(v.val[1]);
+
+                asi = vpadalq_s16(asi, v.val[0]);
+                asq = vpadalq_s16(asq, v.val[1]);
+                aii = vpadalq_s32(aii, vmull_s16(il, il));
+                aii = vpadalq_s32(aii, vmull_high_s16(v.val[0], v.val[0]));
+                aqq = vpadalq_s32(aqq, vmull_s16(ql, ql));
+                aqq = vpadalq_s32(aqq, vmull_high_s16(v.val[1], v.val[1]));
+                aiq = vpadalq_s32(aiq, vmull_s16(il, ql));
+                aiq = vpadalq_s32(aiq, vmull_high_s16(v.val[0], v.val[1]));
+
+                int32x4_t cql = vmlal_n_s16(vmull_n_s16(ql, a), il, b);
+                int32x4_t cqh = vmlal_high_n_s16(vmull_high_n_s16(v.val[1], a), v.val[0], b);
+                cql = vaddq_s32(vrshrq_n_s32(cql, 14), voq);
+                cqh = vaddq_s32(vrshrq_n_s32(cqh, 14), voq);
+
+                int16x8x2_t o;
+                o.val[0] = vqaddq_s16(v.val[0], voi);
+                o.val[1] = vqmovn_high_s32(vqmovn_s32(cql), cqh);
+                vst2q_s16(pout + 2 * k, o);
+            }
+
+            si += vaddlvq_s32(asi);
+            sq += vaddlvq_s32(asq);
+        }
+
+        sii = vaddvq_s64(aii);
+        sqq = vaddvq_s64(aqq);
+        siq = vaddvq_s64(aiq);
+    }
+
+    for (; k < samples; k++) {
+        const int32_t i = pin[2 * k + 0];
+        const int32_t q = pin[2 * k + 1];
+
+        si  += i;
+        sq  += q;
+        sii += i * i;
+        sqq += q * q;
+        siq += i * q;
+
+        int32_t ci = i + oi;
+        int32_t cq = ((a * q + b * i + 8192) >> 14) + oq;
+
+        pout[2 * k + 0] = (ci > INT16_MAX) ? INT16_MAX : (ci < INT16_MIN) ? INT16_MIN : ci;
+        pout[2 * k + 1] = (cq > INT16_MAX) ? INT16_MAX : (cq < INT16_MIN) ? INT16_MIN : cq;
+    }
+
+    m->si  += si;
+    m->sq  += sq;
+    m->sii += sii;
+    m->sqq += sqq;
+    m->siq += siq;
+    m->n   += samples;
+}
+
+#undef TEMPLATE_FUNC_NAME
@@ -0,0 +1,96 @@
+static
+int TEMPLATE_FUNC_NAME(quadfm_decode_state_t *__restrict state,
+                       const int16_t *__restrict piq,
+                       unsigned samples,
+                       int16_t *__restrict out,
+                       int32_t *__restrict omaxp,
+                       int64_t *__restrict opwr)
+{
+    unsigned i = 0;
+    int64_t tpwr = 0;
+    int32_t maxp = 0;
+    int16_t iq_prev[2] = { state->iq_prev[0], state->iq_prev[1] };
+    const float d_mp = state->d_mp;
+
+    if (samples >= 8) {
+        const __m256i rot = _mm256_setr_epi32(7, 0, 1, 2, 3, 4, 5, 6);
+        const __m256i swp = _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                                             2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+        const __m256 vmp = _mm256_set1_ps(d_mp);
+
+        __m256i vmaxp = _mm256_setzero_si256();
+        __m256i vpwr0 = _mm256_setzero_si256();
+        __m256i vpwr1 = _mm256_setzero_si256();
+
+        // lane 0 holds the previous IQ pair for the next block
+        __m256i carry = _mm256_set1_epi32((int32_t)(((uint32_t)(uint16_t)iq_prev[1] << 16) | (uint16_t)iq_prev[0]));
+
+        for (; i + 8 <= samples; i += 8) {
+            __m256i cur = _mm256_loadu_si256((const __m256i*)(piq + 2 * i));
+            __m256i rcur = _mm256_permutevar8x32_epi32(cur, rot);
+            __m256i prev = _mm256_blend_epi32(rcur, carry, 0x01);
+            carry = rcur;
+
+            // (-q', i') for the cross term, saturation only affects q' == -32768
+            __m256i sprev = _mm256_shuffle_epi8(prev, swp);
+            __m256i nprev = _mm256_blend_epi16(sprev, _mm256_subs_epi16(_mm256_setzero_si256(), sprev), 0x55);
+
+            __m256i pwr = _mm256_madd_epi16(cur, cur);
+            __m256i ld0 = _mm256_madd_epi16(cur, prev);
+            __m256i ld1 = _mm256_madd_epi16(cur, nprev);
+
+            vmaxp = _mm256_max_epi32(vmaxp, pwr);
+            vpwr0 = _mm256_add_epi64(vpwr0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(pwr)));
+            vpwr1 = _mm256_add_epi64(vpwr1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(pwr, 1)));
+
+            __m256 fy = _mm256_cvtepi32_ps(ld1);
+            __m256 fx = _mm256_cvtepi32_ps(ld0);
+            __m256 fo;
+            WVLT_ATAN2F8(fy, fx, fo);
+
+            __m256i o = _mm256_cvttps_epi32(_mm256_mul_ps(fo, vmp));
+            __m128i o16 = _mm_packs_epi32(_mm256_castsi256_si128(o), _mm256_extracti128_si256(o, 1));
+            _mm_storeu_si128((__m128i*)(out + i), o16);
+        }
+
+        int32_t amaxp[8];
+        int64_t apwr[4];
+        _mm256_storeu_si256((__m256i*)amaxp, vmaxp);
+        _mm256_storeu_si256((__m256i*)apwr, _mm256_add_epi64(vpwr0, vpwr1));
+
+        for (unsigned k = 0; k < 8; k++) {
+            if (maxp < amaxp[k])
+                maxp = amaxp[k];
+        }
+        tpwr = apwr[0] + apwr[1] + apwr[2] + apwr[3];
+
+        iq_prev[0] = piq[2 * i - 2];
+        iq_prev[1] = piq[2 * i - 1];
+    }
+
+    for (; i < samples; i++) {
+        int16_t iq[2] = { piq[2 * i], piq[2 * i + 1] };
+        int32_t pwr = iq[0] * iq[0] + iq[1] * iq[1];
+
+        tpwr += pwr;
+        if (maxp < pwr)
+            maxp = pwr;
+
+        int32_t ld0 = (int32_t)iq[0] * (int32_t)iq_prev[0] + (int32_t)iq[1] * (int32_t)iq_prev[1];
+        int32_t ld1 = (int32_t)iq[1] * (int32_t)iq_prev[0] - (int32_t)iq[0] * (int32_t)iq_prev[1];
+
+        out[i] = (int16_t)(wvlt_atan2f(ld1, ld0) * d_mp);
+
+        iq_prev[0] = iq[0];
+        iq_prev[1] = iq[1];
+    }
+
+    state->iq_prev[0] = iq_prev[0];
+    state->iq_prev[1] = iq_prev[1];
+
+    *omaxp = maxp;
+    *opwr = tpwr;
+    return 0;
+}
+
+#undef TEMPLATE_FUNC_NAME
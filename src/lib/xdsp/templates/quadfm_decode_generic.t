@@ -0,0 +1,51 @@
+static
+int TEMPLATE_FUNC_NAME(quadfm_decode_state_t *__restrict state,
+                       const int16_t *__restrict piq,
+                       unsigned samples,
+                       int16_t *__restrict out,
+                       int32_t *__restrict omaxp,
+                       int64_t *__restrict opwr)
+{
+    unsigned i;
+    int64_t tpwr = 0;
+
+    int16_t iq_prev[2] = { state->iq_prev[0], state->iq_prev[1] };
+    int32_t pwr;
+    int32_t maxp = 0;
+    int16_t iq[2];
+    int32_t ld[2];
+
+    int16_t o;
+
+    for (i = 0; i < samples; i++ ) {
+        iq[0] = piq[2 * i];
+        iq[1] = piq[2 * i + 1];
+
+        // Calc PWR
+        pwr = iq[0] * iq[0] + iq[1] * iq[1];
+
+        tpwr += pwr;
+        if (maxp < pwr)
+            maxp = pwr;
+
+        // Calc differential of x(0) and x*(-1)
+        ld[0] = (int32_t)iq[0] * (int32_t)iq_prev[0] + (int32_t)iq[1] * (int32_t)iq_prev[1];
+        ld[1] = (int32_t)iq[1] * (int32_t)iq_prev[0] - (int32_t)iq[0] * (int32_t)iq_prev[1];
+
+        // decode & multiply
+        o = (int16_t)(atan2f(ld[1], ld[0]) * state->d_mp);
+
+        iq_prev[0] = iq[0];
+        iq_prev[1] = iq[1];
+        out[i] = o;
+    }
+
+    state->iq_prev[0] = iq_prev[0];
+    state->iq_prev[1] = iq_prev[1];
+
+    *omaxp = maxp;
+    *opwr = tpwr;
+    return 0;
+}
+
+#undef TEMPLATE_FUNC_NAME
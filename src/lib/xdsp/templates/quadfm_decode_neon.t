@@ -0,0 +1,85 @@
+static
+int TEMPLATE_FUNC_NAME(quadfm_decode_state_t *__restrict state,
+                       const int16_t *__restrict piq,
+                       unsigned samples,
+                       int16_t *__restrict out,
+                       int32_t *__restrict omaxp,
+                       int64_t *__restrict opwr)
+{
+    unsigned i = 0;
+    int64_t tpwr = 0;
+    int32_t maxp = 0;
+    int16_t iq_prev[2] = { state->iq_prev[0], state->iq_prev[1] };
+    const float d_mp = state->d_mp;
+
+    if (samples >= 8) {
+        int32x4_t vmaxp = vdupq_n_s32(0);
+        int64x2_t vpwr = vdupq_n_s64(0);
+
+        // last lane holds the previous IQ pair for the next block
+        int16x8_t ci = vdupq_n_s16(iq_prev[0]);
+        int16x8_t cq = vdupq_n_s16(iq_prev[1]);
+
+        for (; i + 8 <= samples; i += 8) {
+            int16x8x2_t cur = vld2q_s16(piq + 2 * i);
+            int16x8_t pi = vextq_s16(ci, cur.val[0], 7);
+            int16x8_t pq = vextq_s16(cq, cur.val[1], 7);
+            ci = cur.val[0];
+            cq = cur.val[1];
+
+            int32x4_t pwr_l = vmlal_s16(vmull_s16(vget_low_s16(ci), vget_low_s16(ci)), vget_low_s16(cq), vget_low_s16(cq));
+            int32x4_t pwr_h = vmlal_high_s16(vmull_high_s16(ci, ci), cq, cq);
+
+            int32x4_t ld0_l = vmlal_s16(vmull_s16(vget_low_s16(ci), vget_low_s16(pi)), vget_low_s16(cq), vget_low_s16(pq));
+            int32x4_t ld0_h = vmlal_high_s16(vmull_high_s16(ci, pi), cq, pq);
+            int32x4_t ld1_l = vmlsl_s16(vmull_s16(vget_low_s16(cq), vget_low_s16(pi)), vget_low_s16(ci), vget_low_s16(pq));
+            int32x4_t ld1_h = vmlsl_high_s16(vmull_high_s16(cq, pi), ci, pq);
+
+            vmaxp = vmaxq_s32(vmaxp, vmaxq_s32(pwr_l, pwr_h));
+            vpwr = vpadalq_s32(vpwr, pwr_l);
+            vpwr = vpadalq_s32(vpwr, pwr_h);
+
+            float32x4_t fo_l, fo_h;
+            float32x4_t fy_l = vcvtq_f32_s32(ld1_l), fx_l = vcvtq_f32_s32(ld0_l);
+            float32x4_t fy_h = vcvtq_f32_s32(ld1_h), fx_h = vcvtq_f32_s32(ld0_h);
+            WVLT_ATAN2F8(fy_l, fx_l, fo_l);
+            WVLT_ATAN2F8(fy_h, fx_h, fo_h);
+
+            int32x4_t o_l = vcvtq_s32_f32(vmulq_n_f32(fo_l, d_mp));
+            int32x4_t o_h = vcvtq_s32_f32(vmulq_n_f32(fo_h, d_mp));
+            vst1q_s16(out + i, vcombine_s16(vqmovn_s32(o_l), vqmovn_s32(o_h)));
+        }
+
+        maxp = vmaxvq_s32(vmaxp);
+        tpwr = vaddvq_s64(vpwr);
+
+        iq_prev[0] = piq[2 * i - 2];
+        iq_prev[1] = piq[2 * i - 1];
+    }
+
+    for (; i < samples; i++) {
+        int16_t iq[2] = { piq[2 * i], piq[2 * i + 1] };
+        int32_t pwr = iq[0] * iq[0] + iq[1] * iq[1];
+
+        tpwr += pwr;
+        if (maxp < pwr)
+            maxp = pwr;
+
+        int32_t ld0 = (int32_t)iq[0] * (int32_t)iq_prev[0] + (int32_t)iq[1] * (int32_t)iq_prev[1];
+        int32_t ld1 = (int32_t)iq[1] * (int32_t)iq_prev[0] - (int32_t)iq[0] * (int32_t)iq_prev[1];
+
+        out[i] = (int16_t)(wvlt_atan2f(ld1, ld0) * d_mp);
+
+        iq_prev[0] = iq[0];
+        iq_prev[1] = iq[1];
+    }
+
+    state->iq_prev[0] = iq_prev[0];
+    state->iq_prev[1] = iq_prev[1];
+
+    *omaxp = maxp;
+    *opwr = tpwr;
+    return 0;
+}
+
+#undef TEMPLATE_FUNC_NAME
@@ -0,0 +1,63 @@
+static
+float TEMPLATE_FUNC_NAME(unsigned samples,
+                         const int16_t *__restrict audio,
+                         int16_t *__restrict iq,
+                         float gain,
+                         float iangle)
+{
+    unsigned i = 0;
+    const float amp = 0.7f * 32767.0f;
+
+    iangle = wvlt_wrap_phasef(iangle);
+
+    if (samples >= 8) {
+        const __m256 vgain = _mm256_set1_ps(gain);
+        const __m256 vamp = _mm256_set1_ps(amp);
+        const __m256i bcast7 = _mm256_set1_epi32(7);
+        __m256 base = _mm256_set1_ps(iangle);
+
+        for (; i + 8 <= samples; i += 8) {
+            __m128i a16 = _mm_loadu_si128((const __m128i*)(audio + i));
+            __m256 da = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(a16)), vgain);
+
+            // inclusive prefix sum of the phase increments
+            da = _mm256_add_ps(da, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(da), 4)));
+            da = _mm256_add_ps(da, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(da), 8)));
+            da = _mm256_add_ps(da, _mm256_permute2f128_ps(_mm256_shuffle_ps(da, da, 0xff), da, 0x08));
+
+            __m256 ph = _mm256_add_ps(base, da);
+            __m256 fs, fc;
+            WVLT_SINCOSF8(ph, fs, fc);
+
+            // keep phase small to avoid precision loss on long runs
+            base = _mm256_permutevar8x32_ps(ph, bcast7);
+            base = _mm256_sub_ps(base, _mm256_mul_ps(_mm256_set1_ps(WVLT_2PI_F),
+                                                     _mm256_round_ps(_mm256_mul_ps(base, _mm256_set1_ps(WVLT_1_2PI_F)),
+                                                                     _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)));
+
+            __m256i ci = _mm256_cvttps_epi32(_mm256_mul_ps(fc, vamp));
+            __m256i cq = _mm256_cvttps_epi32(_mm256_mul_ps(fs, vamp));
+
+            // in-lane unpack + pack gives i0 q0 .. i7 q7
+            __m256i lo = _mm256_unpacklo_epi32(ci, cq);
+            __m256i hi = _mm256_unpackhi_epi32(ci, cq);
+            _mm256_storeu_si256((__m256i*)(iq + 2 * i), _mm256_packs_epi32(lo, hi));
+        }
+
+        iangle = _mm256_cvtss_f32(base);
+    }
+
+    for (; i < samples; i++) {
+        float fi, fq;
+
+        iangle += audio[i] * gain;
+        wvlt_sincosf(iangle, &fq, &fi);
+
+        iq[2 * i + 0] = (int16_t)(fi * amp);
+        iq[2 * i + 1] = (int16_t)(fq * amp);
+    }
+
+    return wvlt_wrap_phasef(iangle);
+}
+
+#undef TEMPLATE_FUNC_NAME
@@ -0,0 +1,27 @@
+static
+float TEMPLATE_FUNC_NAME(unsigned samples,
+                         const int16_t *__restrict audio,
+                         int16_t *__restrict iq,
+                         float gain,
+                         float iangle)
+{
+    unsigned i;
+    for (i = 0; i < samples; i++ ) {
+        float da = audio[i] * gain;
+        float fi, fq;
+
+        // a growing phase loses float precision, keep it within [-pi, pi]
+        iangle = wvlt_wrap_phasef(iangle + da);
+        sincosf(iangle, &fq, &fi);
+
+        int16_t vi, vq;
+        vi = (int16_t)(fi * 0.7f * 32767.0f);
+        vq = (int16_t)(fq * 0.7f * 32767.0f);
+
+        iq[2 * i + 0] = vi;
+        iq[2 * i + 1] = vq;
+    }
+    return iangle;
+}
+
+#undef TEMPLATE_FUNC_NAME
@@ -0,0 +1,54 @@
+static
+float TEMPLATE_FUNC_NAME(unsigned samples,
+                         const int16_t *__restrict audio,
+                         int16_t *__restrict iq,
+                         float gain,
+                         float iangle)
+{
+    unsigned i = 0;
+    const float amp = 0.7f * 32767.0f;
+
+    iangle = wvlt_wrap_phasef(iangle);
+
+    if (samples >= 4) {
+        const float32x4_t zero = vdupq_n_f32(0.f);
+        float32x4_t base = vdupq_n_f32(iangle);
+
+        for (; i + 4 <= samples; i += 4) {
+            float32x4_t da = vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vld1_s16(audio + i))), gain);
+
+            // inclusive prefix sum of the phase increments
+            da = vaddq_f32(da, vextq_f32(zero, da, 3));
+            da = vaddq_f32(da, vextq_f32(zero, da, 2));
+
+            float32x4_t ph = vaddq_f32(base, da);
+            float32x4_t fs, fc;
+            WVLT_SINCOSF8(ph, fs, fc);
+
+            // keep phase small to avoid precision loss on long runs
+            base = vdupq_laneq_f32(ph, 3);
+            base = vmlsq_n_f32(base, vrndnq_f32(vmulq_n_f32(base, WVLT_1_2PI_F)), WVLT_2PI_F);
+
+            int16x4x2_t o;
+            o.val[0] = vqmovn_s32(vcvtq_s32_f32(vmulq_n_f32(fc, amp)));
+            o.val[1] = vqmovn_s32(vcvtq_s32_f32(vmulq_n_f32(fs, amp)));
+            vst2_s16(iq + 2 * i, o);
+        }
+
+        iangle = vgetq_lane_f32(base, 0);
+    }
+
+    for (; i < samples; i++) {
+        float fi, fq;
+
+        iangle += audio[i] * gain;
+        wvlt_sincosf(iangle, &fq, &fi);
+
+        iq[2 * i + 0] = (int16_t)(fi * amp);
+        iq[2 * i + 1] = (int16_t)(fq * amp);
+    }
+
+    return wvlt_wrap_phasef(iangle);
+}
+
+#undef TEMPLATE_FUNC_NAME
@@ -0,0 +1,207 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#include <check.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <math.h>
+#include "xdsp_utest_common.h"
+#include "../conv_filter.h"
+
+#define FLEN_MAX (128u)
+#define INTERP_MAX (4u)
+#define SAMPLE_COUNT (8192u)    // cf32 samples, 2 floats each
+#define DATA_SIZE (2 * (SAMPLE_COUNT + FLEN_MAX))
+#define OUT_SIZE (2 * SAMPLE_COUNT * INTERP_MAX)
+
+static const unsigned packet_lens[3] = { 256, 2048, SAMPLE_COUNT };
+static const unsigned flens[4] = { 16, 33, 64, FLEN_MAX };
+
+#define SPEED_FLEN 64
+#define SPEED_MEASURE_ITERS 2000
+#define EPSILON 1E-4
+
+static float* in = NULL;
+static float* taps = NULL;
+static float* out = NULL;
+static float* out_etalon = NULL;
+
+static const char* last_fn_name = NULL;
+static generic_opts_t max_opt = OPT_GENERIC;
+
+static void setup()
+{
+    posix_memalign((void**)&in,         ALIGN_BYTES, sizeof(float) * DATA_SIZE);
+    posix_memalign((void**)&taps,       ALIGN_BYTES, sizeof(float) * FLEN_MAX * INTERP_MAX);
+    posix_memalign((void**)&out,        ALIGN_BYTES, sizeof(float) * OUT_SIZE);
+    posix_memalign((void**)&out_etalon, ALIGN_BYTES, sizeof(float) * OUT_SIZE);
+
+    for(unsigned i = 0; i < DATA_SIZE; ++i)
+    {
+        in[i] = 2.0f * (float)(rand()) / (float)RAND_MAX - 1.0f;
+    }
+
+    for(unsigned i = 0; i < FLEN_MAX * INTERP_MAX; ++i)
+    {
+        taps[i] = (2.0f * (float)(rand()) / (float)RAND_MAX - 1.0f) / FLEN_MAX;
+    }
+}
+
+static void teardown(void)
+{
+    free(in);
+    free(taps);
+    free(out);
+    free(out_etalon);
+}
+
+static int32_t is_equal(unsigned count)
+{
+    for(unsigned i = 0; i < count; i++)
+    {
+        if(fabs(out[i] - out_etalon[i]) > EPSILON) return i;
+    }
+    return -1;
+}
+
+static filter_cf32_function_t get_fn(generic_opts_t o, bool interpolate, int log)
+{
+    const char* fn_name = NULL;
+    filter_cf32_function_t fn = interpolate ? conv_filter_interpolate_cf32_c(o, &fn_name) :
+                                              conv_filter_cf32_c(o, &fn_name);
+
+    //ignore dups
+    if(last_fn_name && !strcmp(last_fn_name, fn_name))
+        return NULL;
+
+    if(log)
+        fprintf(stderr, "%-40s\t", fn_name);
+
+    last_fn_name = fn_name;
+    return fn;
+}
+
+START_TEST(conv_filter_cf32_check_simd)
+{
+    const unsigned flen = flens[_i];
+    const unsigned count = 2 * SAMPLE_COUNT;
+
+    fprintf(stderr,"\n**** Check SIMD implementations, flen = %u ***\n", flen);
+
+    for(unsigned decim_bits = 0; decim_bits < 3; ++decim_bits)
+    {
+        generic_opts_t opt = max_opt;
+        const unsigned outsz = count >> decim_bits;
+
+        last_fn_name = NULL;
+        (*get_fn(OPT_GENERIC, false, 0))(in, taps, out_etalon, count, decim_bits, flen);
+
+        while(opt != OPT_GENERIC)
+        {
+            filter_cf32_function_t fn = get_fn(opt--, false, 1);
+            if(fn)
+            {
+                memset(out, 0, sizeof(float) * outsz);
+                (*fn)(in, taps, out, count, decim_bits, flen);
+
+                int res = is_equal(outsz);
+                fprintf(stderr, "decim:%u", 1u << decim_bits);
+                (res >= 0) ? fprintf(stderr, "\tFAILED!\n") : fprintf(stderr, "\tOK!\n");
+                if(res >= 0)
+                {
+                    fprintf(stderr, "TEST  > i:%d out=%.6f <---> out_etalon=%.6f\n", res, out[res], out_etalon[res]);
+                }
+                ck_assert_int_eq( res, -1 );
+            }
+        }
+    }
+}
+END_TEST
+
+START_TEST(conv_filter_interpolate_cf32_check_simd)
+{
+    const unsigned flen = flens[_i];
+    const unsigned count = 2 * SAMPLE_COUNT;
+
+    fprintf(stderr,"\n**** Check SIMD implementations, flen = %u ***\n", flen);
+
+    for(unsigned interp = 1; interp <= INTERP_MAX; interp <<= 1)
+    {
+        generic_opts_t opt = max_opt;
+        const unsigned outsz = count * interp;
+
+        last_fn_name = NULL;
+        (*get_fn(OPT_GENERIC, true, 0))(in, taps, out_etalon, count, interp, flen);
+
+        while(opt != OPT_GENERIC)
+        {
+            filter_cf32_function_t fn = get_fn(opt--, true, 1);
+            if(fn)
+            {
+                memset(out, 0, sizeof(float) * outsz);
+                (*fn)(in, taps, out, count, interp, flen);
+
+                int res = is_equal(outsz);
+                fprintf(stderr, "interp:%u", interp);
+                (res >= 0) ? fprintf(stderr, "\tFAILED!\n") : fprintf(stderr, "\tOK!\n");
+                if(res >= 0)
+                {
+                    fprintf(stderr, "TEST  > i:%d out=%.6f <---> out_etalon=%.6f\n", res, out[res], out_etalon[res]);
+                }
+                ck_assert_int_eq( res, -1 );
+            }
+        }
+    }
+}
+END_TEST
+
+START_TEST(conv_filter_cf32_speed)
+{
+    generic_opts_t opt = max_opt;
+    const unsigned count = 2 * packet_lens[_i];
+    last_fn_name = NULL;
+
+    fprintf(stderr, "\n**** Compare SIMD implementations speed ***\n");
+    fprintf(stderr,   "**** packet: %u samples, flen: %u, decim: 2, iters: %u ***\n",
+            packet_lens[_i], SPEED_FLEN, SPEED_MEASURE_ITERS);
+
+    while(opt != OPT_GENERIC)
+    {
+        filter_cf32_function_t fn = get_fn(opt--, false, 1);
+        if(fn)
+        {
+            //warming
+            for(int i = 0; i < 100; ++i) (*fn)(in, taps, out, count, 1, SPEED_FLEN);
+
+            //measuring
+            uint64_t tk = clock_get_time();
+            for(int i = 0; i < SPEED_MEASURE_ITERS; ++i) (*fn)(in, taps, out, count, 1, SPEED_FLEN);
+            uint64_t tk1 = clock_get_time() - tk;
+            fprintf(stderr, "\t%" PRIu64 " us elapsed, %" PRIu64 " ns per 1 call, ave speed = %" PRIu64 " calls/s \n",
+                    tk1, (uint64_t)(tk1*1000LL/SPEED_MEASURE_ITERS), (uint64_t)(1000000LL*SPEED_MEASURE_ITERS/tk1));
+        }
+    }
+}
+END_TEST
+
+Suite * conv_filter_cf32_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    max_opt = cpu_vcap_get();
+
+    s = suite_create("conv_filter_cf32");
+    tc_core = tcase_create("XDSP");
+    tcase_set_timeout(tc_core, 120);
+    tcase_add_unchecked_fixture(tc_core, setup, teardown);
+    tcase_add_loop_test(tc_core, conv_filter_cf32_check_simd, 0, 4);
+    tcase_add_loop_test(tc_core, conv_filter_interpolate_cf32_check_simd, 0, 4);
+    tcase_add_loop_test(tc_core, conv_filter_cf32_speed, 0, 3);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
@@ -0,0 +1,183 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#include <check.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <stdlib.h>
+#include "xdsp_utest_common.h"
+#include "../conv_filter.h"
+
+#define FLEN_MAX (64u)
+#define WORD_COUNT (16384u)     // int16 values
+#define DATA_SIZE (WORD_COUNT + 2 * FLEN_MAX)
+
+static const unsigned packet_lens[3] = { 512, 4096, WORD_COUNT };
+static const unsigned flens[3] = { 16, 32, FLEN_MAX };
+
+#define SPEED_FLEN 32
+#define SPEED_MEASURE_ITERS 10000
+
+static int16_t* in = NULL;
+static int16_t* taps = NULL;
+static int16_t* taps_opt = NULL;
+static int16_t* out = NULL;
+static int16_t* out_etalon = NULL;
+
+static const char* last_fn_name = NULL;
+static generic_opts_t max_opt = OPT_GENERIC;
+
+static void setup()
+{
+    posix_memalign((void**)&in,         ALIGN_BYTES, sizeof(int16_t) * DATA_SIZE);
+    posix_memalign((void**)&taps,       ALIGN_BYTES, sizeof(int16_t) * FLEN_MAX);
+    posix_memalign((void**)&taps_opt,   ALIGN_BYTES, sizeof(int16_t) * FLEN_MAX);
+    posix_memalign((void**)&out,        ALIGN_BYTES, sizeof(int16_t) * WORD_COUNT);
+    posix_memalign((void**)&out_etalon, ALIGN_BYTES, sizeof(int16_t) * WORD_COUNT);
+
+    for(unsigned i = 0; i < DATA_SIZE; ++i)
+    {
+        int sign = (float)(rand()) / (float)RAND_MAX > 0.5 ? -1 : 1;
+        in[i] = sign * 32767 * (float)(rand()) / (float)RAND_MAX;
+    }
+
+    // keep sum(|taps|) <= 1.0 in Q15
+    for(unsigned i = 0; i < FLEN_MAX; ++i)
+    {
+        int sign = (float)(rand()) / (float)RAND_MAX > 0.5 ? -1 : 1;
+        taps[i] = sign * (32767 / FLEN_MAX) * (float)(rand()) / (float)RAND_MAX;
+    }
+}
+
+static void teardown(void)
+{
+    free(in);
+    free(taps);
+    free(taps_opt);
+    free(out);
+    free(out_etalon);
+}
+
+static filter_function_t get_fn(generic_opts_t o, bool interleave, int log)
+{
+    const char* fn_name = NULL;
+    filter_function_t fn = interleave ? conv_filter_interleave_c(o, &fn_name) : conv_filter_c(o, &fn_name);
+
+    //ignore dups
+    if(last_fn_name && !strcmp(last_fn_name, fn_name))
+        return NULL;
+
+    if(log)
+        fprintf(stderr, "%-35s\t", fn_name);
+
+    last_fn_name = fn_name;
+    return fn;
+}
+
+static void check_simd(bool interleave, unsigned flen)
+{
+    for(unsigned decim_bits = 0; decim_bits < 3; ++decim_bits)
+    {
+        generic_opts_t opt = max_opt;
+        const unsigned outsz = WORD_COUNT >> decim_bits;
+
+        last_fn_name = NULL;
+        (*get_fn(OPT_GENERIC, interleave, 0))(in, taps, out_etalon, WORD_COUNT, decim_bits, flen);
+
+        while(opt != OPT_GENERIC)
+        {
+            const generic_opts_t cap = opt--;
+            filter_function_t fn = get_fn(cap, interleave, 1);
+            if(fn)
+            {
+                if(interleave)
+                    conv_filter_interleave_taps(cap, taps, flen, taps_opt);
+                else
+                    memcpy(taps_opt, taps, sizeof(int16_t) * flen);
+
+                memset(out, 0, sizeof(int16_t) * outsz);
+                (*fn)(in, taps_opt, out, WORD_COUNT, decim_bits, flen);
+
+                int res = memcmp(out, out_etalon, sizeof(int16_t) * outsz);
+                fprintf(stderr, "decim:%u", 1u << decim_bits);
+                res ? fprintf(stderr, "\tFAILED!\n") : fprintf(stderr, "\tOK!\n");
+                ck_assert_int_eq( res, 0 );
+            }
+        }
+    }
+}
+
+START_TEST(conv_filter_check_simd)
+{
+    fprintf(stderr,"\n**** Check SIMD implementations, flen = %u ***\n", flens[_i]);
+    check_simd(false, flens[_i]);
+}
+END_TEST
+
+START_TEST(conv_filter_interleave_check_simd)
+{
+    fprintf(stderr,"\n**** Check SIMD implementations, flen = %u ***\n", flens[_i]);
+    check_simd(true, flens[_i]);
+}
+END_TEST
+
+static void speed(bool interleave, unsigned count)
+{
+    generic_opts_t opt = max_opt;
+    last_fn_name = NULL;
+
+    fprintf(stderr, "\n**** Compare SIMD implementations speed ***\n");
+    fprintf(stderr,   "**** packet: %u values, flen: %u, decim: 2, iters: %u ***\n",
+            count, SPEED_FLEN, SPEED_MEASURE_ITERS);
+
+    while(opt != OPT_GENERIC)
+    {
+        filter_function_t fn = get_fn(opt--, interleave, 1);
+        if(fn)
+        {
+            //warming
+            for(int i = 0; i < 100; ++i) (*fn)(in, taps, out, count, 1, SPEED_FLEN);
+
+            //measuring
+            uint64_t tk = clock_get_time();
+            for(int i = 0; i < SPEED_MEASURE_ITERS; ++i) (*fn)(in, taps, out, count, 1, SPEED_FLEN);
+            uint64_t tk1 = clock_get_time() - tk;
+            fprintf(stderr, "\t%" PRIu64 " us elapsed, %" PRIu64 " ns per 1 call, ave speed = %" PRIu64 " calls/s \n",
+                    tk1, (uint64_t)(tk1*1000LL/SPEED_MEASURE_ITERS), (uint64_t)(1000000LL*SPEED_MEASURE_ITERS/tk1));
+        }
+    }
+}
+
+START_TEST(conv_filter_speed)
+{
+    speed(false, packet_lens[_i]);
+}
+END_TEST
+
+START_TEST(conv_filter_interleave_speed)
+{
+    speed(true, packet_lens[_i]);
+}
+END_TEST
+
+Suite * conv_filter_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    max_opt = cpu_vcap_get();
+
+    s = suite_create("conv_filter");
+    tc_core = tcase_create("XDSP");
+    tcase_set_timeout(tc_core, 120);
+    tcase_add_unchecked_fixture(tc_core, setup, teardown);
+    tcase_add_loop_test(tc_core, conv_filter_check_simd, 0, 3);
+    tcase_add_loop_test(tc_core, conv_filter_interleave_check_simd, 0, 3);
+    tcase_add_loop_test(tc_core, conv_filter_speed, 0, 3);
+    tcase_add_loop_test(tc_core, conv_filter_interleave_speed, 0, 3);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
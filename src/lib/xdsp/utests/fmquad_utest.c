@@ -0,0 +1,301 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#include <check.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <stdlib.h>
+#include "xdsp_utest_common.h"
+#include "../fmquad.h"
+
+#define SAMPLE_COUNT (65536u + 5u)
+#define CHUNK_SIZE (1021u)      // odd chunks to cover tails & state passing
+
+#define EPSILON_ENC 3
+#define EPSILON_DEC 3
+
+static const unsigned packet_lens[3] = { 1024, 8192, 65536 };
+
+#define SPEED_MEASURE_ITERS 2000
+
+#define ENC_GAIN (2.0f * (float)M_PI * 75000.0f / 1000000.0f / 32767.0f)   // 75 kHz deviation @ 1 Msps
+
+static int16_t* audio = NULL;
+static int16_t* iq = NULL;
+static int16_t* iq_etalon = NULL;
+static int16_t* out = NULL;
+static int16_t* out_etalon = NULL;
+
+static const char* last_fn_name = NULL;
+static generic_opts_t max_opt = OPT_GENERIC;
+
+// Local PRNG, other suites reseed rand() and the input must not depend on the order
+static uint32_t noise_state;
+
+static float noise_next(void)
+{
+    noise_state = noise_state * 1664525u + 1013904223u;
+    return (float)(noise_state >> 8) / (float)(1u << 24) - 0.5f;
+}
+
+static void setup()
+{
+    posix_memalign((void**)&audio,      ALIGN_BYTES, sizeof(int16_t) * SAMPLE_COUNT);
+    posix_memalign((void**)&iq,         ALIGN_BYTES, sizeof(int16_t) * SAMPLE_COUNT * 2);
+    posix_memalign((void**)&iq_etalon,  ALIGN_BYTES, sizeof(int16_t) * SAMPLE_COUNT * 2);
+    posix_memalign((void**)&out,        ALIGN_BYTES, sizeof(int16_t) * SAMPLE_COUNT);
+    posix_memalign((void**)&out_etalon, ALIGN_BYTES, sizeof(int16_t) * SAMPLE_COUNT);
+
+    // two tones + noise
+    noise_state = 1;
+    for(unsigned i = 0; i < SAMPLE_COUNT; ++i)
+    {
+        float noise = noise_next();
+        audio[i] = 32767.f * (0.5f * sinf(2 * M_PI * i / 97.3f) + 0.3f * sinf(2 * M_PI * i / 13.1f) + 0.2f * noise);
+    }
+}
+
+static void teardown(void)
+{
+    free(audio);
+    free(iq);
+    free(iq_etalon);
+    free(out);
+    free(out_etalon);
+}
+
+static quadfm_encode_function_t get_enc_fn(generic_opts_t o, int log)
+{
+    const char* fn_name = NULL;
+    quadfm_encode_function_t fn = quadfm_encode_c(o, &fn_name);
+
+    //ignore dups
+    if(last_fn_name && !strcmp(last_fn_name, fn_name))
+        return NULL;
+
+    if(log)
+        fprintf(stderr, "%-25s\t", fn_name);
+
+    last_fn_name = fn_name;
+    return fn;
+}
+
+static quadfm_decode_function_t get_dec_fn(generic_opts_t o, int log)
+{
+    const char* fn_name = NULL;
+    quadfm_decode_function_t fn = quadfm_decode_c(o, &fn_name);
+
+    //ignore dups
+    if(last_fn_name && !strcmp(last_fn_name, fn_name))
+        return NULL;
+
+    if(log)
+        fprintf(stderr, "%-25s\t", fn_name);
+
+    last_fn_name = fn_name;
+    return fn;
+}
+
+static float run_encode(quadfm_encode_function_t fn, int16_t* piq)
+{
+    float ph = 0.f;
+    for(unsigned i = 0; i < SAMPLE_COUNT; i += CHUNK_SIZE)
+    {
+        unsigned n = (SAMPLE_COUNT - i < CHUNK_SIZE) ? SAMPLE_COUNT - i : CHUNK_SIZE;
+        ph = (*fn)(n, audio + i, piq + 2 * i, ENC_GAIN, ph);
+    }
+    return ph;
+}
+
+static int64_t run_decode(quadfm_decode_function_t fn, int16_t* pout, int32_t* maxp, quadfm_decode_state_t* st)
+{
+    int64_t tpwr = 0;
+    *maxp = 0;
+    st->iq_prev[0] = 32767;
+    st->iq_prev[1] = 0;
+    st->d_mp = 32767.f / (float)M_PI;
+
+    for(unsigned i = 0; i < SAMPLE_COUNT; i += CHUNK_SIZE)
+    {
+        unsigned n = (SAMPLE_COUNT - i < CHUNK_SIZE) ? SAMPLE_COUNT - i : CHUNK_SIZE;
+        int32_t cmaxp;
+        int64_t cpwr;
+        (*fn)(st, iq_etalon + 2 * i, n, pout + i, &cmaxp, &cpwr);
+        tpwr += cpwr;
+        if(*maxp < cmaxp)
+            *maxp = cmaxp;
+    }
+    return tpwr;
+}
+
+static int max_abs_diff(const int16_t* a, const int16_t* b, unsigned count, unsigned* pos)
+{
+    int max_eps = 0;
+    for(unsigned i = 0; i < count; ++i)
+    {
+        int d = abs(a[i] - b[i]);
+        if(d > max_eps)
+        {
+            max_eps = d;
+            *pos = i;
+        }
+    }
+    return max_eps;
+}
+
+START_TEST(quadfm_encode_check_simd)
+{
+    generic_opts_t opt = max_opt;
+    last_fn_name = NULL;
+
+    fprintf(stderr,"\n**** Check SIMD implementations ***\n");
+
+    //get etalon output data (generic foo)
+    float ph_etalon = run_encode(get_enc_fn(OPT_GENERIC, 0), iq_etalon);
+
+    while(opt != OPT_GENERIC)
+    {
+        quadfm_encode_function_t fn = get_enc_fn(opt--, 1);
+        if(fn)
+        {
+            memset(iq, 0, sizeof(int16_t) * SAMPLE_COUNT * 2);
+            float ph = run_encode(fn, iq);
+
+            unsigned pos = 0;
+            int max_eps = max_abs_diff(iq, iq_etalon, SAMPLE_COUNT * 2, &pos);
+            float dph = remainderf(ph - ph_etalon, 2 * (float)M_PI);
+
+            fprintf(stderr, "max_eps:%d @%u phase:%.6f (etalon %.6f)", max_eps, pos, ph, ph_etalon);
+            (max_eps > EPSILON_ENC || fabsf(dph) > 1e-3f) ? fprintf(stderr,"\tFAILED!\n") : fprintf(stderr,"\tOK!\n");
+
+            ck_assert_int_le( max_eps, EPSILON_ENC );
+            ck_assert( fabsf(dph) <= 1e-3f );
+        }
+    }
+}
+END_TEST
+
+START_TEST(quadfm_decode_check_simd)
+{
+    generic_opts_t opt = max_opt;
+    quadfm_decode_state_t st, st_etalon;
+    int32_t maxp, maxp_etalon;
+    last_fn_name = NULL;
+
+    fprintf(stderr,"\n**** Check SIMD implementations ***\n");
+
+    //modulated input
+    run_encode(get_enc_fn(OPT_GENERIC, 0), iq_etalon);
+
+    //get etalon output data (generic foo)
+    int64_t pwr_etalon = run_decode(get_dec_fn(OPT_GENERIC, 0), out_etalon, &maxp_etalon, &st_etalon);
+
+    while(opt != OPT_GENERIC)
+    {
+        quadfm_decode_function_t fn = get_dec_fn(opt--, 1);
+        if(fn)
+        {
+            memset(out, 0, sizeof(int16_t) * SAMPLE_COUNT);
+            int64_t pwr = run_decode(fn, out, &maxp, &st);
+
+            unsigned pos = 0;
+            int max_eps = max_abs_diff(out, out_etalon, SAMPLE_COUNT, &pos);
+
+            fprintf(stderr, "max_eps:%d @%u", max_eps, pos);
+            (max_eps > EPSILON_DEC) ? fprintf(stderr,"\tFAILED!\n") : fprintf(stderr,"\tOK!\n");
+
+            ck_assert_int_le( max_eps, EPSILON_DEC );
+            ck_assert_int_eq( maxp, maxp_etalon );
+            ck_assert_int_eq( pwr, pwr_etalon );
+            ck_assert_int_eq( st.iq_prev[0], st_etalon.iq_prev[0] );
+            ck_assert_int_eq( st.iq_prev[1], st_etalon.iq_prev[1] );
+        }
+    }
+}
+END_TEST
+
+START_TEST(quadfm_encode_speed)
+{
+    generic_opts_t opt = max_opt;
+    const unsigned count = packet_lens[_i];
+    last_fn_name = NULL;
+
+    fprintf(stderr, "\n**** Compare SIMD implementations speed ***\n");
+    fprintf(stderr,   "**** packet: %u samples, iters: %u ***\n", count, SPEED_MEASURE_ITERS);
+
+    while(opt != OPT_GENERIC)
+    {
+        quadfm_encode_function_t fn = get_enc_fn(opt--, 1);
+        if(fn)
+        {
+            float ph = 0.f;
+
+            //warming
+            for(int i = 0; i < 100; ++i) ph = (*fn)(count, audio, iq, ENC_GAIN, ph);
+
+            //measuring
+            uint64_t tk = clock_get_time();
+            for(int i = 0; i < SPEED_MEASURE_ITERS; ++i) ph = (*fn)(count, audio, iq, ENC_GAIN, ph);
+            uint64_t tk1 = clock_get_time() - tk;
+            fprintf(stderr, "\t%" PRIu64 " us elapsed, %" PRIu64 " ns per 1 call, ave speed = %.2f MS/s \n",
+                    tk1, (uint64_t)(tk1*1000LL/SPEED_MEASURE_ITERS), (float)count * SPEED_MEASURE_ITERS / tk1);
+        }
+    }
+}
+END_TEST
+
+START_TEST(quadfm_decode_speed)
+{
+    generic_opts_t opt = max_opt;
+    const unsigned count = packet_lens[_i];
+    last_fn_name = NULL;
+
+    fprintf(stderr, "\n**** Compare SIMD implementations speed ***\n");
+    fprintf(stderr,   "**** packet: %u samples, iters: %u ***\n", count, SPEED_MEASURE_ITERS);
+
+    run_encode(get_enc_fn(OPT_GENERIC, 0), iq_etalon);
+
+    while(opt != OPT_GENERIC)
+    {
+        quadfm_decode_function_t fn = get_dec_fn(opt--, 1);
+        if(fn)
+        {
+            quadfm_decode_state_t st = { { 0, 0 }, 32767.f / (float)M_PI };
+            int32_t maxp;
+            int64_t pwr;
+
+            //warming
+            for(int i = 0; i < 100; ++i) (*fn)(&st, iq_etalon, count, out, &maxp, &pwr);
+
+            //measuring
+            uint64_t tk = clock_get_time();
+            for(int i = 0; i < SPEED_MEASURE_ITERS; ++i) (*fn)(&st, iq_etalon, count, out, &maxp, &pwr);
+            uint64_t tk1 = clock_get_time() - tk;
+            fprintf(stderr, "\t%" PRIu64 " us elapsed, %" PRIu64 " ns per 1 call, ave speed = %.2f MS/s \n",
+                    tk1, (uint64_t)(tk1*1000LL/SPEED_MEASURE_ITERS), (float)count * SPEED_MEASURE_ITERS / tk1);
+        }
+    }
+}
+END_TEST
+
+Suite * fmquad_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    max_opt = cpu_vcap_get();
+
+    s = suite_create("fmquad");
+    tc_core = tcase_create("XDSP");
+    tcase_set_timeout(tc_core, 120);
+    tcase_add_unchecked_fixture(tc_core, setup, teardown);
+    tcase_add_test(tc_core, quadfm_encode_check_simd);
+    tcase_add_test(tc_core, quadfm_decode_check_simd);
+    tcase_add_loop_test(tc_core, quadfm_encode_speed, 0, 3);
+    tcase_add_loop_test(tc_core, quadfm_decode_speed, 0, 3);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
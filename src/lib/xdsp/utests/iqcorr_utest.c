@@ -0,0 +1,264 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#include <check.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <stdlib.h>
+#include "xdsp_utest_common.h"
+#include "../iqcorr.h"
+
+#define SAMPLE_COUNT (65536u + 7u)
+#define CHUNK_SIZE (1021u)      // odd chunks to cover tails
+
+#define EPSILON_F32 1e-5f
+
+static const unsigned packet_lens[3] = { 1024, 8192, 65536 };
+
+#define SPEED_MEASURE_ITERS 2000
+
+// simulated front end impairments
+#define IMB_DC_I     (-412.f)
+#define IMB_DC_Q     ( 233.f)
+#define IMB_GAIN     (1.08f)
+#define IMB_PHASE    (0.07f)
+
+static int16_t* in_ci16 = NULL;
+static int16_t* out_ci16 = NULL;
+static int16_t* out_ci16_etalon = NULL;
+static float* in_cf32 = NULL;
+static float* out_cf32 = NULL;
+static float* out_cf32_etalon = NULL;
+
+static const char* last_fn_name = NULL;
+static generic_opts_t max_opt = OPT_GENERIC;
+
+static void setup()
+{
+    posix_memalign((void**)&in_ci16,         ALIGN_BYTES, sizeof(int16_t) * SAMPLE_COUNT * 2);
+    posix_memalign((void**)&out_ci16,        ALIGN_BYTES, sizeof(int16_t) * SAMPLE_COUNT * 2);
+    posix_memalign((void**)&out_ci16_etalon, ALIGN_BYTES, sizeof(int16_t) * SAMPLE_COUNT * 2);
+    posix_memalign((void**)&in_cf32,         ALIGN_BYTES, sizeof(float) * SAMPLE_COUNT * 2);
+    posix_memalign((void**)&out_cf32,        ALIGN_BYTES, sizeof(float) * SAMPLE_COUNT * 2);
+    posix_memalign((void**)&out_cf32_etalon, ALIGN_BYTES, sizeof(float) * SAMPLE_COUNT * 2);
+
+    // two complex tones + noise passed through DC offset, gain and phase imbalance
+    for(unsigned i = 0; i < SAMPLE_COUNT; ++i)
+    {
+        float ni = (float)(rand()) / (float)RAND_MAX - 0.5f;
+        float nq = (float)(rand()) / (float)RAND_MAX - 0.5f;
+        float ph0 = 2 * M_PI * i / 97.3f;
+        float ph1 = -2 * M_PI * i / 13.1f;
+        float si = 12000.f * cosf(ph0) + 6000.f * cosf(ph1) + 2000.f * ni;
+        float sq = 12000.f * sinf(ph0) + 6000.f * sinf(ph1) + 2000.f * nq;
+
+        float ii = si + IMB_DC_I;
+        float qq = IMB_GAIN * (sq * cosf(IMB_PHASE) + si * sinf(IMB_PHASE)) + IMB_DC_Q;
+
+        in_ci16[2 * i + 0] = ii;
+        in_ci16[2 * i + 1] = qq;
+        in_cf32[2 * i + 0] = ii / 32768.f;
+        in_cf32[2 * i + 1] = qq / 32768.f;
+    }
+}
+
+static void teardown(void)
+{
+    free(in_ci16);
+    free(out_ci16);
+    free(out_ci16_etalon);
+    free(in_cf32);
+    free(out_cf32);
+    free(out_cf32_etalon);
+}
+
+static iqcorr_function_t get_fn(unsigned format, generic_opts_t o, int log)
+{
+    const char* fn_name = NULL;
+    iqcorr_function_t fn = (format == IQCORR_CI16) ? iqcorr_ci16_c(o, &fn_name) : iqcorr_cf32_c(o, &fn_name);
+
+    //ignore dups
+    if(last_fn_name && !strcmp(last_fn_name, fn_name))
+        return NULL;
+
+    if(log)
+        fprintf(stderr, "%-25s\t", fn_name);
+
+    last_fn_name = fn_name;
+    return fn;
+}
+
+static void run_corr(iqcorr_state_t* st, iqcorr_function_t fn, const void* in, void* out)
+{
+    const unsigned ssz = (st->format == IQCORR_CI16) ? 2 * sizeof(int16_t) : 2 * sizeof(float);
+
+    st->func = fn;
+    for(unsigned i = 0; i < SAMPLE_COUNT; i += CHUNK_SIZE)
+    {
+        unsigned n = (SAMPLE_COUNT - i < CHUNK_SIZE) ? SAMPLE_COUNT - i : CHUNK_SIZE;
+        iqcorr_process(st, (const char*)in + ssz * i, (char*)out + ssz * i, n);
+    }
+}
+
+START_TEST(iqcorr_ci16_check_simd)
+{
+    generic_opts_t opt = max_opt;
+    iqcorr_state_t st, st_etalon;
+    last_fn_name = NULL;
+
+    fprintf(stderr,"\n**** Check SIMD implementations ***\n");
+
+    //get etalon output data (generic foo)
+    iqcorr_init(&st_etalon, IQCORR_CI16, IQCORR_DC | IQCORR_IQ, 16384);
+    run_corr(&st_etalon, get_fn(IQCORR_CI16, OPT_GENERIC, 0), in_ci16, out_ci16_etalon);
+
+    while(opt != OPT_GENERIC)
+    {
+        iqcorr_function_t fn = get_fn(IQCORR_CI16, opt--, 1);
+        if(fn)
+        {
+            memset(out_ci16, 0, sizeof(int16_t) * SAMPLE_COUNT * 2);
+            iqcorr_init(&st, IQCORR_CI16, IQCORR_DC | IQCORR_IQ, 16384);
+            run_corr(&st, fn, in_ci16, out_ci16);
+
+            int max_eps = 0;
+            unsigned pos = 0;
+            for(unsigned i = 0; i < SAMPLE_COUNT * 2; ++i)
+            {
+                int d = abs(out_ci16[i] - out_ci16_etalon[i]);
+                if(d > max_eps) { max_eps = d; pos = i; }
+            }
+
+            fprintf(stderr, "max_eps:%d @%u", max_eps, pos);
+            (max_eps > 0) ? fprintf(stderr,"\tFAILED!\n") : fprintf(stderr,"\tOK!\n");
+
+            // integer math, estimates are bit exact too
+            ck_assert_int_eq( max_eps, 0 );
+            ck_assert( memcmp(&st.coeffs, &st_etalon.coeffs, sizeof(st.coeffs)) == 0 );
+        }
+    }
+}
+END_TEST
+
+START_TEST(iqcorr_cf32_check_simd)
+{
+    generic_opts_t opt = max_opt;
+    iqcorr_state_t st, st_etalon;
+    last_fn_name = NULL;
+
+    fprintf(stderr,"\n**** Check SIMD implementations ***\n");
+
+    //get etalon output data (generic foo)
+    iqcorr_init(&st_etalon, IQCORR_CF32, IQCORR_DC | IQCORR_IQ, 16384);
+    run_corr(&st_etalon, get_fn(IQCORR_CF32, OPT_GENERIC, 0), in_cf32, out_cf32_etalon);
+
+    while(opt != OPT_GENERIC)
+    {
+        iqcorr_function_t fn = get_fn(IQCORR_CF32, opt--, 1);
+        if(fn)
+        {
+            memset(out_cf32, 0, sizeof(float) * SAMPLE_COUNT * 2);
+            iqcorr_init(&st, IQCORR_CF32, IQCORR_DC | IQCORR_IQ, 16384);
+            run_corr(&st, fn, in_cf32, out_cf32);
+
+            float max_eps = 0;
+            unsigned pos = 0;
+            for(unsigned i = 0; i < SAMPLE_COUNT * 2; ++i)
+            {
+                float d = fabsf(out_cf32[i] - out_cf32_etalon[i]);
+                if(d > max_eps) { max_eps = d; pos = i; }
+            }
+
+            fprintf(stderr, "max_eps:%.8f @%u", max_eps, pos);
+            (max_eps > EPSILON_F32) ? fprintf(stderr,"\tFAILED!\n") : fprintf(stderr,"\tOK!\n");
+
+            ck_assert( max_eps <= EPSILON_F32 );
+        }
+    }
+}
+END_TEST
+
+START_TEST(iqcorr_ci16_convergence)
+{
+    iqcorr_state_t st;
+    double si = 0, sq = 0, sii = 0, sqq = 0, siq = 0;
+
+    iqcorr_init(&st, IQCORR_CI16, IQCORR_DC | IQCORR_IQ, 4096);
+    run_corr(&st, st.func, in_ci16, out_ci16);
+
+    // measure on the second half, after the estimator settled
+    const unsigned from = SAMPLE_COUNT / 2;
+    const unsigned cnt = SAMPLE_COUNT - from;
+    for(unsigned i = from; i < SAMPLE_COUNT; ++i)
+    {
+        double vi = out_ci16[2 * i + 0], vq = out_ci16[2 * i + 1];
+        si += vi; sq += vq; sii += vi * vi; sqq += vq * vq; siq += vi * vq;
+    }
+    si /= cnt; sq /= cnt; sii /= cnt; sqq /= cnt; siq /= cnt;
+
+    double gain_db = 10 * log10(sqq / sii);
+    double corr = siq / sqrt(sii * sqq);
+
+    fprintf(stderr, "\nDC: %.2f %.2f gain: %.4f dB corr: %.5f\n", si, sq, gain_db, corr);
+
+    ck_assert( fabs(si) < 16 && fabs(sq) < 16 );
+    ck_assert( fabs(gain_db) < 0.05 );
+    ck_assert( fabs(corr) < 0.005 );
+}
+END_TEST
+
+START_TEST(iqcorr_speed)
+{
+    generic_opts_t opt = max_opt;
+    const unsigned format = _i / 3;
+    const unsigned count = packet_lens[_i % 3];
+    void* buf = (format == IQCORR_CI16) ? (void*)out_ci16 : (void*)out_cf32;
+    last_fn_name = NULL;
+
+    fprintf(stderr, "\n**** Compare SIMD implementations speed ***\n");
+    fprintf(stderr,   "**** %s packet: %u samples, iters: %u ***\n", (format == IQCORR_CI16) ? "ci16" : "cf32", count, SPEED_MEASURE_ITERS);
+
+    while(opt != OPT_GENERIC)
+    {
+        iqcorr_function_t fn = get_fn(format, opt--, 1);
+        if(fn)
+        {
+            iqcorr_state_t st;
+            iqcorr_init(&st, format, IQCORR_DC | IQCORR_IQ, 0);
+            st.func = fn;
+
+            //warming
+            for(int i = 0; i < 100; ++i) iqcorr_process(&st, buf, buf, count);
+
+            //measuring
+            uint64_t tk = clock_get_time();
+            for(int i = 0; i < SPEED_MEASURE_ITERS; ++i) iqcorr_process(&st, buf, buf, count);
+            uint64_t tk1 = clock_get_time() - tk;
+            fprintf(stderr, "\t%" PRIu64 " us elapsed, %" PRIu64 " ns per 1 call, ave speed = %.2f MS/s \n",
+                    tk1, (uint64_t)(tk1*1000LL/SPEED_MEASURE_ITERS), (float)count * SPEED_MEASURE_ITERS / tk1);
+        }
+    }
+}
+END_TEST
+
+Suite * iqcorr_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    max_opt = cpu_vcap_get();
+
+    s = suite_create("iqcorr");
+    tc_core = tcase_create("XDSP");
+    tcase_set_timeout(tc_core, 120);
+    tcase_add_unchecked_fixture(tc_core, setup, teardown);
+    tcase_add_test(tc_core, iqcorr_ci16_check_simd);
+    tcase_add_test(tc_core, iqcorr_cf32_check_simd);
+    tcase_add_test(tc_core, iqcorr_ci16_convergence);
+    tcase_add_loop_test(tc_core, iqcorr_speed, 0, 6);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
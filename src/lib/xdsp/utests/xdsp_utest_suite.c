@@ -32,6 +32,10 @@ Suite * conv_ci12_2ci16_suite(void);
 Suite * conv_ci12_4ci16_suite(void);
 Suite * conv_2ci16_ci12_suite(void);
 Suite * conv_4ci16_ci12_suite(void);
+Suite * conv_filter_suite(void);
+Suite * conv_filter_cf32_suite(void);
+Suite * fmquad_suite(void);
+Suite * iqcorr_suite(void);
 
 int main(int argc, char** argv)
 {
@@ -76,6 +80,11 @@ int main(int argc, char** argv)
     srunner_add_suite(sr, conv_ci12_2cf32_suite());
     srunner_add_suite(sr, conv_ci12_4cf32_suite());
     //
+    srunner_add_suite(sr, conv_filter_suite());
+    srunner_add_suite(sr, conv_filter_cf32_suite());
+    srunner_add_suite(sr, fmquad_suite());
+    srunner_add_suite(sr, iqcorr_suite());
+    //
 #else
     sr = srunner_create(wvlt_sincos_i16_suite());
     //srunner_add_suite(sr, conv_2ci16_ci16_suite());
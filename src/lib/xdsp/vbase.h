@@ -40,6 +40,7 @@ typedef enum generic_opts generic_opts_t;
 #include <immintrin.h>
 
 #ifndef __EMSCRIPTEN__
+#define WVLT_AVX512BW
 #define WVLT_AVX2
 #define WVLT_AVX
 #define WVLT_SSE4_2
@@ -60,6 +61,13 @@ typedef enum generic_opts generic_opts_t;
 #endif  //WVLT_SIMD_INTEL
 
 
+#ifdef WVLT_AVX512BW
+#define SELECT_AVX512BW_FN(a, b, fn, cap) do { \
+    if (cap >= OPT_AVX512BW) {a = &fn; b = VB_STRINGIFY(fn);} } while(0)
+#else
+#define SELECT_AVX512BW_FN(a, b, fn, cap)
+#endif
+
 #ifdef WVLT_AVX2
 #define SELECT_AVX2_FN(a, b, fn, cap) do { \
     if (cap >= OPT_AVX2) {a = &fn; b = VB_STRINGIFY(fn);} } while(0)
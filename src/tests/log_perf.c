@@ -0,0 +1,90 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+// Per call cost of USDR_LOG() for filtered messages and for enabled messages
+// written synchronously or through the asynchronous sink. Wall time includes
+// the drain thread when it shares the CPU with the caller, the CPU time of
+// the calling thread is what the asynchronous sink actually takes off it.
+
+#include <usdr_logging.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+
+static unsigned s_lines;
+
+static int null_log_op(uintptr_t param, unsigned sevirity, const char* log)
+{
+    s_lines++;
+    return 0;
+}
+
+static double get_time(clockid_t clk)
+{
+    struct timespec ts;
+    clock_gettime(clk, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+struct run_cost {
+    double wall;
+    double cpu;
+};
+
+// Similar to a typical stream hot path message
+static struct run_cost run(unsigned count, unsigned level)
+{
+    struct run_cost c;
+    double start = get_time(CLOCK_MONOTONIC);
+    double cpu_start = get_time(CLOCK_THREAD_CPUTIME_ID);
+    for (unsigned i = 0; i < count; i++) {
+        USDR_LOG("STRM", level, "Buffer %d / %08x %08x  TO=%d SEQ=%16ld\n",
+                 i, i * 3, i * 7, 1000, (long)i);
+    }
+    c.wall = (get_time(CLOCK_MONOTONIC) - start) * 1e9 / count;
+    c.cpu = (get_time(CLOCK_THREAD_CPUTIME_ID) - cpu_start) * 1e9 / count;
+    return c;
+}
+
+int main(int argc, char** argv)
+{
+    int opt;
+    unsigned count = 1000000;
+
+    while ((opt = getopt(argc, argv, "n:")) != -1) {
+        switch (opt) {
+        case 'n': count = atoi(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-n calls]\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Output goes nowhere, only formatting and queueing are measured
+    usdrlog_set_log_op(&null_log_op);
+    usdrlog_setlevel(NULL, USDR_LOG_WARNING);
+
+    struct run_cost filtered = run(count, USDR_LOG_DEBUG);
+    struct run_cost enabled_sync = run(count, USDR_LOG_WARNING);
+
+    if (usdrlog_set_async(true)) {
+        fprintf(stderr, "Asynchronous log sink isn't available\n");
+        return 1;
+    }
+
+    struct run_cost enabled_async = run(count, USDR_LOG_WARNING);
+    double flush_start = get_time(CLOCK_MONOTONIC);
+    usdrlog_set_async(false);
+    double drain = (get_time(CLOCK_MONOTONIC) - flush_start) * 1e9 / count;
+
+    fprintf(stderr, "USDR_LOG() cost per call, %u calls:          wall   caller CPU\n", count);
+    fprintf(stderr, "  filtered          %8.2f ns %8.2f ns\n", filtered.wall, filtered.cpu);
+    fprintf(stderr, "  enabled, sync     %8.2f ns %8.2f ns\n", enabled_sync.wall, enabled_sync.cpu);
+    fprintf(stderr, "  enabled, async    %8.2f ns %8.2f ns (+%.2f ns left to drain on stop)\n",
+            enabled_async.wall, enabled_async.cpu, drain);
+    fprintf(stderr, "  written %u of %u enabled messages, the rest were dropped on a full ring\n",
+            s_lines, 2 * count);
+    return 0;
+}
@@ -0,0 +1,200 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+// RX throughput and host CPU load with zero-copy (usbfs mapped) transfer
+// buffers compared to regular host memory buffers
+
+#include <dm_dev.h>
+#include <dm_stream.h>
+#include <usdr_logging.h>
+
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+
+static volatile int s_exit_event = 0;
+void sig_term(int signo) {
+    (void)signo;
+
+    if (s_exit_event) {
+        exit(1);
+    }
+
+    s_exit_event = 1;
+}
+
+struct perf_result {
+    int64_t devmem;
+    uint64_t bytes;
+    unsigned lost;
+    double wall;
+    double cpu;
+};
+
+static double get_time(clockid_t clk)
+{
+    struct timespec ts;
+    clock_gettime(clk, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int run_rx(pdm_dev_t dev, const char* format, unsigned chcnt, unsigned pktsyms,
+                  const char* params, unsigned duration, struct perf_result* r)
+{
+    pusdr_dms_t strm;
+    usdr_dms_nfo_t nfo;
+    unsigned chans[2] = { 0, 1 };
+    usdr_channel_info_t chinfo = { chcnt, 0, NULL, chans };
+    void* buffers[2] = { NULL, NULL };
+    struct usdr_dms_recv_nfo rnfo;
+    int res;
+
+    res = usdr_dms_create_ex2(dev, "/ll/srx/0", format, &chinfo, pktsyms, 0, params, &strm);
+    if (res) {
+        fprintf(stderr, "Unable to create RX stream: %d\n", res);
+        return res;
+    }
+
+    res = usdr_dms_info(strm, &nfo);
+    if (res)
+        goto failed_stream;
+
+    r->devmem = -1;
+    usdr_dms_get_option(strm, "devmem", &r->devmem);
+
+    for (unsigned i = 0; i < chcnt; i++) {
+        buffers[i] = malloc(nfo.pktbszie);
+        if (buffers[i] == NULL) {
+            res = -ENOMEM;
+            goto failed_buffers;
+        }
+    }
+
+    res = usdr_dms_sync(dev, "off", 1, &strm);
+    res = res ? res : usdr_dms_op(strm, USDR_DMS_START, 0);
+    res = res ? res : usdr_dms_sync(dev, "none", 1, &strm);
+    if (res)
+        goto failed_buffers;
+
+    // Warmup
+    for (unsigned i = 0; i < 64 && res == 0; i++) {
+        res = usdr_dms_recv(strm, buffers, 2250, &rnfo);
+    }
+
+    r->bytes = 0;
+    r->lost = 0;
+    double wall_start = get_time(CLOCK_MONOTONIC);
+    double cpu_start = get_time(CLOCK_PROCESS_CPUTIME_ID);
+    double wall_stop = wall_start + duration;
+
+    while (res == 0 && !s_exit_event) {
+        res = usdr_dms_recv(strm, buffers, 2250, &rnfo);
+        if (res)
+            break;
+
+        r->bytes += (uint64_t)nfo.pktbszie * chcnt;
+        r->lost += rnfo.totlost;
+
+        if (get_time(CLOCK_MONOTONIC) > wall_stop)
+            break;
+    }
+
+    r->wall = get_time(CLOCK_MONOTONIC) - wall_start;
+    r->cpu = get_time(CLOCK_PROCESS_CPUTIME_ID) - cpu_start;
+
+    usdr_dms_op(strm, USDR_DMS_STOP, 0);
+
+failed_buffers:
+    for (unsigned i = 0; i < chcnt; i++) {
+        free(buffers[i]);
+    }
+failed_stream:
+    usdr_dms_destroy(strm);
+    return res;
+}
+
+int main(int argc, char** argv)
+{
+    int res, opt;
+    const char* device = "";
+    const char* format = "ci16";
+    unsigned rate = 50e6;
+    unsigned chcnt = 1;
+    unsigned pktsyms = 0;
+    unsigned duration = 5;
+    int loglevel = USDR_LOG_WARNING;
+    pdm_dev_t dev;
+
+    static const char* modes[] = { "devmem_on", "devmem_off" };
+    struct perf_result rs[SIZEOF_ARRAY(modes)];
+
+    while ((opt = getopt(argc, argv, "D:F:r:c:p:t:l:")) != -1) {
+        switch (opt) {
+        case 'D': device = optarg; break;
+        case 'F': format = optarg; break;
+        case 'r': rate = atof(optarg); break;
+        case 'c': chcnt = atoi(optarg); break;
+        case 'p': pktsyms = atoi(optarg); break;
+        case 't': duration = atoi(optarg); break;
+        case 'l': loglevel = atoi(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-D device] [-F format] [-r samplerate] [-c channels] [-p pktsyms] [-t seconds] [-l loglevel]\n",
+                    argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (chcnt < 1 || chcnt > 2) {
+        fprintf(stderr, "Only 1 or 2 channels are supported\n");
+        return 1;
+    }
+
+    usdrlog_setlevel(NULL, loglevel);
+    usdrlog_enablecolorize(NULL);
+
+    res = usdr_dmd_create_string(device, &dev);
+    if (res) {
+        fprintf(stderr, "Unable to open device: %d\n", res);
+        return 1;
+    }
+
+    unsigned rates[4] = { rate, 0, 0, 0 };
+    res = usdr_dme_set_uint(dev, "/dm/power/en", 1);
+    res = res ? res : usdr_dme_set_uint(dev, "/dm/rate/rxtxadcdac", (uintptr_t)&rates[0]);
+    if (res) {
+        fprintf(stderr, "Unable to set samplerate: %d\n", res);
+        goto failed;
+    }
+
+    signal(SIGINT, sig_term);
+
+    for (unsigned m = 0; m < SIZEOF_ARRAY(modes) && !s_exit_event; m++) {
+        res = run_rx(dev, format, chcnt, pktsyms, modes[m], duration, &rs[m]);
+        if (res) {
+            fprintf(stderr, "%s: streaming failed: %d\n", modes[m], res);
+            goto failed;
+        }
+
+        fprintf(stderr, "%-10s zero-copy=%-2d %8.1f MB/s  CPU %5.1f%%  lost %u\n",
+                modes[m], (int)rs[m].devmem, rs[m].bytes / rs[m].wall / 1e6,
+                100.0 * rs[m].cpu / rs[m].wall, rs[m].lost);
+    }
+
+    if (!s_exit_event && rs[0].devmem != 1) {
+        fprintf(stderr, "Zero-copy buffers aren't available on this host, both runs used host memory\n");
+    } else if (!s_exit_event) {
+        // CPU seconds per GB is comparable even when the device rate limits throughput
+        double cpb_on = rs[0].cpu / (rs[0].bytes / 1e9);
+        double cpb_off = rs[1].cpu / (rs[1].bytes / 1e9);
+        fprintf(stderr, "CPU per GB: zero-copy %.3f s, host %.3f s (%+.1f%%)\n",
+                cpb_on, cpb_off, 100.0 * (cpb_on - cpb_off) / cpb_off);
+    }
+
+failed:
+    usdr_dmd_close(dev);
+    return res ? 1 : 0;
+}
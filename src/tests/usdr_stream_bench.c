@@ -0,0 +1,496 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+// End-to-end streaming benchmark: sweeps stream formats, channel counts and
+// packet sizes, reports throughput, host CPU per sample, drops and the
+// recv() / send() call latency percentiles as JSON.
+//
+// Works with any device, `-D bus=synth` runs it without hardware:
+//   usdr_stream_bench -D bus=synth -d rx,tx -F ci16,cf32 -c 1,2 -p 4096,16384
+
+#define _GNU_SOURCE
+#include <dm_dev.h>
+#include <dm_stream.h>
+#include <usdr_logging.h>
+
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#endif
+
+enum {
+    BENCH_MAX_LIST = 16,
+    BENCH_MAX_CHS = 2,
+    BENCH_WARMUP_CALLS = 64,
+};
+
+static volatile int s_exit_event = 0;
+void sig_term(int signo) {
+    (void)signo;
+
+    if (s_exit_event) {
+        exit(1);
+    }
+
+    s_exit_event = 1;
+}
+
+enum bench_dir {
+    BENCH_RX = 1,
+    BENCH_TX = 2,
+    BENCH_TRX = BENCH_RX | BENCH_TX,
+};
+
+struct bench_stream {
+    // Input
+    pusdr_dms_t strm;
+    bool rx;
+    unsigned chcnt;
+    int cpu;                // -1 -- don't pin
+    unsigned duration;
+
+    // Output
+    int res;
+    uint64_t calls;
+    uint64_t samples;
+    uint64_t lost;          // RX samples lost, as reported by recv()
+    uint64_t underruns;     // TX, as reported by send(), when there's no telemetry
+    double wall;
+    double cpu_time;        // CPU time of the streaming thread
+    double tsc_hz;          // 0 -- not available
+    int telemetry;          // 0 if the stream keeps telemetry
+    usdr_dms_telemetry_t t0;
+    usdr_dms_telemetry_t t1;
+};
+
+static double get_time(clockid_t clk)
+{
+    struct timespec ts;
+    clock_gettime(clk, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t get_tsc(void)
+{
+#ifdef BENCH_HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static int pin_thread(int cpu)
+{
+    cpu_set_t cpuset;
+
+    if (cpu < 0)
+        return 0;
+
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu, &cpuset);
+    return -pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+}
+
+static unsigned parse_list(const char* str, const char** items, unsigned max, char* storage, size_t len)
+{
+    unsigned cnt = 0;
+    char* saveptr = NULL;
+
+    strncpy(storage, str, len - 1);
+    storage[len - 1] = 0;
+
+    for (char* tok = strtok_r(storage, ",", &saveptr); tok && cnt < max; tok = strtok_r(NULL, ",", &saveptr)) {
+        items[cnt++] = tok;
+    }
+    return cnt;
+}
+
+static void* bench_stream_thread(void* param)
+{
+    struct bench_stream* s = (struct bench_stream*)param;
+    usdr_dms_nfo_t nfo;
+    void* buffers[BENCH_MAX_CHS] = { NULL, NULL };
+    struct usdr_dms_recv_nfo rnfo;
+    usdr_dms_send_stat_t tstat;
+    int res;
+
+    s->telemetry = -ENOTSUP;
+    res = pin_thread(s->cpu);
+    if (res) {
+        fprintf(stderr, "Unable to pin thread to CPU %d: %d\n", s->cpu, res);
+        goto done;
+    }
+
+    res = usdr_dms_info(s->strm, &nfo);
+    if (res)
+        goto done;
+
+    for (unsigned i = 0; i < s->chcnt; i++) {
+        buffers[i] = calloc(1, nfo.pktbszie);
+        if (buffers[i] == NULL) {
+            res = -ENOMEM;
+            goto failed_buffers;
+        }
+    }
+
+    for (unsigned i = 0; i < BENCH_WARMUP_CALLS && res == 0; i++) {
+        res = (s->rx) ? usdr_dms_recv(s->strm, buffers, 2250, &rnfo) :
+                        usdr_dms_send_stat(s->strm, (const void**)buffers, nfo.pktsyms, UINT64_MAX, 2250, &tstat);
+    }
+    if (res)
+        goto failed_buffers;
+
+    // Only the counters accumulated within the measurement window are reported
+    s->telemetry = usdr_dms_get_telemetry(s->strm, &s->t0);
+
+    double wall_start = get_time(CLOCK_MONOTONIC);
+    double cpu_start = get_time(CLOCK_THREAD_CPUTIME_ID);
+    double wall_stop = wall_start + s->duration;
+    uint64_t tsc_start = get_tsc();
+
+    while (!s_exit_event) {
+        if (s->rx) {
+            res = usdr_dms_recv(s->strm, buffers, 2250, &rnfo);
+            if (res)
+                break;
+
+            s->samples += rnfo.totsyms;
+            s->lost += rnfo.totlost;
+        } else {
+            res = usdr_dms_send_stat(s->strm, (const void**)buffers, nfo.pktsyms, UINT64_MAX, 2250, &tstat);
+            if (res)
+                break;
+
+            s->samples += nfo.pktsyms;
+            s->underruns = tstat.underruns;
+        }
+        s->calls++;
+
+        if (get_time(CLOCK_MONOTONIC) > wall_stop)
+            break;
+    }
+
+    s->wall = get_time(CLOCK_MONOTONIC) - wall_start;
+    s->cpu_time = get_time(CLOCK_THREAD_CPUTIME_ID) - cpu_start;
+    s->tsc_hz = (tsc_start) ? (get_tsc() - tsc_start) / s->wall : 0;
+
+    if (s->telemetry == 0)
+        s->telemetry = usdr_dms_get_telemetry(s->strm, &s->t1);
+
+failed_buffers:
+    for (unsigned i = 0; i < s->chcnt; i++) {
+        free(buffers[i]);
+    }
+done:
+    s->res = res;
+    return NULL;
+}
+
+static int create_stream(pdm_dev_t dev, bool rx, const char* format, unsigned chcnt, unsigned pktsyms,
+                         pusdr_dms_t* strm)
+{
+    unsigned chans[BENCH_MAX_CHS] = { 0, 1 };
+    usdr_channel_info_t chinfo = { chcnt, 0, NULL, chans };
+
+    return usdr_dms_create_ex2(dev, rx ? "/ll/srx/0" : "/ll/stx/0", format, &chinfo, pktsyms, 0, NULL, strm);
+}
+
+// Device strings and formats come from the command line
+static void print_json_string(FILE* f, const char* str)
+{
+    fputc('"', f);
+    for (; *str; str++) {
+        unsigned char c = (unsigned char)*str;
+        if (c == '"' || c == '\\') {
+            fprintf(f, "\\%c", c);
+        } else if (c < 0x20) {
+            fprintf(f, "\\u%04x", c);
+        } else {
+            fputc(c, f);
+        }
+    }
+    fputc('"', f);
+}
+
+static void print_stream_json(FILE* f, const struct bench_stream* s)
+{
+    double sps = (s->wall > 0) ? s->samples / s->wall : 0;
+    double cpu_ns = (s->samples) ? s->cpu_time * 1e9 / s->samples : 0;
+
+    fprintf(f, "{\"status\": %d, \"calls\": %llu, \"samples\": %llu, \"seconds\": %.3f, "
+            "\"samples_per_s\": %.0f, \"cpu_pct\": %.1f, \"cpu_ns_per_sample\": %.3f, ",
+            s->res, (unsigned long long)s->calls, (unsigned long long)s->samples, s->wall,
+            sps, (s->wall > 0) ? 100.0 * s->cpu_time / s->wall : 0, cpu_ns);
+
+    if (s->tsc_hz > 0 && s->samples)
+        fprintf(f, "\"cycles_per_sample\": %.2f, ", s->cpu_time * s->tsc_hz / s->samples);
+    else
+        fprintf(f, "\"cycles_per_sample\": null, ");
+
+    if (s->telemetry == 0) {
+        // Difference of the histograms gives the latency within the measurement window
+        struct usdr_dms_histogram h = s->t1.call_latency;
+        h.count -= s->t0.call_latency.count;
+        h.sum_ns -= s->t0.call_latency.sum_ns;
+        for (unsigned i = 0; i < USDR_DMS_HIST_BUCKETS; i++) {
+            h.buckets[i] -= s->t0.call_latency.buckets[i];
+        }
+
+        fprintf(f, "\"overruns\": %llu, \"underruns\": %llu, \"late\": %llu, \"lost_samples\": %llu, "
+                "\"latency_ns\": {\"mean\": %llu, \"p50\": %llu, \"p99\": %llu, \"p999\": %llu}}",
+                (unsigned long long)(s->t1.overruns - s->t0.overruns),
+                (unsigned long long)(s->t1.underruns - s->t0.underruns),
+                (unsigned long long)(s->t1.late - s->t0.late),
+                (unsigned long long)s->lost,
+                (unsigned long long)((h.count) ? h.sum_ns / h.count : 0),
+                (unsigned long long)usdr_dms_histogram_percentile(&h, 50),
+                (unsigned long long)usdr_dms_histogram_percentile(&h, 99),
+                (unsigned long long)usdr_dms_histogram_percentile(&h, 99.9));
+    } else {
+        fprintf(f, "\"overruns\": null, \"underruns\": %llu, \"late\": null, \"lost_samples\": %llu, "
+                "\"latency_ns\": null}",
+                (unsigned long long)s->underruns, (unsigned long long)s->lost);
+    }
+}
+
+static int run_case(FILE* f, bool* first, pdm_dev_t dev, unsigned dir, const char* format, unsigned chcnt,
+                    unsigned pktsyms, unsigned duration, const int cpus[2])
+{
+    struct bench_stream bs[2];
+    pusdr_dms_t strms[2];
+    pthread_t th[2];
+    unsigned scnt = 0;
+    unsigned started = 0;
+    int res = 0;
+
+    memset(bs, 0, sizeof(bs));
+
+    if (!*first)
+        fprintf(f, ",\n");
+    *first = false;
+
+    fprintf(f, "    {\"format\": ");
+    print_json_string(f, format);
+    fprintf(f, ", \"channels\": %u, \"pktsyms\": %u", chcnt, pktsyms);
+    if (dir & BENCH_RX) {
+        bs[scnt].rx = true;
+        scnt++;
+    }
+    if (dir & BENCH_TX) {
+        bs[scnt].rx = false;
+        scnt++;
+    }
+
+    for (unsigned i = 0; i < scnt; i++) {
+        bs[i].chcnt = chcnt;
+        bs[i].cpu = cpus[i];
+        bs[i].duration = duration;
+
+        res = create_stream(dev, bs[i].rx, format, chcnt, pktsyms, &bs[i].strm);
+        if (res) {
+            fprintf(stderr, "Unable to create %s stream %s x%u/%u: %d\n",
+                    bs[i].rx ? "RX" : "TX", format, chcnt, pktsyms, res);
+            scnt = i;
+            goto failed;
+        }
+        strms[i] = bs[i].strm;
+    }
+
+    res = usdr_dms_sync(dev, "off", scnt, strms);
+    for (; started < scnt && res == 0; started++) {
+        res = usdr_dms_op(strms[started], USDR_DMS_START, 0);
+        if (res)
+            break;
+    }
+    res = res ? res : usdr_dms_sync(dev, "none", scnt, strms);
+    if (res) {
+        fprintf(stderr, "Unable to start streams: %d\n", res);
+        goto failed_stop;
+    }
+
+    for (unsigned i = 0; i < scnt; i++) {
+        res = pthread_create(&th[i], NULL, bench_stream_thread, &bs[i]);
+        if (res) {
+            res = -res;
+            s_exit_event = 1;
+            for (unsigned j = 0; j < i; j++) {
+                pthread_join(th[j], NULL);
+            }
+            goto failed_stop;
+        }
+    }
+    for (unsigned i = 0; i < scnt; i++) {
+        pthread_join(th[i], NULL);
+        if (bs[i].res)
+            res = bs[i].res;
+    }
+
+    for (unsigned i = 0; i < scnt; i++) {
+        fprintf(f, ",\n     \"%s\": ", bs[i].rx ? "rx" : "tx");
+        print_stream_json(f, &bs[i]);
+    }
+    fprintf(f, "}");
+    fflush(f);
+
+    for (unsigned i = 0; i < scnt; i++) {
+        fprintf(stderr, "%s %-8s x%u pkt %-6u %10.3f MS/s  CPU %5.1f%%  res %d\n",
+                bs[i].rx ? "RX" : "TX", format, chcnt, pktsyms,
+                (bs[i].wall > 0) ? bs[i].samples / bs[i].wall / 1e6 : 0,
+                (bs[i].wall > 0) ? 100.0 * bs[i].cpu_time / bs[i].wall : 0, bs[i].res);
+    }
+
+    for (unsigned i = 0; i < scnt; i++) {
+        usdr_dms_op(strms[i], USDR_DMS_STOP, 0);
+    }
+    goto done;
+
+failed_stop:
+    for (unsigned i = 0; i < started; i++) {
+        usdr_dms_op(strms[i], USDR_DMS_STOP, 0);
+    }
+failed:
+    fprintf(f, ", \"error\": %d}", res);
+    fflush(f);
+done:
+    for (unsigned i = 0; i < scnt; i++) {
+        usdr_dms_destroy(bs[i].strm);
+    }
+    return res;
+}
+
+int main(int argc, char** argv)
+{
+    int res, opt;
+    const char* device = "";
+    const char* dirs_str = "rx";
+    const char* formats_str = "ci16";
+    const char* chans_str = "1";
+    const char* pkts_str = "4096";
+    const char* cpus_str = NULL;
+    const char* output = NULL;
+    unsigned rate = 50e6;
+    unsigned duration = 5;
+    int loglevel = USDR_LOG_WARNING;
+    int cpus[2] = { -1, -1 };
+    FILE* f = stdout;
+    pdm_dev_t dev;
+
+    char sdirs[64], sfmts[256], schans[64], spkts[256], scpus[64];
+    const char *dirs[BENCH_MAX_LIST], *fmts[BENCH_MAX_LIST], *chans[BENCH_MAX_LIST], *pkts[BENCH_MAX_LIST], *cpul[2];
+    unsigned ndirs, nfmts, nchans, npkts;
+
+    while ((opt = getopt(argc, argv, "D:d:F:c:p:r:t:a:o:l:")) != -1) {
+        switch (opt) {
+        case 'D': device = optarg; break;
+        case 'd': dirs_str = optarg; break;
+        case 'F': formats_str = optarg; break;
+        case 'c': chans_str = optarg; break;
+        case 'p': pkts_str = optarg; break;
+        case 'r': rate = atof(optarg); break;
+        case 't': duration = atoi(optarg); break;
+        case 'a': cpus_str = optarg; break;
+        case 'o': output = optarg; break;
+        case 'l': loglevel = atoi(optarg); break;
+        default:
+            fprintf(stderr, "Usage: %s [-D device] [-d rx,tx,trx] [-F formats] [-c channels] [-p pktsyms] "
+                            "[-r samplerate] [-t seconds per case] [-a rxcpu[,txcpu]] [-o out.json] [-l loglevel]\n"
+                            "  lists are comma separated, every combination is measured; pktsyms defaults to 4096\n",
+                    argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    ndirs = parse_list(dirs_str, dirs, BENCH_MAX_LIST, sdirs, sizeof(sdirs));
+    nfmts = parse_list(formats_str, fmts, BENCH_MAX_LIST, sfmts, sizeof(sfmts));
+    nchans = parse_list(chans_str, chans, BENCH_MAX_LIST, schans, sizeof(schans));
+    npkts = parse_list(pkts_str, pkts, BENCH_MAX_LIST, spkts, sizeof(spkts));
+    if (cpus_str) {
+        unsigned ncpus = parse_list(cpus_str, cpul, 2, scpus, sizeof(scpus));
+        for (unsigned i = 0; i < ncpus; i++) {
+            cpus[i] = atoi(cpul[i]);
+        }
+    }
+
+    for (unsigned i = 0; i < nchans; i++) {
+        unsigned c = atoi(chans[i]);
+        if (c < 1 || c > BENCH_MAX_CHS) {
+            fprintf(stderr, "Only 1 or 2 channels are supported\n");
+            return 1;
+        }
+    }
+
+    usdrlog_setlevel(NULL, loglevel);
+    usdrlog_enablecolorize(NULL);
+
+    if (output) {
+        f = fopen(output, "w");
+        if (f == NULL) {
+            fprintf(stderr, "Unable to create %s: %d\n", output, errno);
+            return 1;
+        }
+    }
+
+    res = usdr_dmd_create_string(device, &dev);
+    if (res) {
+        fprintf(stderr, "Unable to open device: %d\n", res);
+        goto failed_open;
+    }
+
+    // Not every device has the power switch
+    usdr_dme_set_uint(dev, "/dm/power/en", 1);
+
+    unsigned rates[4] = { rate, rate, 0, 0 };
+    res = usdr_dme_set_uint(dev, "/dm/rate/rxtxadcdac", (uintptr_t)&rates[0]);
+    if (res) {
+        fprintf(stderr, "Unable to set samplerate: %d\n", res);
+        goto failed;
+    }
+
+    signal(SIGINT, sig_term);
+
+    fprintf(f, "{\"device\": ");
+    print_json_string(f, device);
+    fprintf(f, ", \"rate\": %u, \"duration\": %u,\n", rate, duration);
+    fprintf(f, " \"cpus\": [%d, %d],\n \"results\": [\n", cpus[0], cpus[1]);
+
+    bool first = true;
+    for (unsigned d = 0; d < ndirs && !s_exit_event; d++) {
+        unsigned dir = (strcmp(dirs[d], "rx") == 0) ? BENCH_RX :
+                       (strcmp(dirs[d], "tx") == 0) ? BENCH_TX :
+                       (strcmp(dirs[d], "trx") == 0) ? BENCH_TRX : 0;
+        if (dir == 0) {
+            fprintf(stderr, "Unknown direction `%s`, skipping\n", dirs[d]);
+            continue;
+        }
+
+        for (unsigned i = 0; i < nfmts && !s_exit_event; i++) {
+            for (unsigned j = 0; j < nchans && !s_exit_event; j++) {
+                for (unsigned k = 0; k < npkts && !s_exit_event; k++) {
+                    // A failed case is reported and the sweep goes on
+                    int r = run_case(f, &first, dev, dir, fmts[i], atoi(chans[j]), atoi(pkts[k]), duration, cpus);
+                    if (r)
+                        res = r;
+                }
+            }
+        }
+    }
+
+    fprintf(f, "\n ]}\n");
+
+failed:
+    usdr_dmd_close(dev);
+failed_open:
+    if (f != stdout)
+        fclose(f);
+    return res ? 1 : 0;
+}
@@ -1282,7 +1282,7 @@ int main(UNUSED int argc, UNUSED char** argv)
     usdr_dms_send_stat_t txstat;
 
     struct timespec tp, tp_prev;
-    clock_gettime(CLOCK_REALTIME, &tp_prev);
+    clock_gettime(CLOCK_MONOTONIC, &tp_prev);
 
     uint64_t pkt_rx_time = 1000000000ULL * snfo_rx.pktsyms / rate;
     uint64_t s_rx_time = tp_prev.tv_sec * 1000000000ULL + tp_prev.tv_nsec;
@@ -1308,7 +1308,7 @@ int main(UNUSED int argc, UNUSED char** argv)
             goto stop;
 
         if (statistics) {
-            clock_gettime(CLOCK_REALTIME, &tp);
+            clock_gettime(CLOCK_MONOTONIC, &tp);
 
             if (dorx) {
                 uint64_t curtime = tp.tv_sec * 1000000000ULL + tp.tv_nsec;
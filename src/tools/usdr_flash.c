@@ -255,14 +255,14 @@ int main(int argc, char** argv)
             res = espi_flash_write(dev, 0, qspi_base, 512,
                                              outa + 4096,
                                              total_length - 4096,
-                                             off + 4096, 0);
+                                             off + 4096, ESPI_FLASH_SKIP_EQUAL);
             if (res) {
                 fprintf(stderr, "Failed to write! res=%d", res);
                 return 4;
             }
         } else {
             res = espi_flash_write(dev, 0, qspi_base, 512, outa, total_length, off,
-                                             ESPI_FLASH_DONT_WRITE_HEADER);
+                                             ESPI_FLASH_DONT_WRITE_HEADER | ESPI_FLASH_SKIP_EQUAL);
             if (res) {
                 fprintf(stderr, "Failed to write! res=%d", res);
                 return 4;
@@ -0,0 +1,180 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+#include <poll.h>
+#include <semaphore.h>
+#include <time.h>
+#include <unistd.h>
+#include "mock_lowlevel.h"
+#include <usdr_time.h>
+
+#define MAX_LOG 64
+
+static sem_t bus_started[2];
+static bool rendezvous;
+
+static uint32_t spi_log[MAX_LOG];
+static unsigned spi_log_cnt;
+
+static int sem_wait_ms(sem_t* s, unsigned ms)
+{
+    return usdr_sem_wait_ns(s, ms * 1000000ll) ? -ETIMEDOUT : 0;
+}
+
+// Bus 0 and bus 1 transactions complete only when both are in flight
+static int spi_tr32_async(unsigned busno, uint32_t dout, uint32_t* din)
+{
+    if (rendezvous && busno < 2) {
+        sem_post(&bus_started[busno]);
+        int res = sem_wait_ms(&bus_started[busno ^ 1], 1000);
+        if (res)
+            return res;
+    }
+
+    if (busno == 2 && spi_log_cnt < MAX_LOG) {
+        spi_log[spi_log_cnt++] = dout;
+        usleep(100);
+    }
+
+    *din = (busno << 24) | (dout & 0xffffff);
+    return 0;
+}
+
+static const struct mock_functions s_async_spi = {
+    spi_tr32_async,
+};
+
+static lldev_t dev;
+
+static void setup(void)
+{
+    sem_init(&bus_started[0], 0, 0);
+    sem_init(&bus_started[1], 0, 0);
+    rendezvous = false;
+    spi_log_cnt = 0;
+    dev = mock_lowlevel_create(&s_async_spi);
+}
+
+static void teardown(void)
+{
+    lowlevel_destroy(dev);
+    sem_destroy(&bus_started[0]);
+    sem_destroy(&bus_started[1]);
+}
+
+START_TEST(async_buses_overlap) {
+    const uint32_t wr[2] = { 0x000123, 0x000456 };
+    uint32_t rd[2] = { 0, 0 };
+    lowlevel_ls_batch_op_t ops[] = {
+        { USDR_LSOP_SPI, 0, 4, 4, &rd[0], &wr[0] },
+        { USDR_LSOP_SPI, 1, 4, 4, &rd[1], &wr[1] },
+    };
+
+    rendezvous = true;
+    int res = lowlevel_ls_op_parallel(dev, 0, ops, SIZEOF_ARRAY(ops), 2000);
+    ck_assert_int_eq(res, 0);
+    ck_assert_uint_eq(rd[0], 0x00000123);
+    ck_assert_uint_eq(rd[1], 0x01000456);
+}
+END_TEST
+
+START_TEST(async_bus_order) {
+    uint32_t wr[16];
+    unsigned ids[16];
+
+    for (unsigned i = 0; i < SIZEOF_ARRAY(wr); i++) {
+        lowlevel_ls_batch_op_t op = { USDR_LSOP_SPI, 2, 0, 4, NULL, &wr[i] };
+        wr[i] = i;
+
+        int res = lowlevel_ls_op_submit(dev, 0, &op, &ids[i]);
+        ck_assert_int_eq(res, 0);
+        ck_assert_uint_ne(ids[i], LLAWAIT_ID_DONE);
+    }
+
+    // Wait in reverse order, completions are still in submission order
+    for (unsigned i = SIZEOF_ARRAY(wr); i > 0; i--) {
+        int res = lowlevel_await(dev, 0, ids[i - 1], 1000);
+        ck_assert_int_eq(res, 0);
+    }
+
+    ck_assert_int_eq(spi_log_cnt, SIZEOF_ARRAY(wr));
+    ck_assert_mem_eq(spi_log, wr, sizeof(wr));
+}
+END_TEST
+
+START_TEST(async_poll_fd) {
+    const uint32_t wr = 0x000789;
+    uint32_t rd = 0;
+    lowlevel_ls_batch_op_t op = { USDR_LSOP_SPI, 3, 4, 4, &rd, &wr };
+    int fd = -1;
+    void* aux = &fd;
+    unsigned id;
+
+    int res = lowlevel_get_ops(dev)->await(dev, 0, 0, LLAWAIT_GET_FD, &aux, 0);
+    ck_assert_int_eq(res, 0);
+    ck_assert_int_ge(fd, 0);
+
+    res = lowlevel_ls_op_submit(dev, 0, &op, &id);
+    ck_assert_int_eq(res, 0);
+
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    res = poll(&pfd, 1, 1000);
+    ck_assert_int_eq(res, 1);
+
+    uint64_t cnt;
+    ck_assert_int_eq(read(fd, &cnt, sizeof(cnt)), sizeof(cnt));
+    ck_assert_uint_eq(cnt, 1);
+
+    res = lowlevel_get_ops(dev)->await(dev, 0, id, LLAWAIT_POLL, NULL, 0);
+    ck_assert_int_eq(res, 0);
+    ck_assert_uint_eq(rd, 0x03000789);
+
+    // Completion was already reaped
+    res = lowlevel_get_ops(dev)->await(dev, 0, id, LLAWAIT_POLL, NULL, 0);
+    ck_assert_int_eq(res, -ENOENT);
+}
+END_TEST
+
+START_TEST(async_sync_fallback) {
+    struct mock_lowlevel_dev* mld = (struct mock_lowlevel_dev*)dev;
+    struct lowlevel_ops ops_noasync;
+    struct lowlevel_ops* ops_orig = lowlevel_get_ops(dev);
+    const uint32_t wr = 0x000abc;
+    uint32_t rd = 0;
+    lowlevel_ls_batch_op_t op = { USDR_LSOP_SPI, 4, 4, 4, &rd, &wr };
+    unsigned id;
+
+    memcpy(&ops_noasync, ops_orig, sizeof(ops_noasync));
+    ops_noasync.await = NULL;
+    mld->base.ops = &ops_noasync;
+
+    int res = lowlevel_ls_op_submit(dev, 0, &op, &id);
+    ck_assert_int_eq(res, 0);
+    ck_assert_uint_eq(id, LLAWAIT_ID_DONE);
+    ck_assert_uint_eq(rd, 0x04000abc);
+    ck_assert_int_eq(lowlevel_await(dev, 0, id, 0), 0);
+
+    mld->base.ops = ops_orig;
+}
+END_TEST
+
+Suite * async_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("async");
+    tc_core = tcase_create("Core");
+    tcase_add_checked_fixture(tc_core, setup, teardown);
+
+    tcase_add_test(tc_core, async_buses_overlap);
+    tcase_add_test(tc_core, async_bus_order);
+    tcase_add_test(tc_core, async_poll_fd);
+    tcase_add_test(tc_core, async_sync_fallback);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
@@ -0,0 +1,140 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "mock_lowlevel.h"
+#include "../lib/device/device_profile.h"
+#include "../lib/device/device_poll.h"
+
+#define STAT_REG   20
+#define STAT_READY 0x10000
+
+// Status register, ready flag goes up after `stat_polls` readbacks
+static unsigned stat_polls;
+static unsigned stat_reads;
+
+static int stat_reg_rd32(unsigned addr, uint32_t* din)
+{
+    if (addr != STAT_REG)
+        return -EINVAL;
+
+    stat_reads++;
+    *din = (stat_reads > stat_polls) ? (STAT_READY | 0x5) : 0x5;
+    return 0;
+}
+
+static const struct mock_functions s_stat_model = {
+    NULL,
+    NULL,
+    stat_reg_rd32,
+};
+
+static lldev_t dev;
+static device_profile_t prof;
+
+static void setup(void)
+{
+    stat_polls = stat_reads = 0;
+    dev = mock_lowlevel_create(&s_stat_model);
+    device_profile_init(&prof);
+}
+
+static void teardown(void)
+{
+    device_profile_free(&prof);
+    lowlevel_destroy(dev);
+}
+
+START_TEST(bringup_spans_nested) {
+    int a = device_span_begin(&prof, "initialize");
+    int b = device_span_begin(&prof, "pmic");
+    ck_assert_int_eq(device_span_end(&prof, b, 0), 0);
+    int c = device_span_begin(&prof, "pll_lock");
+    ck_assert_int_eq(device_span_end(&prof, c, -ETIMEDOUT), -ETIMEDOUT);
+    device_span_end(&prof, a, 0);
+
+    ck_assert_int_eq(prof.count, 3);
+    ck_assert_int_eq(prof.depth, 0);
+    ck_assert_int_eq(prof.spans[0].depth, 0);
+    ck_assert_int_eq(prof.spans[1].depth, 1);
+    ck_assert_int_eq(prof.spans[2].depth, 1);
+    ck_assert_uint_ge(prof.spans[0].dur_ns, prof.spans[1].dur_ns + prof.spans[2].dur_ns);
+
+    const char* r = device_profile_report(&prof);
+    ck_assert_ptr_ne(r, NULL);
+    ck_assert_ptr_ne(strstr(r, "\ninitialize "), NULL);
+    ck_assert_ptr_ne(strstr(r, "\n  pmic "), NULL);
+    ck_assert_ptr_ne(strstr(r, "-110\n"), NULL);
+
+    // NULL profile is a no-op
+    ck_assert_int_eq(device_span_begin(NULL, "x"), -1);
+    ck_assert_int_eq(device_span_end(NULL, -1, 7), 7);
+}
+END_TEST
+
+START_TEST(bringup_spans_evict) {
+    int s = device_span_begin(&prof, "initialize");
+    device_span_end(&prof, device_span_begin(&prof, "board"), 0);
+    device_span_end(&prof, s, 0);
+
+    // Repeated retuning keeps the initialization and the latest steps
+    for (unsigned i = 0; i < 3 * DEVICE_PROFILE_MAX_SPANS; i++) {
+        s = device_span_begin(&prof, (i & 1) ? "set_samplerate_odd" : "set_samplerate");
+        device_span_end(&prof, device_span_begin(&prof, "lms7002m_samplerate"), 0);
+        device_span_end(&prof, s, 0);
+    }
+
+    ck_assert_uint_le(prof.count, DEVICE_PROFILE_MAX_SPANS);
+    ck_assert_uint_gt(prof.dropped, 0);
+    ck_assert_str_eq(prof.spans[0].name, "initialize");
+    ck_assert_str_eq(prof.spans[1].name, "board");
+    ck_assert_str_eq(prof.spans[prof.count - 2].name, "set_samplerate_odd");
+    ck_assert_ptr_ne(strstr(device_profile_report(&prof), "spans dropped"), NULL);
+}
+END_TEST
+
+START_TEST(bringup_poll_ready) {
+    uint32_t last = 0;
+    stat_polls = 5;
+
+    int res = device_poll_reg32(dev, 0, STAT_REG, STAT_READY, STAT_READY, 0, 100000, "test", &last);
+    ck_assert_int_eq(res, 0);
+    ck_assert_int_eq(stat_reads, 6);
+    ck_assert_uint_eq(last, STAT_READY | 0x5);
+}
+END_TEST
+
+START_TEST(bringup_poll_timeout) {
+    uint32_t last = 0;
+    stat_polls = ~0u;
+
+    int res = device_poll_reg32(dev, 0, STAT_REG, STAT_READY, STAT_READY, 0, 2000, "test", &last);
+    ck_assert_int_eq(res, -ETIMEDOUT);
+    ck_assert_uint_eq(last, 0x5);
+
+    // Readback errors abort the poll
+    res = device_poll_reg32(dev, 0, STAT_REG + 1, STAT_READY, STAT_READY, 0, 2000, "test", NULL);
+    ck_assert_int_eq(res, -EINVAL);
+}
+END_TEST
+
+Suite * device_bringup_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("device_bringup");
+    tc_core = tcase_create("Core");
+    tcase_add_checked_fixture(tc_core, setup, teardown);
+
+    tcase_add_test(tc_core, bringup_spans_nested);
+    tcase_add_test(tc_core, bringup_spans_evict);
+    tcase_add_test(tc_core, bringup_poll_ready);
+    tcase_add_test(tc_core, bringup_poll_timeout);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
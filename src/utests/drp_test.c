@@ -0,0 +1,193 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mock_lowlevel.h"
+#include "../lib/device/device_bus.h"
+#include "../lib/device/device_cores.h"
+#include "../lib/ipblks/xlnx_mmcm.h"
+
+#define DRP_REG_BASE 56
+#define DRP_RB_BUSY  0x80000000
+
+// DRP model, request is in flight for `busy_polls` readbacks
+static uint16_t drp_regs[128];
+static unsigned drp_addr;
+static unsigned drp_busy;
+static unsigned drp_busy_polls;
+static unsigned drp_reads;
+static unsigned drp_writes;
+
+static int drp_reg_wr32(unsigned addr, uint32_t dout)
+{
+    if (addr != DRP_REG_BASE)
+        return 0;
+    if ((dout & 0x01000000) == 0)
+        return 0;
+
+    drp_addr = (dout >> 16) & 0x7f;
+    if (dout & 0x80000000) {
+        drp_regs[drp_addr] = dout;
+        drp_writes++;
+    }
+    drp_busy = drp_busy_polls;
+    return 0;
+}
+
+static int drp_reg_rd32(unsigned addr, uint32_t* din)
+{
+    if (addr != DRP_REG_BASE)
+        return 0;
+
+    drp_reads++;
+    if (drp_busy) {
+        drp_busy--;
+        *din = DRP_RB_BUSY | 0xdead;
+        return 0;
+    }
+
+    *din = drp_regs[drp_addr];
+    return 0;
+}
+
+static const struct mock_functions s_drp_model = {
+    NULL,
+    drp_reg_wr32,
+    drp_reg_rd32,
+};
+
+static device_bus_t db;
+static lldev_t dev;
+
+static void setup(void)
+{
+    memset(drp_regs, 0xff, sizeof(drp_regs));
+    drp_busy = drp_busy_polls = 0;
+    drp_reads = drp_writes = 0;
+
+    memset(&db, 0, sizeof(db));
+    db.drp_count = 1;
+    db.drp_base[0] = DRP_REG_BASE;
+    db.drp_core[0] = DRP_CORE_PHY_V1;
+
+    dev = mock_lowlevel_create(&s_drp_model);
+    ((struct mock_lowlevel_dev*)dev)->db = &db;
+}
+
+static void teardown(void)
+{
+    lowlevel_destroy(dev);
+}
+
+START_TEST(drp_poll_ready) {
+    uint16_t v = 0;
+    drp_regs[0x28] = 0x1234;
+    drp_busy_polls = 3;
+
+    int res = lowlevel_drp_rd16(dev, 0, 0, 0x28, &v);
+    ck_assert_int_eq(res, 0);
+    ck_assert_uint_eq(v, 0x1234);
+    ck_assert_int_eq(drp_reads, 4);
+}
+END_TEST
+
+START_TEST(drp_poll_timeout) {
+    uint16_t v = 0;
+    drp_busy_polls = ~0u;
+
+    int res = lowlevel_drp_rd16(dev, 0, 0, 0x28, &v);
+    ck_assert_int_eq(res, -ETIMEDOUT);
+}
+END_TEST
+
+START_TEST(drp_legacy_core) {
+    uint16_t v = 0;
+    db.drp_core[0] = USDR_MAKE_COREID(USDR_CS_BUS, USDR_DRP_PHY_V0);
+    drp_regs[0x16] = 0x4321;
+
+    int res = lowlevel_drp_rd16(dev, 0, 0, 0x16, &v);
+    ck_assert_int_eq(res, 0);
+    ck_assert_uint_eq(v, 0x4321);
+    ck_assert_int_eq(drp_reads, 1);
+}
+END_TEST
+
+START_TEST(drp_rmw_batch) {
+    lowlevel_drp_rmw_t regs[] = {
+        { 0x08, 0xefff, 0x0104, 0 },
+        { 0x09, 0x03ff, 0x0081, 0 },
+        { 0x28, 0xffff, 0xffff, 0 },
+    };
+    drp_regs[0x08] = 0x1000;
+    drp_regs[0x09] = 0xa5a5;
+    drp_regs[0x28] = 0x0000;
+    drp_busy_polls = 1;
+
+    int res = lowlevel_drp_rmw16(dev, 0, 0, regs, SIZEOF_ARRAY(regs));
+    ck_assert_int_eq(res, 0);
+    ck_assert_uint_eq(drp_regs[0x08], 0x1104);
+    ck_assert_uint_eq(drp_regs[0x09], 0xa481);
+    ck_assert_uint_eq(drp_regs[0x28], 0xffff);
+    ck_assert_uint_eq(regs[0].rb, 0x1000);
+    ck_assert_uint_eq(regs[1].rb, 0xa5a5);
+
+    // Write only register isn't read back
+    ck_assert_int_eq(drp_writes, 3);
+    ck_assert_int_eq(drp_reads, 4);
+}
+END_TEST
+
+START_TEST(drp_mmcm_init) {
+    struct mmcm_config_raw cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    for (unsigned i = 0; i < MAX_MMCM_PORTS; i++) {
+        cfg.ports[i].period_l = 4;
+        cfg.ports[i].period_h = 4;
+    }
+    cfg.ports[CLKOUT_PORT_0].delay = 1;
+    cfg.ports[CLKOUT_PORT_1].period_l = 3;
+    cfg.ports[CLKOUT_PORT_1].period_h = 2;
+    drp_regs[0x28] = 0;
+
+    int res = mmcm_init_raw(dev, 0, 0, &cfg);
+    ck_assert_int_eq(res, 0);
+
+    ck_assert_uint_eq(drp_regs[0x28], 0xffff);
+    ck_assert_uint_eq(drp_regs[0x08], 0x1104);
+    ck_assert_uint_eq(drp_regs[0x09], 0xfc01);
+    ck_assert_uint_eq(drp_regs[0x0A], 0x1083);
+    ck_assert_uint_eq(drp_regs[0x0B], 0xfc80);
+    ck_assert_uint_eq(drp_regs[0x16], 0xf001);
+    ck_assert_uint_eq(drp_regs[0x18] & 0xfc00, 0xfc00);
+    ck_assert_uint_eq(drp_regs[0x4E] & 0x66ff, 0x66ff);
+    ck_assert_uint_eq(drp_regs[0x4F] & 0x666f, 0x666f);
+
+    // Invalid configuration is rejected before touching hardware
+    drp_writes = 0;
+    cfg.ports[CLKOUT_PORT_2].period_h = 64;
+    res = mmcm_init_raw(dev, 0, 0, &cfg);
+    ck_assert_int_eq(res, -EINVAL);
+    ck_assert_int_eq(drp_writes, 0);
+}
+END_TEST
+
+Suite * drp_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("drp");
+    tc_core = tcase_create("Core");
+    tcase_add_checked_fixture(tc_core, setup, teardown);
+
+    tcase_add_test(tc_core, drp_poll_ready);
+    tcase_add_test(tc_core, drp_poll_timeout);
+    tcase_add_test(tc_core, drp_legacy_core);
+    tcase_add_test(tc_core, drp_rmw_batch);
+    tcase_add_test(tc_core, drp_mmcm_init);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
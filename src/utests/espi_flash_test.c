@@ -0,0 +1,267 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mock_lowlevel.h"
+#include "../lib/ipblks/espi_flash.h"
+
+#define QSPI_BASE     10
+#define QSPI_MMAP     512
+#define QSPI_MMAP_LEN 256
+
+#define FLASH_SIZE    (256 * 1024)
+#define IMAGE_OFF     (64 * 1024)
+#define IMAGE_SIZE    (128 * 1024)
+
+// Simulated ESPI core with attached NOR flash
+static struct flash_model {
+    uint8_t flash[FLASH_SIZE];
+    uint8_t local[QSPI_MMAP_LEN];
+    uint32_t faddr;
+    uint32_t data;
+    unsigned core_busy;
+    unsigned wip;
+    unsigned wip_polls;
+    bool wel;
+
+    unsigned erases;
+    unsigned programs;
+    unsigned uploads_in_wip;
+    unsigned violations;
+    uint32_t first_erase;
+} fm;
+
+static uint8_t image[IMAGE_SIZE];
+static uint8_t readback[IMAGE_SIZE];
+
+static void fm_flash_cmd(uint32_t v)
+{
+    uint8_t cmd = v >> 24;
+    unsigned sz = (v >> 16) & 0xff;
+    unsigned la = ((v >> 4) & 0xfff) << 4;
+    unsigned i;
+
+    if (fm.wip && cmd != 0x05) {
+        fm.violations++;
+        return;
+    }
+
+    fm.core_busy = 2;
+    switch (cmd) {
+    case 0x06:
+        fm.wel = true;
+        break;
+    case 0x05:
+        fm.data = (fm.wip ? 1 : 0) | (fm.wel ? 2 : 0);
+        if (fm.wip)
+            fm.wip--;
+        break;
+    case 0x9F:
+        fm.data = 0x0019ba20;
+        break;
+    case 0x0B:
+        if (la + sz > QSPI_MMAP_LEN || fm.faddr + sz > FLASH_SIZE) {
+            fm.violations++;
+            break;
+        }
+        memcpy(fm.local + la, fm.flash + fm.faddr, sz);
+        break;
+    case 0x02:
+        if (!fm.wel || la + sz > QSPI_MMAP_LEN || (fm.faddr & 0xff) + sz > 256) {
+            fm.violations++;
+            break;
+        }
+        for (i = 0; i < sz; i++) {
+            fm.flash[fm.faddr + i] &= fm.local[la + i];
+        }
+        fm.programs++;
+        fm.wip = fm.wip_polls;
+        fm.wel = false;
+        break;
+    case 0x20:
+    case 0xD8:
+    case 0xC7: {
+        uint32_t esz = (cmd == 0x20) ? 0x1000 : (cmd == 0xD8) ? 0x10000 : FLASH_SIZE;
+        uint32_t addr = (cmd == 0xC7) ? 0 : fm.faddr & ~(esz - 1);
+        if (!fm.wel) {
+            fm.violations++;
+            break;
+        }
+        if (fm.erases++ == 0)
+            fm.first_erase = addr;
+        memset(fm.flash + addr, 0xff, esz);
+        fm.wip = fm.wip_polls;
+        fm.wel = false;
+        break;
+    }
+    default:
+        fm.violations++;
+    }
+}
+
+static int fm_reg_wr32(unsigned addr, uint32_t dout)
+{
+    if (addr >= QSPI_MMAP && addr < QSPI_MMAP + QSPI_MMAP_LEN / 4) {
+        if (fm.core_busy)
+            fm.violations++;
+        if (fm.wip)
+            fm.uploads_in_wip++;
+
+        memcpy(fm.local + 4 * (addr - QSPI_MMAP), &dout, 4);
+    } else if (addr == QSPI_BASE) {
+        fm_flash_cmd(dout);
+    } else if (addr == QSPI_BASE + 1) {
+        fm.faddr = dout;
+    }
+    return 0;
+}
+
+static int fm_reg_rd32(unsigned addr, uint32_t* din)
+{
+    if (addr >= QSPI_MMAP && addr < QSPI_MMAP + QSPI_MMAP_LEN / 4) {
+        memcpy(din, fm.local + 4 * (addr - QSPI_MMAP), 4);
+    } else if (addr == QSPI_BASE) {
+        *din = fm.core_busy ? 1 : 0;
+        if (fm.core_busy)
+            fm.core_busy--;
+    } else if (addr == QSPI_BASE + 1) {
+        *din = fm.data;
+    }
+    return 0;
+}
+
+static const struct mock_functions s_flash_model = {
+    NULL,
+    fm_reg_wr32,
+    fm_reg_rd32,
+};
+
+static lldev_t dev;
+
+static void fm_reset_counters(void)
+{
+    fm.erases = 0;
+    fm.programs = 0;
+    fm.uploads_in_wip = 0;
+    fm.violations = 0;
+}
+
+static void setup(void)
+{
+    memset(&fm, 0, sizeof(fm));
+    memset(fm.flash, 0x5a, sizeof(fm.flash));
+    fm.wip_polls = 2;
+
+    for (unsigned i = 0; i < IMAGE_SIZE; i++) {
+        image[i] = (uint8_t)(i * 7 + (i >> 8));
+    }
+
+    dev = mock_lowlevel_create(&s_flash_model);
+}
+
+static void teardown(void)
+{
+    lowlevel_destroy(dev);
+}
+
+START_TEST(espi_flash_write_pipelined) {
+    int res = espi_flash_write(dev, 0, QSPI_BASE, QSPI_MMAP, image, IMAGE_SIZE, IMAGE_OFF, 0);
+    ck_assert_int_eq(res, 0);
+    ck_assert_int_eq(fm.violations, 0);
+    ck_assert_int_eq(fm.erases, IMAGE_SIZE / 0x10000);
+    ck_assert_int_eq(fm.programs, IMAGE_SIZE / 128);
+    ck_assert_mem_eq(fm.flash + IMAGE_OFF, image, IMAGE_SIZE);
+
+    // Every block but the first is uploaded while the previous page is programmed
+    ck_assert_int_eq(fm.uploads_in_wip, (IMAGE_SIZE / 128 - 1) * 128 / 4);
+
+    res = espi_flash_read(dev, 0, QSPI_BASE, QSPI_MMAP, IMAGE_OFF, IMAGE_SIZE, readback);
+    ck_assert_int_eq(res, 0);
+    ck_assert_mem_eq(readback, image, IMAGE_SIZE);
+}
+END_TEST
+
+START_TEST(espi_flash_skip_equal) {
+    int res = espi_flash_write(dev, 0, QSPI_BASE, QSPI_MMAP, image, IMAGE_SIZE, IMAGE_OFF,
+                               ESPI_FLASH_SKIP_EQUAL);
+    ck_assert_int_eq(res, 0);
+    ck_assert_int_eq(fm.erases, 2);
+    ck_assert_mem_eq(fm.flash + IMAGE_OFF, image, IMAGE_SIZE);
+
+    fm_reset_counters();
+    res = espi_flash_write(dev, 0, QSPI_BASE, QSPI_MMAP, image, IMAGE_SIZE, IMAGE_OFF,
+                           ESPI_FLASH_SKIP_EQUAL);
+    ck_assert_int_eq(res, 0);
+    ck_assert_int_eq(fm.erases, 0);
+    ck_assert_int_eq(fm.programs, 0);
+
+    image[0x10000 + 77] ^= 0x40;
+    fm_reset_counters();
+    res = espi_flash_write(dev, 0, QSPI_BASE, QSPI_MMAP, image, IMAGE_SIZE, IMAGE_OFF,
+                           ESPI_FLASH_SKIP_EQUAL);
+    ck_assert_int_eq(res, 0);
+    ck_assert_int_eq(fm.violations, 0);
+    ck_assert_int_eq(fm.erases, 1);
+    ck_assert_int_eq(fm.first_erase, IMAGE_OFF + 0x10000);
+    ck_assert_int_eq(fm.programs, 0x10000 / 128);
+    ck_assert_mem_eq(fm.flash + IMAGE_OFF, image, IMAGE_SIZE);
+}
+END_TEST
+
+START_TEST(espi_flash_skip_header) {
+    const unsigned body_flags = ESPI_FLASH_DONT_WRITE_HEADER | ESPI_FLASH_SKIP_EQUAL;
+    const unsigned hdr_flags = ESPI_FLASH_DONT_ERASE | ESPI_FLASH_SKIP_EQUAL;
+
+    int res = espi_flash_write(dev, 0, QSPI_BASE, QSPI_MMAP, image, IMAGE_SIZE, IMAGE_OFF, body_flags);
+    ck_assert_int_eq(res, 0);
+    ck_assert_uint_eq(fm.flash[IMAGE_OFF], 0xff);
+    res = espi_flash_write(dev, 0, QSPI_BASE, QSPI_MMAP, image, 256, IMAGE_OFF, hdr_flags);
+    ck_assert_int_eq(res, 0);
+    ck_assert_mem_eq(fm.flash + IMAGE_OFF, image, IMAGE_SIZE);
+
+    // Same header but new body, header has to be invalidated first
+    image[IMAGE_SIZE - 1] ^= 0x01;
+    fm_reset_counters();
+    res = espi_flash_write(dev, 0, QSPI_BASE, QSPI_MMAP, image, IMAGE_SIZE, IMAGE_OFF, body_flags);
+    ck_assert_int_eq(res, 0);
+    ck_assert_int_eq(fm.violations, 0);
+    ck_assert_int_eq(fm.erases, 2);
+    ck_assert_int_eq(fm.first_erase, IMAGE_OFF);
+    ck_assert_uint_eq(fm.flash[IMAGE_OFF], 0xff);
+
+    res = espi_flash_write(dev, 0, QSPI_BASE, QSPI_MMAP, image, 256, IMAGE_OFF, hdr_flags);
+    ck_assert_int_eq(res, 0);
+    ck_assert_mem_eq(fm.flash + IMAGE_OFF, image, IMAGE_SIZE);
+}
+END_TEST
+
+START_TEST(espi_flash_wip_timeout) {
+    fm.wip_polls = ~0u;
+
+    int res = espi_flash_write(dev, 0, QSPI_BASE, QSPI_MMAP, image, 256, IMAGE_OFF,
+                               ESPI_FLASH_DONT_ERASE);
+    ck_assert_int_eq(res, -ETIMEDOUT);
+    ck_assert_int_eq(fm.programs, 1);
+}
+END_TEST
+
+Suite * espi_flash_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("espi_flash");
+    tc_core = tcase_create("Core");
+    tcase_set_timeout(tc_core, 30);
+    tcase_add_checked_fixture(tc_core, setup, teardown);
+
+    tcase_add_test(tc_core, espi_flash_write_pipelined);
+    tcase_add_test(tc_core, espi_flash_skip_equal);
+    tcase_add_test(tc_core, espi_flash_skip_header);
+    tcase_add_test(tc_core, espi_flash_wip_timeout);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
@@ -0,0 +1,101 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#include <check.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <usdr_logging.h>
+
+static unsigned s_lines;
+static char s_last[256];
+static unsigned s_saved_level;
+
+static int count_log_op(uintptr_t param, unsigned sevirity, const char* log)
+{
+    s_lines++;
+    strncpy(s_last, log, sizeof(s_last) - 1);
+    return 0;
+}
+
+static void setup(void)
+{
+    s_saved_level = usdrlog_getlevel(NULL);
+    s_lines = 0;
+    s_last[0] = 0;
+    usdrlog_set_log_op(&count_log_op);
+}
+
+static void teardown(void)
+{
+    usdrlog_set_log_op(NULL);
+    usdrlog_setlevel(NULL, s_saved_level);
+}
+
+static void log_from(const char* subsystem, unsigned level)
+{
+    if (strcmp(subsystem, "TLMS") == 0) {
+        USDR_LOG("TLMS", level, "lms message\n");
+    } else {
+        USDR_LOG("TSTR", level, "stream message\n");
+    }
+}
+
+START_TEST(logging_per_subsystem) {
+    usdrlog_setlevel(NULL, USDR_LOG_WARNING);
+    usdrlog_setlevel("TLMS", USDR_LOG_DEBUG);
+
+    log_from("TLMS", USDR_LOG_DEBUG);
+    log_from("TSTR", USDR_LOG_DEBUG);
+    ck_assert_int_eq(s_lines, 1);
+    ck_assert_ptr_ne(strstr(s_last, "lms message"), NULL);
+
+    // Explicit levels aren't touched by the default level
+    usdrlog_setlevel(NULL, USDR_LOG_ERROR);
+    ck_assert_int_eq(usdrlog_getlevel("TLMS"), USDR_LOG_DEBUG);
+    ck_assert_int_eq(usdrlog_getlevel("TSTR"), USDR_LOG_ERROR);
+    ck_assert_int_eq(usdrlog_getlevel("TNEW"), USDR_LOG_ERROR);
+
+    log_from("TSTR", USDR_LOG_WARNING);
+    log_from("TLMS", USDR_LOG_TRACE);
+    ck_assert_int_eq(s_lines, 1);
+
+    usdrlog_setlevel(NULL, USDR_LOG_TRACE);
+    log_from("TSTR", USDR_LOG_TRACE);
+    ck_assert_int_eq(s_lines, 2);
+    ck_assert_ptr_ne(strstr(s_last, "stream message"), NULL);
+
+    usdrlog_setlevel("TLMS", USDR_LOG_ERROR);
+}
+END_TEST
+
+START_TEST(logging_spec) {
+    ck_assert_int_eq(usdrlog_setlevels("2:TLMS=debug;TSTR=4"), 0);
+    ck_assert_int_eq(usdrlog_getlevel(NULL), USDR_LOG_WARNING);
+    ck_assert_int_eq(usdrlog_getlevel("TLMS"), USDR_LOG_DEBUG);
+    ck_assert_int_eq(usdrlog_getlevel("TSTR"), USDR_LOG_NOTE);
+
+    ck_assert_int_eq(usdrlog_setlevels("TLMS=verbose,1"), -EINVAL);
+    ck_assert_int_eq(usdrlog_getlevel("TLMS"), USDR_LOG_DEBUG);
+    ck_assert_int_eq(usdrlog_getlevel(NULL), USDR_LOG_CRITICAL_WARNING);
+    ck_assert_int_eq(usdrlog_setlevels(NULL), -EINVAL);
+
+    usdrlog_setlevels("TLMS=0,TSTR=0");
+}
+END_TEST
+
+Suite * logging_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("logging");
+    tc_core = tcase_create("Core");
+    tcase_add_checked_fixture(tc_core, setup, teardown);
+
+    tcase_add_test(tc_core, logging_per_subsystem);
+    tcase_add_test(tc_core, logging_spec);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
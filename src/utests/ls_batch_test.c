@@ -0,0 +1,136 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mock_lowlevel.h"
+
+#define MAX_LOG 256
+
+static uint32_t spi_log[MAX_LOG];
+static unsigned spi_log_cnt;
+
+static int spi_tr32_logger(unsigned busno, uint32_t dout, uint32_t* din)
+{
+    if (spi_log_cnt >= MAX_LOG)
+        return -EOVERFLOW;
+
+    spi_log[spi_log_cnt++] = dout;
+    *din = (busno << 24) | (dout >> 16);
+    return 0;
+}
+
+static const struct mock_functions s_logger = {
+    spi_tr32_logger,
+};
+
+static lldev_t dev;
+
+static void setup(void)
+{
+    spi_log_cnt = 0;
+    dev = mock_lowlevel_create(&s_logger);
+}
+
+static void teardown(void)
+{
+    lowlevel_destroy(dev);
+}
+
+START_TEST(ls_batch_spi_post) {
+    struct mock_lowlevel_dev* mld = (struct mock_lowlevel_dev*)dev;
+    uint32_t regs[100];
+
+    for (unsigned i = 0; i < SIZEOF_ARRAY(regs); i++) {
+        regs[i] = 0x80000000 | (i << 16) | (i * 3);
+    }
+
+    int res = lowlevel_spi_post32(dev, 0, 1, regs, SIZEOF_ARRAY(regs));
+    ck_assert_int_eq(res, 0);
+    ck_assert_int_eq(spi_log_cnt, SIZEOF_ARRAY(regs));
+    ck_assert_mem_eq(spi_log, regs, sizeof(regs));
+
+    // 100 words are split into 32 + 32 + 32 + 4
+    ck_assert_int_eq(mld->ls_batches, 4);
+}
+END_TEST
+
+START_TEST(ls_batch_readback) {
+    struct mock_lowlevel_dev* mld = (struct mock_lowlevel_dev*)dev;
+    const uint32_t wr[3] = { 0x80010005, 0x00020000, 0x00030000 };
+    uint32_t rd[3] = { 0, 0, 0 };
+    uint32_t hwreg = 0;
+    lowlevel_ls_batch_op_t ops[] = {
+        { USDR_LSOP_SPI,   2, 0, 4, NULL,   &wr[0] },
+        { USDR_LSOP_SPI,   2, 4, 4, &rd[1], &wr[1] },
+        { USDR_LSOP_HWREG, 7, 4, 0, &hwreg, NULL   },
+        { USDR_LSOP_SPI,   3, 4, 4, &rd[2], &wr[2] },
+    };
+
+    int res = lowlevel_ls_batch(dev, 0, ops, SIZEOF_ARRAY(ops));
+    ck_assert_int_eq(res, 0);
+    ck_assert_int_eq(mld->ls_batches, 1);
+    ck_assert_int_eq(spi_log_cnt, 3);
+    ck_assert_uint_eq(rd[0], 0);
+    ck_assert_uint_eq(rd[1], 0x02000002);
+    ck_assert_uint_eq(rd[2], 0x03000003);
+    ck_assert_uint_eq(hwreg, ~0u);
+}
+END_TEST
+
+START_TEST(ls_batch_fallback) {
+    struct mock_lowlevel_dev* mld = (struct mock_lowlevel_dev*)dev;
+    struct lowlevel_ops ops_noseq;
+    struct lowlevel_ops* ops_orig = lowlevel_get_ops(dev);
+    uint32_t regs[40];
+
+    memcpy(&ops_noseq, ops_orig, sizeof(ops_noseq));
+    ops_noseq.ls_batch = NULL;
+    mld->base.ops = &ops_noseq;
+
+    for (unsigned i = 0; i < SIZEOF_ARRAY(regs); i++) {
+        regs[i] = (i << 16) | i;
+    }
+
+    int res = lowlevel_spi_post32(dev, 0, 0, regs, SIZEOF_ARRAY(regs));
+    ck_assert_int_eq(res, 0);
+    ck_assert_int_eq(mld->ls_batches, 0);
+    ck_assert_int_eq(spi_log_cnt, SIZEOF_ARRAY(regs));
+    ck_assert_mem_eq(spi_log, regs, sizeof(regs));
+
+    mld->base.ops = ops_orig;
+}
+END_TEST
+
+START_TEST(ls_batch_error) {
+    const uint32_t wr = 0x00010000;
+    lowlevel_ls_batch_op_t ops[] = {
+        { USDR_LSOP_SPI, 0, 0, 4, NULL, &wr },
+        { USDR_LSOP_SPI, 0, 0, 2, NULL, &wr },
+        { USDR_LSOP_SPI, 0, 0, 4, NULL, &wr },
+    };
+
+    int res = lowlevel_ls_batch(dev, 0, ops, SIZEOF_ARRAY(ops));
+    ck_assert_int_eq(res, -EINVAL);
+    ck_assert_int_eq(spi_log_cnt, 1);
+}
+END_TEST
+
+Suite * ls_batch_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("ls_batch");
+    tc_core = tcase_create("Core");
+    tcase_add_checked_fixture(tc_core, setup, teardown);
+
+    tcase_add_test(tc_core, ls_batch_spi_post);
+    tcase_add_test(tc_core, ls_batch_readback);
+    tcase_add_test(tc_core, ls_batch_fallback);
+    tcase_add_test(tc_core, ls_batch_error);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
@@ -2,6 +2,8 @@
 // SPDX-License-Identifier: MIT
 
 #include "mock_lowlevel.h"
+#include "../lib/device/device_bus.h"
+#include "../lib/lowlevel/lowlevel_async.h"
 #include <usdr_logging.h>
 #include <stdlib.h>
 #include <string.h>
@@ -30,11 +32,21 @@ int mock_ls_op(UNUSED lldev_t dev, UNUSED subdev_t subdev,
 
         // Normal operation
         for (i = 0; i < memoutsz / 4; i++) {
+            if (mld->mock_func->mock_reg_wr32) {
+                int res = mld->mock_func->mock_reg_wr32(ls_op_addr + i, outa[i]);
+                if (res)
+                    return res;
+            }
             USDR_LOG("MOCK", USDR_LOG_TRACE, "Write[%d] <= %08x\n",
                      ls_op_addr + i, outa[i]);
         }
         for (i = 0; i < meminsz / 4; i++) {
             ina[i] = ~0u;
+            if (mld->mock_func->mock_reg_rd32) {
+                int res = mld->mock_func->mock_reg_rd32(ls_op_addr + i, &ina[i]);
+                if (res)
+                    return res;
+            }
             USDR_LOG("MOCK", USDR_LOG_TRACE, "Read [%d] => %08x\n",
                      ls_op_addr + i, ina[i]);
         }
@@ -74,6 +86,12 @@ int mock_ls_op(UNUSED lldev_t dev, UNUSED subdev_t subdev,
         memcpy(pin, &i2cin, meminsz);
         return 0;
     }
+    case USDR_LSOP_DRP: {
+        if (mld->db == NULL)
+            return -EOPNOTSUPP;
+
+        return device_bus_drp_generic_op(dev, subdev, mld->db, ls_op_addr, meminsz, pin, memoutsz, pout);
+    }
     }
     return -EOPNOTSUPP;
 }
@@ -126,20 +144,42 @@ int mock_send_buf(lldev_t dev, subdev_t subdev, stream_t channel, void* buffer,
     return -EOPNOTSUPP;
 }
 
-// TODO Async operations
 static
 int mock_await(lldev_t dev, subdev_t subdev, unsigned await_id, unsigned op, void** await_inout_aux_data, unsigned timeout)
 {
-    return -EOPNOTSUPP;
+    struct mock_lowlevel_dev* mld = (struct mock_lowlevel_dev*)dev;
+    if (mld->async == NULL)
+        return -EOPNOTSUPP;
+
+    return lowlevel_async_await(mld->async, subdev, await_id, op, await_inout_aux_data, timeout);
 }
 
 static
 int mock_destroy(lldev_t dev)
 {
+    struct mock_lowlevel_dev* mld = (struct mock_lowlevel_dev*)dev;
+    lowlevel_async_destroy(mld->async);
     free(dev);
     return 0;
 }
 
+// Host side emulation of the FPGA sequencer, ops are executed back to back
+static
+int mock_ls_batch(lldev_t dev, subdev_t subdev, lowlevel_ls_batch_op_t* ops, unsigned count)
+{
+    struct mock_lowlevel_dev* mld = (struct mock_lowlevel_dev*)dev;
+    for (unsigned i = 0; i < count; i++) {
+        int res = mock_ls_op(dev, subdev, ops[i].ls_op, ops[i].ls_op_addr,
+                             ops[i].meminsz, ops[i].pin, ops[i].memoutsz, ops[i].pout);
+        if (res)
+            return res;
+    }
+
+    mld->ls_batches++;
+    USDR_LOG("MOCK", USDR_LOG_TRACE, "Batch of %d ops completed\n", count);
+    return 0;
+}
+
 static
 struct lowlevel_ops s_mock_ops = {
     mock_generic_get,
@@ -154,6 +194,7 @@ struct lowlevel_ops s_mock_ops = {
     mock_send_buf,
     mock_await,
     mock_destroy,
+    mock_ls_batch,
 };
 
 lldev_t mock_lowlevel_create(const struct mock_functions *mf)
@@ -162,5 +203,9 @@ lldev_t mock_lowlevel_create(const struct mock_functions *mf)
     mld->base.ops = &s_mock_ops;
     mld->base.pdev = NULL;
     mld->mock_func = mf;
+    mld->ls_batches = 0;
+    mld->db = NULL;
+    if (lowlevel_async_create(&mld->base, LOWLEVEL_ASYNC_LANES, &mld->async))
+        mld->async = NULL;
     return &mld->base;
 }
@@ -8,14 +8,26 @@
 
 struct mock_functions {
     int (*mock_spi_tr32)(unsigned busno, uint32_t dout, uint32_t* din);
+    int (*mock_reg_wr32)(unsigned addr, uint32_t dout);
+    int (*mock_reg_rd32)(unsigned addr, uint32_t* din);
 };
 
+struct device_bus;
+struct lowlevel_async;
+
 // Create dummy device for unit tests
 lldev_t mock_lowlevel_create(const struct mock_functions *mf);
 
 struct mock_lowlevel_dev {
     struct lowlevel_dev base;
     const struct mock_functions *mock_func;
+    unsigned ls_batches;
+
+    // Bus description for DRP/GPI/GPO generic ops, NULL if not used
+    const struct device_bus* db;
+
+    // Async ls_op executor, mock functions are called from its lane threads
+    struct lowlevel_async* async;
 };
 
 #endif
@@ -0,0 +1,136 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../lib/models/dm_dev.h"
+#include "../lib/models/dm_stream.h"
+#include "streams_api.h"
+
+#define PKT_SYMS  65536
+#define MAX_BRST  64
+
+static pdm_dev_t dev;
+static pusdr_dms_t strm;
+static usdr_dms_nfo_t snfo;
+static void* buffs[1];
+
+static void setup(void)
+{
+    unsigned ch[1] = { 0 };
+    usdr_channel_info_t ci = { 1, 0, NULL, ch };
+    unsigned rates[4] = { 50000000, 50000000, 0, 0 };
+
+    // Synthetic device drops every 7th RX buffer
+    ck_assert_int_eq(usdr_dmd_create_string("bus=synth,synthovf=7", &dev), 0);
+    ck_assert_int_eq(usdr_dme_set_uint(dev, "/dm/rate/rxtxadcdac", (uintptr_t)rates), 0);
+    ck_assert_int_eq(usdr_dms_create_ex2(dev, "/ll/srx/0", "ci16", &ci, PKT_SYMS, 0, NULL, &strm), 0);
+    ck_assert_int_eq(usdr_dms_info(strm, &snfo), 0);
+    buffs[0] = malloc(snfo.pktbszie);
+
+    usdr_dms_sync(dev, "off", 1, &strm);
+    ck_assert_int_eq(usdr_dms_op(strm, USDR_DMS_START, 0), 0);
+    usdr_dms_sync(dev, "none", 1, &strm);
+}
+
+static void teardown(void)
+{
+    usdr_dms_destroy(strm);
+    usdr_dmd_close(dev);
+    free(buffs[0]);
+}
+
+START_TEST(stream_bursts_walk) {
+    usdr_dms_burst_nfo_t b[MAX_BRST];
+    usdr_dms_recv_nfo_t rn;
+    uint64_t next = 0;
+    unsigned n, gaps = 0;
+
+    ck_assert_uint_gt(snfo.burst_count, 1);
+
+    for (unsigned i = 0; i < 20; i++) {
+        ck_assert_int_eq(usdr_dms_recv_ex(strm, buffs, 1000, &rn, b, MAX_BRST, &n), 0);
+        ck_assert_uint_eq(n, snfo.burst_count);
+        ck_assert_uint_eq(b[0].time, rn.fsymtime);
+
+        for (unsigned k = 0; k < n; k++) {
+            ck_assert_uint_eq(b[k].offset, k * (PKT_SYMS / n));
+            ck_assert_uint_eq(b[k].samples, PKT_SYMS / n);
+            ck_assert_uint_eq(b[k].time, next + b[k].lost);
+            ck_assert_int_eq((b[k].flags & USDR_DMS_BURST_GAP) != 0, b[k].lost != 0);
+            ck_assert_int_eq(b[k].flags & USDR_DMS_BURST_PARTIAL, 0);
+            if (b[k].lost) {
+                ck_assert_uint_eq(k, 0);
+                ck_assert_uint_eq(b[k].lost % PKT_SYMS, 0);
+                gaps++;
+            }
+            next = b[k].time + b[k].samples;
+        }
+    }
+    ck_assert_uint_gt(gaps, 0);
+
+    // Side buffer smaller than the burst count
+    ck_assert_int_eq(usdr_dms_recv_ex(strm, buffs, 1000, NULL, b, 2, &n), 0);
+    ck_assert_uint_eq(n, 2);
+}
+END_TEST
+
+// Stream without recv_bursts(), takes the generic single burst path
+static int fake_recv(stream_handle_t* stream, char **stream_buffs, unsigned timeout_ms,
+                     struct usdr_dms_recv_nfo* nfo)
+{
+    nfo->fsymtime = 4096;
+    nfo->totsyms = 1024;
+    nfo->totlost = 0;
+    return 0;
+}
+
+START_TEST(stream_bursts_null) {
+    usdr_dms_burst_nfo_t b[MAX_BRST];
+    stream_ops_t fake_ops;
+    stream_handle_t fake;
+    unsigned n;
+
+    // Burst reporting stream
+    ck_assert_int_eq(usdr_dms_recv_ex(strm, buffs, 1000, NULL, NULL, 0, NULL), 0);
+    ck_assert_int_eq(usdr_dms_recv_ex(strm, buffs, 1000, NULL, b, MAX_BRST, NULL), 0);
+    n = ~0u;
+    ck_assert_int_eq(usdr_dms_recv_ex(strm, buffs, 1000, NULL, NULL, MAX_BRST, &n), 0);
+    ck_assert_uint_eq(n, 0);
+
+    // Generic fallback behaves the same
+    memset(&fake_ops, 0, sizeof(fake_ops));
+    fake_ops.recv = fake_recv;
+    fake.dev = NULL;
+    fake.ops = &fake_ops;
+
+    ck_assert_int_eq(usdr_dms_recv_ex((pusdr_dms_t)&fake, buffs, 1000, NULL, NULL, 0, NULL), 0);
+    ck_assert_int_eq(usdr_dms_recv_ex((pusdr_dms_t)&fake, buffs, 1000, NULL, b, MAX_BRST, NULL), 0);
+    n = ~0u;
+    ck_assert_int_eq(usdr_dms_recv_ex((pusdr_dms_t)&fake, buffs, 1000, NULL, NULL, MAX_BRST, &n), 0);
+    ck_assert_uint_eq(n, 0);
+
+    ck_assert_int_eq(usdr_dms_recv_ex((pusdr_dms_t)&fake, buffs, 1000, NULL, b, MAX_BRST, &n), 0);
+    ck_assert_uint_eq(n, 1);
+    ck_assert_uint_eq(b[0].time, 4096);
+    ck_assert_uint_eq(b[0].samples, 1024);
+}
+END_TEST
+
+Suite * stream_bursts_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("stream_bursts");
+    tc_core = tcase_create("Core");
+    tcase_add_checked_fixture(tc_core, setup, teardown);
+    tcase_set_timeout(tc_core, 30);
+
+    tcase_add_test(tc_core, stream_bursts_walk);
+    tcase_add_test(tc_core, stream_bursts_null);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
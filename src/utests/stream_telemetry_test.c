@@ -0,0 +1,124 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "stream_telemetry.h"
+
+START_TEST(telemetry_buckets) {
+    unsigned prev = 0;
+
+    ck_assert_int_eq(stream_telemetry_bucket(0), 0);
+    ck_assert_int_eq(stream_telemetry_bucket(255), 3);
+    ck_assert_int_eq(stream_telemetry_bucket(UINT64_MAX), USDR_DMS_HIST_BUCKETS - 1);
+
+    // Monotonic and every value is below the top of its bucket
+    for (uint64_t ns = 1; ns < 4000000000ull; ns += ns / 7 + 1) {
+        unsigned idx = stream_telemetry_bucket(ns);
+        ck_assert_uint_ge(idx, prev);
+        ck_assert_uint_lt(ns, stream_telemetry_bucket_top(idx));
+        if (idx > 0) {
+            ck_assert_uint_ge(ns, stream_telemetry_bucket_top(idx - 1));
+        }
+        prev = idx;
+    }
+
+    // Relative bucket width stays within 25% above the linear part
+    for (unsigned i = 5; i < USDR_DMS_HIST_BUCKETS - 1; i++) {
+        uint64_t lo = stream_telemetry_bucket_top(i - 1);
+        uint64_t hi = stream_telemetry_bucket_top(i);
+        ck_assert_uint_le((hi - lo) * 4, lo);
+    }
+}
+END_TEST
+
+START_TEST(telemetry_percentile) {
+    struct usdr_dms_histogram h;
+    memset(&h, 0, sizeof(h));
+    ck_assert_uint_eq(stream_telemetry_percentile(&h, 50), 0);
+
+    stream_telemetry_t t;
+    stream_telemetry_init(&t);
+    for (unsigned i = 0; i < 990; i++) {
+        stream_telemetry_hist_add(&t.d.call_latency, 10000);
+    }
+    for (unsigned i = 0; i < 10; i++) {
+        stream_telemetry_hist_add(&t.d.call_latency, 3000000);
+    }
+
+    uint64_t p50 = stream_telemetry_percentile(&t.d.call_latency, 50);
+    uint64_t p99 = stream_telemetry_percentile(&t.d.call_latency, 99);
+    uint64_t p999 = stream_telemetry_percentile(&t.d.call_latency, 99.9);
+    ck_assert_uint_gt(p50, 10000);
+    ck_assert_uint_le(p50, 12500);
+    ck_assert_uint_eq(p99, p50);
+    ck_assert_uint_eq(p999, 3000000);
+    ck_assert_uint_eq(t.d.call_latency.count, 1000);
+    ck_assert_uint_eq(t.d.call_latency.max_ns, 3000000);
+}
+END_TEST
+
+static stream_telemetry_t s_tm;
+static bool s_stop;
+
+static void* writer_thread(void* arg)
+{
+    for (uint64_t i = 1; !__atomic_load_n(&s_stop, __ATOMIC_RELAXED); i++) {
+        stream_telemetry_begin(&s_tm);
+        STM_ADD(&s_tm, calls, 1);
+        STM_ADD(&s_tm, packets, 1);
+        STM_SET(&s_tm, last_overrun_ns, i);
+        stream_telemetry_hist_add(&s_tm.d.call_latency, i & 0xfffff);
+        stream_telemetry_end(&s_tm);
+    }
+    return NULL;
+}
+
+START_TEST(telemetry_snapshot_consistent) {
+    pthread_t thr;
+    usdr_dms_telemetry_t snap;
+    uint64_t last = 0;
+
+    stream_telemetry_init(&s_tm);
+    s_stop = false;
+    ck_assert_int_eq(pthread_create(&thr, NULL, writer_thread, NULL), 0);
+
+    for (unsigned k = 0; k < 20000; k++) {
+        uint64_t sum = 0;
+        ck_assert_int_eq(stream_telemetry_snapshot(&s_tm, &snap), 0);
+
+        ck_assert_uint_eq(snap.calls, snap.packets);
+        ck_assert_uint_eq(snap.calls, snap.last_overrun_ns);
+        ck_assert_uint_eq(snap.calls, snap.call_latency.count);
+        for (unsigned i = 0; i < USDR_DMS_HIST_BUCKETS; i++) {
+            sum += snap.call_latency.buckets[i];
+        }
+        ck_assert_uint_eq(sum, snap.call_latency.count);
+        ck_assert_uint_ge(snap.calls, last);
+        ck_assert_uint_ne(snap.snap_ns, 0);
+        last = snap.calls;
+    }
+
+    __atomic_store_n(&s_stop, true, __ATOMIC_RELAXED);
+    pthread_join(thr, NULL);
+    ck_assert_uint_gt(last, 0);
+}
+END_TEST
+
+Suite * stream_telemetry_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("stream_telemetry");
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, telemetry_buckets);
+    tcase_add_test(tc_core, telemetry_percentile);
+    tcase_add_test(tc_core, telemetry_snapshot_consistent);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
@@ -0,0 +1,118 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../lib/models/dm_dev.h"
+#include "../lib/models/dm_stream.h"
+
+#define PKT_SYMS  4096
+#define RATE      1000000
+
+static pdm_dev_t dev;
+
+static void setup(void)
+{
+    ck_assert_int_eq(usdr_dmd_create_string("bus=synth", &dev), 0);
+}
+
+static void teardown(void)
+{
+    usdr_dmd_close(dev);
+}
+
+START_TEST(synth_device_params) {
+    uint64_t v;
+
+    // Same set usdr_dm_create applies with default options
+    const struct dme_findsetv_data dev_data[] = {
+        { "rx/freqency", 900e6, false, true },
+        { "tx/freqency", 920e6, false, true },
+        { "tdd/freqency", 910e6, false, true },
+        { "rx/bandwidth", 1e6, false, true },
+        { "tx/bandwidth", 1e6, false, true },
+        { "rx/gain/vga", 15, false, true },
+        { "rx/gain/pga", 15, false, true },
+        { "rx/gain/lna", 15, false, true },
+        { "tx/gain", 0, false, true },
+        { "rx/path", (uintptr_t)"rx_auto", false, true },
+        { "tx/path", (uintptr_t)"tx_auto", false, true },
+    };
+    ck_assert_int_eq(usdr_dme_findsetv_uint(dev, "/dm/sdr/0/", SIZEOF_ARRAY(dev_data), dev_data), 0);
+
+    ck_assert_int_eq(usdr_dme_get_uint(dev, "/dm/sensor/temp", &v), 0);
+    ck_assert_uint_eq(v, 25 * 256);
+
+    ck_assert_int_eq(usdr_dme_set_string(dev, "/dm/sdr/refclk/path", "external"), 0);
+    ck_assert_int_eq(usdr_dme_set_uint(dev, "/dm/sdr/refclk/frequency", 10000000), 0);
+    ck_assert_int_eq(usdr_dme_get_uint(dev, "/dm/sdr/refclk/frequency", &v), 0);
+    ck_assert_uint_eq(v, 10000000);
+
+    ck_assert_int_eq(usdr_dme_set_uint(dev, "/dm/sdr/0/calibrate", 1), 0);
+    ck_assert_int_eq(usdr_dme_get_uint(dev, "/dm/debug/all", &v), 0);
+
+    ck_assert_int_ne(usdr_dme_set_uint(dev, "/dm/sdr/0/rx/nonexistent", 1), 0);
+}
+END_TEST
+
+START_TEST(synth_device_rxtx) {
+    unsigned ch[1] = { 0 };
+    usdr_channel_info_t ci = { 1, 0, NULL, ch };
+    unsigned rates[4] = { RATE, RATE, 0, 0 };
+    pusdr_dms_t strms[2];
+    usdr_dms_nfo_t rnfo, tnfo;
+    usdr_dms_recv_nfo_t rn;
+    void* rbuf[1];
+    const void* tbuf[1];
+
+    ck_assert_int_eq(usdr_dme_set_uint(dev, "/dm/rate/rxtxadcdac", (uintptr_t)rates), 0);
+    ck_assert_int_eq(usdr_dms_create_ex2(dev, "/ll/srx/0", "ci16", &ci, PKT_SYMS, 0, NULL, &strms[0]), 0);
+    ck_assert_int_eq(usdr_dms_create_ex2(dev, "/ll/stx/0", "ci16", &ci, PKT_SYMS, 0, NULL, &strms[1]), 0);
+    ck_assert_int_eq(usdr_dms_info(strms[0], &rnfo), 0);
+    ck_assert_int_eq(usdr_dms_info(strms[1], &tnfo), 0);
+    ck_assert_uint_eq(rnfo.pktsyms, PKT_SYMS);
+    ck_assert_uint_eq(tnfo.pktsyms, PKT_SYMS);
+
+    rbuf[0] = malloc(rnfo.pktbszie);
+    tbuf[0] = calloc(1, tnfo.pktbszie);
+
+    ck_assert_int_eq(usdr_dms_sync(dev, "off", 2, strms), 0);
+    ck_assert_int_eq(usdr_dms_op(strms[0], USDR_DMS_START, 0), 0);
+    ck_assert_int_eq(usdr_dms_op(strms[1], USDR_DMS_START, 0), 0);
+    ck_assert_int_eq(usdr_dms_sync(dev, "none", 2, strms), 0);
+
+    // Paced at the set rate without drops, timestamps are contiguous
+    for (unsigned i = 0; i < 16; i++) {
+        ck_assert_int_eq(usdr_dms_recv(strms[0], rbuf, 1000, &rn), 0);
+        ck_assert_uint_eq(rn.totlost, 0);
+        ck_assert_uint_eq(rn.fsymtime, (uint64_t)i * PKT_SYMS);
+
+        ck_assert_int_eq(usdr_dms_send(strms[1], tbuf, PKT_SYMS, (uint64_t)(i + 4) * PKT_SYMS, 1000), 0);
+    }
+
+    ck_assert_int_eq(usdr_dms_op(strms[1], USDR_DMS_STOP, 0), 0);
+    ck_assert_int_eq(usdr_dms_op(strms[0], USDR_DMS_STOP, 0), 0);
+    usdr_dms_destroy(strms[1]);
+    usdr_dms_destroy(strms[0]);
+    free(rbuf[0]);
+    free((void*)tbuf[0]);
+}
+END_TEST
+
+Suite * synth_device_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("synth_device");
+    tc_core = tcase_create("Core");
+    tcase_add_checked_fixture(tc_core, setup, teardown);
+    tcase_set_timeout(tc_core, 30);
+
+    tcase_add_test(tc_core, synth_device_params);
+    tcase_add_test(tc_core, synth_device_rxtx);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
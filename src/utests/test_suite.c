@@ -11,6 +11,21 @@
 Suite * ring_buffer_suite(void);
 Suite * trig_suite(void);
 Suite * clockgen_suite(void);
+Suite * ls_batch_suite(void);
+Suite * drp_suite(void);
+Suite * espi_flash_suite(void);
+Suite * async_suite(void);
+Suite * usb_depth_ctrl_suite(void);
+Suite * logging_suite(void);
+Suite * stream_telemetry_suite(void);
+Suite * dma_trace_suite(void);
+Suite * device_bringup_suite(void);
+Suite * usdr_time_suite(void);
+Suite * stream_bursts_suite(void);
+Suite * usb_uram_seq_suite(void);
+Suite * synth_device_suite(void);
+Suite * vll_ring_suite(void);
+Suite * usb_buffers_suite(void);
 
 int main(int argc, char** argv)
 {
@@ -28,6 +43,21 @@ int main(int argc, char** argv)
     sr = srunner_create(ring_buffer_suite());
     srunner_add_suite(sr, trig_suite());
     srunner_add_suite(sr, clockgen_suite());
+    srunner_add_suite(sr, ls_batch_suite());
+    srunner_add_suite(sr, drp_suite());
+    srunner_add_suite(sr, espi_flash_suite());
+    srunner_add_suite(sr, async_suite());
+    srunner_add_suite(sr, usb_depth_ctrl_suite());
+    srunner_add_suite(sr, logging_suite());
+    srunner_add_suite(sr, stream_telemetry_suite());
+    srunner_add_suite(sr, dma_trace_suite());
+    srunner_add_suite(sr, device_bringup_suite());
+    srunner_add_suite(sr, usdr_time_suite());
+    srunner_add_suite(sr, stream_bursts_suite());
+    srunner_add_suite(sr, usb_uram_seq_suite());
+    srunner_add_suite(sr, synth_device_suite());
+    srunner_add_suite(sr, vll_ring_suite());
+    srunner_add_suite(sr, usb_buffers_suite());
 
     srunner_run_all(sr, (argc > 1) ? CK_VERBOSE : CK_NORMAL);
     number_failed = srunner_ntests_failed(sr);
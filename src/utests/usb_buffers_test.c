@@ -0,0 +1,114 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "libusb_generic.h"
+
+#define TRANSFERS   4
+#define BUFFERS     8
+#define BLOCK_SZ    4096
+#define ROUNDS      5
+
+// No device behind: transfers are completed by hand the way the libusb
+// event thread does, resubmits are parked on the idle list (depth 0).
+static libusb_generic_dev_t s_gdev;
+static struct buffers s_rxb;
+
+static unsigned s_done_bno[TRANSFERS * ROUNDS];
+static unsigned s_done_sz[TRANSFERS * ROUNDS];
+static unsigned s_done;
+
+static void on_buffer(void* param, struct buffer_discriptor * bd)
+{
+    (void)param;
+    s_done_bno[s_done] = bd->bno;
+    s_done_sz[s_done] = bd->buffer_sz;
+    s_done++;
+}
+
+static void setup(void)
+{
+    memset(&s_gdev, 0, sizeof(s_gdev));
+    memset(&s_rxb, 0, sizeof(s_rxb));
+    s_gdev.rx_cfg.enabled = true;
+    s_gdev.rx_cfg.cpu = -1;
+    s_done = 0;
+
+    ck_assert_int_eq(buffers_usb_init(&s_gdev, &s_rxb, TRANSFERS, BUFFERS, BLOCK_SZ,
+                                      LIBUSB_ENDPOINT_IN | 1, false, true), 0);
+    s_rxb.auto_restart = true;
+    s_rxb.on_buffer = on_buffer;
+    s_rxb.transfers_depth = 0;
+}
+
+static void teardown(void)
+{
+    buffers_usb_free(&s_rxb);
+}
+
+static bool wait_idle(unsigned count)
+{
+    for (unsigned i = 0; i < 1000; i++) {
+        if (__atomic_load_n(&s_rxb.transfers_idle_cnt, __ATOMIC_SEQ_CST) == count)
+            return true;
+        usleep(1000);
+    }
+    return false;
+}
+
+START_TEST(usb_buffers_worker_rx) {
+    unsigned bno[TRANSFERS * ROUNDS];
+
+    ck_assert(s_rxb.worker_on);
+
+    for (unsigned r = 0; r < ROUNDS; r++) {
+        for (unsigned t = 0; t < TRANSFERS; t++) {
+            struct libusb_transfer *tr = s_rxb.transfers[t];
+            unsigned n = r * TRANSFERS + t;
+
+            // Buffer numbers run ahead of transfer slots and end up on the
+            // dummy buffer once the consumer falls behind
+            bno[n] = _buffers_prod_get_nolock(&s_rxb);
+            tr->user_data = &s_rxb.bd[bno[n]];
+            tr->status = LIBUSB_TRANSFER_COMPLETED;
+            tr->actual_length = 1024 + n;
+            __atomic_fetch_add(&s_rxb.transfers_inflight, 1, __ATOMIC_SEQ_CST);
+
+            libusb_transfer_buffers_cb(tr);
+        }
+
+        ck_assert(wait_idle(TRANSFERS));
+        for (unsigned t = 0; t < TRANSFERS; t++) {
+            ck_assert_uint_eq(s_rxb.transfers_idle[t], t);
+        }
+        s_rxb.transfers_idle_cnt = 0;
+    }
+
+    ck_assert_uint_eq(bno[BUFFERS], BUFFERS);
+    ck_assert_uint_eq(s_done, TRANSFERS * ROUNDS);
+    for (unsigned n = 0; n < TRANSFERS * ROUNDS; n++) {
+        ck_assert_uint_eq(s_done_bno[n], bno[n]);
+        ck_assert_uint_eq(s_done_sz[n], 1024 + n);
+    }
+    ck_assert_uint_eq(s_rxb.transfers_inflight, 0);
+}
+END_TEST
+
+Suite * usb_buffers_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("usb_buffers");
+    tc_core = tcase_create("Core");
+    tcase_add_checked_fixture(tc_core, setup, teardown);
+    tcase_set_timeout(tc_core, 10);
+
+    tcase_add_test(tc_core, usb_buffers_worker_rx);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
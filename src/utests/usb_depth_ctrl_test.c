@@ -0,0 +1,151 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+#include "usb_depth_ctrl.h"
+
+#define MAX_TRANSFERS 16
+
+// Fake completion source: the device fills one posted transfer every
+// period_us or loses the block when none is posted. The libusb event thread
+// reaps completions and resubmits unless it's stalled.
+struct fake_usb {
+    usb_depth_ctrl_t ctrl;
+    uint64_t now;
+    unsigned period_us;
+    unsigned stall_every_us;
+    unsigned stall_us;
+
+    unsigned posted;
+    unsigned idle;
+    unsigned completed;
+    unsigned ovf_pending;
+
+    unsigned overflows;
+    unsigned max_depth_seen;
+};
+
+static struct fake_usb fu;
+
+static void fake_usb_init(unsigned period_us, unsigned depth, unsigned latency_us)
+{
+    memset(&fu, 0, sizeof(fu));
+    fu.now = 1000000;
+    fu.period_us = period_us;
+    fu.posted = depth;
+    fu.idle = MAX_TRANSFERS - depth;
+    usb_depth_ctrl_init(&fu.ctrl, 2, MAX_TRANSFERS, depth, latency_us);
+}
+
+static bool fake_usb_stalled(void)
+{
+    return fu.stall_every_us && (fu.now % fu.stall_every_us) < fu.stall_us;
+}
+
+static void fake_usb_run(unsigned duration_us)
+{
+    uint64_t stop = fu.now + duration_us;
+    for (; fu.now < stop; fu.now += fu.period_us) {
+        if (fu.posted) {
+            fu.posted--;
+            fu.completed++;
+        } else {
+            fu.ovf_pending++;
+            fu.overflows++;
+        }
+
+        if (fake_usb_stalled())
+            continue;
+
+        // Same as _buffers_usb_depth_resubmit()
+        for (; fu.completed; fu.completed--) {
+            unsigned depth = usb_depth_ctrl_update(&fu.ctrl, fu.now, fu.ovf_pending);
+            fu.ovf_pending = 0;
+            if (depth > fu.max_depth_seen)
+                fu.max_depth_seen = depth;
+
+            fu.idle++;
+            while (fu.idle && fu.posted < depth) {
+                fu.idle--;
+                fu.posted++;
+            }
+        }
+    }
+}
+
+START_TEST(usb_depth_grows_on_stalls) {
+    // 50 MB/s of 8k transfers, event thread is stalled for 1ms every 20ms
+    fake_usb_init(160, 2, 10000);
+    fu.stall_every_us = 20000;
+    fu.stall_us = 1000;
+
+    fake_usb_run(1000000);
+    ck_assert_uint_ge(fu.ctrl.depth, 8);
+    ck_assert_uint_ge(fu.ctrl.grows, 1);
+
+    // Settled, no more losses
+    fu.overflows = 0;
+    fake_usb_run(2000000);
+    ck_assert_int_eq(fu.overflows, 0);
+    ck_assert_uint_eq(fu.ctrl.period_us, 160);
+}
+END_TEST
+
+START_TEST(usb_depth_shrinks_when_calm) {
+    fake_usb_init(160, MAX_TRANSFERS, 10000);
+
+    fake_usb_run(2000000);
+    ck_assert_uint_le(fu.ctrl.depth, 4);
+    ck_assert_uint_ge(fu.ctrl.shrinks, 1);
+    ck_assert_int_eq(fu.overflows, 0);
+    ck_assert_uint_eq(fu.posted + fu.idle + fu.completed, MAX_TRANSFERS);
+}
+END_TEST
+
+START_TEST(usb_depth_latency_bound) {
+    // Low rate, stalls can't be covered without exceeding the latency bound
+    fake_usb_init(2000, 2, 8000);
+    fu.stall_every_us = 100000;
+    fu.stall_us = 20000;
+
+    fake_usb_run(5000000);
+    ck_assert_uint_eq(fu.max_depth_seen, 4);
+    ck_assert_uint_eq(fu.ctrl.depth, 4);
+
+    // Lifting the bound lets it cover the stall
+    usb_depth_ctrl_set_latency(&fu.ctrl, 0);
+    fake_usb_run(2000000);
+    ck_assert_uint_gt(fu.ctrl.depth, 10);
+}
+END_TEST
+
+START_TEST(usb_depth_init_clamp) {
+    usb_depth_ctrl_t c;
+    usb_depth_ctrl_init(&c, 0, 8, 20, 0);
+    ck_assert_uint_eq(c.min_depth, 1);
+    ck_assert_uint_eq(c.depth, 8);
+
+    usb_depth_ctrl_init(&c, 4, 2, 1, 0);
+    ck_assert_uint_eq(c.max_depth, 4);
+    ck_assert_uint_eq(c.depth, 4);
+}
+END_TEST
+
+Suite * usb_depth_ctrl_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("usb_depth_ctrl");
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, usb_depth_grows_on_stalls);
+    tcase_add_test(tc_core, usb_depth_shrinks_when_calm);
+    tcase_add_test(tc_core, usb_depth_latency_bound);
+    tcase_add_test(tc_core, usb_depth_init_clamp);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
@@ -0,0 +1,123 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#include <check.h>
+#include <string.h>
+#include "../lib/lowlevel/usb_uram/usb_uram_generic.h"
+#include "../lib/ipblks/spiext.h"
+
+enum {
+    SPI32_BASE = 0x10,
+    SPICS8_BASE = 0x20,
+    I2C_BASE = 0x30,
+};
+
+static usb_uram_generic_t gen;
+
+static void setup(void)
+{
+    memset(&gen, 0, sizeof(gen));
+    gen.db.spi_count = 2;
+    gen.db.spi_core[0] = SPI_CORE_32W;
+    gen.db.spi_base[0] = SPI32_BASE;
+    gen.db.spi_core[1] = SPI_CORE_CFGW_CS8;
+    gen.db.spi_base[1] = SPICS8_BASE;
+    gen.db.i2c_count = 1;
+    gen.db.i2c_core[0] = I2C_CORE_AUTO_LUTUPD;
+    gen.db.i2c_base[0] = I2C_BASE;
+}
+
+static void teardown(void)
+{
+}
+
+static uint32_t wr_hdr(unsigned addr, unsigned dwcnt)
+{
+    return ((dwcnt - 1) << 16) | addr;
+}
+
+START_TEST(usb_uram_seq_mixed) {
+    uint32_t spi32_out = 0x80123456;
+    uint32_t spi32_in;
+    uint8_t spics8_out[3] = { 0x01, 0x02, 0x03 };
+    uint32_t spics8_in;
+    uint8_t i2c_wr[2] = { 0x10, 0xaa };
+    uint8_t i2c_reg = 0x42;
+    uint8_t i2c_in;
+    unsigned spics8_cfg = MAKE_SPIEXT_CFG(1, 3, 0x10);
+
+    lowlevel_ls_batch_op_t ops[] = {
+        { USDR_LSOP_SPI, MAKE_SPIEXT_LSOPADR(0, 0, 0), 4, 4, &spi32_in, &spi32_out },
+        { USDR_LSOP_SPI, MAKE_SPIEXT_LSOPADR(spics8_cfg, 0, 1), 3, 3, &spics8_in, spics8_out },
+        { USDR_LSOP_I2C_DEV, MAKE_LSOP_I2C_ADDR(0, 0, 0x50), 0, 2, NULL, i2c_wr },
+        { USDR_LSOP_I2C_DEV, MAKE_LSOP_I2C_ADDR(0, 1, 0x51), 1, 1, &i2c_in, &i2c_reg },
+        { USDR_LSOP_HWREG, 0, 0, 0, NULL, NULL },
+    };
+
+    // Expected LUT updates are replayed on a separate cache
+    struct i2c_cache lut[4];
+    unsigned lidx[2];
+    uint32_t lutv[2];
+    memset(lut, 0, sizeof(lut));
+    lidx[0] = si2c_update_lut_idx(lut, 0x50, 0);
+    lutv[0] = si2c_get_lut(lut);
+    lidx[1] = si2c_update_lut_idx(lut, 0x51, 1);
+    lutv[1] = si2c_get_lut(lut);
+
+    const uint32_t expected[] = {
+        wr_hdr(SPI32_BASE, 1), spi32_out,
+        wr_hdr(SPICS8_BASE - 1, 2), spics8_cfg, 0x030201,
+        wr_hdr(I2C_BASE - 1, 2), lutv[0], MAKE_I2C_CMD(0, 7, 2, lidx[0], 0xaa10),
+        wr_hdr(I2C_BASE - 1, 2), lutv[1], MAKE_I2C_CMD(1, 0, 1, lidx[1], 0x42),
+    };
+    const bool expected_wait[] = { true, true, false, true };
+
+    uint32_t cmds[USB_URAM_SEQ_MAX_DW];
+    unsigned dwcnt = 0;
+    unsigned i;
+
+    for (i = 0; i < SIZEOF_ARRAY(ops); i++) {
+        unsigned edwcnt = 0;
+        bool wait = false;
+        int res = usb_uram_seq_encode(&gen, &ops[i], &cmds[dwcnt], &edwcnt, &wait);
+        if (res == -EOPNOTSUPP)
+            break;
+
+        ck_assert_int_eq(res, 0);
+        ck_assert_int_eq(wait, expected_wait[i]);
+        dwcnt += edwcnt;
+    }
+
+    // Only HWREG can't be queued
+    ck_assert_int_eq(i, SIZEOF_ARRAY(ops) - 1);
+    ck_assert_int_eq(dwcnt, SIZEOF_ARRAY(expected));
+    for (i = 0; i < dwcnt; i++) {
+        ck_assert_uint_eq(cmds[i], expected[i]);
+    }
+}
+END_TEST
+
+START_TEST(usb_uram_seq_bad_bus) {
+    uint32_t out = 0;
+    uint32_t cmds[3];
+    unsigned dwcnt;
+    bool wait;
+
+    lowlevel_ls_batch_op_t spi = { USDR_LSOP_SPI, MAKE_SPIEXT_LSOPADR(0x1234, 0, 2), 0, 4, NULL, &out };
+    ck_assert_int_eq(usb_uram_seq_encode(&gen, &spi, cmds, &dwcnt, &wait), -EINVAL);
+
+    lowlevel_ls_batch_op_t i2c = { USDR_LSOP_I2C_DEV, MAKE_LSOP_I2C_ADDR(1, 0, 0x50), 0, 1, NULL, &out };
+    ck_assert_int_eq(usb_uram_seq_encode(&gen, &i2c, cmds, &dwcnt, &wait), -EINVAL);
+}
+END_TEST
+
+Suite * usb_uram_seq_suite(void)
+{
+    Suite *s = suite_create("usb_uram_seq");
+    TCase *tc_core = tcase_create("USB_URAM_SEQ");
+    tcase_add_checked_fixture(tc_core, setup, teardown);
+    tcase_add_test(tc_core, usb_uram_seq_mixed);
+    tcase_add_test(tc_core, usb_uram_seq_bad_bus);
+    suite_add_tcase(s, tc_core);
+    return s;
+}
@@ -0,0 +1,71 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#include <check.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <semaphore.h>
+#include <unistd.h>
+#include <usdr_time.h>
+
+START_TEST(time_cycles_calibrated) {
+    uint64_t t0 = usdr_time_ns();
+    uint64_t c0 = usdr_time_cycles();
+    usleep(20000);
+    uint64_t c1 = usdr_time_cycles();
+    uint64_t t1 = usdr_time_ns();
+
+    int64_t diff = (int64_t)usdr_time_cycles_to_ns(c1 - c0) - (int64_t)(t1 - t0);
+    ck_assert_uint_ne(usdr_time_cal.hz, 0);
+    ck_assert_int_lt(llabs(diff), (t1 - t0) / 100 + 20000);
+}
+END_TEST
+
+START_TEST(time_fast_ns_monotonic) {
+    uint64_t prev = usdr_time_fast_ns();
+
+    for (unsigned i = 0; i < 100000; i++) {
+        uint64_t now = usdr_time_fast_ns();
+        ck_assert_uint_ge(now, prev);
+        prev = now;
+    }
+
+    // Same time base as CLOCK_MONOTONIC
+    int64_t diff = (int64_t)usdr_time_fast_ns() - (int64_t)usdr_time_ns();
+    ck_assert_int_lt(llabs(diff), 1000000);
+}
+END_TEST
+
+START_TEST(time_sem_wait) {
+    sem_t s;
+    ck_assert_int_eq(sem_init(&s, 0, 0), 0);
+
+    ck_assert_int_eq(usdr_sem_wait_ns(&s, 0), -EAGAIN);
+
+    uint64_t t0 = usdr_time_ns();
+    ck_assert_int_eq(usdr_sem_wait_ns(&s, 20 * 1000 * 1000), -ETIMEDOUT);
+    ck_assert_uint_ge(usdr_time_ns() - t0, 20 * 1000 * 1000);
+
+    sem_post(&s);
+    ck_assert_int_eq(usdr_sem_wait_ns(&s, 20 * 1000 * 1000), 0);
+    sem_post(&s);
+    ck_assert_int_eq(usdr_sem_wait_ns(&s, -1), 0);
+    sem_destroy(&s);
+}
+END_TEST
+
+Suite * usdr_time_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("usdr_time");
+    tc_core = tcase_create("Core");
+
+    tcase_add_test(tc_core, time_cycles_calibrated);
+    tcase_add_test(tc_core, time_fast_ns_monotonic);
+    tcase_add_test(tc_core, time_sem_wait);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}
@@ -0,0 +1,186 @@
+// Copyright (c) 2023-2024 Wavelet Lab
+// SPDX-License-Identifier: MIT
+
+#include <check.h>
+#include <stdio.h>
+#include <errno.h>
+#include <sys/wait.h>
+#include "../lib/lowlevel/verilator_ll/unix_vll.h"
+
+// Ring payload size, VLL_RING_DATA_SZ in unix_vll.c
+#define RING_DATA_SZ  0x10000
+#define PKT_MAX       4000
+#define PKT_COUNT     256
+// Long enough for the other side to give up spinning and sleep on the futex
+#define SLEEP_US      50000
+
+static char s_path[64];
+static struct vll_mem s_mem;
+
+static void setup(void)
+{
+    snprintf(s_path, sizeof(s_path), "/tmp/usdr_vll_ring_%d.mmap", (int)getpid());
+    ck_assert_int_eq(vll_mem_create(&s_mem, s_path, VLL_RING_REGION_SIZE), 0);
+}
+
+static void teardown(void)
+{
+    vll_mem_close(&s_mem);
+    unlink(s_path);
+}
+
+static unsigned pkt_size(unsigned i)
+{
+    return 1 + (i * 7919) % PKT_MAX;
+}
+
+static uint8_t stream_byte(uint64_t pos)
+{
+    return (uint8_t)(pos * 31 + (pos >> 8) + 7);
+}
+
+// Client: streams PKT_COUNT packets to the server, pauses in the middle so
+// the server drains the ring and sleeps, then waits for the byte count back
+static int vll_ring_client(int syncfd, uint64_t total)
+{
+    struct vll_mem cm;
+    struct vll_chan cc;
+    uint8_t pkt[PKT_MAX];
+    uint64_t pos = 0;
+    uint64_t echo;
+
+    memset(&cc, 0, sizeof(cc));
+    cc.fd = -1;
+    if (vll_mem_open(&cm, s_path, VLL_RING_REGION_SIZE))
+        return 1;
+    if (vll_ring_attach(&cc, &cm, 0))
+        return 2;
+    if (write(syncfd, "A", 1) != 1)
+        return 3;
+
+    for (unsigned i = 0; i < PKT_COUNT; i++) {
+        unsigned sz = pkt_size(i);
+        for (unsigned k = 0; k < sz; k++)
+            pkt[k] = stream_byte(pos + k);
+        if (vll_chan_send_sync(&cc, pkt, sz) != (int)sz)
+            return 4;
+        pos += sz;
+
+        if (i == PKT_COUNT / 2)
+            usleep(SLEEP_US);
+    }
+
+    if (pos != total)
+        return 5;
+    if (vll_chan_recv_sync(&cc, (uint8_t*)&echo, sizeof(echo)) != sizeof(echo))
+        return 6;
+    if (echo != total)
+        return 7;
+
+    vll_ring_detach(&cc);
+    vll_mem_close(&cm);
+    return 0;
+}
+
+START_TEST(vll_ring_stream) {
+    struct vll_chan sc;
+    uint8_t buf[3001];
+    uint64_t total = 0, pos = 0;
+    int syncfd[2], status;
+    char c;
+    pid_t pid;
+
+    for (unsigned i = 0; i < PKT_COUNT; i++)
+        total += pkt_size(i);
+    // Several laps around the ring
+    ck_assert_uint_gt(total, 4 * RING_DATA_SZ);
+
+    memset(&sc, 0, sizeof(sc));
+    sc.fd = -1;
+    ck_assert_int_eq(vll_ring_create(&sc, &s_mem, 0), 0);
+    ck_assert_int_eq(pipe(syncfd), 0);
+
+    pid = fork();
+    ck_assert_int_ge(pid, 0);
+    if (pid == 0) {
+        _exit(vll_ring_client(syncfd[1], total));
+    }
+
+    ck_assert_int_eq(read(syncfd[0], &c, 1), 1);
+
+    // Client fills the ring up and sleeps waiting for space
+    usleep(SLEEP_US);
+    ck_assert_uint_gt(vll_chan_pending(&sc), RING_DATA_SZ - PKT_MAX);
+
+    // Odd sized reads split packets and cross the ring end at random offsets
+    while (pos < total) {
+        int res = vll_chan_recv_sync(&sc, buf, sizeof(buf));
+        ck_assert_int_gt(res, 0);
+        for (int k = 0; k < res; k++) {
+            ck_assert_uint_eq(buf[k], stream_byte(pos + k));
+        }
+        pos += res;
+    }
+    ck_assert_uint_eq(pos, total);
+    ck_assert_uint_eq(vll_chan_pending(&sc), 0);
+
+    ck_assert_int_eq(vll_chan_send_sync(&sc, (const uint8_t*)&total, sizeof(total)), sizeof(total));
+
+    ck_assert_int_eq(waitpid(pid, &status, 0), pid);
+    ck_assert(WIFEXITED(status));
+    ck_assert_int_eq(WEXITSTATUS(status), 0);
+
+    vll_ring_detach(&sc);
+    close(syncfd[0]);
+    close(syncfd[1]);
+}
+END_TEST
+
+START_TEST(vll_ring_peer_gone) {
+    struct vll_chan sc;
+    uint8_t buf[16];
+    pid_t pid;
+
+    memset(&sc, 0, sizeof(sc));
+    sc.fd = -1;
+    ck_assert_int_eq(vll_ring_create(&sc, &s_mem, 0), 0);
+
+    pid = fork();
+    ck_assert_int_ge(pid, 0);
+    if (pid == 0) {
+        struct vll_mem cm;
+        struct vll_chan cc;
+
+        memset(&cc, 0, sizeof(cc));
+        cc.fd = -1;
+        if (vll_mem_open(&cm, s_path, VLL_RING_REGION_SIZE) || vll_ring_attach(&cc, &cm, 0))
+            _exit(1);
+        // Goes away without detaching
+        _exit(0);
+    }
+
+    ck_assert_int_eq(waitpid(pid, NULL, 0), pid);
+
+    // Sleeping reader notices the dead peer instead of hanging
+    ck_assert_int_eq(vll_chan_recv_sync(&sc, buf, sizeof(buf)), -EPIPE);
+
+    vll_ring_detach(&sc);
+}
+END_TEST
+
+Suite * vll_ring_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("vll_ring");
+    tc_core = tcase_create("Core");
+    tcase_add_checked_fixture(tc_core, setup, teardown);
+    tcase_set_timeout(tc_core, 30);
+
+    tcase_add_test(tc_core, vll_ring_stream);
+    tcase_add_test(tc_core, vll_ring_peer_gone);
+
+    suite_add_tcase(s, tc_core);
+    return s;
+}